@@ -15,8 +15,27 @@
  *    limitations under the License.
  */
 
+/**
+ *    @file
+ *      Persistent-mode libFuzzer harness of the all-clusters-app.
+ *
+ *      The stack is initialized once. Every input is then delivered as the
+ *      payload of an Interaction Model message received on a CASE session
+ *      established with a test key, so that the fuzzer exercises the data
+ *      model rather than the message decryption. Between two inputs, the
+ *      device is brought back to the state it had after initialization by
+ *      Server::RestoreSnapshot(), and the session is replaced.
+ *
+ *      State kept by the cluster implementations outside of the attribute
+ *      store and the persistent storage, e.g. the in-memory caches of the
+ *      group and scene tables, is not reset.
+ */
+
 #include "AppMain.h"
 #include <app/server/Server.h>
+#include <credentials/tests/CHIPCert_unit_test_vectors.h>
+#include <lib/support/TestPersistentStorageDelegate.h>
+#include <protocols/interaction_model/Constants.h>
 
 #include <CommissionableInit.h>
 
@@ -25,10 +44,72 @@ using namespace chip::DeviceLayer;
 
 namespace {
 
+constexpr NodeId kControllerNodeId = 0x000000000001B669;
+constexpr uint16_t kLocalSessionId = 1;
+constexpr uint16_t kPeerSessionId  = 2;
+constexpr uint32_t kMessageCounter = 1;
+constexpr uint16_t kExchangeId     = 1;
+
 LinuxCommissionableDataProvider gCommissionableDataProvider;
+// Wrapped by the server in the storage it snapshots.
+TestPersistentStorageDelegate gStorage;
 
+FabricIndex gFabricIndex = kUndefinedFabricIndex;
+NodeId gLocalNodeId      = kUndefinedNodeId;
+SessionHolder gSession;
+
+void DrainEventLoop()
+{
+    PlatformMgr().ScheduleWork([](intptr_t) { PlatformMgr().StopEventLoopTask(); });
+    PlatformMgr().RunEventLoop();
 }
 
+/**
+ * Commissions the device into a test fabric and grants the administer
+ * privilege to the controller the inputs are received from.
+ */
+void CommissionTestFabric()
+{
+    using namespace chip::TestCerts;
+
+    FabricTable & fabrics = Server::GetInstance().GetFabricTable();
+    VerifyOrDie(fabrics.AddNewFabricForTest(GetRootACertAsset().mCert, GetIAA1CertAsset().mCert, GetNodeA1CertAsset().mCert,
+                                            GetNodeA1CertAsset().mKey, &gFabricIndex) == CHIP_NO_ERROR);
+    gLocalNodeId = fabrics.FindFabricWithIndex(gFabricIndex)->GetNodeId();
+
+    Access::AccessControl::Entry adminEntry;
+    Access::AccessControl & accessControl = Access::GetAccessControl();
+    VerifyOrDie(accessControl.PrepareEntry(adminEntry) == CHIP_NO_ERROR);
+    VerifyOrDie(adminEntry.SetFabricIndex(gFabricIndex) == CHIP_NO_ERROR);
+    VerifyOrDie(adminEntry.SetPrivilege(Access::Privilege::kAdminister) == CHIP_NO_ERROR);
+    VerifyOrDie(adminEntry.SetAuthMode(Access::AuthMode::kCase) == CHIP_NO_ERROR);
+    VerifyOrDie(adminEntry.AddSubject(nullptr, kControllerNodeId) == CHIP_NO_ERROR);
+    VerifyOrDie(accessControl.CreateEntry(nullptr, adminEntry, &gFabricIndex) == CHIP_NO_ERROR);
+}
+
+void OpenSession()
+{
+    // The default peer address has no transport: the responses of the device
+    // fail to be sent without reaching the network.
+    VerifyOrDie(Server::GetInstance().GetSecureSessionManager().InjectCaseSessionWithTestKey(
+                    gSession, kLocalSessionId, kPeerSessionId, gLocalNodeId, kControllerNodeId, gFabricIndex,
+                    Transport::PeerAddress(), CryptoContext::SessionRole::kResponder) == CHIP_NO_ERROR);
+}
+
+void CloseSession()
+{
+    // Evicting the session releases the exchanges, subscriptions and handlers
+    // the input left behind.
+    if (gSession)
+    {
+        gSession->AsSecureSession()->MarkForEviction();
+    }
+    gSession.Release();
+    DrainEventLoop();
+}
+
+} // namespace
+
 void CleanShutdown()
 {
     Server::GetInstance().Shutdown();
@@ -38,6 +119,10 @@ void CleanShutdown()
     // Platform::MemoryShutdown();
 }
 
+/**
+ * The first byte of the input is the Interaction Model message type, the rest
+ * is the TLV payload of the message.
+ */
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t * aData, size_t aSize)
 {
     static bool matterStackInitialized = false;
@@ -54,11 +139,16 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t * aData, size_t aSize)
 
         // ChipLinuxAppMainLoop blocks, and we don't want that here.
         static chip::CommonCaseDeviceServerInitParams initParams;
+        initParams.persistentStorageDelegate = &gStorage;
         (void) initParams.InitializeStaticResourcesBeforeServerInit();
         VerifyOrDie(Server::GetInstance().Init(initParams) == CHIP_NO_ERROR);
 
         ApplicationInit();
 
+        CommissionTestFabric();
+        DrainEventLoop();
+        VerifyOrDie(Server::GetInstance().CaptureSnapshot() == CHIP_NO_ERROR);
+
         // We don't start the event loop task, because we don't plan to deliver
         // data on a separate thread.
 
@@ -69,24 +159,35 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t * aData, size_t aSize)
         atexit(CleanShutdown);
     }
 
-    // For now, just dump the data as a UDP payload into the session manager.
-    // But maybe we should try to separately extract a PeerAddress and data from
-    // the incoming data?
-    Transport::PeerAddress peerAddr;
+    if (aSize < 1)
+    {
+        return 0;
+    }
+
     System::PacketBufferHandle buf =
-        System::PacketBufferHandle::NewWithData(aData, aSize, /* aAdditionalSize = */ 0, /* aReservedSize = */ 0);
+        System::PacketBufferHandle::NewWithData(aData + 1, aSize - 1, /* aAdditionalSize = */ 0, /* aReservedSize = */ 0);
     if (buf.IsNull())
     {
         // Too big; we couldn't represent this as a packetbuffer to start with.
         return 0;
     }
 
-    // Ignoring the return value from OnMessageReceived, because we might be
-    // passing it all sorts of garbage that will cause it to fail.
-    Server::GetInstance().GetSecureSessionManager().OnMessageReceived(peerAddr, std::move(buf));
+    OpenSession();
+
+    PacketHeader packetHeader;
+    packetHeader.SetMessageCounter(kMessageCounter).SetSessionId(kLocalSessionId);
+    PayloadHeader payloadHeader;
+    payloadHeader.SetMessageType(Protocols::InteractionModel::Id, aData[0]).SetExchangeID(kExchangeId).SetInitiator(true);
+
+    // The payload is handed to the exchange manager as if the session manager
+    // had decrypted it, so that no input is spent on the message layer.
+    SessionMessageDelegate & exchangeManager = Server::GetInstance().GetExchangeManager();
+    exchangeManager.OnMessageReceived(packetHeader, payloadHeader, gSession.Get().Value(), DuplicateMessage::No, std::move(buf));
 
     // Now process pending events until our sentinel is reached.
-    PlatformMgr().ScheduleWork([](intptr_t) { PlatformMgr().StopEventLoopTask(); });
-    PlatformMgr().RunEventLoop();
+    DrainEventLoop();
+
+    CloseSession();
+    VerifyOrDie(Server::GetInstance().RestoreSnapshot() == CHIP_NO_ERROR);
     return 0;
 }
@@ -17,6 +17,7 @@
  */
 
 #include "ModelCommand.h"
+#include "../fuzzing/Fuzzing.h"
 
 #include <app/InteractionModelEngine.h>
 #include <app/icd/client/DefaultICDClientStorage.h>
@@ -68,6 +69,14 @@ void ModelCommand::OnDeviceConnectionFailureFn(void * context, const chip::Scope
 
     ModelCommand * command = reinterpret_cast<ModelCommand *>(context);
     VerifyOrReturn(command != nullptr, ChipLogError(chipTool, "OnDeviceConnectionFailureFn: context is null"));
+    if (command->IsFuzzing())
+    {
+        chip::fuzzing::Fuzzer * fuzzer = chip::fuzzing::Fuzzer::GetInstance();
+        if (fuzzer != nullptr)
+        {
+            fuzzer->AnalyzeConnectionFailure(peerId.GetNodeId(), err);
+        }
+    }
     command->SetCommandExitStatus(err);
 }
 
@@ -27,6 +27,8 @@ void registerCommandsFuzzing(Commands & commands, CredentialIssuerCommands * cre
 
     commands_list clusterCommands = {
         make_unique<FuzzingStartCommand>(&commands, credsIssuerConfig),
+        make_unique<FuzzingMinimizeCommand>(&commands, credsIssuerConfig),
+        make_unique<FuzzingReplayCommand>(&commands, credsIssuerConfig),
     };
 
     commands.RegisterCommandSet(clusterName, clusterCommands, "Commands for starting fuzzing process.");
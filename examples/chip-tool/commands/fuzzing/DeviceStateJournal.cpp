@@ -0,0 +1,334 @@
+#include "DeviceStateJournal.h"
+#include "DeviceStateManager.h"
+#include "Visitors.h"
+#include <cstring>
+#include <inttypes.h>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace fuzz = chip::fuzzing;
+namespace fs   = std::filesystem;
+namespace ss   = chip::fuzzing::snapshot;
+
+namespace {
+size_t GetPadding(size_t length)
+{
+    return (ss::kSectionAlignment - length % ss::kSectionAlignment) % ss::kSectionAlignment;
+}
+
+struct JournalChange
+{
+    uint8_t flags = 0;
+    fuzz::AnyType value;
+};
+
+// Changes of every test case, by node, endpoint, cluster and attribute.
+using JournalPath    = std::tuple<chip::NodeId, chip::EndpointId, chip::ClusterId, chip::AttributeId>;
+using JournalChanges = std::map<uint64_t, std::map<JournalPath, JournalChange>>;
+
+CHIP_ERROR LoadChanges(const fs::path & path, JournalChanges & changes)
+{
+    fuzz::DeviceStateJournalReader reader;
+    ReturnErrorOnFailure(reader.Open(path));
+
+    ss::DeltaRecord record;
+    while (reader.Next(record))
+    {
+        if (record.flags & ss::kDeltaReported)
+            continue;
+
+        JournalChange & change = changes[record.input][JournalPath(record.nodeId, record.endpointId, record.clusterId,
+                                                                   record.attributeId)];
+        change.flags           = record.flags;
+        if (record.flags & ss::kDeltaHasValue)
+        {
+            ReturnErrorOnFailure(reader.ReadValue(change.value));
+        }
+    }
+    return CHIP_NO_ERROR;
+}
+
+bool ChangesEqual(const JournalChange & a, const JournalChange & b)
+{
+    constexpr uint8_t kCompared = ss::kDeltaReadable | ss::kDeltaHasValue;
+    VerifyOrReturnValue((a.flags & kCompared) == (b.flags & kCompared), false);
+    return !(a.flags & ss::kDeltaHasValue) || fuzz::Visitors::AttributeValuesEqual(a.value, b.value);
+}
+} // namespace
+
+CHIP_ERROR fuzz::DeviceStateJournal::Open(const fs::path & path, uint64_t baseTimestamp)
+{
+    Close();
+    mFile.open(path, std::ios::binary | std::ios::trunc);
+    VerifyOrReturnError(mFile.is_open(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    mPath = path;
+
+    ss::JournalHeader header{};
+    memcpy(header.magic, ss::kJournalMagic, sizeof(header.magic));
+    header.version       = ss::kJournalVersion;
+    header.elementSize   = static_cast<uint16_t>(sizeof(TLV::DecodedTLVElement));
+    header.baseTimestamp = baseTimestamp;
+    Write(&header, sizeof(header));
+    mFile.flush();
+    VerifyOrReturnError(!mFile.fail(), CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    if (mValue == nullptr)
+    {
+        mValue = TLV::DecodedTLVTree::Create();
+    }
+    mLastInput = SIZE_MAX;
+    return CHIP_NO_ERROR;
+}
+
+void fuzz::DeviceStateJournal::Close()
+{
+    VerifyOrReturn(mFile.is_open());
+    mFile.close();
+}
+
+CHIP_ERROR fuzz::DeviceStateJournal::Append(size_t input, NodeId node, const app::ConcreteAttributePath & path,
+                                            const AttributeState & attribute, bool hasValue, bool reported)
+{
+    VerifyOrReturnError(mFile.is_open(), CHIP_ERROR_INCORRECT_STATE);
+
+    ss::DeltaRecord record{};
+    record.input       = input;
+    record.nodeId      = node;
+    record.clusterId   = path.mClusterId;
+    record.attributeId = path.mAttributeId;
+    record.endpointId  = path.mEndpointId;
+    record.flags       = attribute.IsReadable() ? ss::kDeltaReadable : 0;
+    record.flags |= reported ? ss::kDeltaReported : 0;
+
+    AttributeWrapper * wrapper = attribute.GetWrapper();
+    mValue->Clear();
+    if (hasValue && wrapper != nullptr)
+    {
+        record.type    = static_cast<int8_t>(wrapper->type);
+        record.length  = wrapper->length;
+        record.quality = static_cast<uint8_t>(wrapper->quality);
+        record.flags |= ss::kDeltaHasValue;
+        const AnyType & value = wrapper->Read();
+        if (!std::holds_alternative<std::monostate>(value))
+        {
+            uint32_t index;
+            ReturnErrorOnFailure(mValue->AppendValue(TLV::DecodedTLVTree::kRoot, value, index));
+        }
+        record.elementCount  = static_cast<uint32_t>(mValue->GetElementCount());
+        record.stringsLength = static_cast<uint32_t>(mValue->GetStringsLength());
+    }
+
+    // The changes of the previous test case are complete, they survive a crash of the fuzzer from now on.
+    if (input != mLastInput)
+    {
+        mFile.flush();
+        mLastInput = input;
+    }
+
+    Write(&record, sizeof(record));
+    if (record.elementCount > 0)
+    {
+        Write(mValue->GetElements(), record.elementCount * sizeof(TLV::DecodedTLVElement));
+        Write(mValue->GetStrings(), record.stringsLength);
+        static const char padding[ss::kSectionAlignment] = {};
+        Write(padding, GetPadding(record.stringsLength));
+    }
+    VerifyOrReturnError(!mFile.fail(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    mRecords++;
+    return CHIP_NO_ERROR;
+}
+
+void fuzz::DeviceStateJournal::Write(const void * data, size_t length)
+{
+    VerifyOrReturn(length > 0);
+    mFile.write(static_cast<const char *>(data), static_cast<std::streamsize>(length));
+    mBytes += length;
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::StartJournal(const std::vector<std::string> & commandHistory)
+{
+    fs::path base;
+    ReturnErrorOnFailure(Snapshot(commandHistory, base));
+    // Snapshots are named after their timestamp.
+    uint64_t timestamp = strtoull(base.stem().c_str(), nullptr, 10);
+    return mJournal.Open(fs::path(base).replace_extension(".journal"), timestamp);
+}
+
+void fuzz::DeviceStateManager::StopJournal()
+{
+    VerifyOrReturn(mJournal.IsOpen());
+    mJournal.Close();
+    ChipLogProgress(chipFuzzer, "Journaled %" PRIu64 " attribute changes in %" PRIu64 " bytes", mJournal.GetRecordCount(),
+                    mJournal.GetByteCount());
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::Journal(size_t input, NodeId node, const app::ConcreteAttributePath & path, bool hasValue,
+                                             bool reported)
+{
+    VerifyOrReturnError(mJournal.IsOpen(), CHIP_NO_ERROR);
+    AttributeState * attribute = FindAttributeState(node, path.mEndpointId, path.mClusterId, path.mAttributeId);
+    VerifyOrReturnError(attribute != nullptr, CHIP_ERROR_NOT_FOUND);
+    return mJournal.Append(input, node, path, *attribute, hasValue, reported);
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::ApplyJournal(fs::path src, size_t lastInput)
+{
+    DeviceStateJournalReader reader;
+    ReturnErrorOnFailure(reader.Open(src));
+
+    ss::DeltaRecord record;
+    while (reader.Next(record))
+    {
+        if (record.input > lastInput)
+        {
+            continue;
+        }
+
+        NodeId node = record.nodeId;
+        Add(node);
+        Add(node, record.endpointId);
+        Add(node, record.endpointId, record.clusterId);
+        AttributeState & attribute = GetAttributeState(node, record.endpointId, record.clusterId, record.attributeId);
+        if (record.flags & ss::kDeltaHasValue)
+        {
+            VerifyOrReturnError(record.quality != AttributeQualityEnum::kNullable &&
+                                    record.quality <= AttributeQualityEnum::kMandatory,
+                                CHIP_ERROR_INVALID_ARGUMENT);
+            AnyType value;
+            ReturnErrorOnFailure(reader.ReadValue(value));
+            attribute.Replace(AttributeFactory::Create(static_cast<TLVType>(record.type), std::move(value), record.length,
+                                                       static_cast<AttributeQualityEnum>(record.quality)));
+        }
+        if (attribute.IsReadable() != static_cast<bool>(record.flags & ss::kDeltaReadable))
+        {
+            attribute.ToggleBlockReads();
+        }
+    }
+    return IndexPaths();
+}
+
+CHIP_ERROR fuzz::DeviceStateJournalReader::Open(const fs::path & path)
+{
+    mFile.close();
+    mFile.open(path, std::ios::binary);
+    VerifyOrReturnError(mFile.is_open(), CHIP_ERROR_OPEN_FAILED);
+
+    ss::JournalHeader header;
+    VerifyOrReturnError(mFile.read(reinterpret_cast<char *>(&header), sizeof(header)), CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(memcmp(header.magic, ss::kJournalMagic, sizeof(header.magic)) == 0, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(header.version == ss::kJournalVersion && header.elementSize == sizeof(TLV::DecodedTLVElement),
+                        CHIP_ERROR_VERSION_MISMATCH);
+    return CHIP_NO_ERROR;
+}
+
+bool fuzz::DeviceStateJournalReader::Next(ss::DeltaRecord & record)
+{
+    VerifyOrReturnValue(mFile.read(reinterpret_cast<char *>(&mRecord), sizeof(mRecord)), false);
+    mElements.resize(mRecord.elementCount);
+    mStrings.resize(mRecord.stringsLength + GetPadding(mRecord.stringsLength));
+    if (mRecord.elementCount > 0)
+    {
+        VerifyOrReturnValue(mFile.read(reinterpret_cast<char *>(mElements.data()),
+                                       static_cast<std::streamsize>(mElements.size() * sizeof(TLV::DecodedTLVElement))),
+                            false);
+        VerifyOrReturnValue(mFile.read(mStrings.data(), static_cast<std::streamsize>(mStrings.size())), false);
+    }
+    record = mRecord;
+    return true;
+}
+
+CHIP_ERROR fuzz::DeviceStateJournalReader::ReadValue(AnyType & value) const
+{
+    value = std::monostate();
+    VerifyOrReturnError(mRecord.elementCount > 0, CHIP_NO_ERROR);
+    auto tree = TLV::DecodedTLVTree::Create(0);
+    ReturnErrorOnFailure(tree->Assign(mElements.data(), mElements.size(), mStrings.data(), mRecord.stringsLength));
+    value = tree->GetRoot().GetFirstChild().GetContent();
+    return CHIP_NO_ERROR;
+}
+
+const char * fuzz::JournalDivergence::GetKindName() const
+{
+    switch (kind)
+    {
+    case Kind::kValue:
+        return "different value";
+    case Kind::kMissing:
+        return "missing change";
+    case Kind::kUnexpected:
+        return "unexpected change";
+    default:
+        return "unknown";
+    }
+}
+
+CHIP_ERROR fuzz::CompareJournals(const fs::path & expected, const fs::path & actual, Optional<JournalDivergence> & divergence)
+{
+    divergence.ClearValue();
+    JournalChanges expectedChanges;
+    JournalChanges actualChanges;
+    ReturnErrorOnFailure(LoadChanges(expected, expectedChanges));
+    ReturnErrorOnFailure(LoadChanges(actual, actualChanges));
+
+    std::set<uint64_t> inputs;
+    for (const auto * changes : { &expectedChanges, &actualChanges })
+    {
+        for (const auto & input : *changes)
+        {
+            inputs.insert(input.first);
+        }
+    }
+
+    static const std::map<JournalPath, JournalChange> kNoChanges;
+    for (uint64_t input : inputs)
+    {
+        auto expectedInput         = expectedChanges.find(input);
+        auto actualInput           = actualChanges.find(input);
+        const auto & expectedPaths = expectedInput != expectedChanges.end() ? expectedInput->second : kNoChanges;
+        const auto & actualPaths   = actualInput != actualChanges.end() ? actualInput->second : kNoChanges;
+
+        std::set<JournalPath> paths;
+        for (const auto & change : expectedPaths)
+        {
+            paths.insert(change.first);
+        }
+        for (const auto & change : actualPaths)
+        {
+            paths.insert(change.first);
+        }
+
+        for (const auto & path : paths)
+        {
+            auto expectedChange = expectedPaths.find(path);
+            auto actualChange   = actualPaths.find(path);
+            JournalDivergence found;
+            if (expectedChange == expectedPaths.end())
+            {
+                found.kind   = JournalDivergence::Kind::kUnexpected;
+                found.actual = actualChange->second.value;
+            }
+            else if (actualChange == actualPaths.end())
+            {
+                found.kind     = JournalDivergence::Kind::kMissing;
+                found.expected = expectedChange->second.value;
+            }
+            else if (!ChangesEqual(expectedChange->second, actualChange->second))
+            {
+                found.kind     = JournalDivergence::Kind::kValue;
+                found.expected = expectedChange->second.value;
+                found.actual   = actualChange->second.value;
+            }
+            else
+            {
+                continue;
+            }
+            found.input = input;
+            found.node  = std::get<0>(path);
+            found.path  = app::ConcreteAttributePath(std::get<1>(path), std::get<2>(path), std::get<3>(path));
+            divergence.SetValue(std::move(found));
+            return CHIP_NO_ERROR;
+        }
+    }
+    return CHIP_NO_ERROR;
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "DeviceStateSnapshot.h"
+#include "ForwardDeclarations.h"
+#include "tlv/DecodedTLVElement.h"
+#include <fstream>
+
+namespace chip {
+namespace fuzzing {
+namespace snapshot {
+
+/**
+ * Journal of the attribute changes observed after a base snapshot, as written by DeviceStateJournal.
+ *
+ * The file is a JournalHeader followed by DeltaRecord, each one followed by the DecodedTLVTree holding the new value: its
+ * elements, then its strings, padded to kSectionAlignment. Records are only appended, in the order the changes were observed.
+ */
+
+constexpr char kJournalMagic[8]    = { 'C', 'H', 'I', 'P', 'F', 'Z', 'D', 'L' };
+constexpr uint16_t kJournalVersion = 1;
+
+struct JournalHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t elementSize;
+    uint32_t reserved;
+    // Timestamp of the base snapshot the changes apply to.
+    uint64_t baseTimestamp;
+};
+
+enum DeltaFlags : uint8_t
+{
+    kDeltaReadable = 0x01,
+    // The record carries a new value, otherwise only the flags of the attribute changed.
+    kDeltaHasValue = 0x02,
+    // The change came with a report no test case was waiting for, e.g. from a subscription.
+    kDeltaReported = 0x04,
+};
+
+struct DeltaRecord
+{
+    // Test case whose response carried the change, see Fuzzer::GetJournalInput.
+    uint64_t input;
+    uint64_t nodeId;
+    uint32_t clusterId;
+    uint32_t attributeId;
+    uint16_t endpointId;
+    // TLV type, length and quality of the AttributeWrapper.
+    int8_t type;
+    uint8_t length;
+    uint8_t quality;
+    uint8_t flags;
+    uint16_t reserved;
+    // Size of the value tree following the record, whose root holds the value.
+    uint32_t elementCount;
+    uint32_t stringsLength;
+};
+
+} // namespace snapshot
+
+/**
+ * @brief Append-only log of the attribute changes of the device state, one record per changed attribute.
+ *
+ * The state after any test case is the base snapshot the journal was opened for, with the records of the test cases up to it
+ * applied in order (see DeviceStateManager::ApplyJournal). Only the changed attributes are serialized, through a tree that is
+ * reused from one record to the next, and the file is flushed when the changes of a new test case start: the journal is meant
+ * to be always on.
+ *
+ * Only used from the Matter thread while it is open.
+ */
+class DeviceStateJournal
+{
+public:
+    CHIP_ERROR Open(const fs::path & path, uint64_t baseTimestamp);
+    void Close();
+    bool IsOpen() const { return mFile.is_open(); }
+
+    /**
+     * @param hasValue false if only the readable flag of the attribute changed.
+     * @param reported true if the change is not attributed to the test case being run, see kDeltaReported.
+     */
+    CHIP_ERROR Append(size_t input, NodeId node, const app::ConcreteAttributePath & path, const AttributeState & attribute,
+                      bool hasValue, bool reported);
+
+    uint64_t GetRecordCount() const { return mRecords; }
+    uint64_t GetByteCount() const { return mBytes; }
+    const fs::path & GetPath() const { return mPath; }
+
+private:
+    std::ofstream mFile;
+    fs::path mPath;
+    std::shared_ptr<TLV::DecodedTLVTree> mValue;
+    size_t mLastInput = SIZE_MAX;
+    uint64_t mRecords = 0;
+    uint64_t mBytes   = 0;
+
+    void Write(const void * data, size_t length);
+};
+
+/**
+ * @brief Reads the records of a journal in the order they were appended.
+ */
+class DeviceStateJournalReader
+{
+public:
+    CHIP_ERROR Open(const fs::path & path);
+
+    /**
+     * @brief Reads the next record. A record cut short by a crash of the fuzzer ends the journal.
+     * @return false at the end of the journal.
+     */
+    bool Next(snapshot::DeltaRecord & record);
+
+    /**
+     * @brief Builds the value carried by the last record read. Every value gets its own tree, as the containers restored from
+     * it share it.
+     */
+    CHIP_ERROR ReadValue(AnyType & value) const;
+
+private:
+    std::ifstream mFile;
+    snapshot::DeltaRecord mRecord{};
+    std::vector<TLV::DecodedTLVElement> mElements;
+    std::vector<char> mStrings;
+};
+
+/**
+ * @brief First difference between the changes of the device state recorded in two journals, see CompareJournals.
+ */
+struct JournalDivergence
+{
+    enum class Kind : uint8_t
+    {
+        // Both journals changed the attribute, to different values.
+        kValue,
+        // Only the first journal changed the attribute.
+        kMissing,
+        // Only the second journal changed the attribute.
+        kUnexpected,
+    };
+
+    Kind kind;
+    uint64_t input;
+    NodeId node;
+    app::ConcreteAttributePath path;
+    // Values the attribute was changed to, monostate if the journal did not change it or only changed its readable flag.
+    AnyType expected;
+    AnyType actual;
+
+    const char * GetKindName() const;
+};
+
+/**
+ * @brief Finds the first test case whose responses changed the device state differently in two journals taken from the same
+ * base snapshot.
+ *
+ * The changes of a test case are compared attribute by attribute, the last change of an attribute being the one that counts. The
+ * reported changes are left out, as they depend on the timing of the reports rather than on the test cases.
+ *
+ * @param divergence Set to the first difference, in test case then path order, cleared if the journals agree.
+ */
+CHIP_ERROR CompareJournals(const fs::path & expected, const fs::path & actual, Optional<JournalDivergence> & divergence);
+
+} // namespace fuzzing
+} // namespace chip
@@ -58,6 +58,8 @@ bool WriteValue(Map & map, const K & id, const Path &... ids, const V & aValue)
     return WriteValue(map[id], ids...);
 }
 
+CHIP_ERROR LoadContainer(const YAML::Node & elements, fuzz::TLV::DecodedTLVTree & tree, uint32_t parent);
+
 CHIP_ERROR LoadValue(const YAML::detail::iterator_value & attribute, fuzz::AnyType & value)
 {
     if (attribute["type"].as<std::string>() == "bool")
@@ -117,14 +119,12 @@ CHIP_ERROR LoadValue(const YAML::detail::iterator_value & attribute, fuzz::AnyTy
     else if (attribute["type"].as<std::string>() == "container")
     {
         // TODO: Manage conversion
-        fuzz::ContainerType container{};
-        for (const auto & element : attribute["value"])
-        {
-            auto nestedElement = std::make_shared<fuzz::TLV::DecodedTLVElement>();
-            ReturnErrorOnFailure(LoadValue(element, nestedElement->content));
-            container.push_back(std::move(nestedElement));
-        }
-        value = container;
+        auto tree = fuzz::TLV::DecodedTLVTree::Create();
+        uint32_t index;
+        ReturnErrorOnFailure(
+            tree->Append(fuzz::TLV::DecodedTLVTree::kRoot, fuzz::TLV::DecodedTLVElement(fuzz::TLVType::kTLVType_Array), index));
+        ReturnErrorOnFailure(LoadContainer(attribute["value"], *tree, index));
+        value = tree->GetContainer(index);
     }
     else
     {
@@ -134,22 +134,42 @@ CHIP_ERROR LoadValue(const YAML::detail::iterator_value & attribute, fuzz::AnyTy
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR LoadContainer(const YAML::Node & elements, fuzz::TLV::DecodedTLVTree & tree, uint32_t parent)
+{
+    for (const auto & element : elements)
+    {
+        uint32_t index;
+        if (element["type"].as<std::string>() == "container")
+        {
+            // The kind of container is not dumped.
+            ReturnErrorOnFailure(tree.Append(parent, fuzz::TLV::DecodedTLVElement(fuzz::TLVType::kTLVType_Array), index));
+            ReturnErrorOnFailure(LoadContainer(element["value"], tree, index));
+            continue;
+        }
+        fuzz::AnyType value;
+        ReturnErrorOnFailure(LoadValue(element, value));
+        ReturnErrorOnFailure(tree.AppendValue(parent, value, index));
+    }
+    return CHIP_NO_ERROR;
+}
+
 CHIP_ERROR DumpContainer(const fuzz::ContainerType & container, YAML::Emitter & emitter)
 {
 
     emitter << YAML::Key << "value" << YAML::BeginSeq;
     for (const auto & element : container)
     {
-        std::string attributeType = fuzz::Visitors::AttributeTypeAsString(element->content);
+        fuzz::AnyType content     = element.GetContent();
+        std::string attributeType = fuzz::Visitors::AttributeTypeAsString(content);
         emitter << YAML::BeginMap;
         emitter << YAML::Key << "type" << YAML::Value << attributeType;
         if (attributeType == "container")
         {
-            VerifyOrReturnError(std::holds_alternative<fuzz::ContainerType>(element->content), CHIP_ERROR_INTERNAL);
-            ReturnErrorOnFailure(DumpContainer(std::get<fuzz::ContainerType>(element->content), emitter));
+            VerifyOrReturnError(std::holds_alternative<fuzz::ContainerType>(content), CHIP_ERROR_INTERNAL);
+            ReturnErrorOnFailure(DumpContainer(std::get<fuzz::ContainerType>(content), emitter));
         }
         else
-            emitter << YAML::Key << "value" << YAML::Value << fuzz::Visitors::AttributeValueAsString(element->content);
+            emitter << YAML::Key << "value" << YAML::Value << fuzz::Visitors::AttributeValueAsString(content);
 
         emitter << YAML::EndMap;
     }
@@ -179,14 +199,18 @@ fuzz::ClusterState * fuzz::DeviceState::operator()(NodeId node, EndpointId endpo
 const fuzz::AnyType & fuzz::DeviceStateManager::ReadAttribute(NodeId node, EndpointId endpoint, ClusterId cluster,
                                                               AttributeId attribute, bool current)
 {
-    VerifyOrReturnValue(mDeviceState(node, endpoint, cluster) != nullptr, kInvalidValue);
-    AttributeState * attributeState = ReadValueOrNull(mDeviceState(node, endpoint, cluster)->attributes, attribute);
+    AttributeState * attributeState = FindAttributeState(node, endpoint, cluster, attribute);
     VerifyOrReturnValue(attributeState != nullptr, kInvalidValue);
     return current ? attributeState->ReadCurrent() : attributeState->ReadLast();
 }
 fuzz::AttributeState & fuzz::DeviceStateManager::GetAttributeState(NodeId node, EndpointId endpoint, ClusterId cluster,
                                                                    AttributeId attribute)
 {
+    if (AttributeState * attributeState = FindAttributeState(node, endpoint, cluster, attribute))
+    {
+        return *attributeState;
+    }
+    mPathIndexStale = mPathIndex.GetPathCount() > 0;
     return ReadValueOrDefault(mDeviceState(node, endpoint, cluster)->attributes, attribute);
 }
 
@@ -194,8 +218,32 @@ void fuzz::DeviceStateManager::WriteAttribute(NodeId node, EndpointId endpoint,
                                               AnyType && aValue)
 {
     VerifyOrDie(mDeviceState(node, endpoint, cluster) != nullptr);
-    AttributeState & attributeState = ReadValueOrDefault(mDeviceState(node, endpoint, cluster)->attributes, attribute);
-    attributeState.Write(std::move(aValue));
+    GetAttributeState(node, endpoint, cluster, attribute).Write(std::move(aValue));
+}
+
+fuzz::AttributeState * fuzz::DeviceStateManager::FindAttributeState(NodeId node, EndpointId endpoint, ClusterId cluster,
+                                                                    AttributeId attribute)
+{
+    if (mPathIndexStale)
+    {
+        LogErrorOnFailure(IndexPaths());
+    }
+    if (const PathIndex::Entry * entry = mPathIndex.Find(node, endpoint, cluster, attribute))
+    {
+        return entry->state;
+    }
+    // Paths which appeared after the last indexing.
+    VerifyOrReturnValue(mDeviceState(node, endpoint, cluster) != nullptr, nullptr);
+    return ReadValueOrNull(mDeviceState(node, endpoint, cluster)->attributes, attribute);
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::IndexPaths()
+{
+    mPathIndexStale = false;
+    CHIP_ERROR err  = mPathIndex.Build(mDeviceState);
+    VerifyOrReturnError(err == CHIP_NO_ERROR, err);
+    ChipLogDetail(chipFuzzer, "Indexed %u attribute paths", static_cast<unsigned>(mPathIndex.GetPathCount()));
+    return CHIP_NO_ERROR;
 }
 
 // TODO: Consider variadic refactoring
@@ -245,6 +293,10 @@ void fuzz::DeviceStateManager::Add(NodeId node, BasicInformation aInfo)
     {
         nodeInfo.serialNumber = aInfo.serialNumber;
     }
+    if (!nodeInfo.subscriptionsPerFabric)
+    {
+        nodeInfo.subscriptionsPerFabric = aInfo.subscriptionsPerFabric;
+    }
 }
 
 void fuzz::DeviceStateManager::Add(NodeId node, EndpointId endpoint)
@@ -259,18 +311,15 @@ void fuzz::DeviceStateManager::Add(NodeId node, EndpointId endpoint)
 void fuzz::DeviceStateManager::Add(NodeId node, EndpointId endpoint, DeviceTypeStruct deviceType)
 {
     VerifyOrReturn((endpoint != kInvalidEndpointId) && (deviceType.id != kInvalidClusterId));
-    VerifyOrReturn(mDeviceState(node) != nullptr);
-    if (mDeviceState(node, endpoint) != nullptr)
+    // Endpoints are only added from the parts list, the wildcard reads of the data model also report the root endpoint.
+    EndpointState * state = mDeviceState(node, endpoint);
+    VerifyOrReturn(state != nullptr);
+    // The descriptor is reported again whenever the whole data model is read.
+    for (const auto & known : state->deviceTypes)
     {
-        mDeviceState(node, endpoint)->deviceTypes.push_back(deviceType);
-    }
-    else
-    {
-        EndpointState state{};
-        state.endpointId  = endpoint;
-        state.deviceTypes = std::vector<DeviceTypeStruct>();
-        VerifyOrDie(mDeviceState(node)->endpoints.emplace(endpoint, state).second);
+        VerifyOrReturn(known.id != deviceType.id);
     }
+    state->deviceTypes.push_back(deviceType);
 }
 
 void fuzz::DeviceStateManager::Add(NodeId node, EndpointId endpoint, ClusterId cluster, uint16_t revision)
@@ -291,6 +340,7 @@ void fuzz::DeviceStateManager::Add(NodeId node, EndpointId endpoint, ClusterId c
 
     AttributeState state{};
     VerifyOrDie(mDeviceState(node, endpoint, cluster)->attributes.emplace(attribute, state).second);
+    mPathIndexStale = mPathIndex.GetPathCount() > 0;
 }
 
 /**
@@ -430,5 +480,5 @@ CHIP_ERROR fuzz::DeviceStateManager::Load(fs::path src)
             }
         }
     }
-    return CHIP_NO_ERROR;
+    return IndexPaths();
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "AttributeFactory.h"
+#include "DeviceStateJournal.h"
 #include "ForwardDeclarations.h"
+#include "PathIndex.h"
 #include "Utils.h"
 #include <unordered_map>
 
@@ -89,9 +91,25 @@ public:
         return CHIP_NO_ERROR;
     }
 
+    // Restores the attribute as it was when the device state snapshot was taken.
+    void Restore(std::shared_ptr<AttributeWrapper> value, std::shared_ptr<AttributeWrapper> oldValue, bool readable)
+    {
+        mValue    = std::move(value);
+        mOldValue = std::move(oldValue);
+        mReadable = readable;
+    }
+
+    // The current value becomes the previous one, as after a Write, e.g. when applying a journal of the device state.
+    void Replace(std::shared_ptr<AttributeWrapper> value)
+    {
+        mOldValue = std::move(mValue);
+        mValue    = std::move(value);
+    }
+
     // If the attribute is unreadable, any read access to it is denied
     void ToggleBlockReads() { mReadable = !mReadable; }
-    bool IsReadable() { return mReadable; }
+    bool IsReadable() const { return mReadable; }
+    AttributeWrapper * GetWrapper(bool current = true) const { return current ? mValue.get() : mOldValue.get(); }
 
 private:
     // Some attributes may be blocked or uninitialized, e.g. when reading them, the device returns a 0x01 status code (FAILURE)
@@ -130,6 +148,8 @@ struct BasicInformation
     uint32_t swVersion            = 0;
     std::string manufacturingDate = "";
     std::string serialNumber      = "";
+    // SubscriptionsPerFabric field of the CapabilityMinima attribute, 0 if unknown. Not saved in the snapshots.
+    uint16_t subscriptionsPerFabric = 0;
 };
 
 struct NodeState
@@ -198,6 +218,8 @@ public:
         VerifyOrDie(mDeviceState(node, endpoint, cluster) != nullptr);
         return &mDeviceState(node, endpoint, cluster)->attributes;
     }
+    // Tells whether the attributes of a cluster are tracked, which is not the case for the nodes whose data model was not acquired.
+    bool Contains(NodeId node, EndpointId endpoint, ClusterId cluster) { return mDeviceState(node, endpoint, cluster) != nullptr; }
 
     // The Add methods are used to add new nodes, endpoints, clusters, and attributes to the device state.
     void Add(NodeId node);
@@ -217,9 +239,79 @@ public:
      */
     CHIP_ERROR Load(fs::path src);
 
+    /**
+     * @brief Saves the current device state to a binary snapshot, see DeviceStateSnapshot.h.
+     *
+     * Unlike the YAML dump, the snapshot keeps the TLV type, quality and previous value of the attributes, and can be restored
+     * as many times as needed, e.g. before every replay.
+     *
+     * @param path Set to the path of the snapshot, written in the dump directory.
+     */
+    CHIP_ERROR Snapshot(const std::vector<std::string> & commandHistory, fs::path & path);
+
+    /**
+     * @brief Replaces the device state with a binary snapshot. The file is memory-mapped and the attribute values are restored
+     * without parsing them, the containers of all the attributes share a single tree.
+     *
+     * @param commandHistory If not null, set to the command history stored in the snapshot.
+     */
+    CHIP_ERROR Restore(fs::path src, std::vector<std::string> * commandHistory = nullptr);
+
+    /**
+     * @brief Saves the data model of a node, i.e. its endpoints, clusters and attributes, to a binary snapshot holding that node
+     * only, so that it can be restored for another node running the same firmware.
+     */
+    CHIP_ERROR SnapshotDataModel(NodeId node, const fs::path & path);
+
+    /**
+     * @brief Replaces the endpoints of a node with the ones of a snapshot taken by SnapshotDataModel, possibly for another node.
+     * The basic information of the node is kept.
+     */
+    CHIP_ERROR RestoreDataModel(NodeId node, const fs::path & src);
+
+    /**
+     * @brief Takes a base snapshot and opens the journal of the attribute changes that follow it, next to the snapshot.
+     */
+    CHIP_ERROR StartJournal(const std::vector<std::string> & commandHistory);
+    void StopJournal();
+
+    /**
+     * @brief Appends the current state of an attribute to the journal, if open. Callers only journal actual changes.
+     *
+     * @param hasValue false if only the readable flag of the attribute changed.
+     * @param reported true if the change is not attributed to the test case being run, e.g. it came from a subscription.
+     */
+    CHIP_ERROR Journal(size_t input, NodeId node, const app::ConcreteAttributePath & path, bool hasValue = true,
+                       bool reported = false);
+    // Path of the journal being written, or of the last one.
+    const fs::path & GetJournalPath() const { return mJournal.GetPath(); }
+
+    /**
+     * @brief Applies the changes recorded for the test cases up to lastInput to the device state, which must have been restored
+     * from the base snapshot of the journal. Endpoints and clusters which appeared after the snapshot are added.
+     */
+    CHIP_ERROR ApplyJournal(fs::path src, size_t lastInput = SIZE_MAX);
+
+    /**
+     * @brief Indexes the attribute paths of the device state, see PathIndex. Called once the data model of the nodes has been
+     * acquired and whenever the device state is replaced, attributes added later are indexed again on their next lookup.
+     */
+    CHIP_ERROR IndexPaths();
+    const PathIndex & GetPathIndex() const { return mPathIndex; }
+
 private:
     DeviceState mDeviceState;
     fs::path mDumpDirectory;
+    DeviceStateJournal mJournal;
+    PathIndex mPathIndex;
+    bool mPathIndexStale = false;
+
+    CHIP_ERROR WriteSnapshot(const std::vector<NodeId> & nodes, const std::vector<std::string> & commandHistory,
+                             const fs::path & path, uint64_t timestamp);
+    static CHIP_ERROR ReadSnapshot(const fs::path & src, DeviceState & state, std::vector<std::string> * commandHistory);
+
+    // Looks the attribute up in the index, then in the nested maps if it is not indexed yet.
+    AttributeState * FindAttributeState(NodeId node, EndpointId endpoint, ClusterId cluster, AttributeId attribute);
 };
 
 } // namespace fuzzing
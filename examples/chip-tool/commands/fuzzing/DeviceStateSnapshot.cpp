@@ -0,0 +1,466 @@
+#include "DeviceStateSnapshot.h"
+#include "DeviceStateManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fuzz = chip::fuzzing;
+namespace ss   = chip::fuzzing::snapshot;
+
+namespace {
+template <typename Map>
+std::vector<typename Map::key_type> SortedKeys(const Map & map)
+{
+    std::vector<typename Map::key_type> keys;
+    keys.reserve(map.size());
+    for (const auto & entry : map)
+    {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter() : mValues(fuzz::TLV::DecodedTLVTree::Create()) {}
+
+    CHIP_ERROR AddNode(const fuzz::NodeState & node)
+    {
+        ss::NodeRecord record{};
+        record.nodeId     = node.nodeId;
+        record.swVersion  = node.nodeInfo.swVersion;
+        record.dmRevision = node.nodeInfo.dmRevision;
+        record.vendorId   = node.nodeInfo.vendorId;
+        record.productId  = node.nodeInfo.productId;
+        record.hwVersion  = node.nodeInfo.hwVersion;
+        ReturnErrorOnFailure(AddText(node.nodeInfo.vendorName, record.vendorName));
+        ReturnErrorOnFailure(AddText(node.nodeInfo.manufacturingDate, record.manufacturingDate));
+        ReturnErrorOnFailure(AddText(node.nodeInfo.serialNumber, record.serialNumber));
+        record.firstEndpoint = static_cast<uint32_t>(mEndpoints.size());
+        record.endpointCount = static_cast<uint32_t>(node.endpoints.size());
+        mNodes.push_back(record);
+        return CHIP_NO_ERROR;
+    }
+
+    void AddEndpoint(const fuzz::EndpointState & endpoint)
+    {
+        ss::EndpointRecord record{};
+        record.endpointId      = endpoint.endpointId;
+        record.firstDeviceType = static_cast<uint32_t>(mDeviceTypes.size());
+        record.deviceTypeCount = static_cast<uint32_t>(endpoint.deviceTypes.size());
+        record.firstCluster    = static_cast<uint32_t>(mClusters.size());
+        record.clusterCount    = static_cast<uint32_t>(endpoint.clusters.size());
+        mEndpoints.push_back(record);
+        for (const auto & deviceType : endpoint.deviceTypes)
+        {
+            mDeviceTypes.push_back(ss::DeviceTypeRecord{ deviceType.id, deviceType.revision, 0 });
+        }
+    }
+
+    void AddCluster(const fuzz::ClusterState & cluster)
+    {
+        ss::ClusterRecord record{};
+        record.clusterId      = cluster.clusterId;
+        record.revision       = cluster.clusterRevision;
+        record.firstAttribute = static_cast<uint32_t>(mAttributes.size());
+        record.attributeCount = static_cast<uint32_t>(cluster.attributes.size());
+        mClusters.push_back(record);
+    }
+
+    CHIP_ERROR AddAttribute(chip::AttributeId id, const fuzz::AttributeState & attribute)
+    {
+        ss::AttributeRecord record{};
+        record.attributeId             = id;
+        record.value                   = fuzz::TLV::kNoElement;
+        record.oldValue                = fuzz::TLV::kNoElement;
+        fuzz::AttributeWrapper * value = attribute.GetWrapper();
+        fuzz::AttributeWrapper * old   = attribute.GetWrapper(false);
+        if (value != nullptr)
+        {
+            record.type    = static_cast<int8_t>(value->type);
+            record.length  = value->length;
+            record.quality = static_cast<uint8_t>(value->quality);
+            record.flags |= ss::kHasValue;
+            ReturnErrorOnFailure(AddValue(value->Read(), record.value));
+        }
+        if (old != nullptr)
+        {
+            record.flags |= ss::kHasOldValue;
+            ReturnErrorOnFailure(AddValue(old->Read(), record.oldValue));
+        }
+        if (attribute.IsReadable())
+        {
+            record.flags |= ss::kReadable;
+        }
+        mAttributes.push_back(record);
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR AddHistory(const std::vector<std::string> & commandHistory)
+    {
+        mHistory.reserve(commandHistory.size());
+        for (const auto & command : commandHistory)
+        {
+            ReturnErrorOnFailure(AddText(command, mHistory.emplace_back()));
+        }
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR Write(const fuzz::fs::path & path, uint64_t timestamp)
+    {
+        ss::Header header{};
+        memcpy(header.magic, ss::kMagic, sizeof(header.magic));
+        header.version     = ss::kVersion;
+        header.elementSize = static_cast<uint16_t>(sizeof(fuzz::TLV::DecodedTLVElement));
+        header.timestamp   = timestamp;
+
+        std::vector<char> buffer(sizeof(header));
+        Append(buffer, header.sections[ss::kNodes], mNodes.data(), mNodes.size());
+        Append(buffer, header.sections[ss::kEndpoints], mEndpoints.data(), mEndpoints.size());
+        Append(buffer, header.sections[ss::kDeviceTypes], mDeviceTypes.data(), mDeviceTypes.size());
+        Append(buffer, header.sections[ss::kClusters], mClusters.data(), mClusters.size());
+        Append(buffer, header.sections[ss::kAttributes], mAttributes.data(), mAttributes.size());
+        Append(buffer, header.sections[ss::kElements], mValues->GetElements(), mValues->GetElementCount());
+        Append(buffer, header.sections[ss::kStrings], mValues->GetStrings(), mValues->GetStringsLength());
+        Append(buffer, header.sections[ss::kText], mText.data(), mText.size());
+        Append(buffer, header.sections[ss::kHistory], mHistory.data(), mHistory.size());
+        memcpy(buffer.data(), &header, sizeof(header));
+
+        std::ofstream file(path, std::ios::binary);
+        VerifyOrReturnError(file.is_open(), CHIP_FUZZER_FILESYSTEM_ERROR);
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.close();
+        VerifyOrReturnError(!file.fail(), CHIP_FUZZER_FILESYSTEM_ERROR);
+        return CHIP_NO_ERROR;
+    }
+
+private:
+    std::vector<ss::NodeRecord> mNodes;
+    std::vector<ss::EndpointRecord> mEndpoints;
+    std::vector<ss::DeviceTypeRecord> mDeviceTypes;
+    std::vector<ss::ClusterRecord> mClusters;
+    std::vector<ss::AttributeRecord> mAttributes;
+    std::vector<ss::TextRecord> mHistory;
+    std::vector<char> mText;
+    std::shared_ptr<fuzz::TLV::DecodedTLVTree> mValues;
+
+    CHIP_ERROR AddText(const std::string & text, ss::TextRecord & record)
+    {
+        VerifyOrReturnError(mText.size() + text.size() < UINT32_MAX, CHIP_ERROR_NO_MEMORY);
+        record.offset = static_cast<uint32_t>(mText.size());
+        record.length = static_cast<uint32_t>(text.size());
+        mText.insert(mText.end(), text.begin(), text.end());
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR AddValue(const fuzz::AnyType & value, uint32_t & index)
+    {
+        VerifyOrReturnError(!std::holds_alternative<std::monostate>(value), CHIP_NO_ERROR);
+        return mValues->AppendValue(fuzz::TLV::DecodedTLVTree::kRoot, value, index);
+    }
+
+    template <typename T>
+    static void Append(std::vector<char> & buffer, ss::SectionHeader & section, const T * records, size_t count)
+    {
+        size_t offset = (buffer.size() + ss::kSectionAlignment - 1) / ss::kSectionAlignment * ss::kSectionAlignment;
+        buffer.resize(offset + count * sizeof(T));
+        if (count > 0)
+        {
+            memcpy(buffer.data() + offset, records, count * sizeof(T));
+        }
+        section.offset = offset;
+        section.count  = count;
+    }
+};
+
+/**
+ * @brief Read-only mapping of a snapshot, whose sections are handed out in place after being checked to lie in the file.
+ */
+class MappedSnapshot
+{
+public:
+    ~MappedSnapshot()
+    {
+        if (mData != MAP_FAILED)
+        {
+            munmap(mData, mSize);
+        }
+    }
+
+    CHIP_ERROR Open(const fuzz::fs::path & path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        VerifyOrReturnError(fd >= 0, CHIP_ERROR_OPEN_FAILED);
+        struct stat status;
+        if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(ss::Header))
+        {
+            close(fd);
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+        mSize = static_cast<size_t>(status.st_size);
+        mData = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        VerifyOrReturnError(mData != MAP_FAILED, CHIP_FUZZER_FILESYSTEM_ERROR);
+
+        const ss::Header & header = GetHeader();
+        VerifyOrReturnError(memcmp(header.magic, ss::kMagic, sizeof(header.magic)) == 0, CHIP_ERROR_INVALID_ARGUMENT);
+        VerifyOrReturnError(header.version == ss::kVersion && header.elementSize == sizeof(fuzz::TLV::DecodedTLVElement),
+                            CHIP_ERROR_VERSION_MISMATCH);
+        return CHIP_NO_ERROR;
+    }
+
+    const ss::Header & GetHeader() const { return *static_cast<const ss::Header *>(mData); }
+
+    template <typename T>
+    CHIP_ERROR GetSection(ss::Section section, const T *& records, size_t & count) const
+    {
+        const ss::SectionHeader & found = GetHeader().sections[section];
+        VerifyOrReturnError(found.offset % alignof(T) == 0 && found.offset <= mSize, CHIP_ERROR_INVALID_ARGUMENT);
+        VerifyOrReturnError(found.count <= (mSize - found.offset) / sizeof(T), CHIP_ERROR_INVALID_ARGUMENT);
+        records = reinterpret_cast<const T *>(static_cast<const char *>(mData) + found.offset);
+        count   = static_cast<size_t>(found.count);
+        return CHIP_NO_ERROR;
+    }
+
+private:
+    void * mData = MAP_FAILED;
+    size_t mSize = 0;
+};
+
+struct SnapshotSections
+{
+    const ss::NodeRecord * nodes;
+    const ss::EndpointRecord * endpoints;
+    const ss::DeviceTypeRecord * deviceTypes;
+    const ss::ClusterRecord * clusters;
+    const ss::AttributeRecord * attributes;
+    const fuzz::TLV::DecodedTLVElement * elements;
+    const char * strings;
+    const char * text;
+    const ss::TextRecord * history;
+    size_t counts[ss::kSectionCount];
+
+    CHIP_ERROR Map(const MappedSnapshot & snapshot)
+    {
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kNodes, nodes, counts[ss::kNodes]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kEndpoints, endpoints, counts[ss::kEndpoints]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kDeviceTypes, deviceTypes, counts[ss::kDeviceTypes]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kClusters, clusters, counts[ss::kClusters]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kAttributes, attributes, counts[ss::kAttributes]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kElements, elements, counts[ss::kElements]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kStrings, strings, counts[ss::kStrings]));
+        ReturnErrorOnFailure(snapshot.GetSection(ss::kText, text, counts[ss::kText]));
+        return snapshot.GetSection(ss::kHistory, history, counts[ss::kHistory]);
+    }
+
+    bool Contains(ss::Section section, uint32_t first, uint32_t count) const
+    {
+        return static_cast<uint64_t>(first) + count <= counts[section];
+    }
+
+    CHIP_ERROR GetText(const ss::TextRecord & record, std::string & output) const
+    {
+        VerifyOrReturnError(static_cast<uint64_t>(record.offset) + record.length <= counts[ss::kText], CHIP_ERROR_INVALID_ARGUMENT);
+        output.assign(text + record.offset, record.length);
+        return CHIP_NO_ERROR;
+    }
+};
+
+CHIP_ERROR RestoreValue(const std::shared_ptr<fuzz::TLV::DecodedTLVTree> & values, const ss::AttributeRecord & record,
+                        uint32_t index, std::shared_ptr<fuzz::AttributeWrapper> & wrapper)
+{
+    fuzz::AnyType value;
+    if (index != fuzz::TLV::kNoElement)
+    {
+        VerifyOrReturnError(index < values->GetElementCount(), CHIP_ERROR_INVALID_ARGUMENT);
+        value = fuzz::TLV::DecodedTLVView(values.get(), index).GetContent();
+    }
+    wrapper = fuzz::AttributeFactory::Create(static_cast<fuzz::TLVType>(record.type), std::move(value), record.length,
+                                             static_cast<fuzz::AttributeQualityEnum>(record.quality));
+    return CHIP_NO_ERROR;
+}
+} // namespace
+
+CHIP_ERROR fuzz::DeviceStateManager::Snapshot(const std::vector<std::string> & commandHistory, fs::path & path)
+{
+    auto now    = std::chrono::system_clock::now();
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    path        = mDumpDirectory / (std::to_string(now_ms) + ".snapshot");
+    return WriteSnapshot(SortedKeys(mDeviceState.nodes), commandHistory, path, static_cast<uint64_t>(now_ms));
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::SnapshotDataModel(NodeId node, const fs::path & path)
+{
+    VerifyOrReturnError(mDeviceState(node) != nullptr, CHIP_ERROR_NOT_FOUND);
+    auto now    = std::chrono::system_clock::now();
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    return WriteSnapshot({ node }, {}, path, static_cast<uint64_t>(now_ms));
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::WriteSnapshot(const std::vector<NodeId> & nodes,
+                                                   const std::vector<std::string> & commandHistory, const fs::path & path,
+                                                   uint64_t timestamp)
+{
+    SnapshotWriter writer;
+    for (const auto nodeId : nodes)
+    {
+        const NodeState & node = mDeviceState.nodes.at(nodeId);
+        ReturnErrorOnFailure(writer.AddNode(node));
+        // Endpoints, clusters and attributes are laid out breadth-first, so that the children of a record are contiguous.
+        const auto endpointIds = SortedKeys(node.endpoints);
+        for (const auto endpointId : endpointIds)
+        {
+            writer.AddEndpoint(node.endpoints.at(endpointId));
+        }
+        for (const auto endpointId : endpointIds)
+        {
+            const auto & clusters = node.endpoints.at(endpointId).clusters;
+            for (const auto clusterId : SortedKeys(clusters))
+            {
+                writer.AddCluster(clusters.at(clusterId));
+            }
+        }
+        for (const auto endpointId : endpointIds)
+        {
+            const auto & clusters = node.endpoints.at(endpointId).clusters;
+            for (const auto clusterId : SortedKeys(clusters))
+            {
+                const auto & attributes = clusters.at(clusterId).attributes;
+                for (const auto attributeId : SortedKeys(attributes))
+                {
+                    ReturnErrorOnFailure(writer.AddAttribute(attributeId, attributes.at(attributeId)));
+                }
+            }
+        }
+    }
+    ReturnErrorOnFailure(writer.AddHistory(commandHistory));
+    return writer.Write(path, timestamp);
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::Restore(fs::path src, std::vector<std::string> * commandHistory)
+{
+    DeviceState state;
+    ReturnErrorOnFailure(ReadSnapshot(src, state, commandHistory));
+
+    // The index points into the attributes being replaced.
+    mPathIndex.Clear();
+    mDeviceState = std::move(state);
+    return IndexPaths();
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::RestoreDataModel(NodeId node, const fs::path & src)
+{
+    VerifyOrReturnError(mDeviceState(node) != nullptr, CHIP_ERROR_NOT_FOUND);
+    DeviceState state;
+    ReturnErrorOnFailure(ReadSnapshot(src, state, nullptr));
+    VerifyOrReturnError(state.nodes.size() == 1, CHIP_ERROR_INVALID_ARGUMENT);
+
+    // The basic information read from the node, e.g. its serial number, is kept.
+    mPathIndex.Clear();
+    mDeviceState(node)->endpoints = std::move(state.nodes.begin()->second.endpoints);
+    return IndexPaths();
+}
+
+CHIP_ERROR fuzz::DeviceStateManager::ReadSnapshot(const fs::path & src, DeviceState & state,
+                                                  std::vector<std::string> * commandHistory)
+{
+    MappedSnapshot snapshot;
+    ReturnErrorOnFailure(snapshot.Open(src));
+    SnapshotSections sections;
+    ReturnErrorOnFailure(sections.Map(snapshot));
+
+    // A single copy of the value buffers: the containers of every attribute share this tree.
+    auto values = TLV::DecodedTLVTree::Create(0);
+    ReturnErrorOnFailure(values->Assign(sections.elements, sections.counts[ss::kElements], sections.strings,
+                                        sections.counts[ss::kStrings]));
+
+    state.nodes.reserve(sections.counts[ss::kNodes]);
+    for (size_t n = 0; n < sections.counts[ss::kNodes]; n++)
+    {
+        const ss::NodeRecord & nodeRecord = sections.nodes[n];
+        VerifyOrReturnError(sections.Contains(ss::kEndpoints, nodeRecord.firstEndpoint, nodeRecord.endpointCount),
+                            CHIP_ERROR_INVALID_ARGUMENT);
+        NodeState node{};
+        node.nodeId              = nodeRecord.nodeId;
+        node.nodeInfo.swVersion  = nodeRecord.swVersion;
+        node.nodeInfo.dmRevision = nodeRecord.dmRevision;
+        node.nodeInfo.vendorId   = nodeRecord.vendorId;
+        node.nodeInfo.productId  = nodeRecord.productId;
+        node.nodeInfo.hwVersion  = nodeRecord.hwVersion;
+        ReturnErrorOnFailure(sections.GetText(nodeRecord.vendorName, node.nodeInfo.vendorName));
+        ReturnErrorOnFailure(sections.GetText(nodeRecord.manufacturingDate, node.nodeInfo.manufacturingDate));
+        ReturnErrorOnFailure(sections.GetText(nodeRecord.serialNumber, node.nodeInfo.serialNumber));
+        node.endpoints.reserve(nodeRecord.endpointCount);
+
+        for (uint32_t e = 0; e < nodeRecord.endpointCount; e++)
+        {
+            const ss::EndpointRecord & endpointRecord = sections.endpoints[nodeRecord.firstEndpoint + e];
+            VerifyOrReturnError(sections.Contains(ss::kDeviceTypes, endpointRecord.firstDeviceType, endpointRecord.deviceTypeCount),
+                                CHIP_ERROR_INVALID_ARGUMENT);
+            VerifyOrReturnError(sections.Contains(ss::kClusters, endpointRecord.firstCluster, endpointRecord.clusterCount),
+                                CHIP_ERROR_INVALID_ARGUMENT);
+            EndpointState endpoint{};
+            endpoint.endpointId = endpointRecord.endpointId;
+            endpoint.deviceTypes.reserve(endpointRecord.deviceTypeCount);
+            for (uint32_t d = 0; d < endpointRecord.deviceTypeCount; d++)
+            {
+                const ss::DeviceTypeRecord & deviceType = sections.deviceTypes[endpointRecord.firstDeviceType + d];
+                endpoint.deviceTypes.push_back(DeviceTypeStruct{ deviceType.id, deviceType.revision });
+            }
+            endpoint.clusters.reserve(endpointRecord.clusterCount);
+
+            for (uint32_t c = 0; c < endpointRecord.clusterCount; c++)
+            {
+                const ss::ClusterRecord & clusterRecord = sections.clusters[endpointRecord.firstCluster + c];
+                VerifyOrReturnError(sections.Contains(ss::kAttributes, clusterRecord.firstAttribute, clusterRecord.attributeCount),
+                                    CHIP_ERROR_INVALID_ARGUMENT);
+                ClusterState cluster{};
+                cluster.clusterId       = clusterRecord.clusterId;
+                cluster.clusterRevision = clusterRecord.revision;
+                cluster.attributes.reserve(clusterRecord.attributeCount);
+
+                for (uint32_t a = 0; a < clusterRecord.attributeCount; a++)
+                {
+                    const ss::AttributeRecord & attributeRecord = sections.attributes[clusterRecord.firstAttribute + a];
+                    VerifyOrReturnError(attributeRecord.quality != AttributeQualityEnum::kNullable &&
+                                            attributeRecord.quality <= AttributeQualityEnum::kMandatory,
+                                        CHIP_ERROR_INVALID_ARGUMENT);
+                    std::shared_ptr<AttributeWrapper> value;
+                    std::shared_ptr<AttributeWrapper> oldValue;
+                    if (attributeRecord.flags & ss::kHasValue)
+                    {
+                        ReturnErrorOnFailure(RestoreValue(values, attributeRecord, attributeRecord.value, value));
+                    }
+                    if (attributeRecord.flags & ss::kHasOldValue)
+                    {
+                        ReturnErrorOnFailure(RestoreValue(values, attributeRecord, attributeRecord.oldValue, oldValue));
+                    }
+                    AttributeState attribute;
+                    attribute.Restore(std::move(value), std::move(oldValue), attributeRecord.flags & ss::kReadable);
+                    cluster.attributes.emplace(attributeRecord.attributeId, std::move(attribute));
+                }
+                endpoint.clusters.emplace(cluster.clusterId, std::move(cluster));
+            }
+            node.endpoints.emplace(endpoint.endpointId, std::move(endpoint));
+        }
+        state.nodes.emplace(node.nodeId, std::move(node));
+    }
+
+    if (commandHistory != nullptr)
+    {
+        commandHistory->clear();
+        commandHistory->reserve(sections.counts[ss::kHistory]);
+        for (size_t h = 0; h < sections.counts[ss::kHistory]; h++)
+        {
+            ReturnErrorOnFailure(sections.GetText(sections.history[h], commandHistory->emplace_back()));
+        }
+    }
+    return CHIP_NO_ERROR;
+}
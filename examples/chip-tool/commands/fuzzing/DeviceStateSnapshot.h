@@ -0,0 +1,134 @@
+#pragma once
+#include "ForwardDeclarations.h"
+#include "tlv/DecodedTLVElement.h"
+#include <type_traits>
+
+namespace chip {
+namespace fuzzing {
+namespace snapshot {
+
+/**
+ * Binary snapshot of a device state, as written by DeviceStateManager::Snapshot.
+ *
+ * The file is a Header followed by sections of fixed-size records, so that it can be memory-mapped and walked in place. The
+ * hierarchy is flattened: every node refers to a range of endpoints, every endpoint to a range of device types and clusters, and
+ * every cluster to a range of attributes. The attribute values are the children of the root of a single DecodedTLVTree, whose
+ * element and string buffers are stored as they are.
+ *
+ * Records use the byte order and the DecodedTLVElement layout of the build which wrote them: the snapshot is a cache for the
+ * replays of the same fuzzer, the YAML dump is the portable view of the device state.
+ */
+
+constexpr char kMagic[8]    = { 'C', 'H', 'I', 'P', 'F', 'Z', 'S', 'S' };
+constexpr uint16_t kVersion = 1;
+// Sections start on this alignment, which suits every record.
+constexpr size_t kSectionAlignment = 8;
+
+enum Section : uint8_t
+{
+    kNodes,
+    kEndpoints,
+    kDeviceTypes,
+    kClusters,
+    kAttributes,
+    // DecodedTLVElement buffer of the value tree.
+    kElements,
+    // String buffer of the value tree.
+    kStrings,
+    // Node information strings and commands of the history.
+    kText,
+    kHistory,
+    kSectionCount,
+};
+
+struct SectionHeader
+{
+    uint64_t offset;
+    // Number of records, or of bytes for kStrings and kText.
+    uint64_t count;
+};
+
+struct Header
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t elementSize;
+    uint32_t reserved;
+    uint64_t timestamp;
+    SectionHeader sections[kSectionCount];
+};
+
+// Slice of the kText section.
+struct TextRecord
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct NodeRecord
+{
+    uint64_t nodeId;
+    uint32_t swVersion;
+    uint16_t dmRevision;
+    uint16_t vendorId;
+    uint16_t productId;
+    uint16_t hwVersion;
+    TextRecord vendorName;
+    TextRecord manufacturingDate;
+    TextRecord serialNumber;
+    uint32_t firstEndpoint;
+    uint32_t endpointCount;
+};
+
+struct EndpointRecord
+{
+    uint16_t endpointId;
+    uint16_t reserved;
+    uint32_t firstDeviceType;
+    uint32_t deviceTypeCount;
+    uint32_t firstCluster;
+    uint32_t clusterCount;
+};
+
+struct DeviceTypeRecord
+{
+    uint32_t id;
+    uint16_t revision;
+    uint16_t reserved;
+};
+
+struct ClusterRecord
+{
+    uint32_t clusterId;
+    uint16_t revision;
+    uint16_t reserved;
+    uint32_t firstAttribute;
+    uint32_t attributeCount;
+};
+
+enum AttributeFlags : uint8_t
+{
+    kReadable    = 0x01,
+    kHasValue    = 0x02,
+    kHasOldValue = 0x04,
+};
+
+struct AttributeRecord
+{
+    uint32_t attributeId;
+    // TLV type, length and quality of the AttributeWrapper.
+    int8_t type;
+    uint8_t length;
+    uint8_t quality;
+    uint8_t flags;
+    // Indexes of the current and previous values in the value tree, kNoElement if the value is not set.
+    uint32_t value;
+    uint32_t oldValue;
+};
+
+static_assert(std::is_trivially_copyable_v<TLV::DecodedTLVElement>, "Elements are copied from the snapshot as they are");
+static_assert(alignof(TLV::DecodedTLVElement) <= kSectionAlignment && alignof(NodeRecord) <= kSectionAlignment);
+
+} // namespace snapshot
+} // namespace fuzzing
+} // namespace chip
@@ -17,6 +17,9 @@ namespace fuzzing {
 #define CHIP_FUZZER_FILESYSTEM_ERROR CHIP_APPLICATION_ERROR(0x05)
 #define CHIP_FUZZER_UNEXPECTED_ERROR CHIP_APPLICATION_ERROR(0x06)
 #define CHIP_FUZZER_ERROR_ATTRIBUTE_TYPE_MISMATCH CHIP_APPLICATION_ERROR(0x07)
+#define CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE CHIP_APPLICATION_ERROR(0x08)
+#define CHIP_FUZZER_ERROR_NOT_REPRODUCED CHIP_APPLICATION_ERROR(0x09)
+#define CHIP_FUZZER_ERROR_REPLAY_DIVERGED CHIP_APPLICATION_ERROR(0x0A)
 #define CHIP_FUZZER_GENERIC_ERROR CHIP_APPLICATION_ERROR(0xFF)
 
 using TLVType       = chip::TLV::TLVType;
@@ -42,6 +45,9 @@ std::function<const char *(fs::path)> ConvertStringToGenerationFunction(const ch
 namespace TLV {
 class TLVDataPayloadHelper;
 class DecodedTLVElement;
+class DecodedTLVTree;
+class DecodedTLVView;
+class DecodedTLVContainer;
 class DecodedTLVElementPrettyPrinter;
 
 inline TLVTag ExtractTagFromControlByte(uint16_t controlByte);
@@ -1,95 +1,314 @@
 #include "Fuzzing.h"
 #include "Visitors.h"
+#include "execution/LivenessMonitor.h"
 #include "generation/Wrappers.cpp"
+#include <algorithm>
 #include <app-common/zap-generated/ids/Attributes.h>
 #include <app-common/zap-generated/ids/Clusters.h>
+#include <app-common/zap-generated/ids/Events.h>
+#include <fstream>
+#include <inttypes.h>
 
 namespace fuzz = chip::fuzzing;
+namespace exec = chip::fuzzing::execution;
+
+namespace {
+bool GetUnsigned(const fuzz::AnyType & value, uint64_t & result)
+{
+    return std::visit(
+        [&](auto && held) {
+            using T = std::decay_t<decltype(held)>;
+            if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>)
+            {
+                result = held;
+                return true;
+            }
+            return false;
+        },
+        value);
+}
+
+/**
+ * @brief Tells whether the new value of a GeneralDiagnostics attribute shows that the node rebooted since its previous report.
+ * @return A description of the evidence, nullptr if there is none.
+ */
+const char * GetRebootEvidence(const chip::app::ConcreteDataAttributePath & path, const fuzz::AnyType & last,
+                               const fuzz::AnyType & current)
+{
+    namespace Attributes = chip::app::Clusters::GeneralDiagnostics::Attributes;
+    VerifyOrReturnValue(path.mClusterId == chip::app::Clusters::GeneralDiagnostics::Id, nullptr);
+    uint64_t before = 0;
+    uint64_t after  = 0;
+    VerifyOrReturnValue(GetUnsigned(last, before) && GetUnsigned(current, after), nullptr);
+    switch (path.mAttributeId)
+    {
+    case Attributes::RebootCount::Id:
+        return after != before ? "RebootCount changed" : nullptr;
+    case Attributes::BootReason::Id:
+        return after != before ? "BootReason changed" : nullptr;
+    case Attributes::UpTime::Id:
+        return after < before ? "UpTime went back" : nullptr;
+    default:
+        return nullptr;
+    }
+}
+} // namespace
+
 void fuzz::Fuzzer::AnalyzeCommandResponse(chip::TLV::TLVReader * data, const chip::app::ConcreteCommandPath & path,
                                           const chip::app::StatusIB & status, chip::app::StatusIB expectedStatus)
 {
+    if (auto * signature = GetCurrentSignature())
+    {
+        signature->AddStatus(path.mEndpointId, path.mClusterId, path.mCommandId, status);
+    }
+    NotifyAnswer();
+    CountInvokeStatus(status.mStatus);
+
     if (data != nullptr)
     {
         TLV::TLVDataPayloadHelper helper(data);
         helper.Print(path.mEndpointId, path.mClusterId, path.mCommandId);
-        std::shared_ptr<TLV::DecodedTLVElement> output = TLV::DecodedTLVElement::Create(TLVType::kTLVType_Structure);
-        VerifyOrDie(output != nullptr);
-        output->content = ContainerType();
-        helper.Decode(output);
-        TLV::DecodedTLVElementPrettyPrinter(output).Print();
+        TLV::DecodedTLVTree & output = Decode(helper);
+        TLV::DecodedTLVElementPrettyPrinter(output.GetRoot()).Print();
         // TODO: To modify the local device state, we process the subscription response
         // TODO: [DISCLAIMER] We assume the request-response-subscription_response flow is synchronous (in this order)
     }
 
-    // TODO: Parse the TLV data and call mOracle.Consume() on every attribute/path scanned
+    // The oracle only has rules on attributes: command responses are not checked.
     // TODO: For each error, log a line showing command, error type and error description
-    // mOracle->Consume(path, status, expectedStatus);
 }
 
 void fuzz::Fuzzer::AnalyzeReportData(chip::TLV::TLVReader * data, const chip::app::ConcreteDataAttributePath & path,
                                      const chip::app::StatusIB & status, chip::app::StatusIB expectedStatus)
 {
+    auto * signature = GetCurrentSignature();
+    if (signature != nullptr)
+    {
+        signature->AddStatus(path.mEndpointId, path.mClusterId, path.mAttributeId, status);
+    }
+    NotifyAnswer();
+
     if (data != nullptr)
     {
         TLV::TLVDataPayloadHelper helper(data);
         helper.Print(path);
-        std::shared_ptr<TLV::DecodedTLVElement> output = TLV::DecodedTLVElement::Create(TLVType::kTLVType_Structure);
-        VerifyOrDie(output != nullptr);
-        output->content = ContainerType();
-        helper.Decode(output);
-        TLV::DecodedTLVElementPrettyPrinter(output).Print();
+        TLV::DecodedTLVTree & output = Decode(helper, true);
+        TLV::DecodedTLVElementPrettyPrinter(output.GetRoot()).Print();
 
         // TODO: Read the new value of the attribute and update the device state accordingly
         if (path.mClusterId == chip::app::Clusters::Descriptor::Id)
         {
-            ProcessDescriptorClusterResponse(output, path, mCurrentDestination);
+            ProcessDescriptorClusterResponse(output.GetRoot(), path, mCurrentDestination);
         }
         else if (path.mClusterId == chip::app::Clusters::BasicInformation::Id)
         {
-            Visitors::TLV::ProcessBasicInformationClusterResponse(output, path, mCurrentDestination);
+            Visitors::TLV::ProcessBasicInformationClusterResponse(output.GetRoot(), path, mCurrentDestination);
         }
-        else
+        else if (mDeviceStateManager.Contains(mCurrentDestination, path.mEndpointId, path.mClusterId))
         {
             auto & attributeState =
                 mDeviceStateManager.GetAttributeState(mCurrentDestination, path.mEndpointId, path.mClusterId, path.mAttributeId);
-            helper.WriteToDeviceState(std::move(output), attributeState);
-            // mOracle->Consume(path, attributeState, status);
+            CHIP_ERROR err = helper.WriteToDeviceState(output, attributeState);
+            if (err == CHIP_NO_ERROR && !Visitors::AttributeValuesEqual(attributeState.ReadLast(), attributeState.ReadCurrent()))
+            {
+                LogErrorOnFailure(
+                    mDeviceStateManager.Journal(GetJournalInput(), mCurrentDestination, path, true, !mCurrentInput.HasValue()));
+                const char * evidence = GetRebootEvidence(path, attributeState.ReadLast(), attributeState.ReadCurrent());
+                if (evidence != nullptr)
+                {
+                    ReportReboot(evidence);
+                }
+            }
+            if (signature != nullptr)
+            {
+                signature->AddTransition(path.mEndpointId, path.mClusterId, path.mAttributeId,
+                                         feedback::ClassifyValue(attributeState.ReadLast()),
+                                         feedback::ClassifyValue(attributeState.ReadCurrent()));
+            }
         }
+        mOracle->Consume(mDeviceStateManager.GetPathIndex(), mCurrentDestination, path, status, output.GetRoot().GetFirstChild());
+    }
+    else
+    {
+        mOracle->Consume(mDeviceStateManager.GetPathIndex(), mCurrentDestination, path, status, TLV::DecodedTLVView());
     }
 
-    // TODO: Parse the TLV data and call mOracle.Consume() on every attribute/path scanned
     // TODO: For each error, log a line showing command, error type and error description
 }
 
 void fuzz::Fuzzer::AnalyzeReportData(const chip::app::EventHeader & eventHeader, chip::TLV::TLVReader * data,
                                      const chip::app::StatusIB * status, chip::app::StatusIB expectedStatus)
 {
+    if (auto * signature = GetCurrentSignature())
+    {
+        signature->AddEvent(eventHeader.mPath.mEndpointId, eventHeader.mPath.mClusterId, eventHeader.mPath.mEventId);
+    }
+    NotifyAnswer();
+
+    if (eventHeader.mPath.mClusterId == chip::app::Clusters::BasicInformation::Id &&
+        eventHeader.mPath.mEventId == chip::app::Clusters::BasicInformation::Events::StartUp::Id)
+    {
+        // The StartUp events of the previous boots are reported again on every new subscription, only a newer one is a reboot.
+        auto last = mStartUpEvents.find(mCurrentDestination);
+        if (last == mStartUpEvents.end() || last->second < eventHeader.mEventNumber)
+        {
+            if (last != mStartUpEvents.end())
+            {
+                ReportReboot("StartUp event");
+            }
+            mStartUpEvents[mCurrentDestination] = eventHeader.mEventNumber;
+        }
+    }
+
     if (data != nullptr)
     {
         TLV::TLVDataPayloadHelper helper(data);
         helper.Print(eventHeader);
-        std::shared_ptr<TLV::DecodedTLVElement> output = TLV::DecodedTLVElement::Create(TLVType::kTLVType_Structure);
-        VerifyOrDie(output != nullptr);
-        output->content = ContainerType();
-        helper.Decode(output);
-        TLV::DecodedTLVElementPrettyPrinter(output).Print();
+        TLV::DecodedTLVTree & output = Decode(helper);
+        TLV::DecodedTLVElementPrettyPrinter(output.GetRoot()).Print();
     }
 
-    // TODO: Parse the TLV data and call mOracle.Consume() on every attribute/path scanned
+    // The oracle only has rules on attributes: events are not checked.
     // TODO: For each error, log a line showing command, error type and error description
-    // mOracle->Consume(*status, expectedStatus);
 }
 
 void fuzz::Fuzzer::AnalyzeReportError(const chip::app::ConcreteDataAttributePath & path, const chip::app::StatusIB & status)
 {
+    if (auto * signature = GetCurrentSignature())
+    {
+        signature->AddStatus(path.mEndpointId, path.mClusterId, path.mAttributeId, status);
+    }
+    NotifyAnswer();
+    VerifyOrReturn(mDeviceStateManager.Contains(mCurrentDestination, path.mEndpointId, path.mClusterId));
     auto & attributeState =
         mDeviceStateManager.GetAttributeState(mCurrentDestination, path.mEndpointId, path.mClusterId, path.mAttributeId);
     if (attributeState.IsReadable())
+    {
         attributeState.ToggleBlockReads();
+        LogErrorOnFailure(
+            mDeviceStateManager.Journal(GetJournalInput(), mCurrentDestination, path, false, !mCurrentInput.HasValue()));
+    }
+}
+void fuzz::Fuzzer::AnalyzeSubscriptionReport(NodeId node, chip::TLV::TLVReader * data,
+                                             const chip::app::ConcreteDataAttributePath & path, const chip::app::StatusIB & status)
+{
+    NodeId destination     = mCurrentDestination;
+    Optional<size_t> input = mCurrentInput;
+    mCurrentDestination    = node;
+    mCurrentInput.ClearValue();
+
+    AnalyzeReportData(data, path, status);
+    if (!status.IsSuccess())
+    {
+        AnalyzeReportError(path, status);
+    }
+
+    mCurrentDestination = destination;
+    mCurrentInput       = input;
 }
+
+void fuzz::Fuzzer::AnalyzeSubscriptionReport(NodeId node, const chip::app::EventHeader & eventHeader,
+                                             chip::TLV::TLVReader * data, const chip::app::StatusIB * status)
+{
+    NodeId destination     = mCurrentDestination;
+    Optional<size_t> input = mCurrentInput;
+    mCurrentDestination    = node;
+    mCurrentInput.ClearValue();
+
+    AnalyzeReportData(eventHeader, data, status);
+
+    mCurrentDestination = destination;
+    mCurrentInput       = input;
+}
+
+void fuzz::Fuzzer::AnalyzeSubscriptionReportEnd(NodeId node)
+{
+    // The resubscription which follows a reboot reports it in its first report, any later evidence is a new reboot.
+    mRecoveredNodes.erase(node);
+}
+
+void fuzz::Fuzzer::ReportReboot(const char * evidence)
+{
+    // Only the subscription reports the boot a node recovered from, the responses to the test cases are always up to date.
+    if (!mCurrentInput.HasValue() && mRecoveredNodes.count(mCurrentDestination) > 0)
+    {
+        ChipLogProgress(chipFuzzer, "Node 0x" ChipLogFormatX64 " reported the boot it recovered from (%s)",
+                        ChipLogValueX64(mCurrentDestination), evidence);
+        return;
+    }
+    if (mLivenessMonitor != nullptr)
+    {
+        mLivenessMonitor->OnEvent(mCurrentDestination, exec::LivenessEvent::kRebooted, evidence);
+    }
+}
+
 void fuzz::Fuzzer::AnalyzeCommandError(const chip::Protocols::InteractionModel::MsgType messageType, CHIP_ERROR error,
                                        CHIP_ERROR expectedError)
-{}
+{
+    if (auto * signature = GetCurrentSignature())
+    {
+        signature->AddError(error);
+    }
+    if (messageType == Protocols::InteractionModel::MsgType::InvokeCommandResponse && error.IsIMStatus())
+    {
+        CountInvokeStatus(app::StatusIB(error).mStatus);
+    }
+    VerifyOrReturn(mLivenessMonitor != nullptr);
+    if (error == CHIP_ERROR_TIMEOUT)
+    {
+        mLivenessMonitor->OnTimeout(mCurrentDestination);
+    }
+    else if (error.IsIMStatus())
+    {
+        // The node answered with a status.
+        mLivenessMonitor->OnAnswer(mCurrentDestination);
+    }
+}
+
+void fuzz::Fuzzer::CountInvokeStatus(Protocols::InteractionModel::Status status)
+{
+    using Protocols::InteractionModel::Status;
+    switch (status)
+    {
+    case Status::InvalidCommand:
+        mInvokeStatistics.rejected++;
+        break;
+    case Status::Success:
+        mInvokeStatistics.accepted++;
+        break;
+    case Status::ConstraintError:
+        mInvokeStatistics.constrained++;
+        break;
+    case Status::UnsupportedEndpoint:
+    case Status::UnsupportedCluster:
+    case Status::UnsupportedCommand:
+    case Status::UnsupportedAccess:
+    case Status::NeedsTimedInteraction:
+        mInvokeStatistics.unsupported++;
+        break;
+    default:
+        mInvokeStatistics.failed++;
+        break;
+    }
+}
+
+void fuzz::Fuzzer::AnalyzeConnectionFailure(NodeId node, CHIP_ERROR error)
+{
+    ChipLogError(chipFuzzer, "No session with node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT, ChipLogValueX64(node),
+                 error.Format());
+    if (mLivenessMonitor != nullptr)
+    {
+        mLivenessMonitor->OnTimeout(node);
+    }
+}
+
+void fuzz::Fuzzer::NotifyAnswer()
+{
+    if (mLivenessMonitor != nullptr)
+    {
+        mLivenessMonitor->OnAnswer(mCurrentDestination);
+    }
+}
 
 CHIP_ERROR fuzz::Fuzzer::ExportSeedToFile(const char * command, const chip::app::ConcreteClusterPath & dataModelPath)
 {
@@ -123,24 +342,85 @@ CHIP_ERROR fuzz::Fuzzer::ExportSeedToFile(const char * command, const chip::app:
     return CHIP_NO_ERROR;
 }
 
-void fuzz::Fuzzer::ProcessDescriptorClusterResponse(std::shared_ptr<TLV::DecodedTLVElement> decoded,
+CHIP_ERROR fuzz::Fuzzer::ExportTiming(const fs::path & path) const
+{
+    std::ofstream file(path);
+    for (uint64_t time : mCommandTimes)
+    {
+        file << time << '\n';
+    }
+    VerifyOrReturnError(file.flush(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    return CHIP_NO_ERROR;
+}
+
+void fuzz::Fuzzer::ProcessDescriptorClusterResponse(const TLV::DecodedTLVView & decoded,
                                                     const chip::app::ConcreteDataAttributePath & path, NodeId node)
 {
     switch (path.mAttributeId)
     {
     case chip::app::Clusters::Descriptor::Attributes::PartsList::Id: {
-        Visitors::TLV::ProcessDescriptorClusterResponse<EndpointId>(std::move(decoded), path, node);
+        Visitors::TLV::ProcessDescriptorClusterResponse<EndpointId>(decoded, path, node);
         break;
     }
     case chip::app::Clusters::Descriptor::Attributes::DeviceTypeList::Id:
     case chip::app::Clusters::Descriptor::Attributes::ServerList::Id: {
         // This case also applies to the DeviceTypeId: both types are uint32_t
-        Visitors::TLV::ProcessDescriptorClusterResponse<ClusterId>(std::move(decoded), path, node);
+        Visitors::TLV::ProcessDescriptorClusterResponse<ClusterId>(decoded, path, node);
         break;
     }
     }
 }
 
+fuzz::TLV::DecodedTLVTree & fuzz::Fuzzer::Decode(TLV::TLVDataPayloadHelper & helper, bool isAttribute)
+{
+    // A new tree costs one allocation on top of its buffers, whose allocations the tree counts itself.
+    uint64_t allocations = 0;
+    uint64_t baseline    = 0;
+    if (mDecodeTree == nullptr || mDecodeTree.use_count() > 1)
+    {
+        // The device state kept a container of the previous response, which now owns the tree.
+        size_t elements = mDecodeTree != nullptr ? mDecodeTree->GetElementCount() : 1;
+        size_t strings  = mDecodeTree != nullptr ? mDecodeTree->GetStringsLength() : 0;
+        mDecodeTree     = TLV::DecodedTLVTree::Create(elements, strings);
+        allocations     = 1;
+    }
+    else
+    {
+        mDecodeTree->Clear();
+        baseline = mDecodeTree->GetAllocationCount();
+    }
+
+    helper.Decode(*mDecodeTree);
+    if (isAttribute)
+    {
+        mDecodeStatistics.attributes++;
+        mDecodeStatistics.elements += mDecodeTree->GetElementCount() - 1;
+        mDecodeStatistics.allocations += allocations + mDecodeTree->GetAllocationCount() - baseline;
+    }
+    return *mDecodeTree;
+}
+
+void fuzz::Fuzzer::LogDecodeStatistics() const
+{
+    VerifyOrReturn(mDecodeStatistics.attributes > 0);
+    double attributes = static_cast<double>(mDecodeStatistics.attributes);
+    ChipLogProgress(chipFuzzer, "Decoded %" PRIu64 " attributes: %.2f elements and %.2f heap allocations per attribute",
+                    mDecodeStatistics.attributes, static_cast<double>(mDecodeStatistics.elements) / attributes,
+                    static_cast<double>(mDecodeStatistics.allocations) / attributes);
+}
+
+void fuzz::Fuzzer::LogInvokeStatistics() const
+{
+    const InvokeStatistics & invokes = mInvokeStatistics;
+    VerifyOrReturn(invokes.accepted + invokes.rejected + invokes.constrained + invokes.unsupported + invokes.failed > 0);
+    // The ratio is the number of accepted invocations when none was rejected.
+    double ratio = static_cast<double>(invokes.accepted) / static_cast<double>(std::max<uint64_t>(invokes.rejected, 1));
+    ChipLogProgress(chipFuzzer,
+                    "Invocations: %" PRIu64 " accepted, %" PRIu64 " rejected as invalid, %" PRIu64 " out of range, %" PRIu64
+                    " unsupported or denied, %" PRIu64 " failed, accepted-to-rejected ratio %.2f",
+                    invokes.accepted, invokes.rejected, invokes.constrained, invokes.unsupported, invokes.failed, ratio);
+}
+
 std::function<const char *(fs::path)> fuzz::ConvertStringToGenerationFunction(const char * key)
 {
     if (std::string(key).compare("seed-only") == 0)
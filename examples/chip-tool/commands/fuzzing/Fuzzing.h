@@ -2,13 +2,22 @@
 #include "DeviceStateManager.h"
 #include "ForwardDeclarations.h"
 #include "Oracle.h"
+#include "feedback/ResponseSignature.h"
 #include "tlv/DecodedTLVElement.h"
 #include "tlv/TLVDataPayloadHelper.h"
+#include <chrono>
+#include <unordered_set>
 
 class FuzzingCommand;
+class FuzzingMinimizeCommand;
+class FuzzingReplayCommand;
 class FuzzingStartCommand;
 namespace chip {
 namespace fuzzing {
+namespace execution {
+class LivenessMonitor;
+} // namespace execution
+
 /**
  * @brief Generates mutated commands to test the CHIP device's behavior, as well as
  * saving the valid ones as future reference.
@@ -48,18 +57,75 @@ public:
      */
     void AnalyzeReportError(const chip::app::ConcreteDataAttributePath & path, const chip::app::StatusIB & status);
 
+    /**
+     * Analyzes the data reported by the subscription to a node, see execution::StateSubscriber. The device state of the node is
+     * updated and its changes are journaled as reported ones, whichever test case is being analyzed meanwhile.
+     */
+    void AnalyzeSubscriptionReport(NodeId node, chip::TLV::TLVReader * data, const chip::app::ConcreteDataAttributePath & path,
+                                   const chip::app::StatusIB & status);
+    void AnalyzeSubscriptionReport(NodeId node, const chip::app::EventHeader & eventHeader, chip::TLV::TLVReader * data,
+                                   const chip::app::StatusIB * status);
+    // Called once every report of the subscription to a node has been analyzed.
+    void AnalyzeSubscriptionReportEnd(NodeId node);
+
+    /**
+     * Called with the Matter stack locked once a node which went down answers again. The evidence of a reboot reported by its
+     * subscription until the end of the next report announces the boot the node recovered from, e.g. the StartUp event sent
+     * again on resubscription, and is not reported to the LivenessMonitor.
+     */
+    void OnNodeRecovered(NodeId node) { mRecoveredNodes.insert(node); }
+
     // Analyzes data coming from the OnError callbacks.
     void AnalyzeCommandError(const chip::Protocols::InteractionModel::MsgType messageType, CHIP_ERROR error,
                              CHIP_ERROR expectedError = CHIP_NO_ERROR);
 
-    void ProcessDescriptorClusterResponse(std::shared_ptr<TLV::DecodedTLVElement> decoded,
-                                          const chip::app::ConcreteDataAttributePath & path, NodeId node);
+    // Analyzes a failure to establish the session of a chip-tool command, which never reaches the OnError callbacks.
+    void AnalyzeConnectionFailure(NodeId node, CHIP_ERROR error);
+
+    void ProcessDescriptorClusterResponse(const TLV::DecodedTLVView & decoded, const chip::app::ConcreteDataAttributePath & path,
+                                          NodeId node);
 
     DeviceStateManager * GetDeviceStateManager() { return &mDeviceStateManager; }
 
+    // Selects the node whose device state is updated by the responses to the chip-tool commands run next.
+    void SetCurrentDestination(NodeId node) { mCurrentDestination = node; }
+
+    /**
+     * Identifies the test case whose response is being analyzed, as its index in the command history, and the node it was sent
+     * to. When several requests are in flight, the sender sets it before calling the Analyze methods, so that Oracle verdicts and
+     * crash triage point to the test case that caused the response rather than to the last one sent, and the device state of the
+     * right node is updated.
+     */
+    void SetCurrentInput(NodeId node, size_t index)
+    {
+        mCurrentDestination = node;
+        mCurrentInput.SetValue(index);
+    }
+    void ClearCurrentInput() { mCurrentInput.ClearValue(); }
+    const Optional<size_t> & GetCurrentInput() const { return mCurrentInput; }
+    // Index that the next command appended to the history will have.
+    size_t GetNextInputIndex() const { return mCommandHistory.size(); }
+
+    /**
+     * Sets the monitor told about the answers, timeouts and reboots of the nodes, see execution::LivenessMonitor. Must only be
+     * changed while the Matter stack is locked.
+     */
+    void SetLivenessMonitor(execution::LivenessMonitor * monitor) { mLivenessMonitor = monitor; }
+
+    // Signatures of the responses to the in-flight test cases, only accessed from the Matter thread.
+    feedback::SignatureRecorder & GetSignatureRecorder() { return mSignatureRecorder; }
+
+    // Logs the cost of decoding the attribute reports, in elements and heap allocations.
+    void LogDecodeStatistics() const;
+
+    // Logs how many invocations got past the decoding of their command fields, see InvokeStatistics.
+    void LogInvokeStatistics() const;
+
 protected:
     // FuzzingStartCommand must be a friend class as it is the only allowed to instantiate the Fuzzer class.
     friend class ::FuzzingCommand;
+    friend class ::FuzzingMinimizeCommand;
+    friend class ::FuzzingReplayCommand;
     friend class ::FuzzingStartCommand;
 
     static void Initialize(NodeId dst, fs::path seedsDirectory, std::function<const char *(fs::path)> generationFunc,
@@ -89,9 +155,21 @@ protected:
     CHIP_ERROR ExportSeedToFile(const char * command, const chip::app::ConcreteClusterPath & dataModelPath);
     CHIP_ERROR AppendToHistory(const char * command)
     {
+        auto now = std::chrono::steady_clock::now();
+        if (mCommandHistory.empty())
+        {
+            mHistoryStart = now;
+        }
         mCommandHistory.push_back(std::string(command));
+        mCommandTimes.push_back(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - mHistoryStart).count()));
         return CHIP_NO_ERROR;
     }
+    /**
+     * Writes the time every command of the history was appended at, one per line in milliseconds since the first one, so that a
+     * replay can keep the pace of the campaign.
+     */
+    CHIP_ERROR ExportTiming(const fs::path & path) const;
 
 private:
     Fuzzer(NodeId dst, fs::path seedsDirectory, std::function<const char *(fs::path)> generationFunc, fs::path dumpDirectory) :
@@ -113,6 +191,58 @@ private:
     std::function<const char *(fs::path)> mGenerationFunc;
     NodeId mCurrentDestination;
     std::vector<std::string> mCommandHistory;
+    std::vector<uint64_t> mCommandTimes;
+    std::chrono::steady_clock::time_point mHistoryStart;
+    Optional<size_t> mCurrentInput = NullOptional;
+    feedback::SignatureRecorder mSignatureRecorder;
+    execution::LivenessMonitor * mLivenessMonitor = nullptr;
+    // Number of the last StartUp event of every node, events being numbered across reboots. Only accessed from the Matter thread.
+    std::unordered_map<NodeId, EventNumber> mStartUpEvents;
+    // Nodes which recovered since the last report of their subscription, only accessed from the Matter thread.
+    std::unordered_set<NodeId> mRecoveredNodes;
+
+    // Tells the LivenessMonitor that the current destination rebooted, unless the reboot is the one it recovered from.
+    void ReportReboot(const char * evidence);
+
+    struct DecodeStatistics
+    {
+        uint64_t attributes  = 0;
+        uint64_t elements    = 0;
+        uint64_t allocations = 0;
+    };
+    // Responses are decoded into the same tree until the device state keeps one of its containers, only accessed from the
+    // Matter thread.
+    std::shared_ptr<TLV::DecodedTLVTree> mDecodeTree;
+    DecodeStatistics mDecodeStatistics;
+
+    // Invocations answered with a status, by what the node made of their command fields. Only accessed from the Matter thread.
+    struct InvokeStatistics
+    {
+        // SUCCESS, including the cluster-specific responses: the fields were decoded and the cluster logic carried the command out.
+        uint64_t accepted = 0;
+        // INVALID_COMMAND: the fields could not be decoded, e.g. a mandatory one is missing or of another type.
+        uint64_t rejected = 0;
+        // CONSTRAINT_ERROR: the fields were decoded but a value is out of its range.
+        uint64_t constrained = 0;
+        // UNSUPPORTED_* and access statuses: the command never reached its fields decoding.
+        uint64_t unsupported = 0;
+        // Any other status, e.g. FAILURE or BUSY: the command was not carried out.
+        uint64_t failed = 0;
+    };
+    InvokeStatistics mInvokeStatistics;
+
+    void CountInvokeStatus(Protocols::InteractionModel::Status status);
+
+    TLV::DecodedTLVTree & Decode(TLV::TLVDataPayloadHelper & helper, bool isAttribute = false);
+
+    // Test case the changes of the device state are journaled for: the current input, or the next one for the reports which are
+    // not attributed to any, e.g. those of the subscriptions.
+    size_t GetJournalInput() const { return mCurrentInput.ValueOr(GetNextInputIndex()); }
+
+    feedback::ResponseSignature * GetCurrentSignature() { return mSignatureRecorder.Find(mCurrentDestination, mCurrentInput); }
+
+    // Tells the liveness monitor, if any, that the current destination answered.
+    void NotifyAnswer();
 };
 
 std::function<const char *(fs::path)> ConvertStringToGenerationFunction(const char * key);
@@ -3,43 +3,150 @@
 #include "Utils.h"
 #include "Visitors.h"
 #include "editline.h"
+#include "execution/CampaignScheduler.h"
+#include "execution/PipelinedSender.h"
 #include "generation/RuntimeGrammarManager.h"
+#include "generation/TestCaseFormat.h"
+#include <lib/support/BytesToHex.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <inttypes.h>
 #include <numeric>
+#include <random>
 #include <regex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 namespace fuzz = chip::fuzzing;
 namespace fs   = std::filesystem;
 namespace {
+// Subdirectory of the seed path holding the seeds of the tlv execution.
+constexpr char kTLVSeedDirectory[] = "tlv";
+// Subdirectory of the output path holding the reproducers of the nodes which went down.
+constexpr char kReproducerDirectory[] = "reproducers";
+// Files of a reproducer bundle, see LivenessMonitor.
+constexpr char kBundleHistoryFile[]    = "history";
+constexpr char kBundleReasonFile[]     = "reason";
+constexpr char kMinimizedHistoryFile[] = "history.min";
+// Cache of the artifacts derived from the devices, shared by the campaigns.
+constexpr char kDefaultCachePath[] = "out/debug/standalone/chip-fuzzer/cache";
+// Subdirectory of the cache holding the data models, one snapshot per vendor, product and software version.
+constexpr char kDataModelCacheDirectory[] = "datamodels";
+// Subdirectory of the cache holding the grammars and their generators, by fingerprint of the accepted commands.
+constexpr char kGrammarCacheDirectory[] = "grammars";
+// Sidecar of the final snapshot of a campaign holding the time every command of its history was sent at, see Fuzzer::ExportTiming.
+constexpr char kTimingExtension[] = ".timing";
+
+CHIP_ERROR ParseNodeList(const char * argument, std::vector<chip::NodeId> & nodes)
+{
+    std::istringstream list(argument);
+    std::string token;
+    while (std::getline(list, token, ','))
+    {
+        char * end        = nullptr;
+        chip::NodeId node = strtoull(token.c_str(), &end, 0);
+        VerifyOrReturnError(!token.empty() && *end == '\0', CHIP_ERROR_INVALID_ARGUMENT);
+        VerifyOrReturnError(std::find(nodes.begin(), nodes.end(), node) == nodes.end(), CHIP_ERROR_INVALID_ARGUMENT);
+        nodes.push_back(node);
+    }
+    return CHIP_NO_ERROR;
+}
+
+// Tells whether an exchange of a minimization trial or of a replay got no answer.
+class TrialListener : public fuzz::execution::ExchangeListener
+{
+public:
+    void OnExchangeDone(chip::NodeId node, const fuzz::execution::ExchangeOutcome & outcome) override
+    {
+        if (outcome.error == CHIP_ERROR_TIMEOUT || outcome.error == CHIP_ERROR_NOT_CONNECTED)
+        {
+            mDown = true;
+        }
+    }
+    bool IsDown() const { return mDown; }
+
+private:
+    std::atomic<bool> mDown{ false };
+};
+
+// Read sent on the session of a trial once its test cases are answered: a device which rebooted in the meantime lost the session
+// and never answers it.
+fuzz::generation::GeneratedCommand GetLivenessProbe()
+{
+    fuzz::generation::GeneratedCommand probe;
+    probe.kind          = fuzz::generation::RequestKind::kRead;
+    probe.attributePath = fuzz::generation::AttributePath{ chip::kRootEndpointId, chip::app::Clusters::Descriptor::Id,
+                                                           chip::app::Clusters::Globals::Attributes::ClusterRevision::Id };
+    return probe;
+}
+
+CHIP_ERROR LoadTiming(const fs::path & path, std::vector<uint64_t> & timing)
+{
+    std::ifstream file(path);
+    VerifyOrReturnError(file.is_open(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    uint64_t time;
+    while (file >> time)
+    {
+        // The replay waits for the difference between consecutive times, which must not go backwards.
+        if (!timing.empty() && time < timing.back())
+        {
+            ChipLogError(chipFuzzer, "The timing of %s goes backwards at line %u", path.c_str(),
+                         static_cast<unsigned>(timing.size() + 1));
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+        timing.push_back(time);
+    }
+    VerifyOrReturnError(file.eof(), CHIP_ERROR_INVALID_ARGUMENT);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR ParseRequestKinds(const char * argument, std::vector<fuzz::generation::RequestKind> & kinds)
+{
+    std::istringstream stream(argument);
+    std::string kind;
+    while (std::getline(stream, kind, ','))
+    {
+        if (kind == "invoke")
+            kinds.push_back(fuzz::generation::RequestKind::kInvoke);
+        else if (kind == "read")
+            kinds.push_back(fuzz::generation::RequestKind::kRead);
+        else if (kind == "write")
+            kinds.push_back(fuzz::generation::RequestKind::kWrite);
+        else
+        {
+            ChipLogError(chipFuzzer, "Unknown request kind: %s", kind.c_str());
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+    }
+    VerifyOrReturnError(!kinds.empty(), CHIP_ERROR_INVALID_ARGUMENT);
+    return CHIP_NO_ERROR;
+}
+
 inline std::string GetRetrieveEndpointsCommand(chip::NodeId node)
 {
     std::string kCommand("descriptor read parts-list ");
     kCommand.append(std::to_string(node)).append(" 0");
     return kCommand;
 }; // returns endpoints of the node
-inline std::string GetRetrieveDeviceTypeCommand(chip::NodeId node, chip::EndpointId endpoint)
-{
-    std::string kCommand("descriptor read device-type-list "); // returns device type for each endpoint of the node
-    kCommand.append(std::to_string(node)).append(" ").append(std::to_string(endpoint));
-    return kCommand;
-}; // returns device type of the endpoint
-inline std::string GetRetrieveServerClustersCommand(chip::NodeId node, chip::EndpointId endpoint)
-{
-    std::string kCommand("descriptor read server-list ");
-    kCommand.append(std::to_string(node)).append(" ").append(std::to_string(endpoint));
-    return kCommand;
-}; // returns clusters of all endpoints
-inline std::string GetReadAllClusterAttributesCommand(chip::NodeId node, chip::EndpointId endpoint, chip::ClusterId cluster)
+inline std::string GetReadAllDescriptorsCommand(chip::NodeId node)
 {
     std::string kCommand("any read-by-id ");
-    kCommand.append(std::to_string(cluster))
+    kCommand.append(std::to_string(chip::app::Clusters::Descriptor::Id))
         .append(" 0xFFFFFFFF ")
         .append(std::to_string(node))
-        .append(" ")
-        .append(std::to_string(endpoint));
+        .append(" 0xFFFF");
+    return kCommand;
+}; // returns device types and server clusters of all endpoints
+inline std::string GetReadAllAttributesCommand(chip::NodeId node)
+{
+    std::string kCommand("any read-by-id 0xFFFFFFFF 0xFFFFFFFF ");
+    kCommand.append(std::to_string(node)).append(" 0xFFFF");
     return kCommand;
-}; // reads all attributes
+}; // reads all attributes of all endpoints, the device chunks the report
 inline std::string GetReadClusterEventCommand(chip::NodeId node, chip::EndpointId endpoint, chip::ClusterId cluster)
 {
     std::string kCommand("any read-event-by-id ");
@@ -50,33 +157,6 @@ inline std::string GetReadClusterEventCommand(chip::NodeId node, chip::EndpointI
         .append(std::to_string(endpoint));
     return kCommand;
 }; // reads all events
-inline std::string GetSubscribeAllClusterAttributesCommand(chip::NodeId node, chip::EndpointId endpoint, chip::ClusterId cluster)
-{
-    std::string kCommand("any subscribe-by-id ");
-    kCommand.append(std::to_string(cluster))
-        .append(" 0xFFFFFFFF")
-        .append(" 0")
-        .append(" -1 ")
-        .append(std::to_string(node))
-        .append(" ")
-        .append(std::to_string(endpoint));
-    return kCommand;
-}; // subscribes to all attributes
-inline std::string GetSubscribeEventCommand(chip::NodeId node, chip::EndpointId endpoint, chip::ClusterId cluster,
-                                            chip::EventId event)
-{
-    std::string kCommand("any subscribe-event-by-id ");
-    kCommand.append(std::to_string(cluster))
-        .append(" ")
-        .append(std::to_string(event))
-        .append(" 0")
-        .append(" -1 ")
-        .append(std::to_string(node))
-        .append(" ")
-        .append(std::to_string(endpoint));
-    return kCommand;
-}; // subscribes to all events
-
 void ReorderCommandArgs(std::ostringstream & commandArgs)
 {
     std::istringstream iss(commandArgs.str());
@@ -193,6 +273,21 @@ void FuzzingCommand::ExecuteCommand(const char * command, int * status)
     *status = mHandler->RunFuzzing(command);
 }
 
+void FuzzingCommand::ExecuteAttributedCommand(chip::NodeId node, const char * command, int * status)
+{
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    {
+        chip::DeviceLayer::StackLock lock;
+        fuzzer->SetCurrentInput(node, fuzzer->GetNextInputIndex());
+    }
+    ExecuteCommand(command, status);
+    {
+        chip::DeviceLayer::StackLock lock;
+        fuzzer->ClearCurrentInput();
+    }
+    fuzzer->AppendToHistory(command);
+}
+
 CHIP_ERROR FuzzingStartCommand::AcquireBasicInformation(NodeId nodeId, int * status)
 {
     std::ostringstream command = std::ostringstream() << "basicinformation read data-model-revision " << nodeId << " 0";
@@ -219,6 +314,11 @@ CHIP_ERROR FuzzingStartCommand::AcquireBasicInformation(NodeId nodeId, int * sta
     ExecuteCommand(command.str().c_str(), status);
     VerifyOrReturnError(*status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
 
+    // Tells how many subscriptions the node holds, see StateSubscriber.
+    command = std::ostringstream() << "basicinformation read capability-minima " << nodeId << " 0";
+    ExecuteCommand(command.str().c_str(), status);
+    VerifyOrReturnError(*status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
+
     return CHIP_NO_ERROR;
 }
 
@@ -226,9 +326,9 @@ CHIP_ERROR FuzzingStartCommand::AcquireBasicInformation(NodeId nodeId, int * sta
  * Acquires the remote data model for a given NodeId.
  *
  * This method is responsible for acquiring the remote data model for a specific NodeId. It retrieves
- * the endpoints, device types, server clusters, and cluster attributes for the given NodeId. It also
- * subscribes to all cluster attributes and events for each endpoint and cluster. If any of the commands
- * fail to execute successfully, an error code is returned.
+ * the basic information of the node, then the endpoints, device types, server clusters, and cluster attributes
+ * with wildcard reads, unless the data model of the same vendor, product and software version is cached. The node is
+ * subscribed to afterwards, see StateSubscriber. If any of the commands fail to execute successfully, an error code is returned.
  *
  * @param id The NodeId for which to acquire the remote data model.
  * @return CHIP_NO_ERROR on success, or an error code indicating the reason for failure.
@@ -241,62 +341,49 @@ FuzzingStartCommand::AcquireRemoteDataModel(NodeId id)
     int status                             = 0;
     deviceState->Add(id);
 
-    /**
-     * Steps:
-     * 1) get the endpoints of the node;
-     * 2) for each endpoint, get the device type and server clusters (those who respond to commands);
-     * 3) for each cluster, read all attributes and events and subscribe to them.
-     *
-     * The command response callbacks will parse the response and update the device state accordingly.
-     */
-    std::string retrieveEndpointsCommand = GetRetrieveEndpointsCommand(id);
-
-    ExecuteCommand(retrieveEndpointsCommand.c_str(), &status);
-    VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-    VerifyOrReturnError(deviceState->List(id) != nullptr, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-    for (auto & endpoint : *deviceState->List(id))
+    // The data model of a firmware is cached once acquired, so that the next campaigns against the same firmware skip the scan.
+    ReturnErrorOnFailure(AcquireBasicInformation(id, &status));
+    fs::path cached = GetDataModelCachePath(*deviceState->GetNodeInformation(id));
+    if (fs::exists(cached) && CHIP_NO_ERROR == deviceState->RestoreDataModel(id, cached))
     {
-        std::string retrieveDeviceTypeCommand     = GetRetrieveDeviceTypeCommand(id, endpoint.first);
-        std::string retrieveServerClustersCommand = GetRetrieveServerClustersCommand(id, endpoint.first);
-        ExecuteCommand(retrieveDeviceTypeCommand.c_str(), &status);
+        ChipLogProgress(chipFuzzer, "Data model of node 0x" ChipLogFormatX64 " loaded from %s", ChipLogValueX64(id),
+                        cached.c_str());
+    }
+    else
+    {
+        /**
+         * Steps:
+         * 1) get the endpoints of the node;
+         * 2) get the device types and server clusters of every endpoint at once;
+         * 3) read all the attributes of every cluster at once.
+         *
+         * The command response callbacks will parse the response and update the device state accordingly.
+         */
+        std::string retrieveEndpointsCommand = GetRetrieveEndpointsCommand(id);
+        ExecuteCommand(retrieveEndpointsCommand.c_str(), &status);
         VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
+        VerifyOrReturnError(!deviceState->List(id)->empty(), CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
 
-        ExecuteCommand(retrieveServerClustersCommand.c_str(), &status);
+        std::string readAllDescriptorsCommand = GetReadAllDescriptorsCommand(id);
+        ExecuteCommand(readAllDescriptorsCommand.c_str(), &status);
         VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-        VerifyOrReturnError(deviceState->List(id, endpoint.first) != nullptr, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-
-        for (auto & cluster : *deviceState->List(id, endpoint.first))
-        {
-            std::string readAllClusterAttributesCommand = GetReadAllClusterAttributesCommand(id, endpoint.first, cluster.first);
-            std::string subscribeAllClusterAttributesCommand =
-                GetSubscribeAllClusterAttributesCommand(id, endpoint.first, cluster.first);
-
-            ExecuteCommand(readAllClusterAttributesCommand.c_str(), &status);
-            VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-            ExecuteCommand(subscribeAllClusterAttributesCommand.c_str(), &status);
-            VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-
-            VerifyOrReturnError(deviceState->List(id, endpoint.first, cluster.first) != nullptr,
-                                CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-
-            auto eventList = deviceState->ReadAttribute(id, endpoint.first, cluster.first,
-                                                        chip::app::Clusters::Globals::Attributes::EventList::Id);
-            if (!std::holds_alternative<chip::fuzzing::ContainerType>(eventList))
-                continue;
 
-            for (auto & event : std::get<chip::fuzzing::ContainerType>(eventList))
-            {
-                std::string subscribeClusterEventCommand = GetSubscribeEventCommand(
-                    id, endpoint.first, cluster.first, chip::fuzzing::Visitors::TLV::ConvertToIdType<uint32_t>(event));
+        std::string readAllAttributesCommand = GetReadAllAttributesCommand(id);
+        ExecuteCommand(readAllAttributesCommand.c_str(), &status);
+        VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
 
-                ExecuteCommand(subscribeClusterEventCommand.c_str(), &status);
-                VerifyOrReturnError(status == EXIT_SUCCESS, CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-            }
-        }
+        LogErrorOnFailure(deviceState->SnapshotDataModel(id, cached));
     }
     return CHIP_NO_ERROR;
 }
 
+fs::path FuzzingStartCommand::GetDataModelCachePath(const fuzz::BasicInformation & info)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%04x-%04x-%08" PRIx32 ".snapshot", info.vendorId, info.productId, info.swVersion);
+    return fs::path(mCachePathArgument.ValueOr(const_cast<char *>(kDefaultCachePath))) / kDataModelCacheDirectory / name;
+}
+
 CHIP_ERROR FuzzingStartCommand::InitializeFuzzer()
 {
     std::function<const char *(fs::path)> kGenerationFunc = fuzz::ConvertStringToGenerationFunction(mGenerationFuncArgument);
@@ -308,6 +395,10 @@ CHIP_ERROR FuzzingStartCommand::InitializeFuzzer()
         VerifyOrReturnError(fs::create_directory(mSeedDirectory), CHIP_FUZZER_FILESYSTEM_ERROR);
     }
 
+    std::error_code ec;
+    fs::create_directories(GetDataModelCachePath(fuzz::BasicInformation()).parent_path(), ec);
+    VerifyOrReturnError(!ec, CHIP_FUZZER_FILESYSTEM_ERROR);
+
     if (mOutputDirectoryArgument.HasValue())
     {
         mStatefulFuzzingEnabled = true;
@@ -328,25 +419,15 @@ CHIP_ERROR FuzzingStartCommand::InitializeFuzzer()
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR FuzzingStartCommand::RunCommand()
+CHIP_ERROR FuzzingStartCommand::GenerateTestCasesWithGrammarinator(std::vector<std::string> & testCases)
 {
-    CHIP_ERROR err = InitializeFuzzer();
-    VerifyOrReturnError(CHIP_NO_ERROR == err, err);
-    VerifyOrReturnError(CHIP_NO_ERROR == AcquireRemoteDataModel(mDestinationId), CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-    auto fuzzer             = fuzz::Fuzzer::GetInstance();
-    auto deviceStateManager = fuzzer->GetDeviceStateManager();
-    int status              = 0;
+    auto deviceStateManager = fuzz::Fuzzer::GetInstance()->GetDeviceStateManager();
 
-    // Read the first line of each file in "out/testcases" and send it as a command
-    auto * endpointList = deviceStateManager->List(mDestinationId);
-    VerifyOrReturnError(endpointList && CHIP_NO_ERROR == AcquireBasicInformation(mDestinationId, &status),
-                        CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
-
-    std::string testcasesDirectory          = "out/debug/standalone/chip-fuzzer/testcases";
-    std::string generatedGrammarsDirectory  = "out/debug/standalone/chip-fuzzer/grammars";
-    const fuzz::BasicInformation * nodeInfo = deviceStateManager->GetNodeInformation(mDestinationId);
-    fuzz::generation::RuntimeGrammarManager grammarManager(nodeInfo, generatedGrammarsDirectory);
-    grammarManager.CreateGrammar(deviceStateManager, mDestinationId);
+    std::string testcasesDirectory = "out/debug/standalone/chip-fuzzer/testcases";
+    fs::path grammarCacheDirectory =
+        fs::path(mCachePathArgument.ValueOr(const_cast<char *>(kDefaultCachePath))) / kGrammarCacheDirectory;
+    fuzz::generation::RuntimeGrammarManager grammarManager(deviceStateManager, mDestinationId, grammarCacheDirectory);
+    grammarManager.CreateGrammar();
     grammarManager.GenerateTestCases(testcasesDirectory, mIterations.Value());
 
     fs::directory_iterator endIterator;
@@ -357,35 +438,268 @@ CHIP_ERROR FuzzingStartCommand::RunCommand()
             std::ifstream file(iter->path());
             if (file.is_open())
             {
-                /**
-                 * Strings generated by Grammarinator come with the form ENDPOINT CLUSTER COMMAND JSON.
-                 * To fit the generated content into a command, we must append it to the command-by-id begin string and the node ID,
-                 * then rotate the tokens of the string by 2 positions to match the desired format by the chip-tool.
-                 * any command-by-id
-                 */
                 std::string generatedArgs;
                 std::getline(file, generatedArgs);
                 file.close();
+                // Grammarinator test cases encode numbers as hex strings, which the chip-tool JSON parser does not accept.
+                testCases.push_back(convertHexToDecimal(generatedArgs));
+            }
+        }
+    }
+    VerifyOrReturnError(!testCases.empty(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    return CHIP_NO_ERROR;
+}
 
-                std::ostringstream command;
-                std::ostringstream commandArgs;
+void FuzzingStartCommand::ExecuteTestCase(const std::string & testCase, int * status)
+{
+    /**
+     * Generated test cases come with the form ENDPOINT CLUSTER COMMAND JSON.
+     * To fit the generated content into a command, we must append it to the command-by-id begin string and the node ID,
+     * then rotate the tokens of the string by 2 positions to match the desired format by the chip-tool.
+     * any command-by-id
+     */
+    std::ostringstream command;
+    std::ostringstream commandArgs;
 
-                commandArgs << mDestinationId << " " << convertHexToDecimal(generatedArgs);
-                ReorderCommandArgs(commandArgs);
+    commandArgs << mDestinationId << " " << testCase;
+    ReorderCommandArgs(commandArgs);
 
-                std::string reorderedCommandArgs = commandArgs.str();
-                // reorderedCommandArgs.pop_back(); // Remove the last space
-                command << "any command-by-id " << reorderedCommandArgs;
+    command << "any command-by-id " << commandArgs.str();
 
-                ExecuteCommand(command.str().c_str(), &status);
-                fuzzer->AppendToHistory(command.str().c_str());
-                // Handle the status as needed
-            }
+    ExecuteAttributedCommand(mDestinationId, command.str().c_str(), status);
+}
+
+CHIP_ERROR FuzzingStartCommand::InjectTestCases(const std::vector<chip::NodeId> & nodes, fuzz::execution::SessionPool & sessions,
+                                                fuzz::execution::LivenessMonitor & monitor)
+{
+    std::vector<fuzz::generation::RequestKind> kinds;
+    ReturnErrorOnFailure(ParseRequestKinds(mRequestsArgument.ValueOr(const_cast<char *>("invoke")), kinds));
+
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    fuzz::execution::CampaignScheduler scheduler(sessions, monitor, mWindow.Value(), mSeed.Value());
+    for (auto node : nodes)
+    {
+        ReturnErrorOnFailure(scheduler.AddNode(node, fuzzer->GetDeviceStateManager(), kinds, mMalformedPercent.Value()));
+    }
+    ReturnErrorOnFailure(LoadSeeds(scheduler));
+
+    std::string command;
+    // The index of the history entry identifies the test case in the analysis of the response, which may come before the entry
+    // is recorded.
+    auto nextInput = [&]() { return fuzzer->GetNextInputIndex(); };
+    auto record    = [&](chip::NodeId node, const fuzz::generation::GeneratedCommand & testCase) {
+        // An entry is appended even if the test case cannot be rendered, so that the following indices stay aligned.
+        if (CHIP_NO_ERROR != fuzz::generation::FormatTestCase(node, testCase, command))
+        {
+            command = "tlv-unrenderable";
+        }
+        fuzzer->AppendToHistory(command.c_str());
+    };
+    CHIP_ERROR err = scheduler.Run(mIterations.Value(), nextInput, record);
+
+    scheduler.LogStatistics();
+    fuzzer->LogDecodeStatistics();
+    fuzzer->LogInvokeStatistics();
+    CHIP_ERROR exportErr = ExportCorpus(scheduler);
+    return err == CHIP_NO_ERROR ? exportErr : err;
+}
+
+CHIP_ERROR FuzzingStartCommand::LoadSeeds(fuzz::execution::CampaignScheduler & scheduler)
+{
+    fs::path directory = mSeedDirectory / kTLVSeedDirectory;
+    VerifyOrReturnError(fs::is_directory(directory), CHIP_NO_ERROR);
+
+    size_t loaded = 0;
+    std::string line;
+    for (const auto & entry : fs::recursive_directory_iterator(directory))
+    {
+        if (!entry.is_regular_file())
+            continue;
+
+        std::ifstream file(entry.path());
+        chip::NodeId node;
+        fuzz::generation::GeneratedCommand seed;
+        if (!std::getline(file, line) || CHIP_NO_ERROR != fuzz::generation::ParseTestCase(line, node, seed))
+        {
+            ChipLogError(chipFuzzer, "Skipping malformed seed %s", entry.path().c_str());
+            continue;
+        }
+        // The node a seed was recorded against is irrelevant, the seed is sent to every node of the campaign.
+        if (CHIP_NO_ERROR != scheduler.AddSeed(seed))
+        {
+            ChipLogError(chipFuzzer, "Too many seeds, ignoring the remaining ones");
+            break;
+        }
+        loaded++;
+    }
+    ChipLogProgress(chipFuzzer, "Loaded %u seeds from %s", static_cast<unsigned>(loaded), directory.c_str());
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR FuzzingStartCommand::ExportCorpus(const fuzz::execution::CampaignScheduler & scheduler)
+{
+    fs::path directory = mSeedDirectory / kTLVSeedDirectory;
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    VerifyOrReturnError(!ec, CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    // Entries are named after their signature, so that the corpora of the following campaigns merge into the same directory.
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    std::string line;
+    scheduler.ForEachCorpusEntry([&](chip::NodeId node, const fuzz::feedback::CorpusEntry & entry) {
+        char name[17];
+        snprintf(name, sizeof(name), "%016" PRIx64, entry.signature);
+        if (CHIP_NO_ERROR != fuzz::generation::FormatTestCase(node, entry.testCase, line))
+            return;
+
+        std::ofstream file(directory / name);
+        file << line << std::endl;
+        if (!file)
+        {
+            err = CHIP_FUZZER_FILESYSTEM_ERROR;
+        }
+    });
+    return err;
+}
+
+CHIP_ERROR FuzzingStartCommand::ParseDestinationIds(std::vector<chip::NodeId> & nodes)
+{
+    nodes.push_back(mDestinationId);
+    VerifyOrReturnError(mDestinationIdsArgument.HasValue(), CHIP_NO_ERROR);
+    return ParseNodeList(mDestinationIdsArgument.Value(), nodes);
+}
+
+CHIP_ERROR FuzzingStartCommand::RunCommand()
+{
+    CHIP_ERROR err = InitializeFuzzer();
+    VerifyOrReturnError(CHIP_NO_ERROR == err, err);
+
+    if (!mSeed.HasValue())
+    {
+        mSeed.SetValue(std::random_device{}());
+    }
+    ChipLogProgress(chipFuzzer, "Random seed: %" PRIu64 ", pass it with --seed to generate the same test cases again",
+                    mSeed.Value());
+
+    std::vector<chip::NodeId> nodes;
+    ReturnErrorOnFailure(ParseDestinationIds(nodes));
+
+    // The arguments are validated before the campaign starts, so that nothing has to be undone when they are not supported.
+    const bool grammarinator = mGeneratorArgument.HasValue() && strcmp(mGeneratorArgument.Value(), "grammarinator") == 0;
+    VerifyOrReturnError(grammarinator || !mGeneratorArgument.HasValue() || strcmp(mGeneratorArgument.Value(), "native") == 0,
+                        CHIP_FUZZER_ERROR_NOT_IMPLEMENTED);
+    const bool injecting = mExecutionArgument.HasValue() && strcmp(mExecutionArgument.Value(), "tlv") == 0;
+    VerifyOrReturnError(grammarinator || injecting || !mExecutionArgument.HasValue() ||
+                            strcmp(mExecutionArgument.Value(), "chip-tool") == 0,
+                        CHIP_FUZZER_ERROR_NOT_IMPLEMENTED);
+    // Only the tlv execution mode attributes the responses to the node which sent them.
+    VerifyOrReturnError(nodes.size() == 1 || injecting, CHIP_ERROR_INVALID_ARGUMENT);
+
+    auto fuzzer             = fuzz::Fuzzer::GetInstance();
+    auto deviceStateManager = fuzzer->GetDeviceStateManager();
+    int status              = 0;
+
+    // Every node gets its own partition of the device state manager, acquired while it is the current destination.
+    for (auto node : nodes)
+    {
+        fuzzer->SetCurrentDestination(node);
+        VerifyOrReturnError(CHIP_NO_ERROR == AcquireRemoteDataModel(node), CHIP_FUZZER_ERROR_NODE_SCAN_FAILED);
+    }
+    fuzzer->SetCurrentDestination(mDestinationId);
+    // The paths of the acquired data model are known from now on, every response is looked up in their index.
+    ReturnErrorOnFailure(deviceStateManager->IndexPaths());
+    // Every attribute change from now on is journaled against the state acquired so far.
+    ReturnErrorOnFailure(deviceStateManager->StartJournal(fuzzer->mCommandHistory));
+
+    // Session statistics are collected in every mode, so that they can be compared on the same device.
+    fuzz::execution::SessionPool sessions(CurrentCommissioner());
+    // The reproducers of the nodes which go down are captured, and nothing is sent to them until they are back.
+    fs::path reproducers = mOutputDirectory.ValueOr(fs::path("out/debug/standalone/chip-fuzzer")) / kReproducerDirectory;
+    fuzz::execution::LivenessMonitor monitor(sessions, *deviceStateManager, fuzzer->mCommandHistory, reproducers,
+                                             mReproducerDepth.Value());
+    monitor.Start();
+    // The changes the nodes report on their own are applied to the device state as they come, whatever the execution mode.
+    fuzz::execution::StateSubscriber subscriber(sessions);
+    for (auto node : nodes)
+    {
+        CHIP_ERROR err = subscriber.Subscribe(node, deviceStateManager->GetNodeInformation(node)->subscriptionsPerFabric);
+        if (err != CHIP_NO_ERROR)
+        {
+            ChipLogError(chipFuzzer, "Failed to subscribe to node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                         ChipLogValueX64(node), err.Format());
         }
     }
 
+    // An interrupted campaign still gets its device state saved.
+    CHIP_ERROR campaignErr = CHIP_NO_ERROR;
+    uint32_t failures      = 0;
+    std::vector<std::string> testCases;
+    if (grammarinator)
+    {
+        campaignErr = GenerateTestCasesWithGrammarinator(testCases);
+        for (size_t i = 0; campaignErr == CHIP_NO_ERROR && i < testCases.size(); i++)
+        {
+            campaignErr = monitor.WaitForRecovery(mDestinationId);
+            if (campaignErr != CHIP_NO_ERROR)
+                break;
+            ExecuteTestCase(testCases[i], &status);
+            failures += (status != EXIT_SUCCESS) ? 1 : 0;
+        }
+    }
+    else if (injecting)
+    {
+        campaignErr = InjectTestCases(nodes, sessions, monitor);
+        sessions.LogStatistics("tlv");
+    }
+    else
+    {
+        // Test cases are generated on the fly, one per iteration, so that nothing is kept in memory or written to disk.
+        fuzz::generation::CommandGenerator generator;
+        generator.Seed(mSeed.Value());
+        generator.SetMalformedPercent(mMalformedPercent.Value());
+        campaignErr = generator.Initialize(deviceStateManager, mDestinationId);
+        for (uint32_t i = 0; campaignErr == CHIP_NO_ERROR && i < mIterations.Value(); i++)
+        {
+            // The commands run one at a time, so the campaign waits for the node whenever it is down.
+            campaignErr = monitor.WaitForRecovery(mDestinationId);
+            if (campaignErr != CHIP_NO_ERROR)
+                break;
+            ExecuteTestCase(generator.Next(), &status);
+            failures += (status != EXIT_SUCCESS) ? 1 : 0;
+            sessions.CountIteration();
+            sessions.Observe(mDestinationId);
+        }
+        sessions.LogStatistics("chip-tool");
+        generator.LogStatistics();
+        fuzzer->LogInvokeStatistics();
+    }
+    if (!injecting)
+    {
+        ChipLogProgress(chipFuzzer, "%" PRIu32 " test cases failed", failures);
+    }
+    // The device state saved below must not change while it is written.
+    subscriber.UnsubscribeAll();
+    subscriber.LogStatistics();
+    monitor.LogStatistics();
+    monitor.Stop();
+
+    deviceStateManager->StopJournal();
+    ChipLogProgress(chipFuzzer, "The oracle found %" PRIu64 " data model violations", fuzzer->mOracle->GetViolationCount());
     fuzzer->GetDeviceStateManager()->Dump(fuzzer->mCommandHistory);
+    // The binary snapshot is the one restored before a replay, the YAML dump is kept for inspection.
+    fs::path snapshot;
+    CHIP_ERROR snapshotErr = fuzzer->GetDeviceStateManager()->Snapshot(fuzzer->mCommandHistory, snapshot);
+    if (snapshotErr != CHIP_NO_ERROR)
+    {
+        ChipLogError(chipFuzzer, "Failed to snapshot the device state: %" CHIP_ERROR_FORMAT, snapshotErr.Format());
+    }
+    else
+    {
+        ChipLogProgress(chipFuzzer, "Device state snapshot written to %s", snapshot.c_str());
+        LogErrorOnFailure(fuzzer->ExportTiming(fs::path(snapshot).replace_extension(kTimingExtension)));
+    }
 
+    ReturnErrorOnFailure(campaignErr);
     SetCommandExitStatus(CHIP_NO_ERROR);
     return CHIP_NO_ERROR;
 };
@@ -396,3 +710,286 @@ const char * FuzzingStartCommand::GenerateCommand(chip::ClusterId cluster)
     VerifyOrReturnError(fuzzer != nullptr, nullptr);
     return fuzzer->GenerateCommand();
 };
+
+CHIP_ERROR FuzzingMinimizeCommand::LoadBundleNode(const fs::path & bundle, chip::NodeId & node)
+{
+    std::ifstream file(bundle / kBundleReasonFile);
+    VerifyOrReturnError(file.is_open(), CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    constexpr char kNodeKey[] = "node: ";
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.rfind(kNodeKey, 0) == 0)
+        {
+            char * end = nullptr;
+            node       = strtoull(line.c_str() + strlen(kNodeKey), &end, 0);
+            VerifyOrReturnError(end != line.c_str() + strlen(kNodeKey) && *end == '\0', CHIP_ERROR_INVALID_ARGUMENT);
+            return CHIP_NO_ERROR;
+        }
+    }
+    // The node is written to every reason file, see LivenessMonitor.
+    return CHIP_ERROR_INVALID_ARGUMENT;
+}
+
+CHIP_ERROR FuzzingMinimizeCommand::LoadHistory(const fs::path & bundle, std::vector<fuzz::generation::GeneratedCommand> & testCases,
+                                               chip::NodeId & node)
+{
+    // The history of a multi-node campaign interleaves the test cases of every node, only the ones of the node which went down
+    // are minimized.
+    ReturnErrorOnFailure(LoadBundleNode(bundle, node));
+    std::ifstream file(bundle / kBundleHistoryFile);
+    VerifyOrReturnError(file.is_open(), CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    size_t skipped = 0;
+    size_t others  = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        chip::NodeId destination;
+        fuzz::generation::GeneratedCommand testCase;
+        // The commands of the chip-tool execution, and the test cases which could not be rendered, cannot be sent again.
+        if (CHIP_NO_ERROR != fuzz::generation::ParseTestCase(line, destination, testCase))
+        {
+            skipped++;
+            continue;
+        }
+        if (destination != node)
+        {
+            others++;
+            continue;
+        }
+        testCases.push_back(testCase);
+    }
+    if (skipped > 0)
+    {
+        ChipLogError(chipFuzzer, "Skipped %u entries of the history which are not test cases of the tlv execution",
+                     static_cast<unsigned>(skipped));
+    }
+    if (others > 0)
+    {
+        ChipLogProgress(chipFuzzer, "Skipped %u test cases sent to other nodes than 0x" ChipLogFormatX64,
+                        static_cast<unsigned>(others), ChipLogValueX64(node));
+    }
+    VerifyOrReturnError(!testCases.empty(), CHIP_ERROR_INVALID_ARGUMENT);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR FuzzingMinimizeCommand::ResetNode(chip::NodeId node)
+{
+    std::string command = std::string(mResetCommandArgument) + " " + std::to_string(node);
+    int status          = std::system(command.c_str());
+    if (status != 0)
+    {
+        ChipLogError(chipFuzzer, "Failed to reset node 0x" ChipLogFormatX64 ": the reset command returned %d",
+                     ChipLogValueX64(node), status);
+        return CHIP_FUZZER_UNEXPECTED_ERROR;
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR FuzzingMinimizeCommand::RunTrial(size_t worker, const std::vector<fuzz::generation::GeneratedCommand> & testCases,
+                                            bool & reproduced)
+{
+    chip::NodeId node = mNodes[worker];
+    ReturnErrorOnFailure(ResetNode(node));
+
+    // Every trial runs on its own thread, the sessions of a pool must only be managed from one.
+    fuzz::execution::SessionPool sessions(CurrentCommissioner());
+    // The stack may still hold the session established before the reset.
+    sessions.Evict(node);
+    CHIP_ERROR err = sessions.Connect(node);
+    if (err != CHIP_NO_ERROR)
+    {
+        // The reset command succeeded, so a device which cannot be reached went down.
+        ChipLogProgress(chipFuzzer, "Node 0x" ChipLogFormatX64 " is not reachable after its reset: %" CHIP_ERROR_FORMAT,
+                        ChipLogValueX64(node), err.Format());
+        reproduced = true;
+        return CHIP_NO_ERROR;
+    }
+
+    TrialListener listener;
+    fuzz::execution::PipelinedSender sender(sessions, node, 1, &listener);
+    for (const auto & testCase : testCases)
+    {
+        err = sender.WaitForCapacity();
+        if (err == CHIP_NO_ERROR)
+        {
+            err = sender.Submit(testCase, mNextInput++);
+        }
+        if (err != CHIP_NO_ERROR || listener.IsDown())
+            break;
+    }
+    if (err == CHIP_NO_ERROR && !listener.IsDown())
+    {
+        // A device which rebooted in the meantime never answers the probe, which the listener reports as down.
+        err = sender.Submit(GetLivenessProbe(), mNextInput++);
+        err = (err == CHIP_NO_ERROR) ? sender.Drain() : err;
+    }
+    // Only the liveness of the device tells whether the failure reproduced: the local errors of a device which is still up mean
+    // that the trial could not be run.
+    reproduced = listener.IsDown();
+
+    // The sender must be idle before the session pool goes away.
+    CHIP_ERROR drainErr = sender.Drain();
+    if (!reproduced && err != CHIP_NO_ERROR)
+    {
+        ChipLogError(chipFuzzer, "Failed to run a trial on node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                     ChipLogValueX64(node), err.Format());
+        return err;
+    }
+    return drainErr;
+}
+
+CHIP_ERROR FuzzingMinimizeCommand::RunCommand()
+{
+    fs::path bundle(mBundleArgument);
+    ReturnErrorOnFailure(ParseNodeList(mDestinationIdsArgument, mNodes));
+    VerifyOrReturnError(!mNodes.empty(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    std::vector<fuzz::generation::GeneratedCommand> testCases;
+    chip::NodeId recorded = chip::kUndefinedNodeId;
+    ReturnErrorOnFailure(LoadHistory(bundle, testCases, recorded));
+
+    // The slots of the sender report the responses to the Fuzzer. The data model of the devices is not acquired: their responses
+    // only tell whether they still answer.
+    fuzz::Fuzzer::Initialize(mNodes.front(), bundle, fuzz::ConvertStringToGenerationFunction("seed-only"),
+                             fs::path("out/debug/standalone/chip-fuzzer/statedumps"));
+
+    fuzz::execution::Minimizer minimizer(mNodes.size(), [this](size_t worker, const auto & sequence, bool & reproduced) {
+        return RunTrial(worker, sequence, reproduced);
+    });
+    CHIP_ERROR err = minimizer.Minimize(testCases);
+    minimizer.LogStatistics();
+    ReturnErrorOnFailure(err);
+
+    // The minimal history reads like the one of the bundle, so that it can be replayed against the recorded node.
+    std::ofstream file(bundle / kMinimizedHistoryFile);
+    std::string line;
+    for (const auto & testCase : testCases)
+    {
+        ReturnErrorOnFailure(fuzz::generation::FormatTestCase(recorded, testCase, line));
+        file << line << '\n';
+    }
+    VerifyOrReturnError(file.flush(), CHIP_FUZZER_FILESYSTEM_ERROR);
+    ChipLogProgress(chipFuzzer, "Minimal history written to %s", (bundle / kMinimizedHistoryFile).c_str());
+
+    SetCommandExitStatus(CHIP_NO_ERROR);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR FuzzingReplayCommand::Replay(const std::vector<std::string> & history, const std::vector<uint64_t> & timing)
+{
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    size_t first          = fuzzer->GetNextInputIndex();
+    // The chip-tool execution only fuzzes one node, the one of the device state.
+    auto * nodes = fuzzer->GetDeviceStateManager()->List();
+    VerifyOrReturnError(!nodes->empty(), CHIP_ERROR_INCORRECT_STATE);
+    chip::NodeId destination = nodes->begin()->first;
+
+    fuzz::execution::SessionPool sessions(CurrentCommissioner());
+    TrialListener listener;
+    std::unordered_map<chip::NodeId, std::unique_ptr<fuzz::execution::PipelinedSender>> senders;
+
+    int status = 0;
+    auto start = std::chrono::steady_clock::now();
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    for (size_t i = first; i < history.size() && err == CHIP_NO_ERROR; i++)
+    {
+        if (!timing.empty())
+        {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(timing[i] - timing[first]));
+        }
+
+        const std::string & line = history[i];
+        chip::NodeId node;
+        fuzz::generation::GeneratedCommand testCase;
+        if (line.rfind("tlv", 0) != 0)
+        {
+            ExecuteAttributedCommand(destination, line.c_str(), &status);
+            continue;
+        }
+        // The test cases which could not be rendered are kept in the history, so that the following indices stay aligned.
+        size_t input = fuzzer->GetNextInputIndex();
+        fuzzer->AppendToHistory(line.c_str());
+        if (CHIP_NO_ERROR != fuzz::generation::ParseTestCase(line, node, testCase))
+            continue;
+
+        auto & sender = senders[node];
+        if (!sender)
+        {
+            ReturnErrorOnFailure(sessions.Connect(node));
+            sender = std::make_unique<fuzz::execution::PipelinedSender>(sessions, node, 1, &listener);
+        }
+        // Every test case is answered before the next one is sent, as during a campaign with a window of 1.
+        err = sender->Submit(testCase, input);
+        err = (err == CHIP_NO_ERROR) ? sender->Drain() : err;
+        if (err == CHIP_NO_ERROR && listener.IsDown())
+        {
+            ChipLogError(chipFuzzer, "Node 0x" ChipLogFormatX64 " stopped answering at test case #%u", ChipLogValueX64(node),
+                         static_cast<unsigned>(input));
+            err = CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE;
+        }
+    }
+    // The senders must be idle before the session pool goes away.
+    for (auto & sender : senders)
+    {
+        LogErrorOnFailure(sender.second->Drain());
+    }
+    return err;
+}
+
+void FuzzingReplayCommand::LogDivergence(const fuzz::JournalDivergence & divergence, const std::vector<std::string> & history)
+{
+    const char * line = divergence.input < history.size() ? history[divergence.input].c_str() : "<unknown>";
+    ChipLogError(chipFuzzer, "The replay diverged at test case #%" PRIu64 ": %s", divergence.input, line);
+    ChipLogError(chipFuzzer,
+                 "%s change of node 0x" ChipLogFormatX64 " endpoint %u cluster " ChipLogFormatMEI " attribute " ChipLogFormatMEI,
+                 divergence.GetKindName(), ChipLogValueX64(divergence.node), divergence.path.mEndpointId,
+                 ChipLogValueMEI(divergence.path.mClusterId), ChipLogValueMEI(divergence.path.mAttributeId));
+    ChipLogError(chipFuzzer, "Expected %s, got %s", fuzz::Visitors::AttributeValueAsString(divergence.expected).c_str(),
+                 fuzz::Visitors::AttributeValueAsString(divergence.actual).c_str());
+}
+
+CHIP_ERROR FuzzingReplayCommand::RunCommand()
+{
+    fs::path snapshot(mSnapshotArgument);
+    fs::path journal(mJournalArgument);
+
+    std::vector<uint64_t> timing;
+    if (mPreserveTiming.Value())
+    {
+        ReturnErrorOnFailure(LoadTiming(fs::path(snapshot).replace_extension(kTimingExtension), timing));
+    }
+
+    fuzz::Fuzzer::Initialize(chip::kUndefinedNodeId, snapshot.parent_path(), fuzz::ConvertStringToGenerationFunction("seed-only"),
+                             fs::path("out/debug/standalone/chip-fuzzer/statedumps"));
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    auto * deviceStateManager = fuzzer->GetDeviceStateManager();
+
+    // The final snapshot holds the whole history, the base snapshot of the journal the part sent before it was started.
+    std::vector<std::string> history;
+    ReturnErrorOnFailure(deviceStateManager->Restore(snapshot, &history));
+    ReturnErrorOnFailure(deviceStateManager->Restore(fs::path(journal).replace_extension(".snapshot"), &fuzzer->mCommandHistory));
+    VerifyOrReturnError(fuzzer->mCommandHistory.size() <= history.size(), CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(timing.empty() || timing.size() == history.size(), CHIP_ERROR_INVALID_ARGUMENT);
+    ReturnErrorOnFailure(deviceStateManager->IndexPaths());
+    ReturnErrorOnFailure(deviceStateManager->StartJournal(fuzzer->mCommandHistory));
+
+    ChipLogProgress(chipFuzzer, "Replaying %u test cases", static_cast<unsigned>(history.size() - fuzzer->mCommandHistory.size()));
+    CHIP_ERROR err = Replay(history, timing);
+    deviceStateManager->StopJournal();
+    ReturnErrorOnFailure(err);
+
+    chip::Optional<fuzz::JournalDivergence> divergence;
+    ReturnErrorOnFailure(fuzz::CompareJournals(journal, deviceStateManager->GetJournalPath(), divergence));
+    if (divergence.HasValue())
+    {
+        LogDivergence(divergence.Value(), history);
+        return CHIP_FUZZER_ERROR_REPLAY_DIVERGED;
+    }
+    ChipLogProgress(chipFuzzer, "The replay changed the device state as the campaign did");
+
+    SetCommandExitStatus(CHIP_NO_ERROR);
+    return CHIP_NO_ERROR;
+}
@@ -4,6 +4,12 @@
 #include "../common/Commands.h"
 #include "ForwardDeclarations.h"
 #include "Fuzzing.h"
+#include "execution/CampaignScheduler.h"
+#include "execution/LivenessMonitor.h"
+#include "execution/Minimizer.h"
+#include "execution/SessionPool.h"
+#include "execution/StateSubscriber.h"
+#include "generation/CommandGenerator.h"
 
 namespace fuzz = chip::fuzzing;
 namespace fs   = std::filesystem;
@@ -20,6 +26,11 @@ public:
     void ExecuteCommand(const char * command, int * status);
     virtual CHIP_ERROR RunCommand() override = 0;
 
+protected:
+    // Runs a chip-tool command sent to the node and appends it to the history. The device state changes caused by its responses
+    // are journaled as the ones of this command.
+    void ExecuteAttributedCommand(chip::NodeId node, const char * command, int * status);
+
 private:
     Commands * mHandler = nullptr;
 };
@@ -44,6 +55,33 @@ public:
         AddArgument("output-path", &mOutputDirectoryArgument,
                     "Path where to export stateful fuzzer logs. Enables stateful fuzzing");
         AddArgument("iterations", 0U, UINT32_MAX, &mIterations, "Number of iterations (commands) to run the fuzzer for");
+        AddArgument("generator", &mGeneratorArgument,
+                    "Test case generator backend (native, grammarinator). Defaults to the in-process native generator");
+        AddArgument("execution", &mExecutionArgument,
+                    "Test case execution mode (chip-tool, tlv). tlv injects the native generator output as TLV-encoded IM "
+                    "requests on a CASE session kept for the whole campaign, bypassing the chip-tool command lifecycle. Defaults "
+                    "to chip-tool");
+        AddArgument("window", 1, UINT16_MAX, &mWindow,
+                    "Maximum number of exchanges kept in flight in tlv execution mode. The actual window adapts to the busy "
+                    "statuses and timeouts of the device. Defaults to 1");
+        AddArgument("requests", &mRequestsArgument,
+                    "Comma-separated kinds of requests generated in tlv execution mode (invoke, read, write). Defaults to invoke");
+        AddArgument("destination-ids", &mDestinationIdsArgument,
+                    "Comma-separated identifiers of additional nodes fuzzed in the same campaign as destination-id. The test "
+                    "case budget is shared between the nodes according to the new behaviours they exhibit (tlv execution only)");
+        AddArgument("reproducer-depth", 1U, UINT32_MAX, &mReproducerDepth,
+                    "Number of the last test cases saved in the reproducer captured when a node stops answering, reboots or "
+                    "loses its session. Defaults to 64");
+        AddArgument("cache-path", &mCachePathArgument,
+                    "Path where the data models of the devices are cached, by vendor, product and software version, along with "
+                    "the grammars of the commands they accept. Delete the cached data model of a firmware to scan it again. "
+                    "Defaults to out/debug/standalone/chip-fuzzer/cache");
+        AddArgument("malformed-percent", 0, 100, &mMalformedPercent,
+                    "Percentage of the command fields the native generator deliberately malforms, for the commands whose schema "
+                    "is known: the other fields are well-typed and within their constraints. Defaults to 10");
+        AddArgument("seed", 0, UINT64_MAX, &mSeed,
+                    "Seed of the native generator and of the scheduling of the test cases, logged at start-up so that a campaign "
+                    "can be run again with the same test cases. Defaults to a random seed");
     }
 
     /////////// CHIPCommand Interface /////////
@@ -55,6 +93,15 @@ private:
     char * mSeedDirectoryArgument;
     chip::Optional<char *> mOutputDirectoryArgument = chip::NullOptional;
     chip::Optional<uint32_t> mIterations            = chip::Optional<uint32_t>::Value(1000U);
+    chip::Optional<char *> mGeneratorArgument       = chip::NullOptional;
+    chip::Optional<char *> mExecutionArgument       = chip::NullOptional;
+    chip::Optional<uint16_t> mWindow                = chip::Optional<uint16_t>::Value(1U);
+    chip::Optional<char *> mRequestsArgument        = chip::NullOptional;
+    chip::Optional<char *> mDestinationIdsArgument  = chip::NullOptional;
+    chip::Optional<uint32_t> mReproducerDepth       = chip::Optional<uint32_t>::Value(64U);
+    chip::Optional<char *> mCachePathArgument       = chip::NullOptional;
+    chip::Optional<uint8_t> mMalformedPercent       = chip::Optional<uint8_t>::Value(10U);
+    chip::Optional<uint64_t> mSeed                  = chip::NullOptional;
 
     bool mStatefulFuzzingEnabled = false;
     fs::path mSeedDirectory;
@@ -62,7 +109,99 @@ private:
 
     CHIP_ERROR InitializeFuzzer();
 
+    CHIP_ERROR ParseDestinationIds(std::vector<chip::NodeId> & nodes);
     CHIP_ERROR AcquireRemoteDataModel(chip::NodeId node);
     CHIP_ERROR AcquireBasicInformation(chip::NodeId, int * status);
+    fs::path GetDataModelCachePath(const fuzz::BasicInformation & info);
+    CHIP_ERROR GenerateTestCasesWithGrammarinator(std::vector<std::string> & testCases);
+    void ExecuteTestCase(const std::string & testCase, int * status);
+    CHIP_ERROR InjectTestCases(const std::vector<chip::NodeId> & nodes, fuzz::execution::SessionPool & sessions,
+                               fuzz::execution::LivenessMonitor & monitor);
+    // Seeds of the tlv execution, one test case per file in the command history format, under <seed-path>/tlv.
+    CHIP_ERROR LoadSeeds(fuzz::execution::CampaignScheduler & scheduler);
+    CHIP_ERROR ExportCorpus(const fuzz::execution::CampaignScheduler & scheduler);
     const char * GenerateCommand(chip::ClusterId cluster);
 };
+
+/**
+ * @brief Reduces the history of a reproducer bundle to a minimal sequence of test cases which still brings a device down, see
+ * fuzz::execution::Minimizer.
+ *
+ * Every trial factory resets a device with the reset command, sends a candidate sequence on a new CASE session, one test case at
+ * a time, then reads an attribute on the same session: the device went down if any of these exchanges gets no answer, or if no
+ * session can be established once the reset command succeeded. Only the failures of the reset command are errors. The trials are
+ * spread over several identical devices.
+ */
+class FuzzingMinimizeCommand : public FuzzingCommand
+{
+public:
+    FuzzingMinimizeCommand(Commands * commandsHandler, CredentialIssuerCommands * credsIssuerConfig) :
+        FuzzingCommand("minimize", commandsHandler, "Minimize the history of a reproducer captured during a fuzzing campaign.",
+                       credsIssuerConfig)
+    {
+        AddArgument("bundle-path", &mBundleArgument,
+                    "Path of the reproducer bundle. The minimal history is written next to its history, as history.min");
+        AddArgument("destination-ids", &mDestinationIdsArgument,
+                    "Comma-separated identifiers of the identical devices the trials are run on, one trial per device at once");
+        AddArgument("reset-command", &mResetCommandArgument,
+                    "Shell command run before every trial with the identifier of the device appended, which must factory reset "
+                    "the device and commission it again");
+    }
+
+    /////////// CHIPCommand Interface /////////
+    CHIP_ERROR RunCommand() override;
+
+private:
+    char * mBundleArgument;
+    char * mDestinationIdsArgument;
+    char * mResetCommandArgument;
+
+    std::vector<chip::NodeId> mNodes;
+    // Trials use their own input indices, so that the responses of the devices are never attributed to the same test case.
+    std::atomic<size_t> mNextInput{ 0 };
+
+    // Reads the node which went down from the reason file of the bundle.
+    CHIP_ERROR LoadBundleNode(const fs::path & bundle, chip::NodeId & node);
+    // Loads the test cases of the tlv execution sent to the node of the bundle, recorded in its history.
+    CHIP_ERROR LoadHistory(const fs::path & bundle, std::vector<fuzz::generation::GeneratedCommand> & testCases,
+                           chip::NodeId & node);
+    CHIP_ERROR ResetNode(chip::NodeId node);
+    CHIP_ERROR RunTrial(size_t worker, const std::vector<fuzz::generation::GeneratedCommand> & testCases, bool & reproduced);
+};
+
+/**
+ * @brief Replays the history of a campaign from the device state its journal was started from, and checks that the responses of
+ * the device change its state as they did during the campaign.
+ *
+ * The device state is restored from the base snapshot of the journal and the test cases following it are sent again, one at a
+ * time, to the same nodes. The journal of the replay is then compared with the recorded one, see fuzz::CompareJournals, and the
+ * first test case whose responses diverge is reported. The device must have been brought back to the state of the base snapshot
+ * beforehand.
+ */
+class FuzzingReplayCommand : public FuzzingCommand
+{
+public:
+    FuzzingReplayCommand(Commands * commandsHandler, CredentialIssuerCommands * credsIssuerConfig) :
+        FuzzingCommand("replay", commandsHandler, "Replay the history of a fuzzing campaign and compare the device state changes.",
+                       credsIssuerConfig)
+    {
+        AddArgument("snapshot-path", &mSnapshotArgument, "Path of the device state snapshot taken at the end of the campaign");
+        AddArgument("journal-path", &mJournalArgument,
+                    "Path of the journal recorded during the campaign, whose base snapshot is the one with the same name");
+        AddArgument("preserve-timing", 0, 1, &mPreserveTiming,
+                    "Send the test cases at the pace they were sent during the campaign instead of as fast as the device answers. "
+                    "Defaults to false");
+    }
+
+    /////////// CHIPCommand Interface /////////
+    CHIP_ERROR RunCommand() override;
+
+private:
+    char * mSnapshotArgument;
+    char * mJournalArgument;
+    chip::Optional<bool> mPreserveTiming = chip::Optional<bool>::Value(false);
+
+    // Sends the entries of the history which follow the base snapshot, stopping at the first node which goes down.
+    CHIP_ERROR Replay(const std::vector<std::string> & history, const std::vector<uint64_t> & timing);
+    void LogDivergence(const fuzz::JournalDivergence & divergence, const std::vector<std::string> & history);
+};
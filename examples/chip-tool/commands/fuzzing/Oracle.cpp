@@ -1,5 +1,150 @@
 #include "Oracle.h"
+#include <inttypes.h>
 namespace fuzz = chip::fuzzing;
+using chip::Protocols::InteractionModel::Status;
+
+const fuzz::OracleRule fuzz::OracleRuleMap::kInvalidClusterOracleRule{
+    chip::app::ConcreteDataAttributePath(kInvalidEndpointId, kInvalidClusterId, kInvalidAttributeId), Status::UnsupportedCluster
+};
+const fuzz::OracleRule fuzz::OracleRuleMap::kInvalidAttributeOracleRule{
+    chip::app::ConcreteDataAttributePath(kInvalidEndpointId, kInvalidClusterId, kInvalidAttributeId), Status::UnsupportedAttribute
+};
+
+namespace {
+bool IsStandardAttribute(chip::AttributeId attribute)
+{
+    // Manufacturer-specific attributes carry the manufacturer code in their upper 16 bits.
+    return (attribute & 0xFFFF0000) == 0;
+}
+
+bool IsExpectedType(fuzz::SpecType type, chip::TLV::TLVType tlvType)
+{
+    switch (type)
+    {
+    case fuzz::SpecType::kBoolean:
+        return tlvType == chip::TLV::kTLVType_Boolean;
+    case fuzz::SpecType::kUnsigned:
+    case fuzz::SpecType::kEnum:
+    case fuzz::SpecType::kBitmap:
+        return tlvType == chip::TLV::kTLVType_UnsignedInteger;
+    case fuzz::SpecType::kSigned:
+        return tlvType == chip::TLV::kTLVType_SignedInteger;
+    case fuzz::SpecType::kFloat:
+    case fuzz::SpecType::kDouble:
+        return tlvType == chip::TLV::kTLVType_FloatingPointNumber;
+    case fuzz::SpecType::kString:
+        return tlvType == chip::TLV::kTLVType_UTF8String;
+    case fuzz::SpecType::kOctets:
+        return tlvType == chip::TLV::kTLVType_ByteString;
+    case fuzz::SpecType::kList:
+        return tlvType == chip::TLV::kTLVType_Array;
+    case fuzz::SpecType::kStruct:
+        return tlvType == chip::TLV::kTLVType_Structure;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Reads the integer held by a decoded element.
+ * @return false if the element holds no integer.
+ */
+bool GetInteger(const fuzz::TLV::DecodedTLVElement & element, bool & isSigned, int64_t & signedValue, uint64_t & unsignedValue)
+{
+    return std::visit(
+        [&](auto && value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+            {
+                isSigned = std::is_signed_v<T>;
+                if constexpr (std::is_signed_v<T>)
+                {
+                    signedValue = value;
+                }
+                else
+                {
+                    unsignedValue = value;
+                }
+                return true;
+            }
+            return false;
+        },
+        element.value);
+}
+
+bool IsBelow(const fuzz::AttributeRule & rule, bool isSigned, int64_t signedValue, uint64_t unsignedValue)
+{
+    VerifyOrReturnValue(rule.Has(fuzz::kRuleHasMinimum), false);
+    if (isSigned)
+    {
+        return signedValue < rule.minimum;
+    }
+    return rule.minimum > 0 && unsignedValue < static_cast<uint64_t>(rule.minimum);
+}
+
+bool IsAbove(const fuzz::AttributeRule & rule, bool isSigned, int64_t signedValue, uint64_t unsignedValue)
+{
+    VerifyOrReturnValue(rule.Has(fuzz::kRuleHasMaximum), false);
+    if (isSigned)
+    {
+        return signedValue > rule.maximum;
+    }
+    return rule.maximum < 0 || unsignedValue > static_cast<uint64_t>(rule.maximum);
+}
+
+/**
+ * @brief Checks a reported value against the rule of its attribute.
+ * @return A description of the violation, nullptr if the value follows the rule.
+ */
+const char * CheckValue(const fuzz::AttributeRule & rule, const fuzz::TLV::DecodedTLVView & value)
+{
+    const fuzz::TLV::DecodedTLVElement & element = *value;
+    if (element.type == chip::TLV::kTLVType_Null)
+    {
+        return rule.Has(fuzz::kRuleNullable) ? nullptr : "null value on a non-nullable attribute";
+    }
+    VerifyOrReturnValue(IsExpectedType(rule.type, element.type), "value of the wrong type");
+
+    switch (rule.type)
+    {
+    case fuzz::SpecType::kUnsigned:
+    case fuzz::SpecType::kSigned:
+    case fuzz::SpecType::kEnum:
+    case fuzz::SpecType::kBitmap: {
+        bool isSigned          = false;
+        int64_t signedValue    = 0;
+        uint64_t unsignedValue = 0;
+        VerifyOrReturnValue(GetInteger(element, isSigned, signedValue, unsignedValue), nullptr);
+        // Integers are encoded on the fewest bytes holding them, which never exceeds the size of their type.
+        VerifyOrReturnValue(rule.size == 0 || element.length <= rule.size, "value wider than its type");
+        if (rule.type == fuzz::SpecType::kBitmap && rule.Has(fuzz::kRuleMask))
+        {
+            VerifyOrReturnValue((unsignedValue & ~static_cast<uint64_t>(rule.maximum)) == 0, "undefined bits set in a bitmap");
+            return nullptr;
+        }
+        if (rule.type == fuzz::SpecType::kEnum)
+        {
+            VerifyOrReturnValue(fuzz::rules::IsAllowedValue(rule, static_cast<int64_t>(unsignedValue)),
+                                "undefined value of an enum");
+        }
+        VerifyOrReturnValue(!IsBelow(rule, isSigned, signedValue, unsignedValue), "value below its minimum");
+        VerifyOrReturnValue(!IsAbove(rule, isSigned, signedValue, unsignedValue), "value above its maximum");
+        return nullptr;
+    }
+    case fuzz::SpecType::kString:
+    case fuzz::SpecType::kOctets:
+        VerifyOrReturnValue(!IsBelow(rule, false, 0, element.size), "string shorter than its minimum length");
+        VerifyOrReturnValue(!IsAbove(rule, false, 0, element.size), "string longer than its maximum length");
+        return nullptr;
+    case fuzz::SpecType::kList:
+        VerifyOrReturnValue(!IsBelow(rule, false, 0, value.GetChildCount()), "list with fewer entries than its minimum");
+        VerifyOrReturnValue(!IsAbove(rule, false, 0, value.GetChildCount()), "list with more entries than its maximum");
+        return nullptr;
+    default:
+        return nullptr;
+    }
+}
+} // namespace
 
 fuzz::OracleStatus & fuzz::Oracle::Consume(const chip::app::StatusIB & actual, chip::app::StatusIB & expected)
 {
@@ -8,7 +153,6 @@ fuzz::OracleStatus & fuzz::Oracle::Consume(const chip::app::StatusIB & actual, c
 
 fuzz::OracleStatus & fuzz::Oracle::Consume(const CHIP_ERROR & actual, const CHIP_ERROR & expected)
 {
-    // TODO
     mLastStatus = mCurrentStatus;
 
     if (actual == expected)
@@ -29,17 +173,100 @@ fuzz::OracleStatus & fuzz::Oracle::Consume(const CHIP_ERROR & actual, const CHIP
     return mCurrentStatus;
 } // namespace chip::fuzzing
 
-fuzz::OracleResult fuzz::OracleRuleMap::Query(const chip::app::ConcreteDataAttributePath & path,
-                                              const chip::Protocols::InteractionModel::Status & receivedStatus)
+fuzz::OracleStatus & fuzz::Oracle::Consume(const PathIndex & index, NodeId node, const chip::app::ConcreteDataAttributePath & path,
+                                           const chip::app::StatusIB & status, const TLV::DecodedTLVView & value)
 {
-    return OracleResult(0, OracleRuleMap::kInvalidClusterOracleRule);
+    // A chunk of a list carries one of its entries, which the rule of the list does not describe.
+    VerifyOrReturnValue(!path.IsListItemOperation(), Transition(OracleStatus::OK));
+
+    OracleResult result    = mRuleMap.Query(index, node, path, status.mStatus);
+    const char * violation = nullptr;
+
+    if (result.invalidIdIndex == OracleResult::kInvalidAttribute && IsStandardAttribute(path.mAttributeId) && value.IsValid())
+    {
+        violation = "value reported on an attribute the specification does not define";
+    }
+    else if (const AttributeRule * rule = result.attributeRule)
+    {
+        if (status.mStatus == Status::Success && value.IsValid())
+        {
+            if (rule->conformance == Conformance::kDisallowed)
+            {
+                violation = "value reported on a disallowed attribute";
+            }
+            else if (!rule->Has(kRuleReadable))
+            {
+                violation = "value reported on a write-only attribute";
+            }
+            else
+            {
+                violation = CheckValue(*rule, value);
+            }
+        }
+        else if (status.mStatus == Status::Success && !rule->Has(kRuleWritable))
+        {
+            // Write responses carry no value.
+            violation = "write accepted on a read-only attribute";
+        }
+        else if (status.mStatus == Status::UnsupportedAttribute && rule->conformance == Conformance::kMandatory)
+        {
+            violation = "mandatory attribute unsupported";
+        }
+    }
+
+    if (violation == nullptr && result.usedRule != nullptr && !result.queryResult)
+    {
+        return Transition(mCurrentStatus == OracleStatus::OK ? OracleStatus::UNEXPECTED_RESPONSE
+                                                              : OracleStatus::UNEXPECTED_BEHAVIOR);
+    }
+    if (violation == nullptr)
+    {
+        return Transition(OracleStatus::OK);
+    }
+
+    mViolations++;
+    ChipLogError(chipFuzzer,
+                 "Data model violation on endpoint %u, cluster " ChipLogFormatMEI ", attribute " ChipLogFormatMEI ": %s",
+                 path.mEndpointId, ChipLogValueMEI(path.mClusterId), ChipLogValueMEI(path.mAttributeId), violation);
+    return Transition(OracleStatus::DATA_MODEL_VIOLATION);
+}
+
+fuzz::OracleStatus & fuzz::Oracle::Transition(OracleStatus status)
+{
+    mLastStatus    = mCurrentStatus;
+    mCurrentStatus = status;
+    return mCurrentStatus;
+}
+
+fuzz::OracleResult fuzz::OracleRuleMap::Query(const PathIndex & index, NodeId node,
+                                              const chip::app::ConcreteDataAttributePath & path,
+                                              const chip::Protocols::InteractionModel::Status & receivedStatus) const
+{
+    OracleResult result;
+    if (!mMap.empty())
+    {
+        auto found = mMap.find(PackPath(path.mClusterId, path.mAttributeId));
+        if (found != mMap.end())
+        {
+            result.usedRule    = &found->second;
+            result.queryResult = found->second.Query(receivedStatus);
+        }
+    }
+
+    const PathIndex::Entry * entry = index.Find(node, path.mEndpointId, path.mClusterId, path.mAttributeId);
+    result.attributeRule           = entry != nullptr ? entry->rule : rules::Find(path.mClusterId, path.mAttributeId);
+    if (result.attributeRule == nullptr)
+    {
+        result.invalidIdIndex =
+            rules::IsKnownCluster(path.mClusterId) ? OracleResult::kInvalidAttribute : OracleResult::kInvalidCluster;
+    }
+    return result;
 }
 
 void fuzz::OracleRuleMap::Add(chip::app::ConcreteDataAttributePath path,
                               const chip::Protocols::InteractionModel::Status & expectedStatus)
 {
-    auto key = std::make_tuple(path.mClusterId, path.mAttributeId);
-    mMap.emplace(key, OracleRule(path, expectedStatus));
-    mNoRulesForCluster[std::get<0>(key)]++;
-    mNoRulesForAttribute[std::get<1>(key)]++;
+    mMap.emplace(PackPath(path.mClusterId, path.mAttributeId), OracleRule(path, expectedStatus));
+    mNoRulesForCluster[path.mClusterId]++;
+    mNoRulesForAttribute[path.mAttributeId]++;
 }
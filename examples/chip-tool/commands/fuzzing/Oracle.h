@@ -1,6 +1,9 @@
 #pragma once
 #include "ForwardDeclarations.h"
+#include "OracleRules.h"
+#include "PathIndex.h"
 #include "Utils.h"
+#include "tlv/DecodedTLVElement.h"
 
 namespace chip {
 namespace fuzzing {
@@ -25,28 +28,26 @@ enum OracleStatus
     UNINITIALIZED, // Initial last status: the oracle hasn't received any data yet
 };
 
-// TODO: Find some standard way to represent specification rules (conformance?)
 /**
  * @class OracleRule
  * @brief The OracleRule struct represents a rule that the device's behavior must follow.
- * It should encode a representation of the conformance rules that the device must follow when in a certain state.
+ * It encodes the status expected on a path in a certain state of the device, on top of the rules of the specification on the
+ * same attribute (see AttributeRule).
  */
 class OracleRule
 {
 public:
-    OracleRule(chip::app::ConcreteDataAttributePath dmPath, const chip::Protocols::InteractionModel::Status & expectedStatus) :
+    OracleRule(chip::app::ConcreteDataAttributePath dmPath, chip::Protocols::InteractionModel::Status expectedStatus) :
         mAttributePath(dmPath), mExpectedStatus(expectedStatus) {};
 
-    OracleRule & operator=(const OracleRule &) = default;
-
-    bool Query(const chip::Protocols::InteractionModel::Status & receivedStatus, const std::optional<AttributeState> & value) const
+    bool Query(const chip::Protocols::InteractionModel::Status & receivedStatus) const
     {
         return receivedStatus == mExpectedStatus;
     }
 
 private:
     const chip::app::ConcreteDataAttributePath mAttributePath;
-    const chip::Protocols::InteractionModel::Status & mExpectedStatus;
+    const chip::Protocols::InteractionModel::Status mExpectedStatus;
 };
 
 /**
@@ -58,66 +59,55 @@ private:
  * - `invalidIdIndex`: is the index of the first invalid element of the map key tuple (`std::tuple<chip::NodeId, chip::EndpointId,
  * chip::ClusterId, chip::AttributeId>`) if no valid rule to query was found for that path or -1 if the path is valid.
  *
- * - `usedRule` is a pointer to the queried rule.
+ * - `usedRule` is a pointer to the queried rule, nullptr if only the specification defines the path.
  *
- * - `queryResult`: indicates if the rule was fulfilled or not (i.e. the query result).
+ * - `attributeRule` is the rule of the specification on the attribute, nullptr if the specification does not define it.
  *
- * - `status`: Represents the OracleStatus the oracle transitioned to.
+ * - `queryResult`: indicates if the rule was fulfilled or not (i.e. the query result).
  */
 struct OracleResult
 {
-    OracleResult(int id, const OracleRule & rule) : invalidIdIndex(id), usedRule(rule) {}
-    OracleResult & operator=(OracleResult &) = default;
-    int invalidIdIndex;
-    const OracleRule & usedRule;
-    bool queryResult;
+    static constexpr int kValidPath        = -1;
+    static constexpr int kInvalidCluster   = 2;
+    static constexpr int kInvalidAttribute = 3;
+
+    int invalidIdIndex                  = kValidPath;
+    const OracleRule * usedRule         = nullptr;
+    const AttributeRule * attributeRule = nullptr;
+    bool queryResult                    = true;
 };
 
 class OracleRuleMap
 {
-    using key_t = std::tuple<chip::ClusterId, chip::AttributeId>;
-
 public:
-    OracleResult Query(const chip::app::ConcreteDataAttributePath & path,
-                       const chip::Protocols::InteractionModel::Status & receivedStatus);
+    /**
+     * Looks up the rules on a path: the ones added at runtime, then the ones of the specification. The rule of the
+     * specification comes with the entry of the path in the index of the device state, only the paths which are not indexed
+     * yet are looked up in the rule table (see rules::Find).
+     */
+    OracleResult Query(const PathIndex & index, NodeId node, const chip::app::ConcreteDataAttributePath & path,
+                       const chip::Protocols::InteractionModel::Status & receivedStatus) const;
     void Add(chip::app::ConcreteDataAttributePath path, const chip::Protocols::InteractionModel::Status & expectedStatus);
 
     static const OracleRule kInvalidClusterOracleRule;
     static const OracleRule kInvalidAttributeOracleRule;
 
 private:
-    struct PathHash
-    {
-        PathHash() : clusterHasher(), attributeHasher() {}
-        std::hash<uint32_t> clusterHasher;
-        std::hash<uint32_t> attributeHasher;
-        std::size_t operator()(const key_t & k) const { return clusterHasher(std::get<0>(k)) ^ attributeHasher(std::get<1>(k)); }
-    };
-
-    struct PathEqual
-    {
-        bool operator()(const key_t & v0, const key_t & v1) const
-        {
-            return (std::get<0>(v0) == std::get<0>(v1) && std::get<1>(v0) == std::get<1>(v1));
-        }
-    };
-
-    std::unordered_map<key_t, OracleRule, PathHash, PathEqual> mMap;
+    // Keyed by PackPath(cluster, attribute).
+    std::unordered_map<uint64_t, OracleRule, PackedPathHash> mMap;
     std::unordered_map<chip::ClusterId, uint64_t> mNoRulesForCluster;
     std::unordered_map<chip::AttributeId, uint64_t> mNoRulesForAttribute;
 };
 
-const OracleRule kInvalidClusterOracleRule{ chip::app::ConcreteDataAttributePath(kInvalidEndpointId, kInvalidClusterId,
-                                                                                 kInvalidAttributeId),
-                                            chip::Protocols::InteractionModel::Status::UnsupportedCluster };
-const OracleRule kInvalidAttributeOracleRule{ chip::app::ConcreteDataAttributePath(kInvalidEndpointId, kInvalidClusterId,
-                                                                                   kInvalidAttributeId),
-                                              chip::Protocols::InteractionModel::Status::UnsupportedAttribute };
 /**
  * @class Oracle
  * @brief The bug oracle checks if the received response status/error was expected or not.
  * If not, it dumps the device's current state and the received data to a file, also logging the error.
  * In other words, it checks if the device is behaving as expected.
+ *
+ * Attribute responses are checked against the rules of the specification: the type, nullability, bounds and enum values of
+ * the reported values, the access of the attribute and its conformance. Any mismatch is a DATA_MODEL_VIOLATION. Only attribute
+ * reports and write responses are checked, the rules do not cover commands and events.
  */
 
 class Oracle
@@ -126,14 +116,31 @@ public:
     Oracle() : mCurrentStatus(OracleStatus::INITIALIZED), mLastStatus(OracleStatus::UNINITIALIZED) {};
     ~Oracle() {};
 
-    // TODO: Edit signature to take AttributeDataIB/AttributeStatusIB as parameter too
+    /**
+     * Compares a received status with the expected one, without looking up any rule: the statuses of command and event responses
+     * are not checked against the specification.
+     */
     OracleStatus & Consume(const CHIP_ERROR & actual, const CHIP_ERROR & expected);
     OracleStatus & Consume(const chip::app::StatusIB & actual, chip::app::StatusIB & expected);
 
+    /**
+     * Checks the response on an attribute path.
+     * @param index The index of the device state, see DeviceStateManager::GetPathIndex.
+     * @param value The reported value, i.e. the first child of the root of the decoded payload. An invalid view for the responses
+     * carrying only a status, such as the ones of write requests.
+     */
+    OracleStatus & Consume(const PathIndex & index, NodeId node, const chip::app::ConcreteDataAttributePath & path,
+                           const chip::app::StatusIB & status, const TLV::DecodedTLVView & value);
+
+    uint64_t GetViolationCount() const { return mViolations; }
+
 private:
     OracleStatus mCurrentStatus;
     OracleStatus mLastStatus;
     OracleRuleMap mRuleMap;
+    uint64_t mViolations = 0;
+
+    OracleStatus & Transition(OracleStatus status);
 };
 } // namespace fuzzing
 }; // namespace chip
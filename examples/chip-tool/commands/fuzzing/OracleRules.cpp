@@ -0,0 +1,59 @@
+#include "OracleRules.h"
+#include <algorithm>
+#include <app-common/zap-generated/ids/Attributes.h>
+#include <fuzzing/OracleRuleTable.h>
+#include <lib/support/CodeUtils.h>
+
+namespace fuzz = chip::fuzzing;
+
+namespace {
+constexpr size_t kSlotCount = sizeof(fuzz::kAttributeRuleSlots) / sizeof(fuzz::kAttributeRuleSlots[0]);
+
+// Must match hash_path in gen_oracle_rules.py.
+constexpr uint32_t HashPath(chip::ClusterId cluster, chip::AttributeId attribute)
+{
+    uint32_t hash = (cluster * 0x9E3779B1u) ^ (attribute * 0x85EBCA77u);
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return hash;
+}
+} // namespace
+
+const fuzz::AttributeRule * fuzz::rules::Find(ClusterId cluster, AttributeId attribute)
+{
+    // The table is at most half full, so the probing always ends on an empty slot.
+    for (size_t slot = HashPath(cluster, attribute) & (kSlotCount - 1);; slot = (slot + 1) & (kSlotCount - 1))
+    {
+        uint16_t entry = kAttributeRuleSlots[slot];
+        if (entry == 0)
+        {
+            return nullptr;
+        }
+        const AttributeRule & rule = kAttributeRules[entry - 1];
+        if (rule.cluster == cluster && rule.attribute == attribute)
+        {
+            return &rule;
+        }
+    }
+}
+
+bool fuzz::rules::IsKnownCluster(ClusterId cluster)
+{
+    return Find(cluster, app::Clusters::Globals::Attributes::ClusterRevision::Id) != nullptr;
+}
+
+bool fuzz::rules::IsAllowedValue(const AttributeRule & rule, int64_t value)
+{
+    VerifyOrReturnValue(rule.valueCount > 0, true);
+    const int64_t * first = &kEnumValues[rule.firstValue];
+    const int64_t * last  = first + rule.valueCount;
+    // The generator sorts the values of every enum.
+    const int64_t * found = std::lower_bound(first, last, value);
+    return found != last && *found == value;
+}
+
+size_t fuzz::rules::GetRuleCount()
+{
+    return sizeof(kAttributeRules) / sizeof(kAttributeRules[0]);
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <lib/core/DataModelTypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chip {
+namespace fuzzing {
+
+/**
+ * @brief Rules of the Matter specification on the attributes of the standard clusters, compiled by gen_oracle_rules.py from
+ * the cluster definitions of the data_model directory into a constexpr table (see OracleRuleTable.h in the generated headers).
+ *
+ * Only the constraints which hold for every device are compiled: bounds given as literals, the values of the enums and the
+ * fields of the bitmaps. Conformances depending on features or on other elements are kept as Conformance::kConditional.
+ */
+
+enum class SpecType : uint8_t
+{
+    kUnknown,
+    kBoolean,
+    kUnsigned,
+    kSigned,
+    kEnum,
+    kBitmap,
+    kFloat,
+    kDouble,
+    kString,
+    kOctets,
+    kList,
+    kStruct,
+};
+
+enum class Conformance : uint8_t
+{
+    kMandatory,
+    // Mandatory under some condition of the device, e.g. a feature.
+    kConditional,
+    kOptional,
+    kProvisional,
+    kDeprecated,
+    kDisallowed,
+};
+
+enum class Privilege : uint8_t
+{
+    kNone,
+    kView,
+    kOperate,
+    kManage,
+    kAdminister,
+};
+
+enum AttributeRuleFlags : uint8_t
+{
+    kRuleReadable     = 0x01,
+    kRuleWritable     = 0x02,
+    kRuleNullable     = 0x04,
+    kRuleFabricScoped = 0x08,
+    kRuleHasMinimum   = 0x10,
+    kRuleHasMaximum   = 0x20,
+    // Bitmaps: maximum holds the mask of the defined bits.
+    kRuleMask = 0x40,
+};
+
+/**
+ * @brief Rule of one attribute of one cluster.
+ *
+ * minimum and maximum bound the value of numeric types, the length of strings and the number of entries of lists. The allowed
+ * values of an enum are kEnumValues[firstValue, firstValue + valueCount).
+ */
+struct AttributeRule
+{
+    ClusterId cluster;
+    AttributeId attribute;
+    SpecType type;
+    // Size in bytes of numeric types, 0 otherwise.
+    uint8_t size;
+    Conformance conformance;
+    Privilege readPrivilege;
+    Privilege writePrivilege;
+    uint8_t flags;
+    uint16_t firstValue;
+    uint16_t valueCount;
+    int64_t minimum;
+    int64_t maximum;
+
+    bool Has(AttributeRuleFlags flag) const { return (flags & flag) != 0; }
+};
+
+namespace rules {
+
+/**
+ * @brief Looks up the rule of an attribute in constant time.
+ * @return nullptr if the specification defines no such attribute.
+ */
+const AttributeRule * Find(ClusterId cluster, AttributeId attribute);
+
+/**
+ * @return true if the cluster is defined by the specification, i.e. the table holds its ClusterRevision.
+ */
+bool IsKnownCluster(ClusterId cluster);
+
+/**
+ * @return true if value is one of the values of the enum of the rule, or if the rule lists none.
+ */
+bool IsAllowedValue(const AttributeRule & rule, int64_t value);
+
+size_t GetRuleCount();
+
+} // namespace rules
+} // namespace fuzzing
+} // namespace chip
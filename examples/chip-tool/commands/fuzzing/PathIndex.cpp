@@ -0,0 +1,113 @@
+#include "PathIndex.h"
+#include "DeviceStateManager.h"
+#include <algorithm>
+
+namespace fuzz = chip::fuzzing;
+
+namespace {
+// Average number of paths per bucket: larger buckets take less memory, but more attempts to find their seed.
+constexpr size_t kPathsPerBucket = 4;
+constexpr uint32_t kMaxSeed      = 1u << 16;
+// Growth of the table, in eighths of the paths, when some bucket could not be placed.
+constexpr size_t kMaxGrowth = 4;
+} // namespace
+
+CHIP_ERROR fuzz::PathIndex::Build(DeviceState & deviceState)
+{
+    Clear();
+
+    std::vector<Entry> paths;
+    for (auto & [nodeId, node] : deviceState.nodes)
+    {
+        for (auto & [endpointId, endpoint] : node.endpoints)
+        {
+            for (auto & [clusterId, cluster] : endpoint.clusters)
+            {
+                for (auto & [attributeId, attribute] : cluster.attributes)
+                {
+                    paths.push_back(Entry{ nodeId, PackPath(clusterId, attributeId), endpointId, &attribute,
+                                           rules::Find(clusterId, attributeId) });
+                }
+            }
+        }
+    }
+    VerifyOrReturnError(!paths.empty(), CHIP_NO_ERROR);
+
+    std::vector<uint64_t> hashes(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        hashes[i] = HashPath(paths[i].node, paths[i].endpoint, paths[i].packedPath);
+    }
+
+    // Buckets are placed from the largest one, while most of the slots are still free.
+    std::vector<std::vector<uint32_t>> buckets((paths.size() + kPathsPerBucket - 1) / kPathsPerBucket);
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        buckets[Reduce(hashes[i], buckets.size())].push_back(static_cast<uint32_t>(i));
+    }
+    std::vector<uint32_t> order(buckets.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    // A minimal table holds exactly one entry per path. It only grows if some bucket finds no seed, which would take two paths
+    // with the same 64-bit hash.
+    for (size_t growth = 0; growth <= kMaxGrowth; growth++)
+    {
+        mSeeds.assign(buckets.size(), 0);
+        mEntries.assign(paths.size() + paths.size() * growth / 8, Entry{});
+        std::vector<size_t> slots;
+        bool placed = true;
+        for (uint32_t bucket : order)
+        {
+            uint32_t seed = 0;
+            while (seed < kMaxSeed && !Place(hashes, buckets[bucket], seed, slots))
+            {
+                seed++;
+            }
+            if (seed == kMaxSeed)
+            {
+                placed = false;
+                break;
+            }
+            mSeeds[bucket] = seed;
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                mEntries[slots[i]] = paths[buckets[bucket][i]];
+            }
+        }
+        if (placed)
+        {
+            mPathCount = paths.size();
+            return CHIP_NO_ERROR;
+        }
+    }
+
+    Clear();
+    return CHIP_ERROR_INTERNAL;
+}
+
+void fuzz::PathIndex::Clear()
+{
+    mSeeds.clear();
+    mEntries.clear();
+    mPathCount = 0;
+}
+
+bool fuzz::PathIndex::Place(const std::vector<uint64_t> & hashes, const std::vector<uint32_t> & bucket, uint32_t seed,
+                            std::vector<size_t> & slots) const
+{
+    slots.clear();
+    for (uint32_t path : bucket)
+    {
+        size_t slot = Slot(hashes[path], seed);
+        if (mEntries[slot].state != nullptr || std::find(slots.begin(), slots.end(), slot) != slots.end())
+        {
+            return false;
+        }
+        slots.push_back(slot);
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "ForwardDeclarations.h"
+#include "OracleRules.h"
+#include <vector>
+
+namespace chip {
+namespace fuzzing {
+
+// Packs a cluster and an attribute of the data model into a single key, the endpoint and the node being mixed in by HashPath.
+constexpr uint64_t PackPath(ClusterId cluster, AttributeId attribute)
+{
+    return (static_cast<uint64_t>(cluster) << 32) | attribute;
+}
+
+// Finalizer of MurmurHash3, spreading every bit of the input over the whole output.
+constexpr uint64_t MixPath(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+constexpr uint64_t HashPath(NodeId node, EndpointId endpoint, uint64_t packedPath)
+{
+    return MixPath(packedPath ^ MixPath(node ^ (static_cast<uint64_t>(endpoint) << 48)));
+}
+
+struct PackedPathHash
+{
+    size_t operator()(uint64_t packedPath) const { return static_cast<size_t>(MixPath(packedPath)); }
+};
+
+/**
+ * @brief Flat index of the attribute paths of the device state, which maps every (node, endpoint, cluster, attribute) path to
+ * its AttributeState and to the rule of the specification on it.
+ *
+ * The paths are known once the data model of the nodes has been acquired, so the index is built with a minimal perfect hash
+ * (hash and displace): every path hashes to a bucket, whose seed places its paths in distinct slots of a table holding one
+ * entry per path. A lookup hashes the path once, reads the seed of its bucket and compares the path to the single entry it
+ * points to, whether the path is indexed or not.
+ *
+ * The entries point into the nested maps of DeviceState, whose elements never move: the index stays valid until the attributes
+ * are removed, i.e. until the device state is replaced.
+ */
+class PathIndex
+{
+public:
+    struct Entry
+    {
+        NodeId node                = kUndefinedNodeId;
+        uint64_t packedPath        = 0;
+        EndpointId endpoint        = kInvalidEndpointId;
+        AttributeState * state     = nullptr;
+        const AttributeRule * rule = nullptr;
+    };
+
+    /**
+     * @brief Indexes every attribute of the device state, replacing the previous paths.
+     */
+    CHIP_ERROR Build(DeviceState & deviceState);
+    void Clear();
+
+    const Entry * Find(NodeId node, EndpointId endpoint, ClusterId cluster, AttributeId attribute) const
+    {
+        VerifyOrReturnValue(!mSeeds.empty(), nullptr);
+        uint64_t packedPath = PackPath(cluster, attribute);
+        uint64_t hash       = HashPath(node, endpoint, packedPath);
+        const Entry & entry = mEntries[Slot(hash, mSeeds[Reduce(hash, mSeeds.size())])];
+        VerifyOrReturnValue(entry.state != nullptr && entry.packedPath == packedPath && entry.endpoint == endpoint &&
+                                entry.node == node,
+                            nullptr);
+        return &entry;
+    }
+
+    size_t GetPathCount() const { return mPathCount; }
+    size_t GetSlotCount() const { return mEntries.size(); }
+
+private:
+    // Seeds of the buckets, in bucket order.
+    std::vector<uint32_t> mSeeds;
+    // Entries in slot order, empty slots have no state.
+    std::vector<Entry> mEntries;
+    size_t mPathCount = 0;
+
+    // Maps a hash to [0, count) without a division.
+    static size_t Reduce(uint64_t hash, size_t count)
+    {
+        return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(count)) >> 32);
+    }
+    size_t Slot(uint64_t hash, uint32_t seed) const { return Reduce(MixPath(hash ^ seed), mEntries.size()); }
+    // Finds the free slots of the paths of a bucket for a seed, false if two of them collide or one is taken.
+    bool Place(const std::vector<uint64_t> & hashes, const std::vector<uint32_t> & bucket, uint32_t seed,
+               std::vector<size_t> & slots) const;
+};
+
+} // namespace fuzzing
+} // namespace chip
@@ -1,5 +1,6 @@
 #pragma once
 #include "ForwardDeclarations.h"
+#include "tlv/DecodedTLVContainer.h"
 #include <iostream>
 
 namespace chip {
@@ -20,7 +21,7 @@ struct ExtendedVariant<std::variant<Args0...>, std::variant<Args1...>>
     using type = std::variant<Args0..., Args1...>;
 };
 } // namespace utils
-using ContainerType = std::vector<std::shared_ptr<TLV::DecodedTLVElement>>;
+using ContainerType = TLV::DecodedTLVContainer;
 using AnyType       = typename utils::ExtendedVariant<PrimitiveType, ContainerType>::type;
 
 inline AnyType kInvalidValue = std::monostate();
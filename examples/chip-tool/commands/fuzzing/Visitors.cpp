@@ -4,11 +4,18 @@
 #include "tlv/DecodedTLVElement.h"
 #include <app-common/zap-generated/ids/Attributes.h>
 #include <app-common/zap-generated/ids/Clusters.h>
+#include <cmath>
+#include <cstring>
 
 namespace Visitors = chip::fuzzing::Visitors;
 
+namespace {
+// Context tag of the SubscriptionsPerFabric field of the CapabilityMinimaStruct.
+constexpr uint8_t kSubscriptionsPerFabricTag = 1;
+} // namespace
+
 template <typename T>
-T Visitors::TLV::ConvertToIdType(std::shared_ptr<DecodedTLVElement> element)
+T Visitors::TLV::ConvertToIdType(const DecodedTLVView & element)
 {
     uint32_t primitive = TryConvertPrimitiveType<uint32_t>(element);
     if (primitive == std::numeric_limits<uint32_t>::max())
@@ -24,13 +31,13 @@ T Visitors::TLV::ConvertToIdType(std::shared_ptr<DecodedTLVElement> element)
     }
     return static_cast<T>(primitive);
 }
-template chip::EndpointId Visitors::TLV::ConvertToIdType<chip::EndpointId>(std::shared_ptr<DecodedTLVElement> element);
-template chip::ClusterId Visitors::TLV::ConvertToIdType<chip::ClusterId>(std::shared_ptr<DecodedTLVElement> element);
+template chip::EndpointId Visitors::TLV::ConvertToIdType<chip::EndpointId>(const DecodedTLVView & element);
+template chip::ClusterId Visitors::TLV::ConvertToIdType<chip::ClusterId>(const DecodedTLVView & element);
 
 template <typename T>
-T Visitors::TLV::TryConvertPrimitiveType(std::shared_ptr<DecodedTLVElement> element)
+T Visitors::TLV::TryConvertPrimitiveType(const DecodedTLVView & element)
 {
-    VerifyOrDie(!std::holds_alternative<ContainerType>(element->content));
+    VerifyOrDie(element.IsValid() && !element.IsContainer());
     return std::visit(
         [](auto && arg) -> T {
             using arg_t = std::decay_t<decltype(arg)>;
@@ -44,128 +51,127 @@ T Visitors::TLV::TryConvertPrimitiveType(std::shared_ptr<DecodedTLVElement> elem
                 return std::numeric_limits<T>::max();
             }
         },
-        element->content);
+        element->value);
 }
-template uint32_t Visitors::TLV::TryConvertPrimitiveType<uint32_t>(std::shared_ptr<DecodedTLVElement> element);
+template uint32_t Visitors::TLV::TryConvertPrimitiveType<uint32_t>(const DecodedTLVView & element);
 
-void Visitors::TLV::PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer, std::shared_ptr<DecodedTLVElement> element,
-                                        size_t indent)
+void Visitors::TLV::PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer, const DecodedTLVView & element, size_t indent)
 {
+    printer->PrintDecodedElementMetadata(element, indent);
+    if (element.IsContainer())
+    {
+        printer->PrintDecodedContainerElement(element, indent);
+        return;
+    }
     std::visit(
         [&](auto && arg) {
             using arg_t = std::decay_t<decltype(arg)>;
-            printer->PrintDecodedElementMetadata(element, indent);
-
-            if constexpr (std::is_same_v<arg_t, ContainerType>)
-            {
-                printer->PrintDecodedContainerElement(arg, indent);
-            }
-            else
+            if constexpr (!std::is_same_v<arg_t, ContainerType>)
             {
                 printer->PrintDecodedPrimitiveElement<arg_t>(arg, indent);
             }
         },
-        element->content);
+        element.GetContent());
 }
 
-void Visitors::TLV::FinalizePrintDecodedElementMetadata(DecodedTLVElementPrettyPrinter * printer,
-                                                        std::shared_ptr<DecodedTLVElement> element, size_t indent)
+void Visitors::TLV::FinalizePrintDecodedElementMetadata(DecodedTLVElementPrettyPrinter * printer, const DecodedTLVView & element,
+                                                        size_t indent)
 {
-    std::visit(
-        [&](auto && arg) {
-            using arg_t = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<arg_t, ContainerType>)
-            {
-                std::cout << "), size: " << std::dec << arg.size() << "] = {" << std::endl;
-            }
-            else
-            {
-                std::cout << ")] = ";
-            }
-        },
-        element->content);
+    if (element.IsContainer())
+    {
+        std::cout << "), size: " << std::dec << element.GetChildCount() << "] = {" << std::endl;
+    }
+    else
+    {
+        std::cout << ")] = ";
+    }
 }
 
 template <typename T>
-void Visitors::TLV::ProcessDescriptorClusterResponse(std::shared_ptr<DecodedTLVElement> decoded,
+void Visitors::TLV::ProcessDescriptorClusterResponse(const DecodedTLVView & decoded,
                                                      const chip::app::ConcreteDataAttributePath & path, NodeId node)
 {
     // decoded is a structure which first element is an array (container inside root container)
-    std::visit(
-        [&](auto && arg) {
-            using arg_t = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<arg_t, ContainerType>)
-            {
-                VerifyOrReturn(std::holds_alternative<ContainerType>(arg[0]->content));
-                auto container = std::get<ContainerType>(arg[0]->content);
-                for (const auto & element : container)
-                {
-                    auto * deviceState = fuzz::Fuzzer::GetInstance()->GetDeviceStateManager();
-                    if constexpr (std::is_same_v<T, EndpointId>)
-                    {
-                        deviceState->Add(node, ConvertToIdType<EndpointId>(element));
-                    }
-                    else if constexpr (std::is_same_v<T, uint32_t>)
-                    {
-                        /**
-                         * This case applies to both DeviceTypeId and ClusterId: both types are uint32_t.
-                         * "element" may be an array of DeviceTypeStruct typed objects:
-                         * [
-                         *   {
-                         *     deviceType: int,
-                         *     revision: int
-                         *   }
-                         * ]
-                         * We only really care about the first array element at the moment
-                         */
+    DecodedTLVView container = decoded.GetFirstChild();
+    VerifyOrReturn(container.IsContainer());
+    auto * deviceState = fuzz::Fuzzer::GetInstance()->GetDeviceStateManager();
+    for (auto element = container.GetFirstChild(); element.IsValid(); element = element.GetNextSibling())
+    {
+        if constexpr (std::is_same_v<T, EndpointId>)
+        {
+            deviceState->Add(node, ConvertToIdType<EndpointId>(element));
+        }
+        else if constexpr (std::is_same_v<T, uint32_t>)
+        {
+            /**
+             * This case applies to both DeviceTypeId and ClusterId: both types are uint32_t.
+             * "element" may be an array of DeviceTypeStruct typed objects:
+             * [
+             *   {
+             *     deviceType: int,
+             *     revision: int
+             *   }
+             * ]
+             * We only really care about the first array element at the moment
+             */
 
-                        // Processing testing clusters is not useful and may lead to errors.
+            // Processing testing clusters is not useful and may lead to errors.
 
-                        if (path.mAttributeId == chip::app::Clusters::Descriptor::Attributes::DeviceTypeList::Id)
-                        {
-                            VerifyOrDie(std::holds_alternative<ContainerType>(element->content));
-                            auto deviceTypeStruct   = std::get<ContainerType>(element->content);
-                            DeviceTypeId deviceType = ConvertToIdType<DeviceTypeId>(deviceTypeStruct[0]);
-                            uint16_t revision       = static_cast<uint16_t>(std::get<uint8_t>(deviceTypeStruct[1]->content));
-                            deviceState->Add(node, path.mEndpointId, DeviceTypeStruct{ deviceType, revision });
-                        }
-                        else
-                        {
-                            ClusterId cluster = ConvertToIdType<ClusterId>(element);
-                            // TODO: Get cluster revision dynamically
-                            if (IsManufacturerSpecificTestingCluster(cluster) || cluster == chip::app::Clusters::Descriptor::Id)
-                                continue;
-                            deviceState->Add(node, path.mEndpointId, cluster);
-                        }
-                    }
-                }
+            if (path.mAttributeId == chip::app::Clusters::Descriptor::Attributes::DeviceTypeList::Id)
+            {
+                VerifyOrDie(element.IsContainer());
+                DecodedTLVView deviceTypeField = element.GetFirstChild();
+                DecodedTLVView revisionField   = deviceTypeField.GetNextSibling();
+                VerifyOrDie(revisionField.IsValid());
+                DeviceTypeId deviceType = ConvertToIdType<DeviceTypeId>(deviceTypeField);
+                uint16_t revision       = static_cast<uint16_t>(std::get<uint8_t>(revisionField->value));
+                deviceState->Add(node, path.mEndpointId, DeviceTypeStruct{ deviceType, revision });
             }
-        },
-        decoded->content);
+            else
+            {
+                ClusterId cluster = ConvertToIdType<ClusterId>(element);
+                // TODO: Get cluster revision dynamically
+                if (IsManufacturerSpecificTestingCluster(cluster) || cluster == chip::app::Clusters::Descriptor::Id)
+                    continue;
+                deviceState->Add(node, path.mEndpointId, cluster);
+            }
+        }
+    }
 }
 
-template void Visitors::TLV::ProcessDescriptorClusterResponse<chip::EndpointId>(std::shared_ptr<DecodedTLVElement> decoded,
+template void Visitors::TLV::ProcessDescriptorClusterResponse<chip::EndpointId>(const DecodedTLVView & decoded,
                                                                                 const chip::app::ConcreteDataAttributePath & path,
                                                                                 NodeId node);
-template void Visitors::TLV::ProcessDescriptorClusterResponse<chip::ClusterId>(std::shared_ptr<DecodedTLVElement> decoded,
+template void Visitors::TLV::ProcessDescriptorClusterResponse<chip::ClusterId>(const DecodedTLVView & decoded,
                                                                                const chip::app::ConcreteDataAttributePath & path,
                                                                                NodeId node);
 
-void Visitors::TLV::ProcessBasicInformationClusterResponse(std::shared_ptr<DecodedTLVElement> decoded,
+void Visitors::TLV::ProcessBasicInformationClusterResponse(const DecodedTLVView & decoded,
                                                            const chip::app::ConcreteDataAttributePath & path, NodeId node)
 {
-    VerifyOrReturn(std::holds_alternative<ContainerType>(decoded->content));
-    auto element = std::get<ContainerType>(decoded->content);
+    DecodedTLVView element = decoded.GetFirstChild();
+    VerifyOrReturn(element.IsValid());
     std::visit(
         [&](auto && arg) {
             using arg_t = std::decay_t<decltype(arg)>;
-            // The only containers the basic information cluster returns are CapabilityMinima and ProductAppearance, which we don't
-            // care about.
+            // The only containers the basic information cluster returns are CapabilityMinima and ProductAppearance. Only the
+            // number of subscriptions per fabric is kept from the former, it bounds the subscriptions the fuzzer keeps.
             BasicInformation info;
             auto * deviceState = fuzz::Fuzzer::GetInstance()->GetDeviceStateManager();
 
             if constexpr (std::is_same_v<arg_t, ContainerType>)
-                return;
+            {
+                VerifyOrReturn(path.mAttributeId == chip::app::Clusters::BasicInformation::Attributes::CapabilityMinima::Id);
+                for (auto field = element.GetFirstChild(); field.IsValid(); field = field.GetNextSibling())
+                {
+                    uint32_t value = TryConvertPrimitiveType<uint32_t>(field);
+                    if (field->fullTag == chip::TLV::ContextTag(kSubscriptionsPerFabricTag) &&
+                        value <= std::numeric_limits<uint16_t>::max())
+                    {
+                        info.subscriptionsPerFabric = static_cast<uint16_t>(value);
+                    }
+                }
+            }
             else if constexpr (std::is_same_v<arg_t, std::string>)
             {
                 switch (path.mAttributeId)
@@ -206,23 +212,7 @@ void Visitors::TLV::ProcessBasicInformationClusterResponse(std::shared_ptr<Decod
                 return;
             deviceState->Add(node, info);
         },
-        element[0]->content);
-}
-
-CHIP_ERROR Visitors::TLV::PushToContainer(std::shared_ptr<DecodedTLVElement> element, std::shared_ptr<DecodedTLVElement> dst)
-{
-    return std::visit(
-        [&](auto & container) -> CHIP_ERROR {
-            using T = std::decay_t<decltype(container)>;
-            if constexpr (std::is_same_v<T, ContainerType>)
-            {
-                container.push_back(std::move(element));
-                return CHIP_NO_ERROR;
-            }
-            else
-                return CHIP_ERROR_WRONG_TLV_TYPE;
-        },
-        dst->content);
+        element.GetContent());
 }
 
 const fuzz::AnyType & Visitors::AttributeWrapperRead(AttributeWrapper * attribute)
@@ -271,6 +261,68 @@ CHIP_ERROR Visitors::AttributeWrapperWriteOrFail(AttributeWrapper * attribute, s
     return CHIP_NO_ERROR;
 }
 
+namespace {
+// Shared by the attribute values and by the scalars of the decoded elements, whose alternatives are a subset of them.
+template <typename Variant>
+bool VariantsEqual(const Variant & a, const Variant & b)
+{
+    VerifyOrReturnValue(a.index() == b.index(), false);
+    return std::visit(
+        [&b](const auto & v) -> bool {
+            using T     = std::decay_t<decltype(v)>;
+            const T & w = std::get<T>(b);
+            if constexpr (std::is_same_v<T, std::monostate> || std::is_same_v<T, chip::NullOptionalType>)
+            {
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, char *>)
+            {
+                return v == w || (v != nullptr && w != nullptr && strcmp(v, w) == 0);
+            }
+            else if constexpr (std::is_same_v<T, chip::fuzzing::ContainerType>)
+            {
+                return Visitors::TLV::ElementsEqual(v.GetView(), w.GetView());
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                return v == w || (std::isnan(v) && std::isnan(w));
+            }
+            else
+            {
+                return v == w;
+            }
+        },
+        a);
+}
+} // namespace
+
+bool Visitors::TLV::ElementsEqual(const DecodedTLVView & a, const DecodedTLVView & b)
+{
+    VerifyOrReturnValue(a.IsValid() && b.IsValid(), a.IsValid() == b.IsValid());
+    VerifyOrReturnValue(a != b, true);
+    VerifyOrReturnValue(a->type == b->type && a->length == b->length && a->fullTag == b->fullTag, false);
+    if (a->IsString())
+    {
+        return a.GetString() == b.GetString();
+    }
+    if (a->IsContainer())
+    {
+        VerifyOrReturnValue(a.GetChildCount() == b.GetChildCount(), false);
+        for (auto x = a.GetFirstChild(), y = b.GetFirstChild(); x.IsValid() && y.IsValid();
+             x = x.GetNextSibling(), y = y.GetNextSibling())
+        {
+            VerifyOrReturnValue(ElementsEqual(x, y), false);
+        }
+        return true;
+    }
+    return VariantsEqual(a->value, b->value);
+}
+
+bool Visitors::AttributeValuesEqual(const AnyType & a, const AnyType & b)
+{
+    return VariantsEqual(a, b);
+}
+
 std::string Visitors::AttributeValueAsString(const AnyType & attr)
 {
     VerifyOrDie(!std::holds_alternative<ContainerType>(attr));
@@ -7,43 +7,45 @@ namespace chip {
 namespace fuzzing {
 namespace Visitors {
 using DecodedTLVElement              = chip::fuzzing::TLV::DecodedTLVElement;
+using DecodedTLVView                 = chip::fuzzing::TLV::DecodedTLVView;
 using DecodedTLVElementPrettyPrinter = chip::fuzzing::TLV::DecodedTLVElementPrettyPrinter;
 
 namespace TLV {
 
-void PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer, std::shared_ptr<DecodedTLVElement> element, size_t indent);
-void FinalizePrintDecodedElementMetadata(DecodedTLVElementPrettyPrinter * printer, std::shared_ptr<DecodedTLVElement> element,
-                                         size_t indent);
-CHIP_ERROR
-PushToContainer(std::shared_ptr<DecodedTLVElement> element, std::shared_ptr<DecodedTLVElement> dst);
+void PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer, const DecodedTLVView & element, size_t indent);
+void FinalizePrintDecodedElementMetadata(DecodedTLVElementPrettyPrinter * printer, const DecodedTLVView & element, size_t indent);
 
 template <typename T>
-T ConvertToIdType(std::shared_ptr<DecodedTLVElement> id);
-extern template EndpointId ConvertToIdType<EndpointId>(std::shared_ptr<DecodedTLVElement> id);
-extern template ClusterId ConvertToIdType<ClusterId>(std::shared_ptr<DecodedTLVElement> id);
+T ConvertToIdType(const DecodedTLVView & id);
+extern template EndpointId ConvertToIdType<EndpointId>(const DecodedTLVView & id);
+extern template ClusterId ConvertToIdType<ClusterId>(const DecodedTLVView & id);
 
 // TODO: It is useful to template this function to allow for more types to be converted?
 template <typename T>
-T TryConvertPrimitiveType(std::shared_ptr<DecodedTLVElement> element);
-extern template uint32_t TryConvertPrimitiveType<uint32_t>(std::shared_ptr<DecodedTLVElement> element);
+T TryConvertPrimitiveType(const DecodedTLVView & element);
+extern template uint32_t TryConvertPrimitiveType<uint32_t>(const DecodedTLVView & element);
 
 template <typename T>
-void ProcessDescriptorClusterResponse(std::shared_ptr<DecodedTLVElement> decoded, const app::ConcreteDataAttributePath & path,
-                                      NodeId node);
+void ProcessDescriptorClusterResponse(const DecodedTLVView & decoded, const app::ConcreteDataAttributePath & path, NodeId node);
 
-extern template void ProcessDescriptorClusterResponse<EndpointId>(std::shared_ptr<DecodedTLVElement> decoded,
+extern template void ProcessDescriptorClusterResponse<EndpointId>(const DecodedTLVView & decoded,
                                                                   const app::ConcreteDataAttributePath & path, NodeId node);
-extern template void ProcessDescriptorClusterResponse<ClusterId>(std::shared_ptr<DecodedTLVElement> decoded,
+extern template void ProcessDescriptorClusterResponse<ClusterId>(const DecodedTLVView & decoded,
                                                                  const app::ConcreteDataAttributePath & path, NodeId node);
 
-void ProcessBasicInformationClusterResponse(std::shared_ptr<DecodedTLVElement> decoded, const app::ConcreteDataAttributePath & path,
+void ProcessBasicInformationClusterResponse(const DecodedTLVView & decoded, const app::ConcreteDataAttributePath & path,
                                             NodeId node);
+
+// Compares the type, tag and value of two elements, and of their children.
+bool ElementsEqual(const DecodedTLVView & a, const DecodedTLVView & b);
 } // namespace TLV
 
 const AnyType & AttributeWrapperRead(AttributeWrapper * attribute);
 CHIP_ERROR AttributeWrapperWriteOrFail(AttributeWrapper * attribute, size_t & typeIndexAfterWrite,
                                        size_t & underlyingTypeIndexAfterWrite, AnyType && aValue);
 
+// Compares two attribute values by content: byte strings by their bytes, containers element by element, NaNs are equal.
+bool AttributeValuesEqual(const AnyType & a, const AnyType & b);
 std::string AttributeValueAsString(const AnyType & attr);
 std::string AttributeTypeAsString(const AnyType & attr);
 
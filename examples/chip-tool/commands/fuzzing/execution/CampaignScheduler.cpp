@@ -0,0 +1,287 @@
+#include "CampaignScheduler.h"
+#include <inttypes.h>
+
+namespace exec = chip::fuzzing::execution;
+namespace gen  = chip::fuzzing::generation;
+
+CHIP_ERROR exec::CampaignScheduler::AddNode(chip::NodeId node, DeviceStateManager * deviceState,
+                                            const std::vector<gen::RequestKind> & kinds, uint8_t malformedPercent)
+{
+    VerifyOrReturnError(Find(node) == nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+    auto campaign  = std::make_unique<NodeCampaign>();
+    campaign->node = node;
+    // Derived from the seed of the scheduler, so that the whole campaign follows from it.
+    campaign->generator.Seed(mRandom());
+    campaign->generator.SetMalformedPercent(malformedPercent);
+    ReturnErrorOnFailure(campaign->generator.Initialize(deviceState, node));
+    campaign->kinds  = kinds;
+    campaign->sender = std::make_unique<PipelinedSender>(mSessions, node, mMaxWindow, this);
+    mNodes.push_back(std::move(campaign));
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::CampaignScheduler::AddSeed(const gen::GeneratedCommand & seed)
+{
+    VerifyOrReturnError(mSeeds.size() < kMaxSeeds, CHIP_ERROR_NO_MEMORY);
+    mSeeds.push_back(seed);
+    return CHIP_NO_ERROR;
+}
+
+exec::CampaignScheduler::NodeCampaign * exec::CampaignScheduler::Find(chip::NodeId node)
+{
+    for (auto & campaign : mNodes)
+    {
+        if (campaign->node == node)
+        {
+            return campaign.get();
+        }
+    }
+    return nullptr;
+}
+
+exec::CampaignScheduler::NodeCampaign * exec::CampaignScheduler::Pick()
+{
+    double total = 0.0;
+    for (auto & campaign : mNodes)
+    {
+        if (!campaign->down && campaign->sender->HasCapacity())
+        {
+            total += 1.0 + kNoveltyWeight * campaign->novelty;
+        }
+    }
+    VerifyOrReturnValue(total > 0.0, nullptr);
+
+    double target = std::uniform_real_distribution<double>(0.0, total)(mRandom);
+
+    NodeCampaign * picked = nullptr;
+    for (auto & campaign : mNodes)
+    {
+        if (campaign->down || !campaign->sender->HasCapacity())
+            continue;
+        picked = campaign.get();
+        target -= 1.0 + kNoveltyWeight * campaign->novelty;
+        if (target <= 0.0)
+            break;
+    }
+    return picked;
+}
+
+bool exec::CampaignScheduler::HasNewFailure()
+{
+    for (auto & campaign : mNodes)
+    {
+        if (!campaign->down && mMonitor.IsDown(campaign->node))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CHIP_ERROR exec::CampaignScheduler::Recover(LivenessMonitor::Clock::time_point & nextProbe)
+{
+    nextProbe        = LivenessMonitor::Clock::time_point::max();
+    size_t abandoned = 0;
+    for (auto & campaign : mNodes)
+    {
+        if (!campaign->abandoned && !campaign->down && mMonitor.IsDown(campaign->node))
+        {
+            // The exchanges still in flight with the node are left to complete on their own.
+            campaign->down = true;
+        }
+        if (campaign->abandoned || !campaign->down)
+        {
+            abandoned += campaign->abandoned ? 1 : 0;
+            continue;
+        }
+
+        LivenessMonitor::Clock::time_point probe;
+        CHIP_ERROR err = mMonitor.Recover(campaign->node, probe);
+        if (err == CHIP_NO_ERROR)
+        {
+            campaign->down = false;
+        }
+        else if (err == CHIP_ERROR_BUSY)
+        {
+            nextProbe = std::min(nextProbe, probe);
+        }
+        else
+        {
+            campaign->abandoned = true;
+            abandoned++;
+        }
+    }
+    VerifyOrReturnError(abandoned < mNodes.size(), CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::CampaignScheduler::Run(uint32_t iterations, const IndexFunction & nextInput, const RecordFunction & record)
+{
+    VerifyOrReturnError(!mNodes.empty(), CHIP_ERROR_INCORRECT_STATE);
+
+    // Kept outside of the loop, the test case is large and its storage is reused at every iteration.
+    gen::GeneratedCommand testCase;
+    uint32_t submitted = 0;
+    while (submitted < iterations)
+    {
+        LivenessMonitor::Clock::time_point nextProbe;
+        ReturnErrorOnFailure(Recover(nextProbe));
+
+        NodeCampaign * campaign = nullptr;
+        {
+            // Waiting stops early when a node goes down or is due for a probe, so that no time is spent on the down nodes.
+            std::unique_lock<std::mutex> lock(mMutex);
+            auto timeout = LivenessMonitor::Clock::now() + std::chrono::milliseconds(kCapacityTimeout.count());
+            bool probing = nextProbe != LivenessMonitor::Clock::time_point::max();
+            bool ready   = mCondition.wait_until(lock, std::min(timeout, nextProbe),
+                                                 [&] { return (campaign = Pick()) != nullptr || HasNewFailure(); });
+            VerifyOrReturnError(ready || probing, CHIP_ERROR_TIMEOUT);
+        }
+
+        // The window of the node may shrink between the pick and the submission: the test case is then generated again for
+        // whichever node has room.
+        if (campaign == nullptr || !campaign->sender->HasCapacity())
+        {
+            continue;
+        }
+        feedback::CorpusEntryId parent;
+        ReturnErrorOnFailure(NextTestCase(*campaign, testCase, parent));
+        // Only this thread records test cases: the index stays the next one until the test case is sent and recorded.
+        size_t input = nextInput();
+        {
+            // Registered before sending, the response may be analyzed before Submit returns.
+            std::lock_guard<std::mutex> lock(mMutex);
+            campaign->inFlight[input] = InFlightTestCase{ testCase, parent };
+        }
+        CHIP_ERROR err = campaign->sender->Submit(testCase, input);
+        if (err != CHIP_NO_ERROR)
+        {
+            // The test case is not recorded: either the window shrank after all, or no session could be established with the
+            // node.
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                campaign->inFlight.erase(input);
+            }
+            if (err != CHIP_ERROR_BUSY)
+            {
+                ChipLogError(chipFuzzer, "Failed to send a test case to node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                             ChipLogValueX64(campaign->node), err.Format());
+                mMonitor.OnEvent(campaign->node, LivenessEvent::kUnresponsive, "no session could be established");
+            }
+            continue;
+        }
+        record(campaign->node, testCase);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        campaign->submitted++;
+        submitted++;
+    }
+
+    for (auto & campaign : mNodes)
+    {
+        // The exchanges with a node which went down may still be timing out.
+        CHIP_ERROR err = campaign->sender->Drain();
+        VerifyOrReturnError(err == CHIP_NO_ERROR || campaign->down || campaign->abandoned, err);
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::CampaignScheduler::NextTestCase(NodeCampaign & campaign, gen::GeneratedCommand & testCase,
+                                                feedback::CorpusEntryId & parent)
+{
+    parent = feedback::Corpus::kNoParent;
+    if (campaign.nextSeed < mSeeds.size())
+    {
+        testCase = mSeeds[campaign.nextSeed++];
+        return CHIP_NO_ERROR;
+    }
+
+    // The trees are shared with the corpus, so that they stay valid if their entries get replaced while mutating.
+    std::shared_ptr<TLV::DecodedTLVTree> tree;
+    std::shared_ptr<TLV::DecodedTLVTree> donor;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!campaign.corpus.IsEmpty() && mRandom() % 100 < kMutationPercent)
+        {
+            const auto & entry = campaign.corpus.Get(campaign.corpus.Pick(mRandom));
+            parent             = entry.id;
+            testCase           = entry.testCase;
+            tree               = entry.tree;
+            donor              = campaign.corpus.Get(mRandom() % campaign.corpus.GetSize()).tree;
+        }
+    }
+
+    if (parent == feedback::Corpus::kNoParent)
+    {
+        return campaign.generator.Next(testCase, campaign.kinds);
+    }
+    if (tree == nullptr || mRandom() % 100 >= kStructureAwarePercent)
+    {
+        return campaign.generator.Mutate(testCase);
+    }
+    if (CHIP_NO_ERROR != mMutator.Mutate(*tree, donor.get(), testCase))
+    {
+        // E.g. the mutant does not fit the payload buffer, which was overwritten in the meantime.
+        parent = feedback::Corpus::kNoParent;
+        return campaign.generator.Next(testCase, campaign.kinds);
+    }
+    return CHIP_NO_ERROR;
+}
+
+void exec::CampaignScheduler::OnExchangeDone(chip::NodeId node, const ExchangeOutcome & outcome)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        NodeCampaign * campaign = Find(node);
+        VerifyOrDie(campaign != nullptr);
+
+        campaign->completed++;
+        campaign->novelty *= kNoveltyDecay;
+
+        auto inFlight = campaign->inFlight.find(outcome.input);
+        VerifyOrDie(inFlight != campaign->inFlight.end());
+        if (campaign->corpus.Consider(inFlight->second.testCase, outcome.input, outcome.signature, inFlight->second.parent))
+        {
+            campaign->novel++;
+            campaign->novelty += 1.0;
+        }
+        campaign->inFlight.erase(inFlight);
+    }
+    mCondition.notify_one();
+}
+
+void exec::CampaignScheduler::ForEachCorpusEntry(const EntryFunction & function) const
+{
+    for (auto & campaign : mNodes)
+    {
+        for (size_t i = 0; i < campaign->corpus.GetSize(); i++)
+        {
+            function(campaign->node, campaign->corpus.Get(i));
+        }
+    }
+}
+
+void exec::CampaignScheduler::LogStatistics() const
+{
+    for (auto & campaign : mNodes)
+    {
+        ChipLogProgress(chipFuzzer,
+                        "Node 0x" ChipLogFormatX64 ": %" PRIu64 " test cases, %" PRIu64 " completed, %" PRIu64
+                        " distinct behaviours, novelty %.2f",
+                        ChipLogValueX64(campaign->node), campaign->submitted, campaign->completed, campaign->novel,
+                        campaign->novelty);
+        const auto & corpus = campaign->corpus.GetStatistics();
+        ChipLogProgress(chipFuzzer, "Corpus: %zu entries, %zu signatures, %" PRIu64 " kept, %" PRIu64 " evicted",
+                        campaign->corpus.GetSize(), campaign->corpus.GetSignatureCount(), corpus.kept, corpus.evicted);
+        campaign->sender->LogStatistics();
+        campaign->generator.LogStatistics();
+    }
+
+    const auto & applied = mMutator.GetStatistics();
+    for (size_t i = 0; i < applied.size(); i++)
+    {
+        auto kind = static_cast<gen::MutationKind>(i);
+        ChipLogProgress(chipFuzzer, "Mutation %s: %" PRIu64 " mutants", gen::TLVMutator::GetMutationName(kind), applied[i]);
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "../DeviceStateManager.h"
+#include "../ForwardDeclarations.h"
+#include "../feedback/Corpus.h"
+#include "../generation/CommandGenerator.h"
+#include "../generation/TLVMutator.h"
+#include "LivenessMonitor.h"
+#include "PipelinedSender.h"
+#include "SessionPool.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+/**
+ * @brief Spreads the test case budget of a campaign across several target nodes driven by the same controller.
+ *
+ * Every node has its own generator, built from its partition of the DeviceStateManager, and its own PipelinedSender, so the
+ * exchanges with different nodes proceed in parallel on the shared sessions and ExchangeManager.
+ *
+ * The next test case always goes to a node with room in its window, chosen at random with a weight that grows with the novelty
+ * it recently produced: an exchange is novel when the signature of its response was never seen on that node. Novelty decays as
+ * the node keeps producing known behaviour, so the budget flows back to the other nodes.
+ *
+ * Every node also keeps a corpus of the test cases which produced novel signatures. Once the corpus is not empty, most test cases
+ * are mutants of its entries, picked according to their energy, while the others are still generated from scratch. Seeds are
+ * sent as they are to every node before anything else, and enter the corpus like any other test case.
+ *
+ * A node the LivenessMonitor reports down gets no test case until it is back: its reproducer is captured and it is probed
+ * between the submissions to the other nodes, which keep the whole budget meanwhile.
+ */
+class CampaignScheduler : public ExchangeListener
+{
+public:
+    // Returns the index in the command history of the next test case recorded.
+    using IndexFunction = std::function<size_t()>;
+    // Records a test case once it is sent, at the index returned by the IndexFunction right before.
+    using RecordFunction = std::function<void(chip::NodeId, const generation::GeneratedCommand &)>;
+    using EntryFunction  = std::function<void(chip::NodeId, const feedback::CorpusEntry &)>;
+
+    CampaignScheduler(SessionPool & sessions, LivenessMonitor & monitor, uint16_t maxWindow,
+                      uint64_t seed = std::random_device{}()) :
+        mSessions(sessions), mMonitor(monitor), mMaxWindow(maxWindow), mRandom(seed), mMutator(seed)
+    {}
+
+    /**
+     * @brief Adds a node to the campaign. Must be called after the remote data model of the node has been acquired.
+     *
+     * @param malformedPercent Percentage of the fields of the schema-guided payloads which are malformed, see CommandGenerator.
+     */
+    CHIP_ERROR AddNode(chip::NodeId node, DeviceStateManager * deviceState, const std::vector<generation::RequestKind> & kinds,
+                       uint8_t malformedPercent = generation::CommandGenerator::kDefaultMalformedPercent);
+
+    /**
+     * @brief Adds a test case sent to every node at the start of the campaign. Fails once kMaxSeeds seeds were added.
+     */
+    CHIP_ERROR AddSeed(const generation::GeneratedCommand & seed);
+
+    /**
+     * @brief Runs the given number of test cases across the nodes, and waits for all of them to complete.
+     *
+     * Only the test cases which were sent are recorded, so that the command history can be replayed as the nodes received it.
+     * Fails with CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE once every node has been down for too long.
+     */
+    CHIP_ERROR Run(uint32_t iterations, const IndexFunction & nextInput, const RecordFunction & record);
+
+    /**
+     * @brief Visits the corpus entries of every node. Must not be called while the campaign runs.
+     */
+    void ForEachCorpusEntry(const EntryFunction & function) const;
+
+    void LogStatistics() const;
+
+    /////////// ExchangeListener Interface /////////
+    void OnExchangeDone(chip::NodeId node, const ExchangeOutcome & outcome) override;
+
+private:
+    // Weight of the recent novelty of a node, relative to the baseline share every node gets.
+    static constexpr double kNoveltyWeight = 4.0;
+    // Fraction of the novelty score kept after each completed exchange.
+    static constexpr double kNoveltyDecay = 0.98;
+    static constexpr chip::System::Clock::Timeout kCapacityTimeout = chip::System::Clock::Seconds16(20);
+    // Share of the test cases mutated from the corpus, once it is not empty.
+    static constexpr uint32_t kMutationPercent = 80;
+    // Share of the mutants derived by the structure-aware TLVMutator, the others get a subtree replaced with generated values.
+    static constexpr uint32_t kStructureAwarePercent = 75;
+    static constexpr size_t kMaxSeeds               = 1024;
+
+    struct InFlightTestCase
+    {
+        generation::GeneratedCommand testCase;
+        // Corpus entry the test case was mutated from, if any. The parent may be replaced while the test case is in flight, in
+        // which case the find is not credited to any entry.
+        feedback::CorpusEntryId parent;
+    };
+
+    struct NodeCampaign
+    {
+        chip::NodeId node;
+        generation::CommandGenerator generator;
+        std::vector<generation::RequestKind> kinds;
+        std::unique_ptr<PipelinedSender> sender;
+
+        // Updated on the Matter thread, protected by the scheduler mutex.
+        feedback::Corpus corpus;
+        std::unordered_map<size_t, InFlightTestCase> inFlight;
+        double novelty     = 0.0;
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t novel     = 0;
+
+        // Only accessed from the fuzzing thread.
+        size_t nextSeed = 0;
+        // The node is down, or was left out of the campaign after being down for too long.
+        bool down      = false;
+        bool abandoned = false;
+    };
+
+    SessionPool & mSessions;
+    LivenessMonitor & mMonitor;
+    uint16_t mMaxWindow;
+    std::mt19937_64 mRandom;
+    generation::TLVMutator mMutator;
+    std::vector<std::unique_ptr<NodeCampaign>> mNodes;
+    std::vector<generation::GeneratedCommand> mSeeds;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+
+    NodeCampaign * Find(chip::NodeId node);
+    NodeCampaign * Pick();
+    // Tells whether a node went down since the last call to Recover.
+    bool HasNewFailure();
+    /**
+     * @brief Pauses the nodes which went down, and probes those which are due.
+     *
+     * @param nextProbe Set to the time of the earliest probe still due, if any node is down.
+     */
+    CHIP_ERROR Recover(LivenessMonitor::Clock::time_point & nextProbe);
+    CHIP_ERROR NextTestCase(NodeCampaign & campaign, generation::GeneratedCommand & testCase, feedback::CorpusEntryId & parent);
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
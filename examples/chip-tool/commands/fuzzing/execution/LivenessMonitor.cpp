@@ -0,0 +1,258 @@
+#include "LivenessMonitor.h"
+#include "../Fuzzing.h"
+#include <fstream>
+#include <inttypes.h>
+#include <platform/PlatformManager.h>
+#include <thread>
+
+namespace fuzz = chip::fuzzing;
+namespace exec = chip::fuzzing::execution;
+
+namespace {
+constexpr char kHistoryFile[]  = "history";
+constexpr char kSnapshotFile[] = "state.snapshot";
+constexpr char kReasonFile[]   = "reason";
+
+chip::System::Clock::Milliseconds64 ToMilliseconds(exec::LivenessMonitor::Clock::duration duration)
+{
+    return std::chrono::duration_cast<chip::System::Clock::Milliseconds64>(duration);
+}
+} // namespace
+
+const char * exec::LivenessMonitor::GetEventName(LivenessEvent event)
+{
+    switch (event)
+    {
+    case LivenessEvent::kUnresponsive:
+        return "unresponsive";
+    case LivenessEvent::kRebooted:
+        return "rebooted";
+    case LivenessEvent::kSessionLost:
+        return "session-lost";
+    default:
+        return "unknown";
+    }
+}
+
+void exec::LivenessMonitor::Start()
+{
+    // Both are read on the Matter thread.
+    chip::DeviceLayer::StackLock lock;
+    fuzz::Fuzzer::GetInstance()->SetLivenessMonitor(this);
+    mSessions.SetLivenessMonitor(this);
+    mStarted = true;
+}
+
+void exec::LivenessMonitor::Stop()
+{
+    VerifyOrReturn(mStarted);
+    chip::DeviceLayer::StackLock lock;
+    fuzz::Fuzzer::GetInstance()->SetLivenessMonitor(nullptr);
+    mSessions.SetLivenessMonitor(nullptr);
+    mStarted = false;
+}
+
+void exec::LivenessMonitor::OnAnswer(chip::NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mNodes.find(node);
+    // The answers to the requests sent before the node went down do not bring it back, only a probe does.
+    VerifyOrReturn(it != mNodes.end() && !it->second.down);
+    it->second.consecutiveTimeouts = 0;
+}
+
+void exec::LivenessMonitor::OnTimeout(chip::NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    NodeLiveness & liveness = mNodes[node];
+    VerifyOrReturn(!liveness.down);
+    if (++liveness.consecutiveTimeouts >= kMaxConsecutiveTimeouts)
+    {
+        MarkDown(node, liveness, LivenessEvent::kUnresponsive, "consecutive timeouts");
+    }
+}
+
+void exec::LivenessMonitor::OnEvent(chip::NodeId node, LivenessEvent event, const char * detail)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    NodeLiveness & liveness = mNodes[node];
+    // The first event is the one captured, the others usually follow from it.
+    VerifyOrReturn(!liveness.down);
+    MarkDown(node, liveness, event, detail);
+}
+
+void exec::LivenessMonitor::MarkDown(chip::NodeId node, NodeLiveness & liveness, LivenessEvent event, const char * detail)
+{
+    ChipLogError(chipFuzzer, "Node 0x" ChipLogFormatX64 " is down (%s: %s), pausing its test cases", ChipLogValueX64(node),
+                 GetEventName(event), detail);
+    liveness.down                = true;
+    liveness.captured            = false;
+    liveness.event               = event;
+    liveness.detail              = detail;
+    liveness.downSince           = Clock::now();
+    liveness.nextProbe           = liveness.downSince;
+    liveness.backoff             = kInitialBackoff;
+    liveness.consecutiveTimeouts = 0;
+
+    switch (event)
+    {
+    case LivenessEvent::kUnresponsive:
+        mStatistics.unresponsive++;
+        break;
+    case LivenessEvent::kRebooted:
+        mStatistics.reboots++;
+        break;
+    case LivenessEvent::kSessionLost:
+        mStatistics.sessionsLost++;
+        break;
+    }
+}
+
+bool exec::LivenessMonitor::IsDown(chip::NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mNodes.find(node);
+    return it != mNodes.end() && it->second.down;
+}
+
+CHIP_ERROR exec::LivenessMonitor::Recover(chip::NodeId node, Clock::time_point & nextProbe)
+{
+    NodeLiveness liveness;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mNodes.find(node);
+        VerifyOrReturnError(it != mNodes.end() && it->second.down, CHIP_NO_ERROR);
+        VerifyOrReturnError(!it->second.abandoned, CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE);
+        liveness            = it->second;
+        it->second.captured = true;
+    }
+
+    if (!liveness.captured)
+    {
+        CHIP_ERROR err = Capture(node, liveness.event, liveness.detail);
+        if (err != CHIP_NO_ERROR)
+        {
+            ChipLogError(chipFuzzer, "Failed to capture the reproducer of node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                         ChipLogValueX64(node), err.Format());
+        }
+    }
+
+    nextProbe = liveness.nextProbe;
+    VerifyOrReturnError(Clock::now() >= nextProbe, CHIP_ERROR_BUSY);
+
+    // A rebooted node lost the keys of its session, and the stack may still hand out the session of an unresponsive one: the
+    // probe always establishes a new session.
+    mSessions.Evict(node);
+    CHIP_ERROR err = mSessions.Connect(node, kProbeTimeout);
+    if (err == CHIP_NO_ERROR)
+    {
+        // Before the node is up again, so that the boot it recovered from is not reported as a new one.
+        chip::DeviceLayer::StackLock stackLock;
+        fuzz::Fuzzer::GetInstance()->OnNodeRecovered(node);
+    }
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mMutex);
+    NodeLiveness & current = mNodes[node];
+    auto downtime          = ToMilliseconds(now - current.downSince);
+    if (err == CHIP_NO_ERROR)
+    {
+        ChipLogProgress(chipFuzzer, "Node 0x" ChipLogFormatX64 " is back after %" PRIu64 " ms, resuming its test cases",
+                        ChipLogValueX64(node), downtime.count());
+        mStatistics.recoveries++;
+        mStatistics.downtime += downtime;
+        current = NodeLiveness();
+        return CHIP_NO_ERROR;
+    }
+    if (downtime >= kMaxDowntime)
+    {
+        ChipLogError(chipFuzzer, "Node 0x" ChipLogFormatX64 " is still down after %" PRIu64 " ms, leaving it out of the campaign",
+                     ChipLogValueX64(node), downtime.count());
+        mStatistics.abandoned++;
+        mStatistics.downtime += downtime;
+        current.abandoned = true;
+        return CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE;
+    }
+
+    current.nextProbe = now + std::chrono::milliseconds(current.backoff.count());
+    current.backoff   = std::min(chip::System::Clock::Timeout(current.backoff.count() * 2), kMaxBackoff);
+    nextProbe         = current.nextProbe;
+    return CHIP_ERROR_BUSY;
+}
+
+CHIP_ERROR exec::LivenessMonitor::WaitForRecovery(chip::NodeId node)
+{
+    Clock::time_point nextProbe;
+    CHIP_ERROR err;
+    while ((err = Recover(node, nextProbe)) == CHIP_ERROR_BUSY)
+    {
+        std::this_thread::sleep_until(nextProbe);
+    }
+    return err;
+}
+
+CHIP_ERROR exec::LivenessMonitor::Capture(chip::NodeId node, LivenessEvent event, const char * detail)
+{
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    char name[64];
+    snprintf(name, sizeof(name), "%" PRId64 "-%016" PRIX64 "-%s", static_cast<int64_t>(now.count()), node, GetEventName(event));
+    fs::path bundle = mDirectory / name;
+    std::error_code ec;
+    fs::create_directories(bundle, ec);
+    VerifyOrReturnError(!ec, CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    // The test cases still in flight when the node went down are part of the history as well.
+    size_t first = mHistory.size() > mDepth ? mHistory.size() - mDepth : 0;
+    std::vector<std::string> history(mHistory.begin() + static_cast<std::ptrdiff_t>(first), mHistory.end());
+
+    std::ofstream historyFile(bundle / kHistoryFile);
+    for (const auto & command : history)
+    {
+        historyFile << command << '\n';
+    }
+    VerifyOrReturnError(historyFile.flush(), CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    std::ofstream reasonFile(bundle / kReasonFile);
+    char nodeId[19];
+    snprintf(nodeId, sizeof(nodeId), "0x%016" PRIX64, node);
+    reasonFile << "event: " << GetEventName(event) << '\n'
+               << "detail: " << detail << '\n'
+               << "node: " << nodeId << '\n'
+               << "first-input: " << first << '\n'
+               << "input-count: " << history.size() << '\n';
+    VerifyOrReturnError(reasonFile.flush(), CHIP_FUZZER_FILESYSTEM_ERROR);
+
+    fs::path snapshot;
+    {
+        // The device state is updated by the responses, on the Matter thread.
+        chip::DeviceLayer::StackLock lock;
+        ReturnErrorOnFailure(mDeviceState.Snapshot(history, snapshot));
+    }
+    // Snapshots are written to the dump directory, which may be on another file system.
+    fs::rename(snapshot, bundle / kSnapshotFile, ec);
+    if (ec)
+    {
+        ec.clear();
+        fs::copy_file(snapshot, bundle / kSnapshotFile, ec);
+        std::error_code removeEc;
+        fs::remove(snapshot, removeEc);
+        VerifyOrReturnError(!ec, CHIP_FUZZER_FILESYSTEM_ERROR);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStatistics.reproducers++;
+    }
+    ChipLogProgress(chipFuzzer, "Reproducer of node 0x" ChipLogFormatX64 " written to %s", ChipLogValueX64(node), bundle.c_str());
+    return CHIP_NO_ERROR;
+}
+
+void exec::LivenessMonitor::LogStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ChipLogProgress(chipFuzzer,
+                    "Liveness statistics: %" PRIu64 " unresponsive, %" PRIu64 " reboots, %" PRIu64 " sessions lost, %" PRIu64
+                    " reproducers, %" PRIu64 " recoveries (%" PRIu64 " ms down), %" PRIu64 " nodes abandoned",
+                    mStatistics.unresponsive, mStatistics.reboots, mStatistics.sessionsLost, mStatistics.reproducers,
+                    mStatistics.recoveries, mStatistics.downtime.count(), mStatistics.abandoned);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "../DeviceStateManager.h"
+#include "../ForwardDeclarations.h"
+#include "SessionPool.h"
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+enum class LivenessEvent : uint8_t
+{
+    // The node stopped answering the requests sent to it.
+    kUnresponsive,
+    // The node announced a new boot, through its StartUp event or its GeneralDiagnostics attributes.
+    kRebooted,
+    // MRP gave up on a message of the session with the node.
+    kSessionLost,
+};
+
+struct LivenessStatistics
+{
+    uint64_t unresponsive = 0;
+    uint64_t reboots      = 0;
+    uint64_t sessionsLost = 0;
+    uint64_t reproducers  = 0;
+    uint64_t recoveries   = 0;
+    // Nodes which stayed down for longer than kMaxDowntime, and were left out of the rest of the campaign.
+    uint64_t abandoned = 0;
+    // Time spent waiting for the nodes to come back.
+    chip::System::Clock::Milliseconds64 downtime{ 0 };
+};
+
+/**
+ * @brief Tells when a target node goes down during a campaign, captures a reproducer of what brought it down and brings the
+ * campaign back to it once it answers again.
+ *
+ * A node is down once it times out on kMaxConsecutiveTimeouts requests in a row, reboots, or loses its session. Nothing should
+ * be sent to it from then on: the first Recover call writes a reproducer bundle, then every call probes the node by establishing
+ * a new CASE session, backing off exponentially, until the node answers or has been down for kMaxDowntime.
+ *
+ * A reproducer bundle is a directory named after the time, the node and the event, holding:
+ *  - history: the last test cases of the command history, one per line, oldest first;
+ *  - state.snapshot: the device state when the node went down, see DeviceStateManager::Snapshot;
+ *  - reason: the event which brought the node down and the indices of the test cases in the command history.
+ *
+ * The On* notifications may come from any thread, usually the Matter one. The other methods are meant to be called from the
+ * fuzzing thread, which is also the only one appending to the command history.
+ */
+class LivenessMonitor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param history Command history of the campaign, the last depth test cases are saved in the reproducers.
+     * @param directory Directory the reproducer bundles are written to.
+     */
+    LivenessMonitor(SessionPool & sessions, DeviceStateManager & deviceState, const std::vector<std::string> & history,
+                    fs::path directory, size_t depth = kDefaultDepth) :
+        mSessions(sessions), mDeviceState(deviceState), mHistory(history), mDirectory(std::move(directory)), mDepth(depth)
+    {}
+    ~LivenessMonitor() { Stop(); }
+
+    /**
+     * @brief Registers the monitor with the Fuzzer and the SessionPool, whose notifications it receives until it is stopped.
+     */
+    void Start();
+    void Stop();
+
+    /////////// Any thread /////////
+    // The node answered a request, or reported data on its own.
+    void OnAnswer(chip::NodeId node);
+    // A request to the node timed out, or no session could be established with it.
+    void OnTimeout(chip::NodeId node);
+    /**
+     * @param detail Static string describing what showed the event, saved in the reproducer.
+     */
+    void OnEvent(chip::NodeId node, LivenessEvent event, const char * detail);
+
+    /////////// Fuzzing thread /////////
+    bool IsDown(chip::NodeId node);
+
+    /**
+     * @brief Brings a node which is down back to the campaign, without blocking for longer than a probe.
+     *
+     * @param nextProbe Set to the time of the next probe when the node is still down.
+     * @return CHIP_NO_ERROR once the node answers again, CHIP_ERROR_BUSY while it is still down, and
+     *         CHIP_FUZZER_ERROR_NODE_UNRESPONSIVE once it has been down for kMaxDowntime.
+     */
+    CHIP_ERROR Recover(chip::NodeId node, Clock::time_point & nextProbe);
+
+    /**
+     * @brief Blocks until a node which is down answers again, for the execution modes which only drive one node.
+     */
+    CHIP_ERROR WaitForRecovery(chip::NodeId node);
+
+    void LogStatistics() const;
+
+    static const char * GetEventName(LivenessEvent event);
+
+private:
+    static constexpr size_t kDefaultDepth             = 64;
+    static constexpr uint32_t kMaxConsecutiveTimeouts = 3;
+    static constexpr chip::System::Clock::Timeout kProbeTimeout   = chip::System::Clock::Seconds16(5);
+    static constexpr chip::System::Clock::Timeout kInitialBackoff = chip::System::Clock::Milliseconds32(500);
+    static constexpr chip::System::Clock::Timeout kMaxBackoff     = chip::System::Clock::Seconds16(30);
+    static constexpr chip::System::Clock::Timeout kMaxDowntime    = chip::System::Clock::Seconds16(600);
+
+    struct NodeLiveness
+    {
+        uint32_t consecutiveTimeouts = 0;
+        bool down                    = false;
+        bool captured                = false;
+        bool abandoned               = false;
+        LivenessEvent event          = LivenessEvent::kUnresponsive;
+        const char * detail          = nullptr;
+        Clock::time_point downSince;
+        Clock::time_point nextProbe;
+        chip::System::Clock::Timeout backoff = kInitialBackoff;
+    };
+
+    SessionPool & mSessions;
+    DeviceStateManager & mDeviceState;
+    const std::vector<std::string> & mHistory;
+    fs::path mDirectory;
+    size_t mDepth;
+    bool mStarted = false;
+
+    // Shared between the fuzzing and the Matter threads.
+    std::unordered_map<chip::NodeId, NodeLiveness> mNodes;
+    LivenessStatistics mStatistics;
+    mutable std::mutex mMutex;
+
+    // Called with mMutex held.
+    void MarkDown(chip::NodeId node, NodeLiveness & liveness, LivenessEvent event, const char * detail);
+    // Writes the reproducer bundle of a node which went down.
+    CHIP_ERROR Capture(chip::NodeId node, LivenessEvent event, const char * detail);
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,262 @@
+#include "Minimizer.h"
+#include <algorithm>
+#include <inttypes.h>
+#include <lib/core/TLV.h>
+#include <numeric>
+#include <thread>
+
+namespace exec = chip::fuzzing::execution;
+namespace gen  = chip::fuzzing::generation;
+
+namespace {
+size_t GetPayloadBytes(const std::vector<gen::GeneratedCommand> & testCases)
+{
+    return std::accumulate(testCases.begin(), testCases.end(), size_t(0),
+                           [](size_t total, const gen::GeneratedCommand & testCase) { return total + testCase.payloadLength; });
+}
+
+// Splits the units into granularity chunks of balanced sizes, keeping their order.
+std::vector<std::vector<size_t>> Split(const std::vector<size_t> & units, size_t granularity)
+{
+    std::vector<std::vector<size_t>> chunks;
+    for (size_t i = 0; i < granularity; i++)
+    {
+        auto first = units.begin() + static_cast<std::ptrdiff_t>(i * units.size() / granularity);
+        auto last  = units.begin() + static_cast<std::ptrdiff_t>((i + 1) * units.size() / granularity);
+        chunks.emplace_back(first, last);
+    }
+    return chunks;
+}
+
+std::vector<size_t> Complement(const std::vector<std::vector<size_t>> & chunks, size_t excluded)
+{
+    std::vector<size_t> complement;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (i != excluded)
+        {
+            complement.insert(complement.end(), chunks[i].begin(), chunks[i].end());
+        }
+    }
+    return complement;
+}
+} // namespace
+
+CHIP_ERROR exec::Minimizer::CountMembers(const gen::GeneratedCommand & testCase, size_t & count)
+{
+    chip::TLV::TLVReader reader;
+    reader.Init(testCase.GetPayload());
+    ReturnErrorOnFailure(reader.Next());
+    VerifyOrReturnError(chip::TLV::TLVTypeIsContainer(reader.GetType()), CHIP_ERROR_WRONG_TLV_TYPE);
+
+    chip::TLV::TLVType container;
+    ReturnErrorOnFailure(reader.EnterContainer(container));
+    count = 0;
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        count++;
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    return reader.ExitContainer(container);
+}
+
+CHIP_ERROR exec::Minimizer::SelectMembers(const gen::GeneratedCommand & testCase, const std::vector<size_t> & members,
+                                          gen::GeneratedCommand & out)
+{
+    chip::TLV::TLVReader reader;
+    reader.Init(testCase.GetPayload());
+    ReturnErrorOnFailure(reader.Next());
+    VerifyOrReturnError(chip::TLV::TLVTypeIsContainer(reader.GetType()), CHIP_ERROR_WRONG_TLV_TYPE);
+
+    out.kind          = testCase.kind;
+    out.path          = testCase.path;
+    out.attributePath = testCase.attributePath;
+
+    chip::TLV::TLVWriter writer;
+    writer.Init(out.payload, sizeof(out.payload));
+    chip::TLV::TLVType readerContainer;
+    chip::TLV::TLVType writerContainer;
+    ReturnErrorOnFailure(writer.StartContainer(reader.GetTag(), reader.GetType(), writerContainer));
+    ReturnErrorOnFailure(reader.EnterContainer(readerContainer));
+
+    auto next    = members.begin();
+    size_t index = 0;
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR && next != members.end())
+    {
+        if (*next == index)
+        {
+            ReturnErrorOnFailure(writer.CopyElement(reader));
+            ++next;
+        }
+        index++;
+    }
+    VerifyOrReturnError(err == CHIP_NO_ERROR || err == CHIP_END_OF_TLV, err);
+    ReturnErrorOnFailure(writer.EndContainer(writerContainer));
+    ReturnErrorOnFailure(writer.Finalize());
+    out.payloadLength = writer.GetLengthWritten();
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::Minimizer::Minimize(std::vector<gen::GeneratedCommand> & testCases)
+{
+    mStatistics                 = MinimizationStatistics();
+    mStatistics.testCasesBefore = testCases.size();
+    mStatistics.bytesBefore     = GetPayloadBytes(testCases);
+    VerifyOrReturnError(!testCases.empty(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    std::vector<size_t> units(testCases.size());
+    std::iota(units.begin(), units.end(), 0);
+    Build sequence = [&testCases](const std::vector<size_t> & kept, std::vector<gen::GeneratedCommand> & out) {
+        out.clear();
+        for (size_t unit : kept)
+        {
+            out.push_back(testCases[unit]);
+        }
+        return CHIP_NO_ERROR;
+    };
+
+    // The trials of the devices are only comparable if all of them go down with the whole sequence.
+    std::vector<gen::GeneratedCommand> whole;
+    ReturnErrorOnFailure(sequence(units, whole));
+    std::vector<uint8_t> reproduced;
+    ReturnErrorOnFailure(RunTrials(std::vector<std::vector<gen::GeneratedCommand>>(mWorkers, whole), reproduced));
+    for (size_t worker = 0; worker < mWorkers; worker++)
+    {
+        if (!reproduced[worker])
+        {
+            ChipLogError(chipFuzzer, "Device #%u did not go down with the whole sequence", static_cast<unsigned>(worker));
+            return CHIP_FUZZER_ERROR_NOT_REPRODUCED;
+        }
+    }
+
+    ReturnErrorOnFailure(Reduce(units, sequence));
+    std::vector<gen::GeneratedCommand> reduced;
+    ReturnErrorOnFailure(sequence(units, reduced));
+    testCases = std::move(reduced);
+    ChipLogProgress(chipFuzzer, "Reduced the sequence to %u test cases", static_cast<unsigned>(testCases.size()));
+
+    for (size_t target = 0; target < testCases.size(); target++)
+    {
+        size_t count = 0;
+        if (CHIP_NO_ERROR != CountMembers(testCases[target], count) || count < 2)
+            continue;
+
+        std::vector<size_t> members(count);
+        std::iota(members.begin(), members.end(), 0);
+        Build payload = [&testCases, target](const std::vector<size_t> & kept, std::vector<gen::GeneratedCommand> & out) {
+            out = testCases;
+            return SelectMembers(testCases[target], kept, out[target]);
+        };
+        ReturnErrorOnFailure(Reduce(members, payload));
+        ReturnErrorOnFailure(payload(members, reduced));
+        testCases = std::move(reduced);
+    }
+
+    mStatistics.testCasesAfter = testCases.size();
+    mStatistics.bytesAfter     = GetPayloadBytes(testCases);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::Minimizer::Reduce(std::vector<size_t> & units, const Build & build)
+{
+    size_t granularity = 2;
+    while (units.size() >= 2)
+    {
+        granularity = std::min(granularity, units.size());
+        std::vector<std::vector<size_t>> chunks     = Split(units, granularity);
+        std::vector<std::vector<size_t>> candidates = chunks;
+        // With two chunks, the complement of each one is the other.
+        for (size_t i = 0; granularity > 2 && i < chunks.size(); i++)
+        {
+            candidates.push_back(Complement(chunks, i));
+        }
+
+        size_t failing;
+        ReturnErrorOnFailure(RunRound(candidates, build, failing));
+        if (failing < chunks.size())
+        {
+            units       = candidates[failing];
+            granularity = 2;
+        }
+        else if (failing < candidates.size())
+        {
+            units       = candidates[failing];
+            granularity = std::max<size_t>(granularity - 1, 2);
+        }
+        else if (granularity == units.size())
+        {
+            break;
+        }
+        else
+        {
+            granularity = std::min(granularity * 2, units.size());
+        }
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::Minimizer::RunRound(const std::vector<std::vector<size_t>> & candidates, const Build & build, size_t & failing)
+{
+    failing = candidates.size();
+    for (size_t first = 0; first < candidates.size(); first += mWorkers)
+    {
+        size_t count = std::min(mWorkers, candidates.size() - first);
+        std::vector<std::vector<gen::GeneratedCommand>> sequences(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            ReturnErrorOnFailure(build(candidates[first + i], sequences[i]));
+        }
+
+        std::vector<uint8_t> reproduced;
+        ReturnErrorOnFailure(RunTrials(sequences, reproduced));
+        auto found = std::find(reproduced.begin(), reproduced.end(), 1);
+        if (found != reproduced.end())
+        {
+            failing = first + static_cast<size_t>(found - reproduced.begin());
+            return CHIP_NO_ERROR;
+        }
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::Minimizer::RunTrials(const std::vector<std::vector<gen::GeneratedCommand>> & sequences,
+                                      std::vector<uint8_t> & reproduced)
+{
+    VerifyOrReturnError(sequences.size() <= mWorkers, CHIP_ERROR_INVALID_ARGUMENT);
+    std::vector<CHIP_ERROR> errors(sequences.size(), CHIP_NO_ERROR);
+    reproduced.assign(sequences.size(), 0);
+
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < sequences.size(); worker++)
+    {
+        workers.emplace_back([&, worker] {
+            bool failed        = false;
+            errors[worker]     = mTrial(worker, sequences[worker], failed);
+            reproduced[worker] = failed;
+        });
+    }
+    for (auto & worker : workers)
+    {
+        worker.join();
+    }
+
+    for (size_t worker = 0; worker < sequences.size(); worker++)
+    {
+        ReturnErrorOnFailure(errors[worker]);
+        mStatistics.trials++;
+        mStatistics.reproduced += reproduced[worker];
+    }
+    return CHIP_NO_ERROR;
+}
+
+void exec::Minimizer::LogStatistics() const
+{
+    ChipLogProgress(chipFuzzer,
+                    "Minimization statistics: %" PRIu64 " trials (%" PRIu64 " reproduced), %u test cases reduced to %u, %u "
+                    "payload bytes reduced to %u",
+                    mStatistics.trials, mStatistics.reproduced, static_cast<unsigned>(mStatistics.testCasesBefore),
+                    static_cast<unsigned>(mStatistics.testCasesAfter), static_cast<unsigned>(mStatistics.bytesBefore),
+                    static_cast<unsigned>(mStatistics.bytesAfter));
+}
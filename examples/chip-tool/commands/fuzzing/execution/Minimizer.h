@@ -0,0 +1,97 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "../generation/CommandGenerator.h"
+#include <functional>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+struct MinimizationStatistics
+{
+    uint64_t trials        = 0;
+    uint64_t reproduced    = 0;
+    size_t testCasesBefore = 0;
+    size_t testCasesAfter  = 0;
+    // Payload bytes of all the test cases.
+    size_t bytesBefore = 0;
+    size_t bytesAfter  = 0;
+};
+
+/**
+ * @brief Reduces a sequence of test cases which brings a device down to a minimal one, with delta debugging (ddmin).
+ *
+ * The sequence is first reduced test case wise, then the top-level elements of the payload of every remaining test case are
+ * reduced the same way, a payload which is not a TLV container being kept as is. The result is 1-minimal with respect to the
+ * reduced units: removing any single test case, or any single element of a payload, no longer reproduces the failure.
+ *
+ * The candidates of a ddmin round are run as trials on several identical devices at once, one trial per device at a time. The
+ * first candidate in ddmin order which reproduces the failure is kept, whichever device completes first, so that the outcome
+ * only depends on the trials.
+ */
+class Minimizer
+{
+public:
+    /**
+     * @brief Runs a candidate sequence on a device, which must be brought back to its initial state beforehand.
+     *
+     * Called from one thread per device at once.
+     *
+     * @param worker Index of the device, below the number of workers.
+     * @param reproduced Set to whether the device went down.
+     * @return An error if the trial could not be run, which aborts the minimization.
+     */
+    using Trial =
+        std::function<CHIP_ERROR(size_t worker, const std::vector<generation::GeneratedCommand> & testCases, bool & reproduced)>;
+
+    Minimizer(size_t workers, Trial trial) : mWorkers(std::max<size_t>(workers, 1)), mTrial(std::move(trial)) {}
+
+    /**
+     * @brief Checks that the sequence reproduces the failure on every device, then reduces it in place.
+     *
+     * @return CHIP_FUZZER_ERROR_NOT_REPRODUCED if a device does not go down with the whole sequence.
+     */
+    CHIP_ERROR Minimize(std::vector<generation::GeneratedCommand> & testCases);
+
+    const MinimizationStatistics & GetStatistics() const { return mStatistics; }
+    void LogStatistics() const;
+
+    /**
+     * @brief Counts the top-level elements of a payload.
+     * @return CHIP_ERROR_WRONG_TLV_TYPE if the payload is not a container.
+     */
+    static CHIP_ERROR CountMembers(const generation::GeneratedCommand & testCase, size_t & count);
+
+    /**
+     * @brief Copies a test case, keeping only some of the top-level elements of its payload.
+     *
+     * @param members Indices of the elements kept, in increasing order.
+     */
+    static CHIP_ERROR SelectMembers(const generation::GeneratedCommand & testCase, const std::vector<size_t> & members,
+                                    generation::GeneratedCommand & out);
+
+private:
+    // Builds the candidate sequence holding a subset of the units being reduced.
+    using Build = std::function<CHIP_ERROR(const std::vector<size_t> & units, std::vector<generation::GeneratedCommand> & out)>;
+
+    size_t mWorkers;
+    Trial mTrial;
+    MinimizationStatistics mStatistics;
+
+    // Runs ddmin over the units, which are reduced in place.
+    CHIP_ERROR Reduce(std::vector<size_t> & units, const Build & build);
+
+    /**
+     * @brief Runs the candidates, up to one per worker at a time, until one of them reproduces the failure.
+     *
+     * @param failing Set to the index of the first candidate which reproduced the failure, or to the number of candidates.
+     */
+    CHIP_ERROR RunRound(const std::vector<std::vector<size_t>> & candidates, const Build & build, size_t & failing);
+    // Runs the trials of the sequences at once, the i-th sequence on the i-th device.
+    CHIP_ERROR RunTrials(const std::vector<std::vector<generation::GeneratedCommand>> & sequences,
+                         std::vector<uint8_t> & reproduced);
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,379 @@
+#include "PipelinedSender.h"
+#include "../Fuzzing.h"
+#include <algorithm>
+#include <app/InteractionModelEngine.h>
+#include <inttypes.h>
+#include <platform/PlatformManager.h>
+
+namespace fuzz = chip::fuzzing;
+namespace exec = chip::fuzzing::execution;
+using chip::Protocols::InteractionModel::MsgType;
+using chip::Protocols::InteractionModel::Status;
+
+namespace {
+// Extra time granted to the Matter stack to report the outcome of the in-flight exchanges before giving up on them.
+constexpr chip::System::Clock::Timeout kCompletionGracePeriod = chip::System::Clock::Seconds16(5);
+
+bool IsBusy(CHIP_ERROR error)
+{
+    return error == CHIP_ERROR_BUSY || (error.IsIMStatus() && chip::app::StatusIB(error).mStatus == Status::Busy);
+}
+} // namespace
+
+exec::PipelinedSender::PipelinedSender(SessionPool & sessions, chip::NodeId node, uint16_t maxWindow,
+                                       ExchangeListener * listener) :
+    mSessions(sessions), mNode(node), mMaxWindow(maxWindow ? maxWindow : 1), mListener(listener)
+{
+    mSlots.reserve(mMaxWindow);
+    mFreeSlots.reserve(mMaxWindow);
+    for (uint16_t i = 0; i < mMaxWindow; i++)
+    {
+        mSlots.push_back(std::make_unique<Slot>(*this));
+        mFreeSlots.push_back(mSlots.back().get());
+    }
+}
+
+exec::PipelinedSender::~PipelinedSender()
+{
+    // The slots are the callbacks of the in-flight exchanges, they cannot go away before them.
+    CHIP_ERROR err = Drain();
+    VerifyOrReturn(err != CHIP_NO_ERROR);
+
+    chip::DeviceLayer::StackLock stackLock;
+    std::lock_guard<std::mutex> lock(mMutex);
+    ChipLogError(chipFuzzer, "Aborting %u exchanges still in flight with node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                 mInFlight, ChipLogValueX64(mNode), err.Format());
+    for (auto & slot : mSlots)
+    {
+        if (std::find(mFreeSlots.begin(), mFreeSlots.end(), slot.get()) != mFreeSlots.end())
+        {
+            continue;
+        }
+        if (!slot->Abort())
+        {
+            // Owned by its pending SendWork from now on.
+            slot.release();
+        }
+    }
+}
+
+CHIP_ERROR exec::PipelinedSender::Submit(const generation::GeneratedCommand & testCase, size_t input)
+{
+    // The LivenessMonitor evicts the session of a node which stopped answering, and establishes a new one once it is back.
+    ReturnErrorOnFailure(mSessions.Connect(mNode));
+
+    Slot * slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        VerifyOrReturnError(mInFlight < mWindow, CHIP_ERROR_BUSY);
+
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        mInFlight++;
+        mStatistics.sent++;
+    }
+
+    // The slot is not reachable from the Matter thread until the work is scheduled.
+    slot->mTestCase = testCase;
+    slot->mInput    = input;
+    mSessions.CountIteration();
+
+    CHIP_ERROR err = chip::DeviceLayer::PlatformMgr().ScheduleWork(Slot::SendWork, reinterpret_cast<intptr_t>(slot));
+    if (err != CHIP_NO_ERROR)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFreeSlots.push_back(slot);
+        mInFlight--;
+    }
+    return err;
+}
+
+bool exec::PipelinedSender::HasCapacity()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mInFlight < mWindow;
+}
+
+CHIP_ERROR exec::PipelinedSender::WaitForCapacity()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto waitTime = std::chrono::milliseconds((kExchangeTimeout + kCompletionGracePeriod).count());
+    VerifyOrReturnError(mCondition.wait_for(lock, waitTime, [this] { return mInFlight < mWindow; }), CHIP_ERROR_TIMEOUT);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR exec::PipelinedSender::Drain()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto waitTime = std::chrono::milliseconds((kExchangeTimeout + kCompletionGracePeriod).count());
+    VerifyOrReturnError(mCondition.wait_for(lock, waitTime, [this] { return mInFlight == 0; }), CHIP_ERROR_TIMEOUT);
+    return CHIP_NO_ERROR;
+}
+
+void exec::PipelinedSender::OnSlotDone(Slot * slot, const ExchangeOutcome & outcome)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        bool busy     = outcome.busy;
+        bool timedOut = (outcome.error == CHIP_ERROR_TIMEOUT);
+
+        if (busy || timedOut)
+        {
+            // Multiplicative decrease: the device is saturated, or the messages get lost.
+            mStatistics.busy += busy ? 1 : 0;
+            mStatistics.timeouts += timedOut ? 1 : 0;
+            mWindow           = static_cast<uint16_t>(std::max(1, mWindow / 2));
+            mCleanCompletions = 0;
+        }
+        else if (++mCleanCompletions >= mWindow && mWindow < mMaxWindow)
+        {
+            // Additive increase, once per window worth of clean exchanges.
+            mWindow++;
+            mCleanCompletions      = 0;
+            mStatistics.peakWindow = std::max(mStatistics.peakWindow, mWindow);
+        }
+
+        mFreeSlots.push_back(slot);
+        mInFlight--;
+    }
+    mCondition.notify_all();
+
+    // The listener is called last, so that the slot is already available if it submits a new test case.
+    if (mListener != nullptr)
+    {
+        mListener->OnExchangeDone(mNode, outcome);
+    }
+}
+
+uint16_t exec::PipelinedSender::GetWindow() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWindow;
+}
+
+exec::PipelineStatistics exec::PipelinedSender::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStatistics;
+}
+
+void exec::PipelinedSender::LogStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ChipLogProgress(chipFuzzer,
+                    "Pipeline statistics: %" PRIu64 " exchanges, %" PRIu64 " busy, %" PRIu64 " timeouts, window %u (peak %u, "
+                    "max %u)",
+                    mStatistics.sent, mStatistics.busy, mStatistics.timeouts, mWindow, mStatistics.peakWindow, mMaxWindow);
+}
+
+void exec::PipelinedSender::Slot::SendWork(intptr_t context)
+{
+    auto * slot = reinterpret_cast<Slot *>(context);
+    if (slot->mDetached)
+    {
+        // The sender was destroyed before the exchange could be sent.
+        delete slot;
+        return;
+    }
+
+    slot->mBusy    = false;
+    slot->mError   = CHIP_NO_ERROR;
+    slot->mStatus  = chip::app::StatusIB();
+    fuzz::Fuzzer::GetInstance()->GetSignatureRecorder().Begin(slot->mSender.mNode, slot->mInput);
+    CHIP_ERROR err = slot->Send();
+    if (err != CHIP_NO_ERROR)
+    {
+        // OnDone is only called after a successful send, so the slot must be released here.
+        ChipLogError(chipFuzzer, "Failed to send input #%zu: %" CHIP_ERROR_FORMAT, slot->mInput, err.Format());
+        slot->mError = err;
+        slot->Finish();
+    }
+}
+
+CHIP_ERROR exec::PipelinedSender::Slot::Send()
+{
+    auto session = mSender.mSessions.GetSession(mSender.mNode);
+    VerifyOrReturnError(session.HasValue(), CHIP_ERROR_NOT_CONNECTED);
+
+    switch (mTestCase.kind)
+    {
+    case generation::RequestKind::kInvoke:
+        return SendInvoke(session.Value());
+    case generation::RequestKind::kRead:
+        return SendRead(session.Value());
+    case generation::RequestKind::kWrite:
+        return SendWrite(session.Value());
+    }
+    return CHIP_ERROR_INVALID_ARGUMENT;
+}
+
+CHIP_ERROR exec::PipelinedSender::Slot::SendInvoke(const chip::SessionHandle & session)
+{
+    const auto & path = mTestCase.path;
+    chip::app::CommandPathParams commandPath(path.endpoint, 0 /* group */, path.cluster, path.command,
+                                             chip::app::CommandPathFlags::kEndpointIdValid);
+    chip::app::CommandSender::AddRequestDataParameters params;
+    RawPayloadEncodable payload(mTestCase.GetPayload());
+
+    mCommandSender = std::make_unique<chip::app::CommandSender>(this, mSender.mSessions.GetExchangeManager(), false /* timed */,
+                                                                false /* suppressResponse */, session->AllowsLargePayload());
+    ReturnErrorOnFailure(mCommandSender->AddRequestData(commandPath, payload, params));
+    return mCommandSender->SendCommandRequest(session, chip::MakeOptional(kExchangeTimeout));
+}
+
+CHIP_ERROR exec::PipelinedSender::Slot::SendRead(const chip::SessionHandle & session)
+{
+    const auto & path    = mTestCase.attributePath;
+    mAttributePathParams = chip::app::AttributePathParams(path.endpoint, path.cluster, path.attribute);
+
+    chip::app::ReadPrepareParams params(session);
+    params.mpAttributePathParamsList    = &mAttributePathParams;
+    params.mAttributePathParamsListSize = 1;
+    params.mTimeout                     = kExchangeTimeout;
+
+    mReadClient = std::make_unique<chip::app::ReadClient>(chip::app::InteractionModelEngine::GetInstance(),
+                                                          mSender.mSessions.GetExchangeManager(), *this,
+                                                          chip::app::ReadClient::InteractionType::Read);
+    return mReadClient->SendRequest(params);
+}
+
+CHIP_ERROR exec::PipelinedSender::Slot::SendWrite(const chip::SessionHandle & session)
+{
+    const auto & path = mTestCase.attributePath;
+    chip::TLV::TLVReader reader;
+    reader.Init(mTestCase.GetPayload());
+    ReturnErrorOnFailure(reader.Next());
+
+    mWriteClient = std::make_unique<chip::app::WriteClient>(mSender.mSessions.GetExchangeManager(), this, chip::NullOptional);
+    ReturnErrorOnFailure(mWriteClient->PutPreencodedAttribute(
+        chip::app::ConcreteDataAttributePath(path.endpoint, path.cluster, path.attribute), reader));
+    return mWriteClient->SendWriteRequest(session, kExchangeTimeout);
+}
+
+bool exec::PipelinedSender::Slot::Abort()
+{
+    if (!mCommandSender && !mReadClient && !mWriteClient)
+    {
+        mDetached = true;
+        return false;
+    }
+
+    // Destroying the clients closes their exchanges, without calling back the slot.
+    mCommandSender.reset();
+    mReadClient.reset();
+    mWriteClient.reset();
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    fuzzer->ClearCurrentInput();
+    fuzzer->GetSignatureRecorder().End(mInput);
+    return true;
+}
+
+void exec::PipelinedSender::Slot::Observe(const chip::app::StatusIB & status)
+{
+    mBusy = mBusy || status.mStatus == Status::Busy;
+    if (mStatus.IsSuccess())
+    {
+        mStatus = status;
+    }
+    fuzz::Fuzzer::GetInstance()->SetCurrentInput(mSender.mNode, mInput);
+}
+
+void exec::PipelinedSender::Slot::Finish()
+{
+    mCommandSender.reset();
+    mReadClient.reset();
+    mWriteClient.reset();
+
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    fuzzer->ClearCurrentInput();
+    // Local failures never reach the analysis, they are part of the signature nonetheless.
+    auto & recorder  = fuzzer->GetSignatureRecorder();
+    auto * signature = recorder.Find(mSender.mNode, chip::MakeOptional(mInput));
+    if (signature != nullptr && mError != CHIP_NO_ERROR)
+    {
+        signature->AddError(mError);
+    }
+
+    ExchangeOutcome outcome;
+    outcome.kind = mTestCase.kind;
+    if (mTestCase.kind == generation::RequestKind::kInvoke)
+    {
+        outcome.endpoint = mTestCase.path.endpoint;
+        outcome.cluster  = mTestCase.path.cluster;
+        outcome.id       = mTestCase.path.command;
+    }
+    else
+    {
+        outcome.endpoint = mTestCase.attributePath.endpoint;
+        outcome.cluster  = mTestCase.attributePath.cluster;
+        outcome.id       = mTestCase.attributePath.attribute;
+    }
+    outcome.input     = mInput;
+    outcome.status    = mStatus;
+    outcome.error     = mError;
+    outcome.busy      = mBusy || IsBusy(mError);
+    outcome.signature = recorder.End(mInput);
+    mSender.OnSlotDone(this, outcome);
+}
+
+void exec::PipelinedSender::Slot::OnResponse(chip::app::CommandSender * client, const chip::app::ConcreteCommandPath & path,
+                                             const chip::app::StatusIB & status, chip::TLV::TLVReader * data)
+{
+    Observe(status);
+    fuzz::Fuzzer::GetInstance()->AnalyzeCommandResponse(data, path, status);
+}
+
+void exec::PipelinedSender::Slot::OnError(const chip::app::CommandSender * client, CHIP_ERROR error)
+{
+    mError = error;
+    fuzz::Fuzzer::GetInstance()->SetCurrentInput(mSender.mNode, mInput);
+    fuzz::Fuzzer::GetInstance()->AnalyzeCommandError(MsgType::InvokeCommandResponse, error);
+}
+
+void exec::PipelinedSender::Slot::OnDone(chip::app::CommandSender * client)
+{
+    Finish();
+}
+
+void exec::PipelinedSender::Slot::OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,
+                                                  const chip::app::StatusIB & status)
+{
+    Observe(status);
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    fuzzer->AnalyzeReportData(data, path, status);
+    if (!status.IsSuccess())
+    {
+        fuzzer->AnalyzeReportError(path, status);
+    }
+}
+
+void exec::PipelinedSender::Slot::OnError(CHIP_ERROR error)
+{
+    mError = error;
+    fuzz::Fuzzer::GetInstance()->SetCurrentInput(mSender.mNode, mInput);
+    fuzz::Fuzzer::GetInstance()->AnalyzeCommandError(MsgType::ReportData, error);
+}
+
+void exec::PipelinedSender::Slot::OnDone(chip::app::ReadClient * client)
+{
+    Finish();
+}
+
+void exec::PipelinedSender::Slot::OnResponse(const chip::app::WriteClient * client,
+                                             const chip::app::ConcreteDataAttributePath & path, chip::app::StatusIB status)
+{
+    Observe(status);
+    fuzz::Fuzzer::GetInstance()->AnalyzeReportData(nullptr, path, status);
+}
+
+void exec::PipelinedSender::Slot::OnError(const chip::app::WriteClient * client, CHIP_ERROR error)
+{
+    mError = error;
+    fuzz::Fuzzer::GetInstance()->SetCurrentInput(mSender.mNode, mInput);
+    fuzz::Fuzzer::GetInstance()->AnalyzeCommandError(MsgType::WriteResponse, error);
+}
+
+void exec::PipelinedSender::Slot::OnDone(chip::app::WriteClient * client)
+{
+    Finish();
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "../generation/CommandGenerator.h"
+#include "SessionPool.h"
+#include <app/CommandSender.h>
+#include <app/ReadClient.h>
+#include <app/WriteClient.h>
+#include <app/data-model/EncodableToTLV.h>
+#include <condition_variable>
+#include <mutex>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+/**
+ * @brief Encodes an already TLV-encoded payload as the CommandFields of a CommandDataIB.
+ */
+class RawPayloadEncodable : public chip::app::DataModel::EncodableToTLV
+{
+public:
+    RawPayloadEncodable(chip::ByteSpan payload) : mPayload(payload) {}
+
+    CHIP_ERROR EncodeTo(chip::TLV::TLVWriter & writer, chip::TLV::Tag tag) const override
+    {
+        chip::TLV::TLVReader reader;
+        reader.Init(mPayload);
+        ReturnErrorOnFailure(reader.Next());
+        return writer.CopyElement(tag, reader);
+    }
+
+private:
+    chip::ByteSpan mPayload;
+};
+
+/**
+ * @brief What the sender observed about a completed exchange, reported to the ExchangeListener.
+ */
+struct ExchangeOutcome
+{
+    generation::RequestKind kind;
+    chip::EndpointId endpoint;
+    chip::ClusterId cluster;
+    // Command or attribute identifier, depending on the kind.
+    uint32_t id;
+    size_t input;
+    // First non-success status reported on a path, or success.
+    chip::app::StatusIB status;
+    CHIP_ERROR error;
+    bool busy;
+    // Hash of the response signature collected by the Fuzzer while the exchange was open.
+    uint64_t signature;
+};
+
+class ExchangeListener
+{
+public:
+    virtual ~ExchangeListener() = default;
+
+    /**
+     * @brief Called on the Matter thread once an exchange is complete and its slot is available again.
+     */
+    virtual void OnExchangeDone(chip::NodeId node, const ExchangeOutcome & outcome) = 0;
+};
+
+struct PipelineStatistics
+{
+    uint64_t sent     = 0;
+    uint64_t busy     = 0;
+    uint64_t timeouts = 0;
+    // Largest window reached during the campaign.
+    uint16_t peakWindow = 1;
+};
+
+/**
+ * @brief Keeps up to a window of invoke, read and write exchanges in flight with a node.
+ *
+ * Every in-flight exchange owns a slot, which holds a copy of the test case and the index of its entry in the command history.
+ * The slot is the callback of its own CommandSender, ReadClient or WriteClient, so each response is attributed to the exact
+ * input which caused it: the Fuzzer current input is set before every Analyze call.
+ *
+ * The window adapts to the device: it grows by one after a full window of exchanges completes cleanly, and it is halved every
+ * time the device reports Busy or an exchange times out. With a maximum window of 1 the sender is strictly sequential.
+ *
+ * Submit, WaitForCapacity and Drain are meant to be called from the fuzzing thread: the exchanges are started on the Matter event
+ * loop.
+ */
+class PipelinedSender
+{
+public:
+    PipelinedSender(SessionPool & sessions, chip::NodeId node, uint16_t maxWindow, ExchangeListener * listener = nullptr);
+    ~PipelinedSender();
+
+    /**
+     * @brief Tells whether the window has room for another exchange.
+     */
+    bool HasCapacity();
+
+    /**
+     * @brief Starts the exchange for a test case.
+     *
+     * Returns CHIP_ERROR_BUSY without sending anything if the window is full: the caller is expected to wait for an exchange to
+     * complete, either through the ExchangeListener or with WaitForCapacity.
+     *
+     * @param input Index of the test case in the command history.
+     */
+    CHIP_ERROR Submit(const generation::GeneratedCommand & testCase, size_t input);
+
+    /**
+     * @brief Blocks until the window has room for another exchange.
+     */
+    CHIP_ERROR WaitForCapacity();
+
+    /**
+     * @brief Waits for every in-flight exchange to complete.
+     */
+    CHIP_ERROR Drain();
+
+    // Safe to call from any thread: the window and the statistics are updated by the responses, on the Matter thread.
+    uint16_t GetWindow() const;
+    PipelineStatistics GetStatistics() const;
+    void LogStatistics() const;
+
+private:
+    static constexpr chip::System::Clock::Timeout kExchangeTimeout = chip::System::Clock::Seconds16(10);
+
+    class Slot : public chip::app::CommandSender::Callback,
+                 public chip::app::ReadClient::Callback,
+                 public chip::app::WriteClient::Callback
+    {
+    public:
+        Slot(PipelinedSender & sender) : mSender(sender) {}
+
+        generation::GeneratedCommand mTestCase;
+        size_t mInput = 0;
+
+        static void SendWork(intptr_t context);
+
+        /**
+         * @brief Drops the exchange of the slot without reporting it, aborting it if it was sent. Must be called with the Matter
+         * stack locked.
+         *
+         * Returns false if the exchange was not sent yet: the slot is then detached from the sender and its pending SendWork
+         * deletes it instead of sending.
+         */
+        bool Abort();
+
+        /////////// CommandSender Callback Interface /////////
+        void OnResponse(chip::app::CommandSender * client, const chip::app::ConcreteCommandPath & path,
+                        const chip::app::StatusIB & status, chip::TLV::TLVReader * data) override;
+        void OnError(const chip::app::CommandSender * client, CHIP_ERROR error) override;
+        void OnDone(chip::app::CommandSender * client) override;
+
+        /////////// ReadClient Callback Interface /////////
+        void OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,
+                             const chip::app::StatusIB & status) override;
+        void OnError(CHIP_ERROR error) override;
+        void OnDone(chip::app::ReadClient * client) override;
+
+        /////////// WriteClient Callback Interface /////////
+        void OnResponse(const chip::app::WriteClient * client, const chip::app::ConcreteDataAttributePath & path,
+                        chip::app::StatusIB status) override;
+        void OnError(const chip::app::WriteClient * client, CHIP_ERROR error) override;
+        void OnDone(chip::app::WriteClient * client) override;
+
+    private:
+        PipelinedSender & mSender;
+        std::unique_ptr<chip::app::CommandSender> mCommandSender;
+        std::unique_ptr<chip::app::ReadClient> mReadClient;
+        std::unique_ptr<chip::app::WriteClient> mWriteClient;
+        chip::app::AttributePathParams mAttributePathParams;
+
+        bool mBusy        = false;
+        bool mDetached    = false;
+        CHIP_ERROR mError = CHIP_NO_ERROR;
+        chip::app::StatusIB mStatus;
+
+        CHIP_ERROR Send();
+        CHIP_ERROR SendInvoke(const chip::SessionHandle & session);
+        CHIP_ERROR SendRead(const chip::SessionHandle & session);
+        CHIP_ERROR SendWrite(const chip::SessionHandle & session);
+        void Observe(const chip::app::StatusIB & status);
+        void Finish();
+    };
+
+    SessionPool & mSessions;
+    chip::NodeId mNode;
+    uint16_t mMaxWindow;
+    ExchangeListener * mListener;
+
+    // Everything below is shared between the fuzzing and the Matter threads, and is protected by mMutex.
+    std::vector<std::unique_ptr<Slot>> mSlots;
+    std::vector<Slot *> mFreeSlots;
+    uint16_t mInFlight         = 0;
+    uint16_t mWindow           = 1;
+    uint16_t mCleanCompletions = 0;
+    PipelineStatistics mStatistics;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+
+    void OnSlotDone(Slot * slot, const ExchangeOutcome & outcome);
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,268 @@
+#include "SessionPool.h"
+#include "LivenessMonitor.h"
+#include <inttypes.h>
+#include <memory>
+#include <platform/PlatformManager.h>
+
+namespace exec = chip::fuzzing::execution;
+
+namespace {
+// Extra time granted to the Matter stack to report the outcome of a session setup before the fuzzing thread gives up on it.
+constexpr chip::System::Clock::Timeout kCompletionGracePeriod = chip::System::Clock::Seconds16(5);
+} // namespace
+
+exec::SessionPool::~SessionPool()
+{
+    // The sessions are registered in the SessionManager, so they must be released on the Matter thread.
+    LogErrorOnFailure(ScheduleAndWait(nullptr, &SessionPool::ReleaseWork, kDefaultTimeout));
+}
+
+exec::SessionPool::NodeSession & exec::SessionPool::GetOrCreate(chip::NodeId node)
+{
+    // The sessions are only destroyed by ReleaseWork, when the pool goes away, so the reference outlives the lock.
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    auto & session = mSessions[node];
+    if (!session)
+    {
+        session = std::make_unique<NodeSession>(*this, node);
+    }
+    return *session;
+}
+
+bool exec::SessionPool::IsConnected(chip::NodeId node) const
+{
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    auto it = mSessions.find(node);
+    return it != mSessions.end() && it->second->mConnected;
+}
+
+chip::Optional<chip::SessionHandle> exec::SessionPool::GetSession(chip::NodeId node)
+{
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    auto it = mSessions.find(node);
+    VerifyOrReturnValue(it != mSessions.end(), chip::NullOptional);
+    return it->second->mHolder.Get();
+}
+
+void exec::SessionPool::Count(uint64_t SessionStatistics::*counter)
+{
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    mStatistics.*counter += 1;
+}
+
+exec::SessionStatistics exec::SessionPool::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    return mStatistics;
+}
+
+CHIP_ERROR exec::SessionPool::Connect(chip::NodeId node, chip::System::Clock::Timeout timeout)
+{
+    VerifyOrReturnError(!IsConnected(node), CHIP_NO_ERROR);
+
+    NodeSession & session = GetOrCreate(node);
+    session.mConnectError = CHIP_NO_ERROR;
+    ReturnErrorOnFailure(ScheduleAndWait(&session, &SessionPool::ConnectWork, timeout));
+    return session.mConnectError;
+}
+
+void exec::SessionPool::Evict(chip::NodeId node)
+{
+    LogErrorOnFailure(ScheduleAndWait(&GetOrCreate(node), &SessionPool::EvictWork, kDefaultTimeout));
+}
+
+void exec::SessionPool::Observe(chip::NodeId node)
+{
+    LogErrorOnFailure(ScheduleAndWait(&GetOrCreate(node), &SessionPool::ObserveWork, kDefaultTimeout));
+}
+
+CHIP_ERROR exec::SessionPool::ScheduleAndWait(NodeSession * session, WorkHandler handler, chip::System::Clock::Timeout timeout)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    uint32_t sequence = ++mPendingSequence;
+    mPending          = true;
+
+    auto work      = std::make_unique<Work>(Work{ this, session, handler, sequence });
+    CHIP_ERROR err = chip::DeviceLayer::PlatformMgr().ScheduleWork(RunWork, reinterpret_cast<intptr_t>(work.get()));
+    if (err != CHIP_NO_ERROR)
+    {
+        mPending = false;
+        return err;
+    }
+    // Owned by RunWork from now on.
+    work.release();
+
+    auto waitTime = std::chrono::milliseconds((timeout + kCompletionGracePeriod).count());
+    if (!mCondition.wait_for(lock, waitTime, [this] { return !mPending; }))
+    {
+        // Late work items and callbacks of this operation are ignored, see IsPending and Complete.
+        ChipLogError(chipFuzzer, "Gave up waiting for session operation %" PRIu32, sequence);
+        mPending = false;
+        return CHIP_ERROR_TIMEOUT;
+    }
+    return CHIP_NO_ERROR;
+}
+
+bool exec::SessionPool::IsPending(uint32_t sequence)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending && mPendingSequence == sequence;
+}
+
+void exec::SessionPool::Complete(uint32_t sequence)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        VerifyOrReturn(mPending && mPendingSequence == sequence);
+        mPending = false;
+    }
+    mCondition.notify_one();
+}
+
+void exec::SessionPool::RunWork(intptr_t context)
+{
+    std::unique_ptr<Work> work(reinterpret_cast<Work *>(context));
+    // The fuzzing thread may have given up on the operation before the Matter thread got to it.
+    VerifyOrReturn(work->pool->IsPending(work->sequence));
+    (work->pool->*work->handler)(work->session, work->sequence);
+}
+
+void exec::SessionPool::ConnectWork(NodeSession * session, uint32_t sequence)
+{
+    if (session->mExpired)
+    {
+        // The session hung, make sure the stack does not hand it back to us.
+        session->mExpired = false;
+        mCommissioner.SessionMgr()->ExpireAllSessions(chip::ScopedNodeId(session->mNode, mCommissioner.GetFabricIndex()));
+    }
+
+    Count(&SessionStatistics::lookups);
+    session->mConnectSequence = sequence;
+    CHIP_ERROR err            = mCommissioner.GetConnectedDevice(session->mNode, &session->mOnDeviceConnectedCallback,
+                                                                 &session->mOnDeviceConnectionFailureCallback);
+    if (err != CHIP_NO_ERROR)
+    {
+        session->mConnectError = err;
+        Complete(sequence);
+    }
+}
+
+void exec::SessionPool::EvictWork(NodeSession * session, uint32_t sequence)
+{
+    if (session->mConnected)
+    {
+        ChipLogProgress(chipFuzzer, "Evicting the session with node 0x" ChipLogFormatX64, ChipLogValueX64(session->mNode));
+        session->mConnected = false;
+        session->mHolder.Release();
+        Count(&SessionStatistics::evictions);
+    }
+    session->mExpired = false;
+    mCommissioner.SessionMgr()->ExpireAllSessions(chip::ScopedNodeId(session->mNode, mCommissioner.GetFabricIndex()));
+    Complete(sequence);
+}
+
+void exec::SessionPool::ObserveWork(NodeSession * session, uint32_t sequence)
+{
+    // Every command run through the chip-tool lifecycle looks the session up again.
+    Count(&SessionStatistics::lookups);
+    auto handle = mCommissioner.SessionMgr()->FindSecureSessionForNode(
+        chip::ScopedNodeId(session->mNode, mCommissioner.GetFabricIndex()),
+        chip::MakeOptional(chip::Transport::SecureSession::Type::kCASE));
+    if (handle.HasValue())
+    {
+        session->Track(handle.Value());
+    }
+    Complete(sequence);
+}
+
+void exec::SessionPool::ReleaseWork(NodeSession *, uint32_t sequence)
+{
+    std::unordered_map<chip::NodeId, std::unique_ptr<NodeSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mSessionsMutex);
+        sessions.swap(mSessions);
+    }
+    // Releasing the holders may notify the sessions, which count the evictions under the lock.
+    sessions.clear();
+    Complete(sequence);
+}
+
+void exec::SessionPool::LogStatistics(const char * mode) const
+{
+    SessionStatistics statistics = GetStatistics();
+    ChipLogProgress(chipFuzzer,
+                    "Session statistics (%s): %" PRIu64 " iterations, %" PRIu64 " lookups, %" PRIu64 " establishments (%.2f per "
+                    "1,000 iterations), %" PRIu64 " evictions",
+                    mode, statistics.iterations, statistics.lookups, statistics.establishments,
+                    statistics.GetEstablishmentsPerThousandIterations(), statistics.evictions);
+}
+
+exec::SessionPool::NodeSession::~NodeSession()
+{
+    mOnDeviceConnectedCallback.Cancel();
+    mOnDeviceConnectionFailureCallback.Cancel();
+}
+
+void exec::SessionPool::NodeSession::Track(const chip::SessionHandle & session)
+{
+    auto * secureSession = session->AsSecureSession();
+    uint16_t localId     = secureSession->GetLocalSessionId();
+    if (!mLastLocalSessionId.HasValue() || mLastLocalSessionId.Value() != localId)
+    {
+        mPool.Count(&SessionStatistics::establishments);
+        mLastLocalSessionId.SetValue(localId);
+    }
+}
+
+void exec::SessionPool::NodeSession::OnSessionReleased()
+{
+    // The holder has already been released by SessionHolderWithDelegate, the next Connect will look the session up again.
+    if (mConnected.exchange(false))
+    {
+        ChipLogProgress(chipFuzzer, "Session with node 0x" ChipLogFormatX64 " released", ChipLogValueX64(mNode));
+        mPool.Count(&SessionStatistics::evictions);
+    }
+}
+
+void exec::SessionPool::NodeSession::OnSessionHang()
+{
+    // MRP gave up on a message: the device is either unreachable or it rebooted and lost the session keys. Keeping the session
+    // would make every following exchange time out, so it is dropped and a new one is established on the next Connect. The session
+    // cannot be expired from within the SessionManager notification, that is deferred to the next Connect.
+    ChipLogProgress(chipFuzzer, "Session with node 0x" ChipLogFormatX64 " hung", ChipLogValueX64(mNode));
+    if (mConnected.exchange(false))
+    {
+        mHolder.Release();
+        mExpired = true;
+        mPool.Count(&SessionStatistics::evictions);
+        if (mPool.mMonitor != nullptr)
+        {
+            mPool.mMonitor->OnEvent(mNode, LivenessEvent::kSessionLost, "session hung");
+        }
+    }
+}
+
+void exec::SessionPool::NodeSession::OnDeviceConnectedFn(void * context, chip::Messaging::ExchangeManager & exchangeMgr,
+                                                         const chip::SessionHandle & sessionHandle)
+{
+    auto * session                  = static_cast<NodeSession *>(context);
+    session->mPool.mExchangeManager = &exchangeMgr;
+    session->mHolder.Grab(sessionHandle);
+    session->Track(sessionHandle);
+    session->mConnected = true;
+    session->mPool.Complete(session->mConnectSequence);
+}
+
+void exec::SessionPool::NodeSession::OnDeviceConnectionFailureFn(void * context, const chip::ScopedNodeId & peerId,
+                                                                 CHIP_ERROR error)
+{
+    ChipLogError(chipFuzzer, "Failed to establish a CASE session with node 0x" ChipLogFormatX64 ": %" CHIP_ERROR_FORMAT,
+                 ChipLogValueX64(peerId.GetNodeId()), error.Format());
+    auto * session = static_cast<NodeSession *>(context);
+    // The error is only reported to the Connect waiting for it, not to a later one.
+    if (session->mPool.IsPending(session->mConnectSequence))
+    {
+        session->mConnectError = error;
+    }
+    session->mPool.Complete(session->mConnectSequence);
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include <atomic>
+#include <condition_variable>
+#include <controller/CHIPDeviceController.h>
+#include <mutex>
+#include <transport/SessionDelegate.h>
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+class LivenessMonitor;
+
+struct SessionStatistics
+{
+    // Number of times the fuzzer asked the stack for a session, i.e. went through CASESessionManager.
+    uint64_t lookups = 0;
+    // Number of CASE sessions which were actually established, i.e. a session different from the previous one was returned.
+    uint64_t establishments = 0;
+    // Number of sessions lost during the campaign, either released by the stack or dropped after the device stopped responding.
+    uint64_t evictions = 0;
+    uint64_t iterations = 0;
+
+    double GetEstablishmentsPerThousandIterations() const
+    {
+        return iterations ? static_cast<double>(establishments) * 1000.0 / static_cast<double>(iterations) : 0.0;
+    }
+};
+
+/**
+ * @brief Keeps one CASE session per target node for the whole fuzzing campaign.
+ *
+ * A session is looked up through the commissioner only when the node has none, and is kept until the stack releases it (e.g.
+ * it gets evicted from the session table) or until the device stops responding on it, which usually means it rebooted. In both
+ * cases the next Connect goes through CASESessionManager again, establishing a new session.
+ *
+ * Connect and Evict are meant to be called from the fuzzing thread, GetSession and GetExchangeManager from the Matter thread. The
+ * sessions and the statistics are shared by both threads, under mSessionsMutex.
+ */
+class SessionPool
+{
+public:
+    SessionPool(chip::Controller::DeviceCommissioner & commissioner) : mCommissioner(commissioner) {}
+    ~SessionPool();
+
+    /**
+     * @brief Makes sure a session with the node is available, establishing it if needed.
+     */
+    CHIP_ERROR Connect(chip::NodeId node, chip::System::Clock::Timeout timeout = kDefaultTimeout);
+
+    /**
+     * @brief Drops the session with the node and expires it in the stack, so that the next Connect establishes a new one. The
+     * sessions the stack holds with the node are expired even when the pool has none, e.g. those of the chip-tool commands.
+     */
+    void Evict(chip::NodeId node);
+
+    /**
+     * @brief Records the session currently used by the stack for the node, without establishing one.
+     *
+     * Used to count session establishments when the commands go through the chip-tool command lifecycle, which looks up the
+     * session on its own.
+     */
+    void Observe(chip::NodeId node);
+
+    bool IsConnected(chip::NodeId node) const;
+    chip::Optional<chip::SessionHandle> GetSession(chip::NodeId node);
+    chip::Messaging::ExchangeManager * GetExchangeManager() const { return mExchangeManager; }
+
+    // Notified when a session hangs. Must only be changed while the Matter stack is locked.
+    void SetLivenessMonitor(LivenessMonitor * monitor) { mMonitor = monitor; }
+
+    void CountIteration() { Count(&SessionStatistics::iterations); }
+    SessionStatistics GetStatistics() const;
+    void LogStatistics(const char * mode) const;
+
+private:
+    static constexpr chip::System::Clock::Timeout kDefaultTimeout = chip::System::Clock::Seconds16(30);
+
+    class NodeSession : public chip::SessionDelegate
+    {
+    public:
+        NodeSession(SessionPool & pool, chip::NodeId node) :
+            mPool(pool), mNode(node), mHolder(*this), mOnDeviceConnectedCallback(OnDeviceConnectedFn, this),
+            mOnDeviceConnectionFailureCallback(OnDeviceConnectionFailureFn, this)
+        {}
+        ~NodeSession() override;
+
+        /////////// SessionDelegate Interface /////////
+        void OnSessionReleased() override;
+        void OnSessionHang() override;
+
+        void Track(const chip::SessionHandle & session);
+
+        SessionPool & mPool;
+        chip::NodeId mNode;
+        chip::SessionHolderWithDelegate mHolder;
+        std::atomic<bool> mConnected{ false };
+        // Set when the session hung, so that it gets expired in the stack before looking it up again.
+        bool mExpired = false;
+        // Local identifier of the last session seen for the node, used to tell a new establishment from a reused session.
+        chip::Optional<uint16_t> mLastLocalSessionId;
+        CHIP_ERROR mConnectError = CHIP_NO_ERROR;
+        // Operation the last session lookup belongs to, completed by the connection callbacks.
+        uint32_t mConnectSequence = 0;
+
+        chip::Callback::Callback<chip::OnDeviceConnected> mOnDeviceConnectedCallback;
+        chip::Callback::Callback<chip::OnDeviceConnectionFailure> mOnDeviceConnectionFailureCallback;
+
+        static void OnDeviceConnectedFn(void * context, chip::Messaging::ExchangeManager & exchangeMgr,
+                                        const chip::SessionHandle & sessionHandle);
+        static void OnDeviceConnectionFailureFn(void * context, const chip::ScopedNodeId & peerId, CHIP_ERROR error);
+    };
+
+    chip::Controller::DeviceCommissioner & mCommissioner;
+    chip::Messaging::ExchangeManager * mExchangeManager = nullptr;
+    LivenessMonitor * mMonitor                          = nullptr;
+    // Guards mSessions and mStatistics. Never held while waiting for the Matter thread.
+    mutable std::mutex mSessionsMutex;
+    std::unordered_map<chip::NodeId, std::unique_ptr<NodeSession>> mSessions;
+    SessionStatistics mStatistics;
+
+    using WorkHandler = void (SessionPool::*)(NodeSession * session, uint32_t sequence);
+
+    // Work item scheduled on the Matter thread, carrying the operation it belongs to so that a work item or a callback which
+    // outlives its operation (the fuzzing thread gave up waiting for it) cannot complete the next one.
+    struct Work
+    {
+        SessionPool * pool;
+        NodeSession * session;
+        WorkHandler handler;
+        uint32_t sequence;
+    };
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mPending = false;
+    // Identifies the operation the fuzzing thread is waiting for, incremented for every operation.
+    uint32_t mPendingSequence = 0;
+
+    NodeSession & GetOrCreate(chip::NodeId node);
+    void Count(uint64_t SessionStatistics::*counter);
+
+    static void RunWork(intptr_t context);
+    void ConnectWork(NodeSession * session, uint32_t sequence);
+    void EvictWork(NodeSession * session, uint32_t sequence);
+    void ObserveWork(NodeSession * session, uint32_t sequence);
+    void ReleaseWork(NodeSession * session, uint32_t sequence);
+
+    CHIP_ERROR ScheduleAndWait(NodeSession * session, WorkHandler handler, chip::System::Clock::Timeout timeout);
+    bool IsPending(uint32_t sequence);
+    void Complete(uint32_t sequence);
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
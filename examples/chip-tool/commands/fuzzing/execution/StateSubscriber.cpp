@@ -0,0 +1,193 @@
+#include "StateSubscriber.h"
+#include "../Fuzzing.h"
+#include <app/InteractionModelEngine.h>
+#include <inttypes.h>
+#include <lib/core/TLV.h>
+#include <platform/PlatformManager.h>
+
+namespace fuzz = chip::fuzzing;
+namespace exec = chip::fuzzing::execution;
+
+exec::StateSubscriber::~StateSubscriber()
+{
+    UnsubscribeAll();
+}
+
+CHIP_ERROR exec::StateSubscriber::Subscribe(chip::NodeId node, uint16_t capacity)
+{
+    VerifyOrReturnError(mSubscriptions.find(node) == mSubscriptions.end(), CHIP_NO_ERROR);
+    uint16_t available = capacity ? capacity : kMinSubscriptionsPerFabric;
+    if (available <= kReservedSubscriptions)
+    {
+        ChipLogProgress(chipFuzzer, "Node 0x" ChipLogFormatX64 " only holds %u subscriptions, its state is not subscribed to",
+                        ChipLogValueX64(node), available);
+        mStatistics.skipped++;
+        return CHIP_NO_ERROR;
+    }
+
+    ReturnErrorOnFailure(mSessions.Connect(node));
+    chip::DeviceLayer::StackLock lock;
+    chip::Optional<chip::SessionHandle> session = mSessions.GetSession(node);
+    VerifyOrReturnError(session.HasValue(), CHIP_ERROR_NOT_CONNECTED);
+
+    auto subscription = std::make_unique<NodeSubscription>(*this, node);
+    ReturnErrorOnFailure(subscription->Start(session.Value()));
+    mSubscriptions.emplace(node, std::move(subscription));
+    mStatistics.subscriptions++;
+    return CHIP_NO_ERROR;
+}
+
+void exec::StateSubscriber::Unsubscribe(chip::NodeId node)
+{
+    chip::DeviceLayer::StackLock lock;
+    mSubscriptions.erase(node);
+}
+
+void exec::StateSubscriber::UnsubscribeAll()
+{
+    chip::DeviceLayer::StackLock lock;
+    mSubscriptions.clear();
+}
+
+void exec::StateSubscriber::LogStatistics() const
+{
+    ChipLogProgress(chipFuzzer,
+                    "Subscription statistics: %" PRIu64 " subscriptions (%" PRIu64 " skipped), %" PRIu64
+                    " resubscriptions, %" PRIu64 " reports, %" PRIu64 " attribute values applied (%" PRIu64
+                    " coalesced), %" PRIu64 " events",
+                    mStatistics.subscriptions, mStatistics.skipped, mStatistics.resubscriptions, mStatistics.reports,
+                    mStatistics.appliedValues, mStatistics.coalescedValues, mStatistics.events);
+}
+
+CHIP_ERROR exec::StateSubscriber::NodeSubscription::Start(const chip::SessionHandle & session)
+{
+    // Default path parameters are wildcards.
+    mAttributePath = chip::app::AttributePathParams();
+    mEventPath     = chip::app::EventPathParams();
+
+    chip::app::ReadPrepareParams params(session);
+    params.mpAttributePathParamsList    = &mAttributePath;
+    params.mAttributePathParamsListSize = 1;
+    params.mpEventPathParamsList        = &mEventPath;
+    params.mEventPathParamsListSize     = 1;
+    params.mMinIntervalFloorSeconds     = kMinIntervalFloorSeconds;
+    params.mMaxIntervalCeilingSeconds   = kMaxIntervalCeilingSeconds;
+    // The subscriptions of the other nodes, and the ones of the test cases, must survive this one.
+    params.mKeepSubscriptions = true;
+
+    mReadClient = std::make_unique<chip::app::ReadClient>(chip::app::InteractionModelEngine::GetInstance(),
+                                                          mSubscriber.mSessions.GetExchangeManager(), mBufferedCallback,
+                                                          chip::app::ReadClient::InteractionType::Subscribe);
+    return mReadClient->SendAutoResubscribeRequest(std::move(params));
+}
+
+void exec::StateSubscriber::NodeSubscription::OnReportBegin()
+{
+    mReport.clear();
+}
+
+void exec::StateSubscriber::NodeSubscription::OnAttributeData(const chip::app::ConcreteDataAttributePath & path,
+                                                              chip::TLV::TLVReader * data, const chip::app::StatusIB & status)
+{
+    auto [entry, inserted] = mReport.try_emplace(PathKey(path.mEndpointId, path.mClusterId, path.mAttributeId));
+    BufferedValue & value  = entry->second;
+    if (!inserted)
+    {
+        mSubscriber.mStatistics.coalescedValues++;
+    }
+    value.path   = path;
+    value.status = status;
+    value.data.clear();
+    VerifyOrReturn(data != nullptr);
+
+    // The reader only lives until the callback returns, the element is copied to be analyzed once the report ends.
+    value.data.resize(data->GetTotalLength());
+    chip::TLV::TLVWriter writer;
+    writer.Init(value.data.data(), static_cast<uint32_t>(value.data.size()));
+    CHIP_ERROR err = writer.CopyElement(chip::TLV::AnonymousTag(), *data);
+    if (err == CHIP_NO_ERROR)
+    {
+        err = writer.Finalize();
+    }
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(chipFuzzer, "Failed to buffer the report of attribute " ChipLogFormatMEI ": %" CHIP_ERROR_FORMAT,
+                     ChipLogValueMEI(path.mAttributeId), err.Format());
+        mReport.erase(entry);
+        return;
+    }
+    value.data.resize(writer.GetLengthWritten());
+}
+
+void exec::StateSubscriber::NodeSubscription::OnReportEnd()
+{
+    for (const auto & entry : mReport)
+    {
+        Apply(entry.second);
+    }
+    mSubscriber.mStatistics.appliedValues += mReport.size();
+    mSubscriber.mStatistics.reports++;
+    mReport.clear();
+    fuzz::Fuzzer::GetInstance()->AnalyzeSubscriptionReportEnd(mNode);
+}
+
+void exec::StateSubscriber::NodeSubscription::Apply(const BufferedValue & value)
+{
+    fuzz::Fuzzer * fuzzer = fuzz::Fuzzer::GetInstance();
+    if (value.data.empty())
+    {
+        fuzzer->AnalyzeSubscriptionReport(mNode, nullptr, value.path, value.status);
+        return;
+    }
+
+    chip::TLV::TLVReader reader;
+    reader.Init(value.data.data(), value.data.size());
+    VerifyOrReturn(reader.Next() == CHIP_NO_ERROR);
+    fuzzer->AnalyzeSubscriptionReport(mNode, &reader, value.path, value.status);
+}
+
+void exec::StateSubscriber::NodeSubscription::OnEventData(const chip::app::EventHeader & eventHeader, chip::TLV::TLVReader * data,
+                                                          const chip::app::StatusIB * status)
+{
+    if (!mHighestEventNumber.HasValue() || mHighestEventNumber.Value() < eventHeader.mEventNumber)
+    {
+        mHighestEventNumber.SetValue(eventHeader.mEventNumber);
+    }
+    mSubscriber.mStatistics.events++;
+    fuzz::Fuzzer::GetInstance()->AnalyzeSubscriptionReport(mNode, eventHeader, data, status);
+}
+
+void exec::StateSubscriber::NodeSubscription::OnSubscriptionEstablished(chip::SubscriptionId subscriptionId)
+{
+    ChipLogProgress(chipFuzzer, "Subscription 0x%08" PRIx32 " established with node 0x" ChipLogFormatX64, subscriptionId,
+                    ChipLogValueX64(mNode));
+}
+
+CHIP_ERROR exec::StateSubscriber::NodeSubscription::OnResubscriptionNeeded(chip::app::ReadClient * client,
+                                                                           CHIP_ERROR terminationCause)
+{
+    ChipLogProgress(chipFuzzer, "Subscription to node 0x" ChipLogFormatX64 " dropped: %" CHIP_ERROR_FORMAT, ChipLogValueX64(mNode),
+                    terminationCause.Format());
+    mSubscriber.mStatistics.resubscriptions++;
+    mReport.clear();
+    return chip::app::ReadClient::Callback::OnResubscriptionNeeded(client, terminationCause);
+}
+
+void exec::StateSubscriber::NodeSubscription::OnError(CHIP_ERROR error)
+{
+    ChipLogError(chipFuzzer, "Subscription to node 0x" ChipLogFormatX64 " failed: %" CHIP_ERROR_FORMAT, ChipLogValueX64(mNode),
+                 error.Format());
+    mReport.clear();
+}
+
+void exec::StateSubscriber::NodeSubscription::OnDone(chip::app::ReadClient * client)
+{
+    ChipLogProgress(chipFuzzer, "Subscription to node 0x" ChipLogFormatX64 " ended", ChipLogValueX64(mNode));
+}
+
+CHIP_ERROR exec::StateSubscriber::NodeSubscription::GetHighestReceivedEventNumber(chip::Optional<chip::EventNumber> & eventNumber)
+{
+    // Resubscriptions only ask for the events which were not received yet.
+    eventNumber = mHighestEventNumber;
+    return CHIP_NO_ERROR;
+}
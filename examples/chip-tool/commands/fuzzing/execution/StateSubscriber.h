@@ -0,0 +1,130 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "SessionPool.h"
+#include <app/BufferedReadCallback.h>
+#include <app/ReadClient.h>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace execution {
+
+struct SubscriptionStatistics
+{
+    uint64_t subscriptions   = 0;
+    uint64_t resubscriptions = 0;
+    uint64_t reports         = 0;
+    // Attribute values passed to the device state, at most one per path and report.
+    uint64_t appliedValues = 0;
+    // Attribute values superseded by a later value of the same path in the same report, never passed to the device state.
+    uint64_t coalescedValues = 0;
+    uint64_t events          = 0;
+    // Nodes left without a subscription because the device cannot hold one more.
+    uint64_t skipped = 0;
+};
+
+/**
+ * @brief Keeps the device state of the target nodes up to date with the changes they report on their own, with a single
+ * wildcard subscription per node.
+ *
+ * The subscription covers every attribute and every event of the node, instead of one subscription per cluster and per event,
+ * so that it fits the SubscriptionsPerFabric capacity the device advertises in its CapabilityMinima: the spec only guarantees 3
+ * subscriptions per fabric, and kReservedSubscriptions of them are left to the subscriptions the test cases request.
+ *
+ * As in ClusterStateCache, the chunks of a list are reassembled by a BufferedReadCallback, and the attribute values of a report
+ * are buffered by path until the report ends: only the last value of every path goes to the DeviceStateManager, through the same
+ * analysis as the responses, attributed to the node and to no test case. Events are analyzed as they come.
+ *
+ * The subscriptions are re-established by the ReadClient whenever they drop, e.g. after the device rebooted, resuming the events
+ * after the last one received.
+ *
+ * Subscribe and Unsubscribe are meant to be called from the fuzzing thread, the reports are analyzed on the Matter thread.
+ */
+class StateSubscriber
+{
+public:
+    // Subscriptions left to the test cases on every node.
+    static constexpr uint16_t kReservedSubscriptions = 1;
+    // Minimum of SubscriptionsPerFabric required by the spec, assumed when the device does not advertise its own.
+    static constexpr uint16_t kMinSubscriptionsPerFabric = 3;
+
+    StateSubscriber(SessionPool & sessions) : mSessions(sessions) {}
+    ~StateSubscriber();
+
+    /**
+     * @brief Subscribes to all the attributes and events of the node, unless it is already subscribed to.
+     *
+     * @param capacity SubscriptionsPerFabric of the node, 0 if unknown. No subscription is made if it leaves no room for the
+     *                 ones of the test cases, which is not an error.
+     */
+    CHIP_ERROR Subscribe(chip::NodeId node, uint16_t capacity);
+    void Unsubscribe(chip::NodeId node);
+    void UnsubscribeAll();
+
+    const SubscriptionStatistics & GetStatistics() const { return mStatistics; }
+    void LogStatistics() const;
+
+private:
+    // The device is asked to report the changes at most this often, so that bursts of changes are coalesced on its side too.
+    static constexpr uint16_t kMinIntervalFloorSeconds = 1;
+    // Bounds the time it takes to tell that a subscription dropped.
+    static constexpr uint16_t kMaxIntervalCeilingSeconds = 60;
+
+    class NodeSubscription : public chip::app::ReadClient::Callback
+    {
+    public:
+        NodeSubscription(StateSubscriber & subscriber, chip::NodeId node) :
+            mSubscriber(subscriber), mNode(node), mBufferedCallback(*this)
+        {}
+
+        // Must be called from the Matter thread.
+        CHIP_ERROR Start(const chip::SessionHandle & session);
+
+        /////////// ReadClient Callback Interface /////////
+        void OnReportBegin() override;
+        void OnReportEnd() override;
+        void OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,
+                             const chip::app::StatusIB & status) override;
+        void OnEventData(const chip::app::EventHeader & eventHeader, chip::TLV::TLVReader * data,
+                         const chip::app::StatusIB * status) override;
+        void OnSubscriptionEstablished(chip::SubscriptionId subscriptionId) override;
+        CHIP_ERROR OnResubscriptionNeeded(chip::app::ReadClient * client, CHIP_ERROR terminationCause) override;
+        void OnError(CHIP_ERROR error) override;
+        void OnDone(chip::app::ReadClient * client) override;
+        // The paths are members of the subscription, which outlives its ReadClient.
+        void OnDeallocatePaths(chip::app::ReadPrepareParams && params) override {}
+        CHIP_ERROR GetHighestReceivedEventNumber(chip::Optional<chip::EventNumber> & eventNumber) override;
+
+    private:
+        using PathKey = std::tuple<chip::EndpointId, chip::ClusterId, chip::AttributeId>;
+
+        // Last value or status reported for a path during the current report.
+        struct BufferedValue
+        {
+            chip::app::ConcreteDataAttributePath path;
+            chip::app::StatusIB status;
+            std::vector<uint8_t> data;
+        };
+
+        StateSubscriber & mSubscriber;
+        chip::NodeId mNode;
+        chip::app::BufferedReadCallback mBufferedCallback;
+        std::unique_ptr<chip::app::ReadClient> mReadClient;
+        chip::app::AttributePathParams mAttributePath;
+        chip::app::EventPathParams mEventPath;
+        chip::Optional<chip::EventNumber> mHighestEventNumber;
+        std::map<PathKey, BufferedValue> mReport;
+
+        void Apply(const BufferedValue & value);
+    };
+
+    SessionPool & mSessions;
+    std::unordered_map<chip::NodeId, std::unique_ptr<NodeSubscription>> mSubscriptions;
+    SubscriptionStatistics mStatistics;
+};
+
+} // namespace execution
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,88 @@
+#include "Corpus.h"
+#include "../generation/TLVMutator.h"
+#include <algorithm>
+
+namespace fb = chip::fuzzing::feedback;
+
+bool fb::Corpus::Consider(const generation::GeneratedCommand & testCase, size_t input, uint64_t signature, CorpusEntryId parent)
+{
+    mStatistics.considered++;
+    uint32_t & hits = mHits[signature];
+    hits++;
+    VerifyOrReturnValue(hits == 1, false);
+
+    // The parent may have been replaced since the test case was mutated from it, its successor did not earn the reward.
+    auto parentIndex = mIndices.find(parent);
+    if (parentIndex != mIndices.end())
+    {
+        mEntries[parentIndex->second].finds++;
+        mEntries[parentIndex->second].energy += kFindReward;
+    }
+
+    CorpusEntry * entry = nullptr;
+    if (mEntries.size() < mCapacity)
+    {
+        entry = &mEntries.emplace_back();
+    }
+    else
+    {
+        // The least promising entry makes room for the new one.
+        entry = &*std::min_element(mEntries.begin(), mEntries.end(), [this](const CorpusEntry & a, const CorpusEntry & b) {
+            return GetWeight(a) < GetWeight(b);
+        });
+        mIndices.erase(entry->id);
+        mStatistics.evicted++;
+    }
+
+    entry->id           = mNextId++;
+    mIndices[entry->id] = static_cast<size_t>(entry - mEntries.data());
+    entry->testCase     = testCase;
+    entry->tree.reset();
+    if (testCase.payloadLength > 0 && CHIP_NO_ERROR != generation::TLVMutator::Decode(testCase.GetPayload(), entry->tree))
+    {
+        // Only the mutations which do not need the structure of the payload apply to the entry.
+        entry->tree.reset();
+    }
+    entry->signature = signature;
+    entry->input     = input;
+    entry->energy    = kInitialEnergy;
+    entry->picks     = 0;
+    entry->finds     = 0;
+    mStatistics.kept++;
+    return true;
+}
+
+size_t fb::Corpus::Pick(std::mt19937_64 & random)
+{
+    VerifyOrDie(!mEntries.empty());
+
+    double total = 0.0;
+    for (const auto & entry : mEntries)
+    {
+        total += GetWeight(entry);
+    }
+
+    double target = std::uniform_real_distribution<double>(0.0, total)(random);
+    size_t picked = mEntries.size() - 1;
+    for (size_t i = 0; i < mEntries.size(); i++)
+    {
+        target -= GetWeight(mEntries[i]);
+        if (target <= 0.0)
+        {
+            picked = i;
+            break;
+        }
+    }
+
+    CorpusEntry & entry = mEntries[picked];
+    entry.picks++;
+    entry.energy = std::max(entry.energy * kPickDecay, kMinEnergy);
+    return picked;
+}
+
+double fb::Corpus::GetWeight(const CorpusEntry & entry) const
+{
+    auto found  = mHits.find(entry.signature);
+    double hits = (found != mHits.end() && found->second > 0) ? static_cast<double>(found->second) : 1.0;
+    return entry.energy / hits;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "../generation/CommandGenerator.h"
+#include "../tlv/DecodedTLVElement.h"
+#include <random>
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace feedback {
+
+// Identifies a corpus entry for as long as it is kept, unlike its index which is reused once the entry gets replaced.
+using CorpusEntryId = uint64_t;
+
+struct CorpusEntry
+{
+    CorpusEntryId id;
+    generation::GeneratedCommand testCase;
+    // Payload decoded once when the entry is kept, the structure-aware mutants are derived from it. Null for reads.
+    std::shared_ptr<TLV::DecodedTLVTree> tree;
+    // Signature of the response which made the test case interesting.
+    uint64_t signature;
+    // Index of the test case in the command history.
+    size_t input;
+    double energy;
+    uint32_t picks = 0;
+    // Number of unseen signatures produced by the mutants of this entry.
+    uint32_t finds = 0;
+};
+
+struct CorpusStatistics
+{
+    uint64_t considered = 0;
+    uint64_t kept       = 0;
+    uint64_t evicted    = 0;
+};
+
+/**
+ * @brief Test cases which made the device exhibit a behaviour never seen before, i.e. a response with an unseen signature.
+ *
+ * This is the black-box counterpart of the coverage-guided queue of AFL: the response signature stands for the coverage map of
+ * a target that cannot be instrumented. Entries are picked for mutation with a probability proportional to their energy, which:
+ * - decays every time the entry is picked, so that the fuzzer moves on from entries that stopped being productive;
+ * - grows every time one of its mutants is kept in turn, so that deep state is explored further;
+ * - is divided by the number of times its signature was hit, so that rare behaviours get most of the budget (as the power
+ *   schedules of AFLFast do).
+ *
+ * Not thread-safe.
+ */
+class Corpus
+{
+public:
+    static constexpr CorpusEntryId kNoParent = 0;
+
+    Corpus(size_t capacity = kDefaultCapacity) : mCapacity(capacity ? capacity : 1) { mEntries.reserve(mCapacity); }
+
+    bool IsEmpty() const { return mEntries.empty(); }
+    size_t GetSize() const { return mEntries.size(); }
+    size_t GetSignatureCount() const { return mHits.size(); }
+    const CorpusStatistics & GetStatistics() const { return mStatistics; }
+
+    /**
+     * @brief Records the signature of the response to a test case, and keeps the test case if the signature is unseen.
+     *
+     * @param parent Identifier of the entry the test case was mutated from, or kNoParent if it was generated from scratch. The
+     *               parent is only rewarded if it is still in the corpus.
+     * @return true if the test case was kept.
+     */
+    bool Consider(const generation::GeneratedCommand & testCase, size_t input, uint64_t signature, CorpusEntryId parent);
+
+    /**
+     * @brief Picks an entry to mutate according to the energy schedule. The corpus must not be empty.
+     *
+     * The returned index identifies the entry until it is replaced, which only happens once the corpus is full: the identifier of
+     * the entry is to be kept instead for longer.
+     */
+    size_t Pick(std::mt19937_64 & random);
+    const CorpusEntry & Get(size_t index) const { return mEntries[index]; }
+
+private:
+    static constexpr size_t kDefaultCapacity = 1024;
+    static constexpr double kInitialEnergy   = 1.0;
+    // Fraction of the energy kept after every pick.
+    static constexpr double kPickDecay = 0.95;
+    // Energy granted to an entry when one of its mutants is kept.
+    static constexpr double kFindReward = 1.0;
+    static constexpr double kMinEnergy  = 0.01;
+
+    size_t mCapacity;
+    std::vector<CorpusEntry> mEntries;
+    // Index of every entry, by identifier.
+    std::unordered_map<CorpusEntryId, size_t> mIndices;
+    CorpusEntryId mNextId = kNoParent + 1;
+    // Number of responses observed for each signature.
+    std::unordered_map<uint64_t, uint32_t> mHits;
+    CorpusStatistics mStatistics;
+
+    double GetWeight(const CorpusEntry & entry) const;
+};
+
+} // namespace feedback
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,180 @@
+#include "ResponseSignature.h"
+#include <algorithm>
+#include <cmath>
+#include <lib/support/TypeTraits.h>
+#include <limits>
+
+namespace fb = chip::fuzzing::feedback;
+
+namespace {
+enum class FeatureKind : uint8_t
+{
+    kStatus,
+    kError,
+    kTransition,
+    kEvent,
+};
+
+constexpr uint64_t kHashOffset = 14695981039346656037ULL;
+constexpr uint64_t kHashPrime  = 1099511628211ULL;
+
+// FNV-1a over whole words, enough to spread the small identifiers the features are made of.
+class FeatureHasher
+{
+public:
+    FeatureHasher(FeatureKind kind) { Combine(static_cast<uint64_t>(kind)); }
+
+    FeatureHasher & Combine(uint64_t value)
+    {
+        mHash ^= value;
+        mHash *= kHashPrime;
+        return *this;
+    }
+
+    uint64_t Get() const { return mHash; }
+
+private:
+    uint64_t mHash = kHashOffset;
+};
+
+template <typename T>
+fb::ValueClass ClassifyNumber(T value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        if (!std::isfinite(value))
+            return fb::ValueClass::kNonFinite;
+    }
+    else
+    {
+        if (value == std::numeric_limits<T>::max())
+            return fb::ValueClass::kMaximum;
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (value == std::numeric_limits<T>::min())
+                return fb::ValueClass::kMinimum;
+        }
+    }
+    if (value == 0)
+        return fb::ValueClass::kZero;
+    if constexpr (std::is_signed_v<T>)
+    {
+        if (value < 0)
+            return fb::ValueClass::kNegative;
+    }
+    return fb::ValueClass::kPositive;
+}
+} // namespace
+
+fb::ValueClass fb::ClassifyValue(const AnyType & value)
+{
+    return std::visit(
+        [](auto && arg) -> ValueClass {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, std::monostate>)
+                return ValueClass::kUnknown;
+            else if constexpr (std::is_same_v<T, NullOptionalType>)
+                return ValueClass::kNull;
+            else if constexpr (std::is_same_v<T, bool>)
+                return arg ? ValueClass::kTrue : ValueClass::kFalse;
+            else if constexpr (std::is_same_v<T, char *>)
+                return (arg == nullptr || arg[0] == '\0') ? ValueClass::kEmpty : ValueClass::kNonEmpty;
+            else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, ContainerType>)
+                return arg.empty() ? ValueClass::kEmpty : ValueClass::kNonEmpty;
+            else
+                return ClassifyNumber(arg);
+        },
+        value);
+}
+
+void fb::ResponseSignature::AddFeature(uint64_t feature)
+{
+    auto position = std::lower_bound(mFeatures.begin(), mFeatures.end(), feature);
+    if (position == mFeatures.end() || *position != feature)
+    {
+        mFeatures.insert(position, feature);
+    }
+}
+
+void fb::ResponseSignature::AddStatus(EndpointId endpoint, ClusterId cluster, uint32_t id, const chip::app::StatusIB & status)
+{
+    AddFeature(FeatureHasher(FeatureKind::kStatus)
+                   .Combine(endpoint)
+                   .Combine(cluster)
+                   .Combine(id)
+                   .Combine(chip::to_underlying(status.mStatus))
+                   .Combine(status.mClusterStatus.ValueOr(0))
+                   .Get());
+}
+
+void fb::ResponseSignature::AddError(CHIP_ERROR error)
+{
+    AddFeature(FeatureHasher(FeatureKind::kError).Combine(error.AsInteger()).Get());
+}
+
+void fb::ResponseSignature::AddTransition(EndpointId endpoint, ClusterId cluster, AttributeId attribute, ValueClass from,
+                                          ValueClass to)
+{
+    AddFeature(FeatureHasher(FeatureKind::kTransition)
+                   .Combine(endpoint)
+                   .Combine(cluster)
+                   .Combine(attribute)
+                   .Combine(chip::to_underlying(from))
+                   .Combine(chip::to_underlying(to))
+                   .Get());
+}
+
+void fb::ResponseSignature::AddEvent(EndpointId endpoint, ClusterId cluster, EventId event)
+{
+    AddFeature(FeatureHasher(FeatureKind::kEvent).Combine(endpoint).Combine(cluster).Combine(event).Get());
+}
+
+uint64_t fb::ResponseSignature::GetHash() const
+{
+    uint64_t hash = kHashOffset;
+    for (auto feature : mFeatures)
+    {
+        hash ^= feature;
+        hash *= kHashPrime;
+    }
+    return hash;
+}
+
+void fb::SignatureRecorder::Begin(NodeId node, size_t input)
+{
+    mOpen[input].Clear();
+    mLatest[node] = input;
+}
+
+uint64_t fb::SignatureRecorder::End(size_t input)
+{
+    auto found = mOpen.find(input);
+    VerifyOrReturnValue(found != mOpen.end(), kHashOffset);
+    uint64_t hash = found->second.GetHash();
+    mOpen.erase(found);
+    return hash;
+}
+
+fb::ResponseSignature * fb::SignatureRecorder::Find(NodeId node, const Optional<size_t> & input)
+{
+    size_t index;
+    if (input.HasValue())
+    {
+        index = input.Value();
+    }
+    else
+    {
+        // Nothing was sent to the node yet, e.g. while its data model is being acquired.
+        auto latest = mLatest.find(node);
+        VerifyOrReturnValue(latest != mLatest.end(), nullptr);
+        index = latest->second;
+    }
+
+    auto found = mOpen.find(index);
+    if (found == mOpen.end())
+    {
+        mUnattributed++;
+        return nullptr;
+    }
+    return &found->second;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "../Utils.h"
+#include <unordered_map>
+
+namespace chip {
+namespace fuzzing {
+namespace feedback {
+
+/**
+ * @brief Coarse class of an attribute value, the unit of the state transitions recorded in a response signature.
+ *
+ * Values are bucketed the way boundary testing looks at them, so that a transition from e.g. zero to the maximum of the type is
+ * a different behaviour than a transition between two ordinary positive values.
+ */
+enum class ValueClass : uint8_t
+{
+    kUnknown,
+    kNull,
+    kFalse,
+    kTrue,
+    kZero,
+    kMinimum,
+    kMaximum,
+    kNegative,
+    kPositive,
+    kNonFinite,
+    kEmpty,
+    kNonEmpty,
+};
+
+ValueClass ClassifyValue(const AnyType & value);
+
+/**
+ * @brief The observable behaviour of the device in response to a single test case.
+ *
+ * A signature is the set of features collected while the exchange was open: the statuses and errors reported on each path, the
+ * value class transitions of the attributes reported back (from AttributeState::ReadLast to AttributeState::ReadCurrent), and
+ * the events emitted. Its hash does not depend on the order in which the features were observed.
+ */
+class ResponseSignature
+{
+public:
+    void AddStatus(EndpointId endpoint, ClusterId cluster, uint32_t id, const chip::app::StatusIB & status);
+    void AddError(CHIP_ERROR error);
+    void AddTransition(EndpointId endpoint, ClusterId cluster, AttributeId attribute, ValueClass from, ValueClass to);
+    void AddEvent(EndpointId endpoint, ClusterId cluster, EventId event);
+
+    bool IsEmpty() const { return mFeatures.empty(); }
+    size_t GetFeatureCount() const { return mFeatures.size(); }
+    uint64_t GetHash() const;
+
+    void Clear() { mFeatures.clear(); }
+
+private:
+    // Kept sorted and without duplicates, a response rarely has more than a handful of features.
+    std::vector<uint64_t> mFeatures;
+
+    void AddFeature(uint64_t feature);
+};
+
+/**
+ * @brief Collects the signatures of the in-flight test cases from the analysis of their responses.
+ *
+ * Responses to the test cases are attributed through the current input of the Fuzzer. Reports which are not attributed to any
+ * input, e.g. those of the subscriptions established during the data model acquisition, are folded into the signature of the
+ * test case most recently sent to the node, as long as it is still open.
+ *
+ * Only used from the Matter thread.
+ */
+class SignatureRecorder
+{
+public:
+    void Begin(NodeId node, size_t input);
+    // Returns the hash of the signature and forgets it.
+    uint64_t End(size_t input);
+
+    /**
+     * @brief Returns the signature that the observations for the input should be added to, or nullptr if it is not open.
+     *
+     * @param input The current input of the Fuzzer, if any.
+     */
+    ResponseSignature * Find(NodeId node, const Optional<size_t> & input);
+
+    uint64_t GetUnattributed() const { return mUnattributed; }
+
+private:
+    std::unordered_map<size_t, ResponseSignature> mOpen;
+    std::unordered_map<NodeId, size_t> mLatest;
+    uint64_t mUnattributed = 0;
+};
+
+} // namespace feedback
+} // namespace fuzzing
+} // namespace chip
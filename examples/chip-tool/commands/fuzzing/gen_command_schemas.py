@@ -0,0 +1,257 @@
+#!/usr/bin/env python
+
+"""Compiles the commands of the data model XML files into the constexpr schema table of the native generator.
+
+Every client-to-server command of every cluster becomes a CommandSchema (see generation/CommandSchemas.h) listing its fields:
+their context tag, type, quality, conformance and the literal bounds of their constraints, resolved like the attributes of
+the oracle rule table. Structures are flattened into the same field table once and shared by all the fields of their type,
+the entries of a list are described by a single anonymous field.
+"""
+
+import glob
+import optparse
+import os
+import sys
+import xml.etree.ElementTree as ElementTree
+
+from gen_oracle_rules import Cluster, Rule, apply_constraints, parse_int, resolve_type
+
+# Commands sent by the server, which the generator never invokes.
+SERVER_DIRECTIONS = ('responseFromServer',)
+# Fields left out of the generated commands: they are not part of the current revision of the cluster.
+EXCLUDED_CONFORMANCES = ('disallowConform', 'deprecateConform')
+# Spellings of the base types which only the command fields use.
+TYPE_ALIASES = {'endpoint-id': 'endpoint-no', 'Boolean': 'bool'}
+# Suffixes of the commands which the specification defines by reference to the command named without it, such as the
+# MoveToLevelWithOnOff command of Level Control: their XML element lists no field at all.
+REFERENCE_SUFFIXES = ('WithOnOff',)
+
+
+class CommandCluster(Cluster):
+    def __init__(self, root, path):
+        super().__init__(root, path)
+        self.struct_elements = {}
+        data_types = root.find('dataTypes')
+        if data_types is not None:
+            for struct in data_types.findall('struct'):
+                self.struct_elements[struct.get('name')] = struct
+        # Requests and responses may share their identifiers, only the requests are kept.
+        self.commands = {}
+        self.responses = set()
+        commands = root.find('commands')
+        if commands is not None:
+            for command in commands.findall('command'):
+                command_id = parse_int(command.get('id'))
+                if command_id is None:
+                    continue
+                if command.get('direction') in SERVER_DIRECTIONS:
+                    self.responses.add(command_id)
+                else:
+                    self.commands[command_id] = command
+
+
+class Field(Rule):
+    def __init__(self, tag, name):
+        super().__init__(0, 0, name)
+        self.tag = tag
+        self.first_field = 0
+        self.field_count = 0
+
+
+def referenced_command(command, definitions):
+    if command.find('field') is not None:
+        return None
+    by_name = {definition.get('name'): definition for definition in definitions.values()}
+    for suffix in REFERENCE_SUFFIXES:
+        name = command.get('name') or ''
+        if name.endswith(suffix) and name[:-len(suffix)] in by_name:
+            return by_name[name[:-len(suffix)]]
+    return None
+
+
+def included_fields(element):
+    fields = []
+    for field in element.findall('field'):
+        if parse_int(field.get('id')) is None or any(field.find(tag) is not None for tag in EXCLUDED_CONFORMANCES):
+            continue
+        fields.append(field)
+    return fields
+
+
+class SchemaBuilder:
+    def __init__(self, struct_scopes):
+        self.fields = []
+        # Clusters the type names of the members of every structure are resolved in, by XML element.
+        self.struct_scopes = struct_scopes
+        # Offset and count of the members of every structure already flattened, by XML element.
+        self.structs = {}
+
+    def add_fields(self, elements, scope):
+        # The members of a container are contiguous, their own members are appended after them.
+        first = len(self.fields)
+        self.fields.extend([None] * len(elements))
+        for index, element in enumerate(elements):
+            self.fields[first + index] = self.build_field(element, scope)
+        return first, len(elements)
+
+    def add_struct(self, struct):
+        if struct not in self.structs:
+            # Registered before its members are built, so that recursive structures refer to themselves.
+            members = included_fields(struct)
+            self.structs[struct] = (len(self.fields), len(members))
+            self.add_fields(members, self.struct_scopes[struct])
+        return self.structs[struct]
+
+    def build_field(self, element, scope):
+        field = Field(parse_int(element.get('id')), element.get('name'))
+        self.resolve(field, element.get('type'), scope)
+        if field.type == 'kList':
+            entry = element.find('entry')
+            first = len(self.fields)
+            self.fields.append(None)
+            entry_field = Field(0, '%s[]' % field.name)
+            if entry is not None:
+                self.resolve(entry_field, entry.get('type'), scope)
+                apply_constraints(entry_field, entry)
+            self.fields[first] = entry_field
+            field.first_field, field.field_count = first, 1
+
+        quality = element.find('quality')
+        if quality is not None and quality.get('nullable') == 'true':
+            field.flags.append('kFieldNullable')
+        if element.find('mandatoryConform') is None or len(element.find('mandatoryConform')) > 0:
+            # Fields mandatory under a condition on the device are as good as optional to the generator.
+            field.flags.append('kFieldOptional')
+        apply_constraints(field, element)
+        return field
+
+    def resolve(self, field, type_name, scope):
+        if type_name and type_name.startswith('ref_'):
+            type_name = type_name[len('ref_'):]
+        type_name = TYPE_ALIASES.get(type_name, type_name)
+        for cluster in scope:
+            if type_name in cluster.struct_elements:
+                field.type = 'kStruct'
+                field.first_field, field.field_count = self.add_struct(cluster.struct_elements[type_name])
+                return
+        resolve_type(field, type_name, scope)
+        field.flags = ['kFieldMask' if flag == 'kRuleMask' else flag for flag in field.flags]
+
+
+def build_schemas(clusters):
+    by_key = {cluster.key(): cluster for cluster in clusters}
+    scopes = {}
+    struct_scopes = {}
+    for cluster in clusters:
+        base = by_key.get(cluster.base) if cluster.base else None
+        scopes[cluster] = [cluster] + ([base] if base else [])
+        for struct in cluster.struct_elements.values():
+            struct_scopes[struct] = scopes[cluster]
+    builder = SchemaBuilder(struct_scopes)
+
+    commands = {}
+    for cluster in clusters:
+        base = by_key.get(cluster.base) if cluster.base else None
+        definitions = dict(base.commands) if base else {}
+        for command_id, command in cluster.commands.items():
+            # Derived clusters may only restate the conformance of a command of their base, without its direction.
+            if command.get('direction') is None and base and command_id in base.responses:
+                continue
+            if command_id not in definitions or included_fields(command):
+                definitions[command_id] = command
+        for command_id, command in definitions.items():
+            # The identifiers of a cluster share the fields of its commands.
+            fields = included_fields(referenced_command(command, definitions) or command)
+            first, count = builder.add_fields(fields, scopes[cluster])
+            for cluster_id in cluster.ids:
+                commands[(cluster_id, command_id)] = (first, count, '%s.%s' % (cluster.key(), command.get('name')))
+    return [(key, commands[key]) for key in sorted(commands)], builder.fields
+
+
+def format_bound(value):
+    if value is None:
+        return '0'
+    if value == -(1 << 63):
+        return 'INT64_MIN'
+    return '%d' % value if value >= 0 else '(%d)' % value
+
+
+def generate(commands, fields, source):
+    lines = [
+        '// Generated by gen_command_schemas.py from %s, do not edit.' % source,
+        '#pragma once',
+        '#include "commands/fuzzing/generation/CommandSchemas.h"',
+        '',
+        'namespace chip {',
+        'namespace fuzzing {',
+        'namespace generation {',
+        '',
+    ]
+
+    lines.append('// Sorted by cluster and command, for the binary search of schemas::Find.')
+    lines.append('inline constexpr CommandSchema kCommandSchemas[] = {')
+    for (cluster_id, command_id), (first, count, name) in commands:
+        lines.append('    { 0x%08X, 0x%08X, %d, %d }, // %s' % (cluster_id, command_id, first if count else 0, count, name))
+    lines.append('};')
+    lines.append('')
+
+    values = []
+    lines.append('inline constexpr FieldSchema kFieldSchemas[] = {')
+    for index, field in enumerate(fields):
+        first = len(values)
+        values.extend(field.values)
+        flags = list(dict.fromkeys(field.flags))
+        if field.minimum is not None:
+            flags.append('kFieldHasMinimum')
+        if field.maximum is not None:
+            flags.append('kFieldHasMaximum')
+        lines.append('    { %d, SpecType::%s, %d, %s, %d, %d, %d, %d, %s, %s }, // %d: %s' % (
+            field.tag, field.type, field.size, ' | '.join(flags) if flags else '0', first if field.values else 0,
+            len(field.values), field.first_field, field.field_count, format_bound(field.minimum),
+            format_bound(field.maximum), index, field.name))
+    if not fields:
+        lines.append('    { 0, SpecType::kUnknown, 0, 0, 0, 0, 0, 0, 0, 0 },')
+    lines.append('};')
+    lines.append('')
+
+    lines.append('inline constexpr int64_t kFieldEnumValues[] = {')
+    for index in range(0, len(values), 16):
+        lines.append('    ' + ', '.join('%d' % v for v in values[index:index + 16]) + ',')
+    if not values:
+        lines.append('    0,')
+    lines.append('};')
+    lines.append('')
+    lines.append('} // namespace generation')
+    lines.append('} // namespace fuzzing')
+    lines.append('} // namespace chip')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    parser = optparse.OptionParser()
+    parser.add_option('--output_file', help='The generated header')
+    parser.add_option('--data_model_dir', help='Directory of the cluster XML definitions')
+    parser.add_option('--depfile', help='Depfile listing the XML definitions, for the build system')
+    options, _ = parser.parse_args(argv)
+    if not options.output_file or not options.data_model_dir:
+        parser.error('--output_file and --data_model_dir are required')
+
+    paths = sorted(glob.glob(os.path.join(options.data_model_dir, '*.xml')))
+    clusters = [CommandCluster(ElementTree.parse(path).getroot(), path) for path in paths]
+    commands, fields = build_schemas(clusters)
+    if len(fields) >= 0xFFFF:
+        raise ValueError('Too many fields for the 16-bit indices: %d' % len(fields))
+
+    chip_root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..')
+    source = os.path.relpath(os.path.abspath(options.data_model_dir), os.path.abspath(chip_root)).replace(os.sep, '/')
+    with open(options.output_file, 'w') as output:
+        output.write(generate(commands, fields, source))
+
+    if options.depfile:
+        with open(options.depfile, 'w') as depfile:
+            depfile.write('%s: %s\n' % (options.output_file, ' '.join(paths)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
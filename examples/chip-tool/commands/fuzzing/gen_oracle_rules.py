@@ -0,0 +1,402 @@
+#!/usr/bin/env python
+
+"""Compiles the cluster definitions of the data model XML files into the constexpr rule table of the fuzzer oracle.
+
+Every attribute of every cluster becomes an AttributeRule (see OracleRules.h): its type, access privileges, conformance,
+quality and the literal bounds of its constraints. Constraints which refer to other attributes or features are left out, as
+they can only be evaluated against the state of the device. The rules are indexed by an open-addressing hash table whose
+hash function is mirrored by OracleRules.cpp.
+"""
+
+import glob
+import optparse
+import os
+import sys
+import xml.etree.ElementTree as ElementTree
+
+# Global attributes, which the cluster definitions do not list.
+CLUSTER_REVISION = 0xFFFD
+FEATURE_MAP = 0xFFFC
+GLOBAL_LISTS = {0xFFF8: 'GeneratedCommandList', 0xFFF9: 'AcceptedCommandList', 0xFFFA: 'EventList', 0xFFFB: 'AttributeList'}
+
+INT64_MIN = -(1 << 63)
+INT64_MAX = (1 << 63) - 1
+
+# Type name: (SpecType, size in bytes, implicit minimum, implicit maximum)
+BASE_TYPES = {
+    'bool': ('kBoolean', 0, None, None),
+    'single': ('kFloat', 0, None, None),
+    'double': ('kDouble', 0, None, None),
+    'string': ('kString', 0, None, None),
+    'String': ('kString', 0, None, None),
+    'octstr': ('kOctets', 0, None, None),
+    'ipadr': ('kOctets', 0, None, None),
+    'ipv4adr': ('kOctets', 0, None, None),
+    'ipv6adr': ('kOctets', 0, None, None),
+    'ipv6pre': ('kOctets', 0, None, None),
+    'hwadr': ('kOctets', 0, None, None),
+    'list': ('kList', 0, None, None),
+    'struct': ('kStruct', 0, None, None),
+    'enum8': ('kEnum', 1, None, None),
+    'enum16': ('kEnum', 2, None, None),
+    'status': ('kEnum', 1, None, None),
+    'priority': ('kEnum', 1, None, None),
+    'map8': ('kBitmap', 1, None, None),
+    'map16': ('kBitmap', 2, None, None),
+    'map32': ('kBitmap', 4, None, None),
+    'map64': ('kBitmap', 8, None, None),
+    'percent': ('kUnsigned', 1, None, 100),
+    'percent100ths': ('kUnsigned', 2, None, 10000),
+    'epoch-s': ('kUnsigned', 4, None, None),
+    'epoch-us': ('kUnsigned', 8, None, None),
+    'elapsed-s': ('kUnsigned', 4, None, None),
+    'utc': ('kUnsigned', 4, None, None),
+    'posix-ms': ('kUnsigned', 8, None, None),
+    'systime-us': ('kUnsigned', 8, None, None),
+    'systime-ms': ('kUnsigned', 8, None, None),
+    'vendor-id': ('kUnsigned', 2, None, None),
+    'fabric-idx': ('kUnsigned', 1, None, None),
+    'fabric-id': ('kUnsigned', 8, None, None),
+    'node-id': ('kUnsigned', 8, None, None),
+    'subject-id': ('kUnsigned', 8, None, None),
+    'group-id': ('kUnsigned', 2, None, None),
+    'endpoint-no': ('kUnsigned', 2, None, None),
+    'cluster-id': ('kUnsigned', 4, None, None),
+    'attrib-id': ('kUnsigned', 4, None, None),
+    'field-id': ('kUnsigned', 4, None, None),
+    'event-id': ('kUnsigned', 4, None, None),
+    'command-id': ('kUnsigned', 4, None, None),
+    'action-id': ('kUnsigned', 1, None, None),
+    'trans-id': ('kUnsigned', 4, None, None),
+    'devtype-id': ('kUnsigned', 4, None, None),
+    'entry-idx': ('kUnsigned', 2, None, None),
+    'data-ver': ('kUnsigned', 4, None, None),
+    'event-no': ('kUnsigned', 8, None, None),
+    'temperature': ('kSigned', 2, None, None),
+    'SignedTemperature': ('kSigned', 1, None, None),
+    'UnsignedTemperature': ('kUnsigned', 1, None, None),
+    'TemperatureDifference': ('kSigned', 2, None, None),
+    'power-mW': ('kSigned', 8, None, None),
+    'amperage-mA': ('kSigned', 8, None, None),
+    'voltage-mV': ('kSigned', 8, None, None),
+    'energy-mWh': ('kSigned', 8, None, None),
+    'money': ('kSigned', 8, None, None),
+}
+for bits in range(8, 72, 8):
+    BASE_TYPES['uint%d' % bits] = ('kUnsigned', bits // 8, None, None)
+    BASE_TYPES['int%d' % bits] = ('kSigned', bits // 8, None, None)
+for bits in (8, 16, 32, 64):
+    BASE_TYPES['bitmap%d' % bits] = ('kBitmap', bits // 8, None, None)
+
+PRIVILEGES = {None: 'kNone', 'view': 'kView', 'operate': 'kOperate', 'manage': 'kManage', 'admin': 'kAdminister'}
+
+CONFORMANCES = [
+    ('mandatoryConform', 'kMandatory'),
+    ('optionalConform', 'kOptional'),
+    ('otherwiseConform', 'kOptional'),
+    ('provisionalConform', 'kProvisional'),
+    ('deprecateConform', 'kDeprecated'),
+    ('disallowConform', 'kDisallowed'),
+]
+
+# Constraint kinds, by the SpecType they bound.
+VALUE_CONSTRAINTS = {'min': (True, False), 'max': (False, True), 'between': (True, True)}
+LENGTH_CONSTRAINTS = {'minLength': (True, False), 'maxLength': (False, True), 'lengthBetween': (True, True)}
+COUNT_CONSTRAINTS = {'minCount': (True, False), 'maxCount': (False, True), 'countBetween': (True, True)}
+
+
+def hash_path(cluster, attribute):
+    """Must match HashPath in OracleRules.cpp."""
+    h = ((cluster * 0x9E3779B1) ^ (attribute * 0x85EBCA77)) & 0xFFFFFFFF
+    h ^= h >> 15
+    h = (h * 0x2C1B3C6D) & 0xFFFFFFFF
+    h ^= h >> 12
+    return h
+
+
+def parse_int(text):
+    if text is None:
+        return None
+    try:
+        return int(text, 0)
+    except ValueError:
+        return None
+
+
+class Cluster:
+    def __init__(self, root, path):
+        self.path = path
+        self.name = root.get('name', '')
+        self.ids = [parse_int(c.get('id')) for c in root.iter('clusterId') if parse_int(c.get('id')) is not None]
+        if not self.ids and parse_int(root.get('id')) is not None:
+            self.ids = [parse_int(root.get('id'))]
+        self.revision = parse_int(root.get('revision')) or 1
+        classification = root.find('classification')
+        self.base = classification.get('baseCluster') if classification is not None else None
+        self.features = [parse_int(f.get('bit')) for f in root.iter('feature') if f.get('bit') is not None]
+        self.enums = {}
+        self.bitmaps = {}
+        self.structs = set()
+        data_types = root.find('dataTypes')
+        if data_types is not None:
+            for enum in data_types.findall('enum'):
+                values = (parse_int(item.get('value')) for item in enum.findall('item'))
+                self.enums[enum.get('name')] = [value for value in values if value is not None]
+            for bitmap in data_types.findall('bitmap'):
+                mask = 0
+                for field in bitmap.findall('bitfield'):
+                    bit = parse_int(field.get('bit'))
+                    if bit is not None:
+                        mask |= 1 << bit
+                    elif parse_int(field.get('from')) is not None and parse_int(field.get('to')) is not None:
+                        for b in range(parse_int(field.get('from')), parse_int(field.get('to')) + 1):
+                            mask |= 1 << b
+                self.bitmaps[bitmap.get('name')] = mask
+            for struct in data_types.findall('struct'):
+                self.structs.add(struct.get('name'))
+        self.attributes = {}
+        attributes = root.find('attributes')
+        if attributes is not None:
+            for attribute in attributes.findall('attribute'):
+                attribute_id = parse_int(attribute.get('id'))
+                if attribute_id is not None:
+                    self.attributes[attribute_id] = attribute
+
+    def key(self):
+        return self.name[:-len(' Cluster')] if self.name.endswith(' Cluster') else self.name
+
+
+class Rule:
+    def __init__(self, cluster, attribute, name):
+        self.cluster = cluster
+        self.attribute = attribute
+        self.name = name
+        self.type = 'kUnknown'
+        self.size = 0
+        self.conformance = 'kOptional'
+        self.read = 'kNone'
+        self.write = 'kNone'
+        self.flags = []
+        self.values = []
+        self.minimum = None
+        self.maximum = None
+
+    def bound(self, minimum, maximum):
+        if minimum is not None:
+            self.minimum = max(minimum, INT64_MIN) if self.minimum is None else max(self.minimum, minimum)
+        if maximum is not None:
+            self.maximum = min(maximum, INT64_MAX) if self.maximum is None else min(self.maximum, maximum)
+
+
+def resolve_type(rule, type_name, clusters):
+    if type_name in BASE_TYPES:
+        rule.type, rule.size, minimum, maximum = BASE_TYPES[type_name]
+        rule.bound(minimum, maximum)
+        return
+    for cluster in clusters:
+        if type_name in cluster.enums:
+            values = cluster.enums[type_name]
+            rule.type, rule.size = 'kEnum', 2 if values and max(values) > 0xFF else 1
+            rule.values = sorted(set(values))
+            return
+        if type_name in cluster.bitmaps:
+            mask = cluster.bitmaps[type_name]
+            rule.type, rule.size = 'kBitmap', max(1, (mask.bit_length() + 7) // 8)
+            rule.flags.append('kRuleMask')
+            rule.minimum, rule.maximum = 0, mask
+            return
+        if type_name in cluster.structs:
+            rule.type = 'kStruct'
+            return
+
+
+def apply_attribute(rule, attribute, clusters):
+    if attribute.get('type'):
+        rule.values = []
+        rule.flags = [f for f in rule.flags if f != 'kRuleMask']
+        rule.minimum = rule.maximum = None
+        resolve_type(rule, attribute.get('type'), clusters)
+
+    access = attribute.find('access')
+    if access is not None:
+        rule.read = PRIVILEGES.get(access.get('readPrivilege'), 'kNone') if access.get('read') == 'true' else 'kNone'
+        rule.write = PRIVILEGES.get(access.get('writePrivilege'), 'kNone') if access.get('write') == 'true' else 'kNone'
+        if access.get('fabricScoped') == 'true':
+            rule.flags.append('kRuleFabricScoped')
+
+    quality = attribute.find('quality')
+    if quality is not None and quality.get('nullable') == 'true':
+        rule.flags.append('kRuleNullable')
+
+    for tag, conformance in CONFORMANCES:
+        element = attribute.find(tag)
+        if element is None:
+            continue
+        # Mandatory conformances which depend on features or on other elements only hold for some devices.
+        rule.conformance = 'kConditional' if conformance == 'kMandatory' and len(element) > 0 else conformance
+        break
+
+    apply_constraints(rule, attribute)
+
+
+def apply_constraints(rule, element):
+    for constraint in element.findall('constraint'):
+        kind = constraint.get('type')
+        if rule.type in ('kUnsigned', 'kSigned', 'kEnum'):
+            bounds = VALUE_CONSTRAINTS.get(kind)
+        elif rule.type in ('kString', 'kOctets'):
+            bounds = LENGTH_CONSTRAINTS.get(kind)
+        elif rule.type == 'kList':
+            bounds = COUNT_CONSTRAINTS.get(kind)
+        else:
+            bounds = None
+        if bounds is None:
+            continue
+        if kind.endswith('etween'):
+            rule.bound(parse_int(constraint.get('from')), parse_int(constraint.get('to')))
+        elif bounds[0]:
+            rule.bound(parse_int(constraint.get('value')), None)
+        else:
+            rule.bound(None, parse_int(constraint.get('value')))
+
+
+def build_rules(clusters):
+    by_key = {cluster.key(): cluster for cluster in clusters}
+    rules = {}
+    for cluster in clusters:
+        base = by_key.get(cluster.base) if cluster.base else None
+        scope = [cluster] + ([base] if base else [])
+        for cluster_id in cluster.ids:
+            attributes = dict(base.attributes) if base else {}
+            for attribute_id, attribute in cluster.attributes.items():
+                attributes[attribute_id] = (attributes[attribute_id], attribute) if attribute_id in attributes else attribute
+            for attribute_id, definition in sorted(attributes.items()):
+                definitions = definition if isinstance(definition, tuple) else (definition,)
+                rule = Rule(cluster_id, attribute_id, '%s.%s' % (cluster.key(), definitions[-1].get('name')))
+                for attribute in definitions:
+                    apply_attribute(rule, attribute, scope)
+                rules[(cluster_id, attribute_id)] = rule
+
+            revision = Rule(cluster_id, CLUSTER_REVISION, '%s.ClusterRevision' % cluster.key())
+            revision.type, revision.size, revision.conformance, revision.read = 'kUnsigned', 2, 'kMandatory', 'kView'
+            revision.bound(1, None)
+            rules[(cluster_id, CLUSTER_REVISION)] = revision
+
+            features = Rule(cluster_id, FEATURE_MAP, '%s.FeatureMap' % cluster.key())
+            features.type, features.size, features.conformance, features.read = 'kBitmap', 4, 'kMandatory', 'kView'
+            features.flags.append('kRuleMask')
+            features.minimum, features.maximum = 0, sum(1 << bit for bit in set(cluster.features + (base.features if base else [])))
+            rules[(cluster_id, FEATURE_MAP)] = features
+
+            for attribute_id, name in GLOBAL_LISTS.items():
+                rule = Rule(cluster_id, attribute_id, '%s.%s' % (cluster.key(), name))
+                rule.type, rule.conformance, rule.read = 'kList', 'kMandatory', 'kView'
+                rules[(cluster_id, attribute_id)] = rule
+    return [rules[key] for key in sorted(rules)]
+
+
+def build_slots(rules):
+    size = 1
+    while size < 2 * len(rules):
+        size *= 2
+    slots = [0] * size
+    for index, rule in enumerate(rules):
+        slot = hash_path(rule.cluster, rule.attribute) & (size - 1)
+        while slots[slot] != 0:
+            slot = (slot + 1) & (size - 1)
+        slots[slot] = index + 1
+    return slots
+
+
+def format_bound(value, default):
+    if value is None:
+        return default
+    if value == INT64_MIN:
+        return 'INT64_MIN'
+    return '%d' % value if value >= 0 else '(%d)' % value
+
+
+def generate(rules, slots, source):
+    lines = [
+        '// Generated by gen_oracle_rules.py from %s, do not edit.' % source,
+        '#pragma once',
+        '#include "commands/fuzzing/OracleRules.h"',
+        '',
+        'namespace chip {',
+        'namespace fuzzing {',
+        '',
+    ]
+
+    values = []
+    lines.append('inline constexpr AttributeRule kAttributeRules[] = {')
+    for rule in rules:
+        first = len(values)
+        values.extend(rule.values)
+        flags = list(dict.fromkeys(rule.flags))
+        if rule.read != 'kNone':
+            flags.append('kRuleReadable')
+        if rule.write != 'kNone':
+            flags.append('kRuleWritable')
+        if rule.minimum is not None:
+            flags.append('kRuleHasMinimum')
+        if rule.maximum is not None:
+            flags.append('kRuleHasMaximum')
+        lines.append('    { 0x%08X, 0x%08X, SpecType::%s, %d, Conformance::%s, Privilege::%s, Privilege::%s, %s, %d, %d, %s, %s },'
+                     ' // %s' % (
+            rule.cluster, rule.attribute, rule.type, rule.size, rule.conformance, rule.read, rule.write,
+            ' | '.join(flags) if flags else '0', first if rule.values else 0, len(rule.values),
+            format_bound(rule.minimum, '0'), format_bound(rule.maximum, '0'), rule.name))
+    lines.append('};')
+    lines.append('')
+
+    lines.append('inline constexpr int64_t kEnumValues[] = {')
+    for index in range(0, len(values), 16):
+        lines.append('    ' + ', '.join('%d' % v for v in values[index:index + 16]) + ',')
+    if not values:
+        lines.append('    0,')
+    lines.append('};')
+    lines.append('')
+
+    lines.append('// Open-addressing index of kAttributeRules, holding the index of the rule plus one, 0 for an empty slot.')
+    lines.append('inline constexpr uint16_t kAttributeRuleSlots[] = {')
+    for index in range(0, len(slots), 16):
+        lines.append('    ' + ', '.join('%d' % s for s in slots[index:index + 16]) + ',')
+    lines.append('};')
+    lines.append('')
+    lines.append('static_assert((sizeof(kAttributeRuleSlots) / sizeof(kAttributeRuleSlots[0]) & '
+                 '(sizeof(kAttributeRuleSlots) / sizeof(kAttributeRuleSlots[0]) - 1)) == 0);')
+    lines.append('')
+    lines.append('} // namespace fuzzing')
+    lines.append('} // namespace chip')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    parser = optparse.OptionParser()
+    parser.add_option('--output_file', help='The generated header')
+    parser.add_option('--data_model_dir', help='Directory of the cluster XML definitions')
+    parser.add_option('--depfile', help='Depfile listing the XML definitions, for the build system')
+    options, _ = parser.parse_args(argv)
+    if not options.output_file or not options.data_model_dir:
+        parser.error('--output_file and --data_model_dir are required')
+
+    paths = sorted(glob.glob(os.path.join(options.data_model_dir, '*.xml')))
+    clusters = [Cluster(ElementTree.parse(path).getroot(), path) for path in paths]
+    rules = build_rules(clusters)
+    if len(rules) >= 0xFFFF:
+        raise ValueError('Too many rules for the 16-bit slots: %d' % len(rules))
+    slots = build_slots(rules)
+
+    chip_root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..')
+    source = os.path.relpath(os.path.abspath(options.data_model_dir), os.path.abspath(chip_root)).replace(os.sep, '/')
+    with open(options.output_file, 'w') as output:
+        output.write(generate(rules, slots, source))
+
+    if options.depfile:
+        with open(options.depfile, 'w') as depfile:
+            depfile.write('%s: %s\n' % (options.output_file, ' '.join(paths)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,1032 @@
+#include "CommandGenerator.h"
+#include "../Visitors.h"
+#include "../tlv/DecodedTLVElement.h"
+#include <app-common/zap-generated/ids/Attributes.h>
+#include <cmath>
+#include <cstring>
+#include <inttypes.h>
+#include <lib/core/TLVReader.h>
+#include <lib/core/TLVWriter.h>
+
+namespace gen = chip::fuzzing::generation;
+
+namespace {
+// Characters allowed inside generated strings. Spaces, quotes and backslashes are excluded because the chip-tool command string
+// is split on spaces and the payload is not escaped.
+constexpr char kStringAlphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-.:/+*#@!?%&=<>()[]{}|~^$";
+constexpr char kHexAlphabet[]    = "0123456789abcdef";
+// Maximum number of attempts to fit a TLV payload into the GeneratedCommand buffer.
+constexpr uint8_t kMaxEncodingAttempts = 8;
+// Integers are generated in an order-preserving unsigned space, where signed values are offset by 2^63.
+constexpr uint64_t kSignBias = 1ULL << 63;
+// One value out of this many of a nullable field is null.
+constexpr uint64_t kNullOdds = 8;
+// Maximum number of entries of a list generated to violate its constraints.
+constexpr uint64_t kMaxOutOfRangeEntries = 16;
+
+enum class ValueKind : uint8_t
+{
+    kObject,
+    kArray,
+    kList,
+    kString,
+    kOctetString,
+    kSignedInteger,
+    kUnsignedInteger,
+    kFloat,
+    kDouble,
+    kTrue,
+    kFalse,
+    kNull,
+    kCount,
+};
+
+/**
+ * Writes generated values in the chip-tool JSON notation.
+ */
+class JsonEmitter
+{
+public:
+    // JSON payloads must be accepted by the chip-tool command parser, so values are restricted to what it can express.
+    static constexpr bool kUnrestricted = false;
+
+    JsonEmitter(std::string & buffer) : mBuffer(buffer) {}
+
+    void BeginObject() { Begin('{'); }
+    void EndObject() { End('}'); }
+    void BeginArray() { Begin('['); }
+    void EndArray() { End(']'); }
+    // The JSON notation has no list type: an array is emitted instead.
+    void BeginList() { Begin('['); }
+    void EndList() { End(']'); }
+
+    void Key(uint8_t key)
+    {
+        Separate();
+        mBuffer.push_back('"');
+        AppendNumber(key);
+        mBuffer.append("\":");
+        mKeyPending = true;
+    }
+
+    void String(const char * data, size_t length)
+    {
+        Separate();
+        mBuffer.push_back('"');
+        mBuffer.append(data, length);
+        mBuffer.push_back('"');
+    }
+
+    void OctetString(const uint8_t * data, size_t length)
+    {
+        Separate();
+        mBuffer.append("\"hex:");
+        for (size_t i = 0; i < length; i++)
+        {
+            mBuffer.push_back(kHexAlphabet[(data[i] >> 4) & 0xF]);
+            mBuffer.push_back(kHexAlphabet[data[i] & 0xF]);
+        }
+        mBuffer.push_back('"');
+    }
+
+    template <typename T>
+    void Integer(T value)
+    {
+        Separate();
+        mBuffer.append(std::is_signed_v<T> ? "\"s:" : "\"u:");
+        AppendNumber(value);
+        mBuffer.push_back('"');
+    }
+
+    void Float(float value) { FloatingPoint("\"f:%.9g\"", static_cast<double>(value)); }
+    void Double(double value) { FloatingPoint("\"d:%.17g\"", value); }
+
+    void Boolean(bool value)
+    {
+        Separate();
+        mBuffer.append(value ? "true" : "false");
+    }
+
+    void Null()
+    {
+        Separate();
+        mBuffer.append("null");
+    }
+
+private:
+    std::string & mBuffer;
+    // One bit per nesting level, set when the container at that level already holds an element.
+    uint64_t mHasElements = 0;
+    uint8_t mDepth        = 0;
+    bool mKeyPending      = false;
+
+    void Separate()
+    {
+        // Values following a key are already separated by the key itself.
+        if (mKeyPending)
+        {
+            mKeyPending = false;
+            return;
+        }
+        if (mDepth > 0 && (mHasElements & (1ULL << mDepth)))
+        {
+            mBuffer.push_back(',');
+        }
+        mHasElements |= (1ULL << mDepth);
+    }
+
+    void Begin(char delimiter)
+    {
+        Separate();
+        VerifyOrDie(mDepth < 63);
+        mBuffer.push_back(delimiter);
+        mDepth++;
+        mHasElements &= ~(1ULL << mDepth);
+    }
+
+    void End(char delimiter)
+    {
+        mBuffer.push_back(delimiter);
+        mDepth--;
+    }
+
+    void FloatingPoint(const char * format, double value)
+    {
+        Separate();
+        char buffer[40];
+        // Non-finite values cannot be expressed in the chip-tool JSON notation.
+        int written = snprintf(buffer, sizeof(buffer), format, std::isfinite(value) ? value : 0.0);
+        VerifyOrDie(written > 0 && static_cast<size_t>(written) < sizeof(buffer));
+        mBuffer.append(buffer, static_cast<size_t>(written));
+    }
+
+    template <typename T>
+    void AppendNumber(T value)
+    {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        VerifyOrDie(result.ec == std::errc());
+        mBuffer.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    }
+};
+
+/**
+ * Writes generated values straight into a TLVWriter. Structure members take a context tag from their key, while array and list
+ * members are anonymous. The first error is latched and returned by GetError().
+ */
+class TLVEmitter
+{
+public:
+    static constexpr bool kUnrestricted = true;
+
+    TLVEmitter(chip::TLV::TLVWriter & writer) : mWriter(writer) {}
+
+    CHIP_ERROR GetError() const { return mError; }
+    chip::TLV::TLVWriter & GetWriter() { return mWriter; }
+
+    void Latch(CHIP_ERROR err)
+    {
+        if (mError == CHIP_NO_ERROR)
+        {
+            mError = err;
+        }
+    }
+
+    void BeginObject() { Begin(chip::TLV::kTLVType_Structure); }
+    void EndObject() { End(); }
+    void BeginArray() { Begin(chip::TLV::kTLVType_Array); }
+    void EndArray() { End(); }
+    void BeginList() { Begin(chip::TLV::kTLVType_List); }
+    void EndList() { End(); }
+
+    void Key(uint8_t key) { mTag = chip::TLV::ContextTag(key); }
+    // Tags the next value with an arbitrary tag, e.g. the one of the element it replaces.
+    void Tag(chip::TLV::Tag tag) { mTag = tag; }
+
+    void String(const char * data, size_t length)
+    {
+        Latch(mWriter.PutString(TakeTag(), data, static_cast<uint32_t>(length)));
+    }
+    void OctetString(const uint8_t * data, size_t length)
+    {
+        Latch(mWriter.PutBytes(TakeTag(), data, static_cast<uint32_t>(length)));
+    }
+    template <typename T>
+    void Integer(T value)
+    {
+        // Keep the generated width, instead of letting the writer pick the smallest encoding.
+        Latch(mWriter.Put(TakeTag(), value, true));
+    }
+    void Float(float value) { Latch(mWriter.Put(TakeTag(), value)); }
+    void Double(double value) { Latch(mWriter.Put(TakeTag(), value)); }
+    void Boolean(bool value) { Latch(mWriter.PutBoolean(TakeTag(), value)); }
+    void Null() { Latch(mWriter.PutNull(TakeTag())); }
+
+private:
+    static constexpr uint8_t kMaxDepth = 64;
+
+    chip::TLV::TLVWriter & mWriter;
+    chip::TLV::Tag mTag = chip::TLV::AnonymousTag();
+    chip::TLV::TLVType mOuterContainers[kMaxDepth];
+    uint8_t mDepth    = 0;
+    CHIP_ERROR mError = CHIP_NO_ERROR;
+
+    chip::TLV::Tag TakeTag()
+    {
+        chip::TLV::Tag tag = mTag;
+        mTag               = chip::TLV::AnonymousTag();
+        return tag;
+    }
+
+    void Begin(chip::TLV::TLVType type)
+    {
+        VerifyOrDie(mDepth < kMaxDepth);
+        chip::TLV::Tag tag = TakeTag();
+        if (mError == CHIP_NO_ERROR)
+        {
+            Latch(mWriter.StartContainer(tag, type, mOuterContainers[mDepth]));
+        }
+        mDepth++;
+    }
+
+    void End()
+    {
+        mDepth--;
+        if (mError == CHIP_NO_ERROR)
+        {
+            Latch(mWriter.EndContainer(mOuterContainers[mDepth]));
+        }
+    }
+};
+} // namespace
+
+namespace chip {
+namespace fuzzing {
+namespace generation {
+/**
+ * Holds the random decisions taken while generating a payload, independently of the encoding. The emitter receives the generated
+ * values in document order.
+ */
+template <typename Emitter>
+class PayloadGenerator
+{
+public:
+    PayloadGenerator(CommandGenerator & generator, Emitter & emitter) : mGenerator(generator), mEmitter(emitter) {}
+
+    Emitter & GetEmitter() { return mEmitter; }
+
+    // Generates the CommandFields of a command following its schema.
+    void GenerateCommandFields(const CommandSchema & schema)
+    {
+        mEmitter.BeginObject();
+        GenerateFields(schema.firstField, schema.fieldCount, 0);
+        mEmitter.EndObject();
+    }
+
+    void GenerateObject(uint16_t depth)
+    {
+        mEmitter.BeginObject();
+        uint64_t elements = mGenerator.Random(CommandGenerator::kMaxContainerElements + 1);
+        for (uint64_t i = 0; i < elements; i++)
+        {
+            GenerateMember(depth);
+        }
+        mEmitter.EndObject();
+    }
+
+    // Generates a member of an object at the given depth, under a random context tag.
+    void GenerateMember(uint16_t depth)
+    {
+        // Most command fields have small context tags, but any UINT8 key is allowed by the grammar.
+        uint64_t key = mGenerator.Random(4) ? mGenerator.Random(8) : mGenerator.Random(UINT8_MAX + 1);
+        mEmitter.Key(static_cast<uint8_t>(key));
+        GenerateValue(static_cast<uint16_t>(depth + 1));
+    }
+
+    void GenerateValue(uint16_t depth)
+    {
+        // Containers are not generated past the maximum depth, so that the recursion always terminates.
+        uint64_t first = depth >= mGenerator.mMaxDepth ? static_cast<uint64_t>(ValueKind::kString) : 0;
+        auto kind      = static_cast<ValueKind>(first + mGenerator.Random(static_cast<uint64_t>(ValueKind::kCount) - first));
+        switch (kind)
+        {
+        case ValueKind::kObject:
+            GenerateObject(depth);
+            break;
+        case ValueKind::kArray:
+            mEmitter.BeginArray();
+            GenerateElements(depth);
+            mEmitter.EndArray();
+            break;
+        case ValueKind::kList:
+            mEmitter.BeginList();
+            GenerateElements(depth);
+            mEmitter.EndList();
+            break;
+        case ValueKind::kString:
+            GenerateString(mGenerator.Random(CommandGenerator::kMaxStringLength + 1), !Emitter::kUnrestricted);
+            break;
+        case ValueKind::kOctetString:
+            // The "hex:" notation needs at least one octet.
+            GenerateOctetString(mGenerator.Random(CommandGenerator::kMaxStringLength) + (Emitter::kUnrestricted ? 0 : 1));
+            break;
+        case ValueKind::kSignedInteger:
+            GenerateInteger<int8_t, int16_t, int32_t, int64_t>();
+            break;
+        case ValueKind::kUnsignedInteger:
+            GenerateInteger<uint8_t, uint16_t, uint32_t, uint64_t>();
+            break;
+        case ValueKind::kFloat: {
+            uint32_t bits = static_cast<uint32_t>(mGenerator.mRandom());
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            mEmitter.Float(value);
+            break;
+        }
+        case ValueKind::kDouble: {
+            uint64_t bits = mGenerator.mRandom();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            mEmitter.Double(value);
+            break;
+        }
+        case ValueKind::kTrue:
+            mEmitter.Boolean(true);
+            break;
+        case ValueKind::kFalse:
+            mEmitter.Boolean(false);
+            break;
+        default:
+            mEmitter.Null();
+            break;
+        }
+    }
+
+private:
+    enum class Malformation : uint8_t
+    {
+        kOmitted,
+        kNull,
+        kOutOfRange,
+        kWrongType,
+        kCount,
+    };
+
+    CommandGenerator & mGenerator;
+    Emitter & mEmitter;
+
+    void GenerateFields(uint16_t first, uint16_t count, uint16_t depth)
+    {
+        for (uint16_t index = first; index < first + count; index++)
+        {
+            const FieldSchema & field = schemas::GetField(index);
+            mGenerator.mStatistics.fields++;
+            if (mGenerator.Random(100) < mGenerator.mMalformedPercent)
+            {
+                mGenerator.mStatistics.malformedFields++;
+                GenerateMalformedField(field, depth);
+                continue;
+            }
+            // Optional fields are left out half of the time.
+            if (field.Has(kFieldOptional) && mGenerator.Random(2) == 0)
+            {
+                continue;
+            }
+            mEmitter.Key(field.tag);
+            GenerateField(field, depth);
+        }
+    }
+
+    // Generates a value of the type of the field, within its constraints.
+    void GenerateField(const FieldSchema & field, uint16_t depth)
+    {
+        if (field.Has(kFieldNullable) && mGenerator.Random(kNullOdds) == 0)
+        {
+            mEmitter.Null();
+            return;
+        }
+
+        switch (field.type)
+        {
+        case SpecType::kBoolean:
+            mEmitter.Boolean(mGenerator.Random(2) != 0);
+            break;
+        case SpecType::kUnsigned:
+        case SpecType::kSigned:
+        case SpecType::kEnum:
+        case SpecType::kBitmap:
+            EmitInteger(field, GenerateInteger(field));
+            break;
+        case SpecType::kFloat:
+            mEmitter.Float(static_cast<float>(GenerateFinite()));
+            break;
+        case SpecType::kDouble:
+            mEmitter.Double(GenerateFinite());
+            break;
+        case SpecType::kString:
+            GenerateString(GenerateSize(field, CommandGenerator::kMaxStringLength, 0), true);
+            break;
+        case SpecType::kOctets:
+            GenerateOctetString(GenerateSize(field, CommandGenerator::kMaxStringLength, Emitter::kUnrestricted ? 0 : 1));
+            break;
+        case SpecType::kList: {
+            // No entries past the maximum depth, so that the recursion always terminates.
+            uint64_t limit   = depth >= mGenerator.mMaxDepth ? 0 : CommandGenerator::kMaxContainerElements;
+            uint64_t entries = GenerateSize(field, limit, 0);
+            GenerateEntries(field, entries, depth);
+            break;
+        }
+        case SpecType::kStruct:
+            mEmitter.BeginObject();
+            if (depth < mGenerator.mMaxDepth)
+            {
+                GenerateFields(field.firstField, field.fieldCount, static_cast<uint16_t>(depth + 1));
+            }
+            mEmitter.EndObject();
+            break;
+        default:
+            GenerateValue(depth);
+            break;
+        }
+    }
+
+    void GenerateMalformedField(const FieldSchema & field, uint16_t depth)
+    {
+        auto malformation = static_cast<Malformation>(mGenerator.Random(static_cast<uint64_t>(Malformation::kCount)));
+        // Leaving an optional field out is well-formed, it gets a value of another type instead.
+        if (malformation == Malformation::kOmitted && !field.Has(kFieldOptional))
+        {
+            return;
+        }
+        mEmitter.Key(field.tag);
+        if (malformation == Malformation::kNull && !field.Has(kFieldNullable))
+        {
+            mEmitter.Null();
+            return;
+        }
+        if (malformation == Malformation::kOutOfRange && GenerateOutOfRange(field, depth))
+        {
+            return;
+        }
+        // Any value, most likely of another type.
+        GenerateValue(depth);
+    }
+
+    // Generates a value of the type of the field which violates its constraints, returns false if it has none to violate.
+    bool GenerateOutOfRange(const FieldSchema & field, uint16_t depth)
+    {
+        switch (field.type)
+        {
+        case SpecType::kUnsigned:
+        case SpecType::kSigned:
+        case SpecType::kEnum:
+        case SpecType::kBitmap: {
+            uint64_t value;
+            VerifyOrReturnValue(GenerateIntegerOutOfRange(field, value), false);
+            uint64_t low;
+            uint64_t high;
+            GetWidthBounds(field, low, high);
+            if (value >= low && value <= high)
+            {
+                EmitInteger(field, value);
+            }
+            else if (field.type == SpecType::kSigned)
+            {
+                // Only a wider integer holds the value.
+                mEmitter.Integer(static_cast<int64_t>(value ^ kSignBias));
+            }
+            else
+            {
+                mEmitter.Integer(value);
+            }
+            return true;
+        }
+        case SpecType::kString:
+        case SpecType::kOctets: {
+            const uint64_t floor = (field.type == SpecType::kOctets && !Emitter::kUnrestricted) ? 1 : 0;
+            uint64_t length;
+            if (field.Has(kFieldHasMaximum) && field.maximum >= 0 &&
+                static_cast<uint64_t>(field.maximum) < CommandGenerator::kMaxStringLength)
+            {
+                uint64_t maximum = static_cast<uint64_t>(field.maximum);
+                length           = maximum + 1 + mGenerator.Random(CommandGenerator::kMaxStringLength - maximum);
+            }
+            else if (field.Has(kFieldHasMinimum) && field.minimum > static_cast<int64_t>(floor))
+            {
+                length = floor + mGenerator.Random(static_cast<uint64_t>(field.minimum) - floor);
+            }
+            else if (field.type == SpecType::kString && Emitter::kUnrestricted)
+            {
+                // No length to violate, but the bytes of the string may not be valid UTF-8.
+                GenerateString(mGenerator.Random(CommandGenerator::kMaxStringLength) + 1, false);
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+            if (field.type == SpecType::kString)
+            {
+                GenerateString(length, true);
+            }
+            else
+            {
+                GenerateOctetString(length);
+            }
+            return true;
+        }
+        case SpecType::kList: {
+            uint64_t entries;
+            if (field.Has(kFieldHasMaximum) && field.maximum >= 0 &&
+                static_cast<uint64_t>(field.maximum) < kMaxOutOfRangeEntries)
+            {
+                entries = static_cast<uint64_t>(field.maximum) + 1;
+            }
+            else if (field.Has(kFieldHasMinimum) && field.minimum > 0)
+            {
+                entries = mGenerator.Random(std::min<uint64_t>(static_cast<uint64_t>(field.minimum), kMaxOutOfRangeEntries));
+            }
+            else
+            {
+                return false;
+            }
+            GenerateEntries(field, entries, depth);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // Lists are encoded as arrays: the data model has no list type, the lists of the specification are TLV arrays.
+    void GenerateEntries(const FieldSchema & field, uint64_t entries, uint16_t depth)
+    {
+        mEmitter.BeginArray();
+        for (uint64_t i = 0; i < entries && field.fieldCount > 0; i++)
+        {
+            GenerateField(schemas::GetField(field.firstField), static_cast<uint16_t>(depth + 1));
+        }
+        mEmitter.EndArray();
+    }
+
+    // Picks a length or a number of entries within the constraints of the field, between floor and limit.
+    uint64_t GenerateSize(const FieldSchema & field, uint64_t limit, uint64_t floor)
+    {
+        uint64_t low  = field.Has(kFieldHasMinimum) && field.minimum > 0 ? static_cast<uint64_t>(field.minimum) : 0;
+        uint64_t high = field.Has(kFieldHasMaximum) && field.maximum >= 0 ? static_cast<uint64_t>(field.maximum) : limit;
+        low           = std::min(std::max(low, floor), limit);
+        high          = std::min(std::max(high, low), limit);
+        return low + mGenerator.Random(high - low + 1);
+    }
+
+    // Values of the integer fields are held in the ordered space, see kSignBias.
+    static uint64_t ToOrdered(const FieldSchema & field, int64_t value)
+    {
+        if (field.type == SpecType::kSigned)
+        {
+            return static_cast<uint64_t>(value) ^ kSignBias;
+        }
+        return value < 0 ? 0 : static_cast<uint64_t>(value);
+    }
+
+    static void GetWidthBounds(const FieldSchema & field, uint64_t & low, uint64_t & high)
+    {
+        const unsigned bits = std::clamp<unsigned>(field.size, 1, 8) * 8;
+        const uint64_t span = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+        low                 = field.type == SpecType::kSigned ? kSignBias - (span / 2 + 1) : 0;
+        high                = field.type == SpecType::kSigned ? kSignBias + span / 2 : span;
+    }
+
+    // Bounds of the values of a numeric field: its width, narrowed by its constraints.
+    static void GetBounds(const FieldSchema & field, uint64_t & low, uint64_t & high)
+    {
+        GetWidthBounds(field, low, high);
+        uint64_t minimum = field.Has(kFieldHasMinimum) ? std::max(low, ToOrdered(field, field.minimum)) : low;
+        uint64_t maximum = field.Has(kFieldHasMaximum) ? std::min(high, ToOrdered(field, field.maximum)) : high;
+        // Constraints beyond the width of the field are ignored.
+        if (minimum <= maximum)
+        {
+            low  = minimum;
+            high = maximum;
+        }
+    }
+
+    uint64_t GenerateInteger(const FieldSchema & field)
+    {
+        if (field.type == SpecType::kEnum && field.valueCount > 0)
+        {
+            return ToOrdered(field, schemas::GetEnumValue(field, static_cast<uint16_t>(mGenerator.Random(field.valueCount))));
+        }
+        if (field.type == SpecType::kBitmap && field.Has(kFieldMask))
+        {
+            return mGenerator.mRandom() & static_cast<uint64_t>(field.maximum);
+        }
+
+        uint64_t low;
+        uint64_t high;
+        GetBounds(field, low, high);
+        // The bounds themselves are picked more often, as off-by-one mistakes happen there.
+        switch (mGenerator.Random(8))
+        {
+        case 0:
+            return low;
+        case 1:
+            return high;
+        default:
+            return high - low == UINT64_MAX ? mGenerator.mRandom() : low + mGenerator.Random(high - low + 1);
+        }
+    }
+
+    bool GenerateIntegerOutOfRange(const FieldSchema & field, uint64_t & value)
+    {
+        if (field.type == SpecType::kEnum && field.valueCount > 0)
+        {
+            // Right past the defined values, where a missing bounds check is most likely.
+            int64_t last = schemas::GetEnumValue(field, static_cast<uint16_t>(field.valueCount - 1));
+            value        = ToOrdered(field, last) + 1 + mGenerator.Random(4);
+            return !schemas::IsAllowedValue(field, static_cast<int64_t>(value));
+        }
+        uint64_t low;
+        uint64_t high;
+        if (field.type == SpecType::kBitmap && field.Has(kFieldMask))
+        {
+            // Sets one of the bits the bitmap does not define.
+            GetWidthBounds(field, low, high);
+            uint64_t undefined = high & ~static_cast<uint64_t>(field.maximum);
+            VerifyOrReturnValue(undefined != 0, false);
+            value = (mGenerator.mRandom() & high) | (undefined & (~undefined + 1));
+            return true;
+        }
+
+        // Right outside the bounds, possibly beyond the width of the field.
+        GetBounds(field, low, high);
+        const bool below = low > 0;
+        const bool above = high < UINT64_MAX;
+        VerifyOrReturnValue(below || above, false);
+        value = (below && (!above || mGenerator.Random(2) == 0)) ? low - 1 : high + 1;
+        return true;
+    }
+
+    // Emits an integer of the width of the field.
+    void EmitInteger(const FieldSchema & field, uint64_t value)
+    {
+        const bool isSigned = field.type == SpecType::kSigned;
+        if (isSigned)
+        {
+            value ^= kSignBias;
+        }
+        switch (field.size)
+        {
+        case 1:
+            isSigned ? mEmitter.Integer(static_cast<int8_t>(value)) : mEmitter.Integer(static_cast<uint8_t>(value));
+            break;
+        case 2:
+            isSigned ? mEmitter.Integer(static_cast<int16_t>(value)) : mEmitter.Integer(static_cast<uint16_t>(value));
+            break;
+        case 3:
+        case 4:
+            isSigned ? mEmitter.Integer(static_cast<int32_t>(value)) : mEmitter.Integer(static_cast<uint32_t>(value));
+            break;
+        default:
+            isSigned ? mEmitter.Integer(static_cast<int64_t>(value)) : mEmitter.Integer(value);
+            break;
+        }
+    }
+
+    // Finite values, which both the JSON notation and the cluster logic can take.
+    double GenerateFinite() { return static_cast<double>(static_cast<int32_t>(mGenerator.mRandom())) / 65536.0; }
+
+    void GenerateElements(uint16_t depth)
+    {
+        uint64_t elements = mGenerator.Random(CommandGenerator::kMaxContainerElements + 1);
+        for (uint64_t i = 0; i < elements; i++)
+        {
+            GenerateValue(static_cast<uint16_t>(depth + 1));
+        }
+    }
+
+    // Printable strings only hold characters of kStringAlphabet, the others any byte but the NUL terminator, including invalid
+    // UTF-8 sequences. The JSON notation only takes printable strings.
+    void GenerateString(uint64_t length, bool printable)
+    {
+        char buffer[CommandGenerator::kMaxStringLength];
+        length = std::min<uint64_t>(length, sizeof(buffer));
+        for (uint64_t i = 0; i < length; i++)
+        {
+            if (printable || !Emitter::kUnrestricted)
+            {
+                buffer[i] = kStringAlphabet[mGenerator.Random(sizeof(kStringAlphabet) - 1)];
+            }
+            else
+            {
+                buffer[i] = static_cast<char>(mGenerator.Random(UINT8_MAX) + 1);
+            }
+        }
+        mEmitter.String(buffer, static_cast<size_t>(length));
+    }
+
+    void GenerateOctetString(uint64_t length)
+    {
+        uint8_t buffer[CommandGenerator::kMaxStringLength];
+        length = std::min<uint64_t>(length, sizeof(buffer));
+        for (uint64_t i = 0; i < length; i++)
+        {
+            buffer[i] = static_cast<uint8_t>(mGenerator.mRandom());
+        }
+        mEmitter.OctetString(buffer, static_cast<size_t>(length));
+    }
+
+    // Picks one of the 8, 16, 32 and 64 bits widths, as the grammar does.
+    template <typename T8, typename T16, typename T32, typename T64>
+    void GenerateInteger()
+    {
+        switch (mGenerator.Random(4))
+        {
+        case 0:
+            mEmitter.Integer(static_cast<T8>(mGenerator.mRandom()));
+            break;
+        case 1:
+            mEmitter.Integer(static_cast<T16>(mGenerator.mRandom()));
+            break;
+        case 2:
+            mEmitter.Integer(static_cast<T32>(mGenerator.mRandom()));
+            break;
+        default:
+            mEmitter.Integer(static_cast<T64>(mGenerator.mRandom()));
+            break;
+        }
+    }
+};
+
+namespace {
+// Counts the elements of a TLV payload in document order, the members of the containers included.
+CHIP_ERROR CountElements(chip::TLV::TLVReader & reader, uint32_t & count)
+{
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        count++;
+        if (chip::TLV::TLVTypeIsContainer(reader.GetType()))
+        {
+            chip::TLV::TLVType outer;
+            ReturnErrorOnFailure(reader.EnterContainer(outer));
+            ReturnErrorOnFailure(CountElements(reader, count));
+            ReturnErrorOnFailure(reader.ExitContainer(outer));
+        }
+    }
+    return err == CHIP_END_OF_TLV ? CHIP_NO_ERROR : err;
+}
+
+// Copies a TLV payload, replacing the element with the target index (as counted by CountElements) with a generated value.
+CHIP_ERROR CopyReplacing(chip::TLV::TLVReader & reader, PayloadGenerator<TLVEmitter> & generator, uint32_t & index,
+                         uint32_t target, uint16_t depth)
+{
+    TLVEmitter & emitter          = generator.GetEmitter();
+    chip::TLV::TLVWriter & writer = emitter.GetWriter();
+
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        if (index++ == target)
+        {
+            emitter.Tag(reader.GetTag());
+            generator.GenerateValue(depth);
+            ReturnErrorOnFailure(emitter.GetError());
+        }
+        else if (chip::TLV::TLVTypeIsContainer(reader.GetType()))
+        {
+            chip::TLV::TLVType readerOuter;
+            chip::TLV::TLVType writerOuter;
+            ReturnErrorOnFailure(writer.StartContainer(reader.GetTag(), reader.GetType(), writerOuter));
+            ReturnErrorOnFailure(reader.EnterContainer(readerOuter));
+            ReturnErrorOnFailure(CopyReplacing(reader, generator, index, target, static_cast<uint16_t>(depth + 1)));
+            ReturnErrorOnFailure(reader.ExitContainer(readerOuter));
+            ReturnErrorOnFailure(writer.EndContainer(writerOuter));
+        }
+        else
+        {
+            ReturnErrorOnFailure(writer.CopyElement(reader));
+        }
+    }
+    return err == CHIP_END_OF_TLV ? CHIP_NO_ERROR : err;
+}
+} // namespace
+} // namespace generation
+} // namespace fuzzing
+} // namespace chip
+
+CHIP_ERROR gen::CommandGenerator::Initialize(DeviceStateManager * deviceState, chip::NodeId node)
+{
+    VerifyOrReturnError(deviceState != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    mCommandPaths.clear();
+    mCommandSchemas.clear();
+    mAttributePaths.clear();
+
+    for (auto & endpoint : *deviceState->List(node))
+    {
+        for (auto & cluster : endpoint.second.clusters)
+        {
+            for (auto & attribute : cluster.second.attributes)
+            {
+                mAttributePaths.push_back(AttributePath{ endpoint.first, cluster.first, attribute.first });
+            }
+
+            const AnyType & commandList = deviceState->ReadAttribute(
+                node, endpoint.first, cluster.first, chip::app::Clusters::Globals::Attributes::AcceptedCommandList::Id);
+            if (!std::holds_alternative<ContainerType>(commandList))
+                continue;
+
+            for (const auto & command : std::get<ContainerType>(commandList))
+            {
+                auto commandId = Visitors::TLV::ConvertToIdType<uint32_t>(command);
+                mCommandPaths.push_back(CommandPath{ endpoint.first, cluster.first, commandId });
+                mCommandSchemas.push_back(schemas::Find(cluster.first, commandId));
+            }
+        }
+    }
+
+    VerifyOrReturnError(!mCommandPaths.empty(), CHIP_FUZZER_ERROR_NOT_FOUND);
+    size_t guided = mCommandPaths.size() - static_cast<size_t>(std::count(mCommandSchemas.begin(), mCommandSchemas.end(), nullptr));
+    ChipLogProgress(chipFuzzer,
+                    "Native generator initialized with %zu command paths (%zu with a schema) and %zu attribute paths, %u%% of the "
+                    "fields malformed.",
+                    mCommandPaths.size(), guided, mAttributePaths.size(), mMalformedPercent);
+    return CHIP_NO_ERROR;
+}
+
+void gen::CommandGenerator::LogStatistics() const
+{
+    ChipLogProgress(chipFuzzer,
+                    "Generation statistics: %" PRIu64 " payloads following the schema of their command, %" PRIu64
+                    " without schema, %" PRIu64 " fields (%" PRIu64 " malformed)",
+                    mStatistics.guidedPayloads, mStatistics.unguidedPayloads, mStatistics.fields, mStatistics.malformedFields);
+}
+
+const std::string & gen::CommandGenerator::Next()
+{
+    VerifyOrDie(!mCommandPaths.empty());
+    const size_t index           = NextPathIndex();
+    const CommandPath & path     = mCommandPaths[index];
+    const CommandSchema * schema = mCommandSchemas[index];
+
+    mBuffer.clear();
+    AppendNumber(path.endpoint);
+    mBuffer.push_back(' ');
+    AppendNumber(path.cluster);
+    mBuffer.push_back(' ');
+    AppendNumber(path.command);
+    mBuffer.push_back(' ');
+
+    JsonEmitter emitter(mBuffer);
+    PayloadGenerator<JsonEmitter> generator(*this, emitter);
+    if (schema != nullptr)
+    {
+        mStatistics.guidedPayloads++;
+        generator.GenerateCommandFields(*schema);
+    }
+    else
+    {
+        mStatistics.unguidedPayloads++;
+        generator.GenerateObject(0);
+    }
+    return mBuffer;
+}
+
+void gen::CommandGenerator::GenerateTestCases(std::vector<std::string> & out, size_t numCases)
+{
+    out.reserve(out.size() + numCases);
+    for (size_t i = 0; i < numCases; i++)
+    {
+        out.push_back(Next());
+    }
+    ChipLogProgress(chipFuzzer, "Generated %zu test cases.", numCases);
+}
+
+template <typename Generate>
+CHIP_ERROR gen::CommandGenerator::Encode(GeneratedCommand & testCase, Generate && generate)
+{
+    // Deep payloads may not fit the buffer: in that case a new one is generated for the same path.
+    CHIP_ERROR err = CHIP_NO_ERROR;
+    for (uint8_t attempt = 0; attempt < kMaxEncodingAttempts; attempt++)
+    {
+        chip::TLV::TLVWriter writer;
+        writer.Init(testCase.payload, sizeof(testCase.payload));
+
+        TLVEmitter emitter(writer);
+        PayloadGenerator<TLVEmitter> payloadGenerator(*this, emitter);
+        generate(payloadGenerator);
+        err = emitter.GetError();
+        if (err == CHIP_NO_ERROR)
+        {
+            err = writer.Finalize();
+        }
+        if (err == CHIP_NO_ERROR)
+        {
+            testCase.payloadLength = writer.GetLengthWritten();
+            return CHIP_NO_ERROR;
+        }
+        VerifyOrReturnError(err == CHIP_ERROR_BUFFER_TOO_SMALL || err == CHIP_ERROR_NO_MEMORY, err);
+    }
+    return err;
+}
+
+CHIP_ERROR gen::CommandGenerator::Next(GeneratedCommand & testCase, RequestKind kind)
+{
+    testCase.kind          = kind;
+    testCase.payloadLength = 0;
+
+    switch (kind)
+    {
+    case RequestKind::kInvoke: {
+        VerifyOrReturnError(!mCommandPaths.empty(), CHIP_ERROR_INCORRECT_STATE);
+        const size_t index           = NextPathIndex();
+        const CommandSchema * schema = mCommandSchemas[index];
+        testCase.path                = mCommandPaths[index];
+        (schema != nullptr ? mStatistics.guidedPayloads : mStatistics.unguidedPayloads)++;
+        return Encode(testCase, [schema](PayloadGenerator<TLVEmitter> & generator) {
+            if (schema != nullptr)
+            {
+                generator.GenerateCommandFields(*schema);
+            }
+            else
+            {
+                generator.GenerateObject(0);
+            }
+        });
+    }
+    case RequestKind::kRead:
+        VerifyOrReturnError(!mAttributePaths.empty(), CHIP_ERROR_INCORRECT_STATE);
+        testCase.attributePath = NextAttributePath();
+        return CHIP_NO_ERROR;
+    case RequestKind::kWrite:
+        VerifyOrReturnError(!mAttributePaths.empty(), CHIP_ERROR_INCORRECT_STATE);
+        testCase.attributePath = NextAttributePath();
+        return Encode(testCase, [](PayloadGenerator<TLVEmitter> & generator) { generator.GenerateValue(0); });
+    }
+    return CHIP_ERROR_INVALID_ARGUMENT;
+}
+
+const gen::AttributePath & gen::CommandGenerator::NextAttributePath(chip::EndpointId endpoint, chip::ClusterId cluster)
+{
+    size_t candidates = 0;
+    for (const auto & path : mAttributePaths)
+    {
+        candidates += (path.endpoint == endpoint && path.cluster == cluster);
+    }
+    VerifyOrReturnValue(candidates > 0, NextAttributePath());
+
+    uint64_t skip = Random(candidates);
+    for (const auto & path : mAttributePaths)
+    {
+        if (path.endpoint == endpoint && path.cluster == cluster && skip-- == 0)
+        {
+            return path;
+        }
+    }
+    return NextAttributePath();
+}
+
+CHIP_ERROR gen::CommandGenerator::Mutate(GeneratedCommand & testCase)
+{
+    if (testCase.kind == RequestKind::kRead)
+    {
+        VerifyOrReturnError(!mAttributePaths.empty(), CHIP_ERROR_INCORRECT_STATE);
+        const AttributePath & path = testCase.attributePath;
+        testCase.attributePath     = Random(4) ? NextAttributePath(path.endpoint, path.cluster) : NextAttributePath();
+        return CHIP_NO_ERROR;
+    }
+
+    // The payload is rewritten in place, so the original is read from a copy.
+    uint8_t original[GeneratedCommand::kMaxPayloadLength];
+    uint32_t originalLength = testCase.payloadLength;
+    std::memcpy(original, testCase.payload, originalLength);
+
+    chip::TLV::TLVReader reader;
+    reader.Init(original, originalLength);
+    uint32_t count = 0;
+    ReturnErrorOnFailure(CountElements(reader, count));
+    // The path of the test case is kept whatever its payload, only Next picks a new one.
+    if (testCase.kind == RequestKind::kInvoke && count <= 1)
+    {
+        // The CommandFields structure is empty, or missing altogether: it gets a new member.
+        return Encode(testCase, [](PayloadGenerator<TLVEmitter> & generator) {
+            generator.GetEmitter().BeginObject();
+            generator.GenerateMember(0);
+            generator.GetEmitter().EndObject();
+        });
+    }
+    if (count == 0)
+    {
+        return Encode(testCase, [](PayloadGenerator<TLVEmitter> & generator) { generator.GenerateValue(0); });
+    }
+
+    // The element with index 0 of an invocation is its CommandFields structure.
+    uint32_t first  = (testCase.kind == RequestKind::kInvoke) ? 1 : 0;
+    uint32_t target = first + static_cast<uint32_t>(Random(count - first));
+    return Encode(testCase, [&](PayloadGenerator<TLVEmitter> & generator) {
+        chip::TLV::TLVReader source;
+        source.Init(original, originalLength);
+        uint32_t index = 0;
+        generator.GetEmitter().Latch(CopyReplacing(source, generator, index, target, 0));
+    });
+}
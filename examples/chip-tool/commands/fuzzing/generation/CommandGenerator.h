@@ -0,0 +1,188 @@
+#pragma once
+#include "../DeviceStateManager.h"
+#include "../ForwardDeclarations.h"
+#include "CommandSchemas.h"
+#include <algorithm>
+#include <charconv>
+#include <random>
+
+namespace chip {
+namespace fuzzing {
+namespace generation {
+
+struct CommandPath
+{
+    chip::EndpointId endpoint;
+    chip::ClusterId cluster;
+    chip::CommandId command;
+};
+
+struct AttributePath
+{
+    chip::EndpointId endpoint;
+    chip::ClusterId cluster;
+    chip::AttributeId attribute;
+};
+
+enum class RequestKind : uint8_t
+{
+    kInvoke,
+    kRead,
+    kWrite,
+};
+
+/**
+ * @brief A test case encoded as TLV, ready to be injected in an InvokeRequest, ReadRequest or WriteRequest.
+ *
+ * For invocations the payload holds a single anonymous structure element, which becomes the CommandFields of the CommandDataIB.
+ * For writes it holds the anonymous attribute value, while reads carry no payload.
+ */
+struct GeneratedCommand
+{
+    // Leaves room for the InvokeRequest framing in a single MRP-sized message.
+    static constexpr uint32_t kMaxPayloadLength = 1024;
+
+    RequestKind kind = RequestKind::kInvoke;
+    // Valid for kInvoke only.
+    CommandPath path;
+    // Valid for kRead and kWrite only.
+    AttributePath attributePath;
+    uint8_t payload[kMaxPayloadLength];
+    uint32_t payloadLength = 0;
+
+    chip::ByteSpan GetPayload() const { return chip::ByteSpan(payload, payloadLength); }
+};
+
+struct GenerationStatistics
+{
+    // Invocation payloads following the schema of their command, and the ones of the commands without any.
+    uint64_t guidedPayloads   = 0;
+    uint64_t unguidedPayloads = 0;
+    // Fields of the guided payloads, and the ones among them which were deliberately malformed.
+    uint64_t fields          = 0;
+    uint64_t malformedFields = 0;
+};
+
+/**
+ * @brief Native in-process test case generator.
+ *
+ * Produces the same "ENDPOINT CLUSTER COMMAND JSON" strings as the grammarinator backend, but straight into memory and without
+ * any intermediate grammar file. The command paths are taken from the AcceptedCommandList attribute of every cluster tracked by
+ * the DeviceStateManager.
+ *
+ * The payloads of the commands of the standard clusters follow their schema (see CommandSchemas.h): every field gets its tag and
+ * a value of its type within its constraints, so that most invocations get past the decoding of the command fields and reach
+ * the cluster logic. A tunable share of the fields is malformed on purpose, i.e. left out although mandatory, null although not
+ * nullable, out of their range or of another type. The payloads of the other commands follow the structure described in
+ * CommandParser.g4.
+ *
+ * The same random payloads can be emitted either as JSON, in the chip-tool notation (decimal with "s:", "u:", "f:" and "d:"
+ * prefixes), or directly as TLV. TLV payloads are not bound by what the JSON notation can express: they may contain non-finite
+ * floating point numbers, arbitrary string bytes and list containers.
+ */
+class CommandGenerator
+{
+public:
+    static constexpr uint8_t kDefaultMalformedPercent = 10;
+
+    CommandGenerator(uint16_t maxDepth = 12, uint64_t seed = std::random_device{}()) : mMaxDepth(maxDepth), mRandom(seed) {}
+    ~CommandGenerator() = default;
+
+    /**
+     * @brief Builds the table of command paths accepted by the node.
+     *
+     * Must be called after the remote data model has been acquired.
+     */
+    CHIP_ERROR Initialize(DeviceStateManager * deviceState, chip::NodeId node);
+
+    bool IsEmpty() const { return mCommandPaths.empty(); }
+    bool HasAttributePaths() const { return !mAttributePaths.empty(); }
+    size_t GetCommandPathsCount() const { return mCommandPaths.size(); }
+
+    // Restarts the random sequence of the generator, so that a campaign run with the same seed generates the same test cases.
+    void Seed(uint64_t seed) { mRandom.seed(seed); }
+
+    // Sets the percentage of the fields of the schema-guided payloads which are malformed, from 0 to 100.
+    void SetMalformedPercent(uint8_t percent) { mMalformedPercent = std::min<uint8_t>(percent, 100); }
+
+    const GenerationStatistics & GetStatistics() const { return mStatistics; }
+    void LogStatistics() const;
+
+    /**
+     * @brief Generates the next test case in the "ENDPOINT CLUSTER COMMAND JSON" form.
+     *
+     * The returned reference points to an internal buffer which is reused, and is only valid until the next call.
+     */
+    const std::string & Next();
+    void GenerateTestCases(std::vector<std::string> & out, size_t numCases);
+
+    /**
+     * @brief Generates the next test case as a TLV-encoded command payload.
+     */
+    CHIP_ERROR Next(GeneratedCommand & testCase) { return Next(testCase, RequestKind::kInvoke); }
+
+    /**
+     * @brief Generates the next test case for the given kind of request.
+     *
+     * Reads and writes target the attributes tracked by the DeviceStateManager, written values are random like command fields.
+     */
+    CHIP_ERROR Next(GeneratedCommand & testCase, RequestKind kind);
+
+    /**
+     * @brief Generates the next test case for a kind of request picked at random among the given ones.
+     */
+    CHIP_ERROR Next(GeneratedCommand & testCase, const std::vector<RequestKind> & kinds)
+    {
+        VerifyOrReturnError(!kinds.empty(), CHIP_ERROR_INVALID_ARGUMENT);
+        return Next(testCase, kinds[Random(kinds.size())]);
+    }
+
+    /**
+     * @brief Mutates a test case in place, keeping its payload well-formed TLV.
+     *
+     * Invocations and writes get one element of their payload replaced with a newly generated value under the same tag, while
+     * the CommandFields structure of invocations is kept: an empty one gets a new member instead. Their path never changes.
+     * Reads move to another attribute, preferably of the same cluster.
+     */
+    CHIP_ERROR Mutate(GeneratedCommand & testCase);
+
+private:
+    template <typename Emitter>
+    friend class PayloadGenerator;
+
+    // Maximum number of elements generated inside a single object or array.
+    static constexpr uint32_t kMaxContainerElements = 4;
+    // Maximum length of generated character and octet strings.
+    static constexpr uint32_t kMaxStringLength = 32;
+
+    uint16_t mMaxDepth;
+    uint8_t mMalformedPercent = kDefaultMalformedPercent;
+    std::mt19937_64 mRandom;
+    std::vector<CommandPath> mCommandPaths;
+    // Schema of the command of every path, nullptr if the specification defines none.
+    std::vector<const CommandSchema *> mCommandSchemas;
+    std::vector<AttributePath> mAttributePaths;
+    std::string mBuffer;
+    GenerationStatistics mStatistics;
+
+    uint64_t Random(uint64_t bound) { return bound ? mRandom() % bound : 0; }
+    size_t NextPathIndex() { return static_cast<size_t>(Random(mCommandPaths.size())); }
+    const AttributePath & NextAttributePath() { return mAttributePaths[Random(mAttributePaths.size())]; }
+    const AttributePath & NextAttributePath(chip::EndpointId endpoint, chip::ClusterId cluster);
+
+    template <typename Generate>
+    CHIP_ERROR Encode(GeneratedCommand & testCase, Generate && generate);
+
+    template <typename T>
+    void AppendNumber(T value)
+    {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        VerifyOrDie(result.ec == std::errc());
+        mBuffer.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    }
+};
+
+} // namespace generation
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,53 @@
+#include "CommandSchemas.h"
+#include <algorithm>
+#include <fuzzing/CommandSchemaTable.h>
+#include <lib/support/CodeUtils.h>
+#include <utility>
+
+namespace gen = chip::fuzzing::generation;
+
+namespace {
+constexpr size_t kSchemaCount = sizeof(gen::kCommandSchemas) / sizeof(gen::kCommandSchemas[0]);
+constexpr size_t kFieldCount  = sizeof(gen::kFieldSchemas) / sizeof(gen::kFieldSchemas[0]);
+} // namespace
+
+const gen::CommandSchema * gen::schemas::Find(ClusterId cluster, CommandId command)
+{
+    // The generator sorts the schemas by cluster, then by command.
+    const CommandSchema * first = kCommandSchemas;
+    const CommandSchema * last  = kCommandSchemas + kSchemaCount;
+    const CommandSchema * found = std::lower_bound(first, last, std::make_pair(cluster, command),
+                                                   [](const CommandSchema & schema, const std::pair<ClusterId, CommandId> & key) {
+                                                       return schema.cluster != key.first ? schema.cluster < key.first
+                                                                                          : schema.command < key.second;
+                                                   });
+    VerifyOrReturnValue(found != last && found->cluster == cluster && found->command == command, nullptr);
+    return found;
+}
+
+const gen::FieldSchema & gen::schemas::GetField(uint16_t index)
+{
+    VerifyOrDie(index < kFieldCount);
+    return kFieldSchemas[index];
+}
+
+int64_t gen::schemas::GetEnumValue(const FieldSchema & field, uint16_t index)
+{
+    VerifyOrDie(index < field.valueCount);
+    return kFieldEnumValues[field.firstValue + index];
+}
+
+bool gen::schemas::IsAllowedValue(const FieldSchema & field, int64_t value)
+{
+    VerifyOrReturnValue(field.valueCount > 0, true);
+    const int64_t * first = &kFieldEnumValues[field.firstValue];
+    const int64_t * last  = first + field.valueCount;
+    // The generator sorts the values of every enum.
+    const int64_t * found = std::lower_bound(first, last, value);
+    return found != last && *found == value;
+}
+
+size_t gen::schemas::GetSchemaCount()
+{
+    return kSchemaCount;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "../OracleRules.h"
+#include <lib/core/DataModelTypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chip {
+namespace fuzzing {
+namespace generation {
+
+/**
+ * @brief Argument schemas of the client-to-server commands of the standard clusters, compiled by gen_command_schemas.py from
+ * the cluster definitions of the data_model directory into a constexpr table (see CommandSchemaTable.h in the generated headers).
+ *
+ * The types are resolved as in the oracle rule table. Fields whose type is defined by another cluster are left as
+ * SpecType::kUnknown, and get random values.
+ */
+
+enum FieldSchemaFlags : uint8_t
+{
+    kFieldNullable = 0x01,
+    // Optional, or mandatory under some condition of the device.
+    kFieldOptional   = 0x02,
+    kFieldHasMinimum = 0x04,
+    kFieldHasMaximum = 0x08,
+    // Bitmaps: maximum holds the mask of the defined bits.
+    kFieldMask = 0x10,
+};
+
+/**
+ * @brief Schema of one field of a command, of a structure or of the entries of a list.
+ *
+ * minimum and maximum bound the value of numeric types, the length of strings and the number of entries of lists. The allowed
+ * values of an enum are kFieldEnumValues[firstValue, firstValue + valueCount). The members of a structure, or the single
+ * anonymous field describing the entries of a list, are kFieldSchemas[firstField, firstField + fieldCount).
+ */
+struct FieldSchema
+{
+    uint8_t tag;
+    SpecType type;
+    // Size in bytes of numeric types, 0 otherwise.
+    uint8_t size;
+    uint8_t flags;
+    uint16_t firstValue;
+    uint16_t valueCount;
+    uint16_t firstField;
+    uint16_t fieldCount;
+    int64_t minimum;
+    int64_t maximum;
+
+    bool Has(FieldSchemaFlags flag) const { return (flags & flag) != 0; }
+};
+
+struct CommandSchema
+{
+    ClusterId cluster;
+    CommandId command;
+    uint16_t firstField;
+    uint16_t fieldCount;
+};
+
+namespace schemas {
+
+/**
+ * @brief Looks up the schema of a command in logarithmic time.
+ * @return nullptr if the specification defines no such command, e.g. for manufacturer-specific clusters.
+ */
+const CommandSchema * Find(ClusterId cluster, CommandId command);
+
+const FieldSchema & GetField(uint16_t index);
+
+// Value of an enum field, index being lower than its valueCount.
+int64_t GetEnumValue(const FieldSchema & field, uint16_t index);
+
+/**
+ * @return true if value is one of the values of the enum of the field, or if the field lists none.
+ */
+bool IsAllowedValue(const FieldSchema & field, int64_t value);
+
+size_t GetSchemaCount();
+
+} // namespace schemas
+} // namespace generation
+} // namespace fuzzing
+} // namespace chip
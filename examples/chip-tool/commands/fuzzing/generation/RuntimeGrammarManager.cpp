@@ -4,90 +4,210 @@
 #include "../tlv/DecodedTLVElement.h"
 #include <app-common/zap-generated/ids/Attributes.h>
 #include <app-common/zap-generated/ids/Clusters.h>
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <unistd.h>
 namespace gen = chip::fuzzing::generation;
-void gen::RuntimeGrammarManager::CreateGrammar(DeviceStateManager * deviceState, chip::NodeId node)
-{
-    VerifyOrReturn(!fs::exists(mGeneratedLexerPath) && !fs::exists(mGeneratedParserPath));
+namespace fs  = std::filesystem;
 
-    std::ifstream baseLexerFile(mBaseLexerPath);
-    std::ifstream baseParserFile(mBaseParserPath);
-    VerifyOrDieWithMsg(baseLexerFile.is_open(), chipFuzzer, "Failed to open base lexer file.");
-    VerifyOrDieWithMsg(baseParserFile.is_open(), chipFuzzer, "Failed to open base parser file.");
+namespace {
+constexpr uint64_t kHashOffset = 14695981039346656037ULL;
+constexpr uint64_t kHashPrime  = 1099511628211ULL;
 
-    std::ofstream generatedLexerFile(mGeneratedLexerPath);
-    VerifyOrDieWithMsg(generatedLexerFile.is_open(), chipFuzzer, "Failed to create lexer file.");
-    std::string line;
-    while (std::getline(baseLexerFile, line))
+// FNV-1a, byte wise so that the fingerprint of a data model is the same on every host sharing the cache.
+class FingerprintHasher
+{
+public:
+    FingerprintHasher & Combine(uint64_t value)
     {
-        if (line.find("CommandLexer") != std::string::npos)
+        for (size_t i = 0; i < sizeof(value); i++)
         {
-            line.replace(line.find("CommandLexer"), std::string("CommandLexer").length(), GetLexerName());
+            CombineByte(static_cast<uint8_t>(value >> (8 * i)));
         }
-        generatedLexerFile << line << "\n";
+        return *this;
     }
+    FingerprintHasher & Combine(const std::string & bytes)
+    {
+        Combine(static_cast<uint64_t>(bytes.size()));
+        for (char byte : bytes)
+        {
+            CombineByte(static_cast<uint8_t>(byte));
+        }
+        return *this;
+    }
+    uint64_t Get() const { return mHash; }
 
-    std::ostringstream commandToken("CMDPATH: ", std::ios_base::ate);
+private:
+    uint64_t mHash = kHashOffset;
+
+    void CombineByte(uint8_t byte)
+    {
+        mHash ^= byte;
+        mHash *= kHashPrime;
+    }
+};
+
+std::string ReadFile(const fs::path & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    VerifyOrDieWithMsg(file.is_open(), chipFuzzer, "Failed to open %s.", path.c_str());
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+} // namespace
 
-    auto endpoints          = *deviceState->List(node);
-    size_t scannedEndpoints = 0;
-    for (auto & endpoint : endpoints)
+gen::RuntimeGrammarManager::RuntimeGrammarManager(DeviceStateManager * deviceState, chip::NodeId node, fs::path cacheDir) :
+    mBaseLexerPath("examples/chip-tool/commands/fuzzing/generation/CommandLexer.g4"),
+    mBaseParserPath("examples/chip-tool/commands/fuzzing/generation/CommandParser.g4")
+{
+    for (auto & endpoint : *deviceState->List(node))
     {
-        if (!endpoint.second.clusters.size())
-            continue;
-        commandToken << "E" << endpoint.first;
-        std::ostringstream endpointToken("E" + std::to_string(endpoint.first) + ": ", std::ios_base::ate);
-        endpointToken << "'" << std::to_string(endpoint.first) << "' SPACE (";
-        size_t scannedClusters = 0;
         for (auto & cluster : endpoint.second.clusters)
         {
             auto attr = cluster.second.attributes.find(chip::app::Clusters::Globals::Attributes::AcceptedCommandList::Id);
             VerifyOrDie(attr != cluster.second.attributes.end());
             auto commandList = std::get<ContainerType>(attr->second.ReadCurrent());
-            // Creating a token when the command list is empty would generate a token "'x' SPACE ()", which would be invalid.
+            // A cluster or an endpoint without commands would give an empty alternative such as "'x' SPACE ()", which is invalid.
             if (!commandList.size())
-            {
-                scannedClusters++;
                 continue;
-            }
 
-            endpointToken << "E" << endpoint.first << "CL" << cluster.first;
-            std::ostringstream clusterToken("E" + std::to_string(endpoint.first), std::ios_base::ate);
-            clusterToken << "CL" << cluster.first << ": '" << std::to_string(cluster.first) << "' SPACE (";
-            for (size_t i = 0; i < commandList.size(); i++)
+            std::vector<chip::CommandId> & commands = mCommands[endpoint.first][cluster.first];
+            for (const auto & command : commandList)
             {
-                auto commandId = chip::fuzzing::Visitors::TLV::ConvertToIdType<uint32_t>(commandList[i]);
-                clusterToken << "'" << commandId << "'";
-                if (i != commandList.size() - 1)
-                {
-                    clusterToken << "|";
-                }
+                commands.push_back(chip::fuzzing::Visitors::TLV::ConvertToIdType<uint32_t>(command));
             }
-            clusterToken << ");\n";
-            generatedLexerFile << clusterToken.str();
+            std::sort(commands.begin(), commands.end());
+        }
+    }
+    VerifyOrDieWithMsg(!mCommands.empty(), chipFuzzer, "The node accepts no command to generate a grammar for.");
 
-            // TODO: Simplify this by popping the last '|' back
-            if (scannedClusters != endpoint.second.clusters.size() - 1)
+    std::ostringstream grammarId("G", std::ios_base::ate);
+    grammarId << std::hex << std::setfill('0') << std::setw(16) << GetFingerprint();
+    mGrammarId        = grammarId.str();
+    mGrammarDirectory = cacheDir / mGrammarId;
+    // Concurrent campaigns may create the cache at the same time: only an error tells that it could not be created.
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    VerifyOrDieWithMsg(!ec, chipFuzzer, "Failed to create the grammar cache: %s.", ec.message().c_str());
+    SetPythonExecutable();
+    VerifyOrDieWithMsg(IsGrammarinatorInstalled(), chipFuzzer,
+                       "Python package 'grammarinator' is required for fuzzer grammar generation.");
+}
+
+uint64_t gen::RuntimeGrammarManager::GetFingerprint()
+{
+    // The sizes are hashed along with the identifiers, so that two different structures never hash the same sequence.
+    FingerprintHasher hasher;
+    hasher.Combine(ReadFile(mBaseLexerPath)).Combine(ReadFile(mBaseParserPath)).Combine(static_cast<uint64_t>(mCommands.size()));
+    for (auto & endpoint : mCommands)
+    {
+        hasher.Combine(endpoint.first).Combine(static_cast<uint64_t>(endpoint.second.size()));
+        for (auto & cluster : endpoint.second)
+        {
+            hasher.Combine(cluster.first).Combine(static_cast<uint64_t>(cluster.second.size()));
+            for (chip::CommandId command : cluster.second)
             {
-                endpointToken << "|";
+                hasher.Combine(command);
             }
-            scannedClusters++;
         }
-        endpointToken << ");\n";
-        generatedLexerFile << endpointToken.str();
+    }
+    return hasher.Get();
+}
+
+void gen::RuntimeGrammarManager::CreateGrammar()
+{
+    if (fs::exists(GetGeneratorPath(mGrammarDirectory)))
+    {
+        ChipLogProgress(chipFuzzer, "Grammar found in the cache: GrammarID: %s.", mGrammarId.c_str());
+        return;
+    }
+
+    // The grammar is built aside, then moved to the cache once compiled, so that the campaigns sharing the cache never see an
+    // incomplete one. Only the build directory of this process is cleaned up, the cached grammars may be in use by other campaigns.
+    std::error_code ec;
+    fs::path buildDirectory = mGrammarDirectory;
+    buildDirectory += ".tmp" + std::to_string(getpid());
+    fs::remove_all(buildDirectory, ec);
+    VerifyOrDie(fs::create_directories(buildDirectory));
+
+    fs::path lexerPath  = buildDirectory / (GetLexerName() + ".g4");
+    fs::path parserPath = buildDirectory / (GetParserName() + ".g4");
+    WriteLexer(lexerPath);
+    WriteParser(parserPath);
+    ChipLogProgress(chipFuzzer, "Grammar files generated successfully: GrammarID: %s.", mGrammarId.c_str());
+
+    std::ostringstream processCommand(mPythonExecutable, std::ios_base::ate);
+    std::string grammarinatorProcessFile = std::string(mEnvPrefix + "/bin/grammarinator-process");
+    processCommand << " " << grammarinatorProcessFile << " " << lexerPath.string() << " " << parserPath.string() << " -o "
+                   << buildDirectory.string() << " --no-actions";
 
-        // TODO: Simplify this by popping the last '|' back
-        if (scannedEndpoints != endpoints.size() - 1)
+    VerifyOrDieWithMsg(std::system(processCommand.str().c_str()) == 0, chipFuzzer, "Failed to process grammar files.");
+    VerifyOrDieWithMsg(fs::exists(GetGeneratorPath(buildDirectory)), chipFuzzer, "Generator file not found.");
+
+    fs::rename(buildDirectory, mGrammarDirectory, ec);
+    if (ec)
+    {
+        // Another campaign cached the same grammar meanwhile.
+        VerifyOrDieWithMsg(fs::exists(GetGeneratorPath(mGrammarDirectory)), chipFuzzer, "Failed to cache the grammar: %s.",
+                           ec.message().c_str());
+        fs::remove_all(buildDirectory, ec);
+    }
+    ChipLogProgress(chipFuzzer, "Grammar files processed successfully.");
+}
+
+void gen::RuntimeGrammarManager::WriteLexer(const fs::path & path)
+{
+    std::ifstream baseLexerFile(mBaseLexerPath);
+    VerifyOrDieWithMsg(baseLexerFile.is_open(), chipFuzzer, "Failed to open base lexer file.");
+    std::ofstream generatedLexerFile(path);
+    VerifyOrDieWithMsg(generatedLexerFile.is_open(), chipFuzzer, "Failed to create lexer file.");
+
+    std::string line;
+    while (std::getline(baseLexerFile, line))
+    {
+        if (line.find("CommandLexer") != std::string::npos)
         {
-            commandToken << "|";
+            line.replace(line.find("CommandLexer"), std::string("CommandLexer").length(), GetLexerName());
         }
-        scannedEndpoints++;
+        generatedLexerFile << line << "\n";
+    }
+
+    std::ostringstream commandToken("CMDPATH: ", std::ios_base::ate);
+    for (auto endpoint = mCommands.begin(); endpoint != mCommands.end(); ++endpoint)
+    {
+        commandToken << (endpoint == mCommands.begin() ? "" : "|") << "E" << endpoint->first;
+        std::ostringstream endpointToken("E" + std::to_string(endpoint->first) + ": ", std::ios_base::ate);
+        endpointToken << "'" << std::to_string(endpoint->first) << "' SPACE (";
+        for (auto cluster = endpoint->second.begin(); cluster != endpoint->second.end(); ++cluster)
+        {
+            endpointToken << (cluster == endpoint->second.begin() ? "" : "|") << "E" << endpoint->first << "CL" << cluster->first;
+            std::ostringstream clusterToken("E" + std::to_string(endpoint->first), std::ios_base::ate);
+            clusterToken << "CL" << cluster->first << ": '" << std::to_string(cluster->first) << "' SPACE (";
+            for (size_t i = 0; i < cluster->second.size(); i++)
+            {
+                clusterToken << (i ? "|" : "") << "'" << cluster->second[i] << "'";
+            }
+            clusterToken << ");\n";
+            generatedLexerFile << clusterToken.str();
+        }
+        endpointToken << ");\n";
+        generatedLexerFile << endpointToken.str();
     }
     commandToken << ";\n";
     generatedLexerFile << commandToken.str();
 
-    std::ofstream generatedParserFile(mGeneratedParserPath);
+    generatedLexerFile.close();
+    VerifyOrDieWithMsg(!generatedLexerFile.fail(), chipFuzzer, "Lexer file was in an incorrect state.");
+}
+
+void gen::RuntimeGrammarManager::WriteParser(const fs::path & path)
+{
+    std::ifstream baseParserFile(mBaseParserPath);
+    VerifyOrDieWithMsg(baseParserFile.is_open(), chipFuzzer, "Failed to open base parser file.");
+    std::ofstream generatedParserFile(path);
     VerifyOrDieWithMsg(generatedParserFile.is_open(), chipFuzzer, "Failed to create parser file.");
 
+    std::string line;
     while (std::getline(baseParserFile, line))
     {
         if (line.find("CommandLexer") != std::string::npos)
@@ -105,28 +225,9 @@ void gen::RuntimeGrammarManager::CreateGrammar(DeviceStateManager * deviceState,
         generatedParserFile << line << "\n";
     }
 
-    baseLexerFile.close();
-    baseParserFile.close();
-    generatedLexerFile.close();
     generatedParserFile.close();
-
-    VerifyOrDieWithMsg(!generatedLexerFile.is_open(), chipFuzzer, "Lexer file was in an incorrect state.");
-    VerifyOrDieWithMsg(!generatedParserFile.is_open(), chipFuzzer, "Parser file was in an incorrect state.");
-    ChipLogProgress(chipFuzzer, "Grammar files generated successfully: GrammarID: %s.", mGrammarId.c_str());
-
-    std::ostringstream processCommand(mPythonExecutable, std::ios_base::ate);
-    std::string grammarinatorProcessFile = std::string(mEnvPrefix + "/bin/grammarinator-process");
-    std::string baseLexerFilename        = mBaseLexerPath.string();
-    std::string baseParserFilename       = mBaseParserPath.string();
-    std::string generatedLexerFilename   = mGeneratedLexerPath.string();
-    std::string generatedParserFilename  = mGeneratedParserPath.string();
-
-    processCommand << " " << grammarinatorProcessFile << " " << generatedLexerFilename << " " << generatedParserFilename << " -o "
-                   << mGeneratedLexerPath.parent_path().string() << " --no-actions";
-
-    VerifyOrDieWithMsg(std::system(processCommand.str().c_str()) == 0, chipFuzzer, "Failed to process grammar files.");
-    ChipLogProgress(chipFuzzer, "Grammar files processed successfully.");
-};
+    VerifyOrDieWithMsg(!generatedParserFile.fail(), chipFuzzer, "Parser file was in an incorrect state.");
+}
 
 void gen::RuntimeGrammarManager::SetPythonExecutable()
 {
@@ -155,8 +256,7 @@ bool gen::RuntimeGrammarManager::IsGrammarinatorInstalled()
 
 void gen::RuntimeGrammarManager::GenerateTestCases(fs::path outDir, size_t numCases, uint16_t maxDepth)
 {
-    VerifyOrDieWithMsg(std::filesystem::exists(mGeneratedLexerPath), chipFuzzer, "Lexer file not found.");
-    VerifyOrDieWithMsg(std::filesystem::exists(mGeneratedParserPath), chipFuzzer, "Parser file not found.");
+    VerifyOrDieWithMsg(fs::exists(GetGeneratorPath(mGrammarDirectory)), chipFuzzer, "Generator file not found.");
 
     if (!std::filesystem::exists(outDir))
     {
@@ -168,12 +268,9 @@ void gen::RuntimeGrammarManager::GenerateTestCases(fs::path outDir, size_t numCa
     std::ostringstream command(mPythonExecutable, std::ios_base::ate);
 
     std::string grammarinatorGenerateFile = std::string(mEnvPrefix + "/bin/grammarinator-generate");
-    std::string baseLexerFilename         = mBaseLexerPath.string();
-    std::string generatedLexerFilename    = mGeneratedLexerPath.string();
-    std::string generatorClassName        = std::string(mGeneratedLexerPath.parent_path().filename().string() + "_Generator." +
-                                                        mGeneratedLexerPath.parent_path().filename().string() + "_Generator");
+    std::string generatorClassName        = GetGeneratorName() + "." + GetGeneratorName();
     command << " " << grammarinatorGenerateFile << " " << generatorClassName << " -o " << outDir.string() << "/test_%d -d "
-            << maxDepth << " -n " << numCases << " --sys-path " << mGeneratedLexerPath.parent_path().string();
+            << maxDepth << " -n " << numCases << " --sys-path " << mGrammarDirectory.string();
 
     ChipLogProgress(chipFuzzer, "Generating test cases...");
     VerifyOrDieWithMsg(std::system(command.str().c_str()) == 0, chipFuzzer, "Failed to generate test cases.");
@@ -2,53 +2,52 @@
 #include "../DeviceStateManager.h"
 #include "../ForwardDeclarations.h"
 #include <fstream>
+#include <map>
 
 namespace chip {
 namespace fuzzing {
 namespace generation {
+
+/**
+ * @brief Creates the grammar of the commands a node accepts and the grammarinator generator compiled from it.
+ *
+ * Both are kept in a content-addressed cache: the directory of a grammar is named after the fingerprint of what it is made of,
+ * i.e. the base grammars and the AcceptedCommandList of every cluster of every endpoint of the node. Nodes which accept the same
+ * commands, e.g. identical devices of a fuzz rack, share the same grammar, and only the first campaign against them compiles it.
+ */
 class RuntimeGrammarManager
 {
 public:
-    RuntimeGrammarManager(const chip::fuzzing::BasicInformation * nodeInfo, fs::path baseDir) :
-        mBaseLexerPath("examples/chip-tool/commands/fuzzing/generation/CommandLexer.g4"),
-        mBaseParserPath("examples/chip-tool/commands/fuzzing/generation/CommandParser.g4")
-    {
-        std::ostringstream filename(nodeInfo->vendorName, std::ios_base::ate);
-        filename << std::hex << "_" << nodeInfo->vendorId << "_" << nodeInfo->productId << "_" << nodeInfo->hwVersion << "_"
-                 << nodeInfo->swVersion << std::dec;
-        if (!fs::exists(baseDir))
-        {
-            VerifyOrDie(fs::create_directories(baseDir));
-        }
-        mGrammarId                    = filename.str();
-        fs::path mGrammarSubdirectory = baseDir / mGrammarId;
-        if (!fs::exists(mGrammarSubdirectory))
-        {
-            VerifyOrDie(fs::create_directories(mGrammarSubdirectory));
-        }
-        mGeneratedLexerPath  = mGrammarSubdirectory / (mGrammarId + "_Lexer.g4");
-        mGeneratedParserPath = mGrammarSubdirectory / (mGrammarId + "_Parser.g4");
-        SetPythonExecutable();
-        VerifyOrDieWithMsg(IsGrammarinatorInstalled(), chipFuzzer,
-                           "Python package 'grammarinator' is required for fuzzer grammar generation.");
-    };
+    RuntimeGrammarManager(DeviceStateManager * deviceState, chip::NodeId node, fs::path cacheDir);
     ~RuntimeGrammarManager() = default;
 
+    // Name of the grammar and of its cache directory, derived from the fingerprint.
     std::string mGrammarId;
 
-    void CreateGrammar(DeviceStateManager * deviceState, chip::NodeId node);
+    // Creates and compiles the grammar, unless it is already cached.
+    void CreateGrammar();
     void GenerateTestCases(fs::path outDir, size_t numCases, uint16_t maxDepth = 12);
 
 private:
+    // Accepted commands of the clusters accepting any, in increasing identifier order, so that the grammar and its fingerprint
+    // do not depend on the order of the device state or of the AcceptedCommandList attributes.
+    using CommandStructure = std::map<chip::EndpointId, std::map<chip::ClusterId, std::vector<chip::CommandId>>>;
+
     fs::path mBaseLexerPath;
     fs::path mBaseParserPath;
-    fs::path mGeneratedLexerPath;
-    fs::path mGeneratedParserPath;
+    fs::path mGrammarDirectory;
+    CommandStructure mCommands;
     std::string mPythonExecutable;
     std::string mEnvPrefix;
 
-    std::string GetLexerName() { return mGeneratedLexerPath.stem().string(); }
-    std::string GetParserName() { return mGeneratedParserPath.stem().string(); }
+    std::string GetLexerName() { return mGrammarId + "_Lexer"; }
+    std::string GetParserName() { return mGrammarId + "_Parser"; }
+    std::string GetGeneratorName() { return mGrammarId + "_Generator"; }
+    // The generator is the last file written to a grammar directory, a directory without it is incomplete.
+    fs::path GetGeneratorPath(const fs::path & directory) { return directory / (GetGeneratorName() + ".py"); }
+    uint64_t GetFingerprint();
+    void WriteLexer(const fs::path & path);
+    void WriteParser(const fs::path & path);
     void SetPythonExecutable();
     bool IsGrammarinatorInstalled();
 };
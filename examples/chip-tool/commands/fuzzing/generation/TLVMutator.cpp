@@ -0,0 +1,404 @@
+#include "TLVMutator.h"
+#include "../tlv/TLVDataPayloadHelper.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <lib/core/TLVReader.h>
+#include <lib/core/TLVWriter.h>
+#include <limits>
+
+namespace gen       = chip::fuzzing::generation;
+using DecodedTLVTree = chip::fuzzing::TLV::DecodedTLVTree;
+using DecodedTLVView = chip::fuzzing::TLV::DecodedTLVView;
+
+namespace {
+bool IsInteger(chip::TLV::TLVType type)
+{
+    return type == chip::TLV::kTLVType_SignedInteger || type == chip::TLV::kTLVType_UnsignedInteger;
+}
+
+// Returns the index-th element of the tree in document order, the root excluded, only counting containers if asked to.
+DecodedTLVView FindElement(const DecodedTLVTree & tree, size_t index, bool containersOnly)
+{
+    for (uint32_t i = DecodedTLVTree::kRoot + 1; i < tree.GetElementCount(); i++)
+    {
+        if (containersOnly && !tree.Get(i).IsContainer())
+            continue;
+        if (index-- == 0)
+            return DecodedTLVView(&tree, i);
+    }
+    return DecodedTLVView();
+}
+
+size_t CountContainers(const DecodedTLVTree & tree)
+{
+    size_t count = 0;
+    for (uint32_t i = DecodedTLVTree::kRoot + 1; i < tree.GetElementCount(); i++)
+    {
+        count += tree.Get(i).IsContainer() ? 1 : 0;
+    }
+    return count;
+}
+
+// Integer value of a decoded element, sign-extended to 64 bits.
+bool GetIntegerBits(const chip::fuzzing::TLV::DecodedScalarType & value, uint64_t & bits)
+{
+    return std::visit(
+        [&bits](auto && arg) -> bool {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+            {
+                bits = static_cast<uint64_t>(arg);
+                return true;
+            }
+            else
+                return false;
+        },
+        value);
+}
+
+CHIP_ERROR PutInteger(chip::TLV::TLVWriter & writer, chip::TLV::Tag tag, chip::TLV::TLVType type, uint8_t width, uint64_t bits)
+{
+    // The width is preserved, instead of letting the writer pick the smallest encoding.
+    if (type == chip::TLV::kTLVType_SignedInteger)
+    {
+        switch (width)
+        {
+        case 1:
+            return writer.Put(tag, static_cast<int8_t>(bits), true);
+        case 2:
+            return writer.Put(tag, static_cast<int16_t>(bits), true);
+        case 4:
+            return writer.Put(tag, static_cast<int32_t>(bits), true);
+        default:
+            return writer.Put(tag, static_cast<int64_t>(bits), true);
+        }
+    }
+    switch (width)
+    {
+    case 1:
+        return writer.Put(tag, static_cast<uint8_t>(bits), true);
+    case 2:
+        return writer.Put(tag, static_cast<uint16_t>(bits), true);
+    case 4:
+        return writer.Put(tag, static_cast<uint32_t>(bits), true);
+    default:
+        return writer.Put(tag, static_cast<uint64_t>(bits), true);
+    }
+}
+
+uint64_t GetBoundaryInteger(chip::TLV::TLVType type, uint8_t width, uint64_t choice)
+{
+    uint32_t bitCount = 8u * std::clamp<uint32_t>(width, 1, 8);
+    uint64_t max      = bitCount == 64 ? UINT64_MAX : (1ULL << bitCount) - 1;
+    if (type == chip::TLV::kTLVType_SignedInteger)
+    {
+        int64_t signedMax      = static_cast<int64_t>(max >> 1);
+        int64_t signedMin      = -signedMax - 1;
+        const int64_t values[] = { signedMin, signedMin + 1, -1, 0, 1, signedMax - 1, signedMax };
+        return static_cast<uint64_t>(values[choice % std::size(values)]);
+    }
+    // The maximum is also the null value of the nullable unsigned integers.
+    const uint64_t values[] = { 0, 1, max >> 1, (max >> 1) + 1, max - 1, max };
+    return values[choice % std::size(values)];
+}
+
+template <typename T>
+T GetBoundaryFloatingPoint(uint64_t choice)
+{
+    const T values[] = { std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::infinity(),
+                         -std::numeric_limits<T>::infinity(), static_cast<T>(-0.0),
+                         std::numeric_limits<T>::max(),       std::numeric_limits<T>::lowest(),
+                         std::numeric_limits<T>::denorm_min() };
+    return values[choice % std::size(values)];
+}
+} // namespace
+
+/**
+ * Walks a decoded tree and encodes it, applying the mutation when the target element is reached.
+ */
+class gen::TLVMutator::Encoder
+{
+public:
+    Encoder(TLVMutator & mutator, chip::TLV::TLVWriter & writer, DecodedTLVView target, MutationKind kind,
+            DecodedTLVView splice) :
+        mMutator(mutator),
+        mWriter(writer), mTarget(target), mKind(kind), mSplice(splice)
+    {}
+
+    CHIP_ERROR EncodeChildren(const DecodedTLVView & container)
+    {
+        VerifyOrReturnError(container.IsContainer(), CHIP_ERROR_WRONG_TLV_TYPE);
+        for (auto child = container.GetFirstChild(); child.IsValid(); child = child.GetNextSibling())
+        {
+            ReturnErrorOnFailure(EncodeElement(child));
+        }
+        return CHIP_NO_ERROR;
+    }
+
+private:
+    TLVMutator & mMutator;
+    chip::TLV::TLVWriter & mWriter;
+    DecodedTLVView mTarget;
+    MutationKind mKind;
+    DecodedTLVView mSplice;
+
+    CHIP_ERROR EncodeElement(const DecodedTLVView & element)
+    {
+        if (element != mTarget)
+        {
+            return Encode(element, element->fullTag);
+        }
+
+        // A spliced container may hold the target itself, it is only mutated once.
+        mTarget = DecodedTLVView();
+        switch (mKind)
+        {
+        case MutationKind::kFlipWidth:
+            return FlipWidth(element);
+        case MutationKind::kBoundaryValue:
+            return EncodeBoundary(element);
+        case MutationKind::kSplice:
+            return Encode(mSplice, element->fullTag);
+        case MutationKind::kDropElement:
+            return CHIP_NO_ERROR;
+        case MutationKind::kDuplicateElement:
+            ReturnErrorOnFailure(Encode(element, element->fullTag));
+            return Encode(element, element->fullTag);
+        case MutationKind::kSwitchNullable:
+            return SwitchNullable(element);
+        default:
+            return CHIP_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+    CHIP_ERROR Encode(const DecodedTLVView & element, chip::TLV::Tag tag)
+    {
+        if (element.IsContainer())
+        {
+            chip::TLV::TLVType outer;
+            ReturnErrorOnFailure(mWriter.StartContainer(tag, element->type, outer));
+            ReturnErrorOnFailure(EncodeChildren(element));
+            return mWriter.EndContainer(outer);
+        }
+        if (element->IsString())
+        {
+            std::string_view value = element.GetString();
+            return PutString(tag, element->type, value.data(), value.size());
+        }
+        return std::visit(
+            [&](auto && arg) -> CHIP_ERROR {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, bool>)
+                    return mWriter.PutBoolean(tag, arg);
+                else if constexpr (std::is_same_v<T, NullOptionalType>)
+                    return mWriter.PutNull(tag);
+                else if constexpr (std::is_floating_point_v<T>)
+                    return mWriter.Put(tag, arg);
+                else if constexpr (std::is_integral_v<T>)
+                    return mWriter.Put(tag, arg, true);
+                else
+                    return CHIP_ERROR_INVALID_TLV_ELEMENT;
+            },
+            element->value);
+    }
+
+    CHIP_ERROR PutString(chip::TLV::Tag tag, chip::TLV::TLVType type, const char * data, size_t length)
+    {
+        if (type == chip::TLV::kTLVType_ByteString)
+        {
+            return mWriter.PutBytes(tag, reinterpret_cast<const uint8_t *>(data), static_cast<uint32_t>(length));
+        }
+        return mWriter.PutString(tag, data, static_cast<uint32_t>(length));
+    }
+
+    CHIP_ERROR FlipWidth(const DecodedTLVView & element)
+    {
+        uint64_t bits;
+        if (IsInteger(element->type) && GetIntegerBits(element->value, bits))
+        {
+            // Any other integer encoding of the supportedTypes table, the value is truncated or extended accordingly.
+            auto encoding     = std::make_pair(element->type, element->length);
+            size_t candidates = 0;
+            for (const auto & supported : supportedTypes)
+            {
+                candidates += IsInteger(supported.first) && supported != encoding;
+            }
+            uint64_t skip = mMutator.Random(candidates);
+            for (const auto & supported : supportedTypes)
+            {
+                if (IsInteger(supported.first) && supported != encoding && skip-- == 0)
+                {
+                    return PutInteger(mWriter, element->fullTag, supported.first, supported.second, bits);
+                }
+            }
+        }
+        else if (const auto * value = std::get_if<float>(&element->value))
+        {
+            return mWriter.Put(element->fullTag, static_cast<double>(*value));
+        }
+        else if (const auto * value = std::get_if<double>(&element->value))
+        {
+            return mWriter.Put(element->fullTag, static_cast<float>(*value));
+        }
+        else if (element->IsString())
+        {
+            auto type = element->type == chip::TLV::kTLVType_ByteString ? chip::TLV::kTLVType_UTF8String
+                                                                         : chip::TLV::kTLVType_ByteString;
+            std::string_view value = element.GetString();
+            return PutString(element->fullTag, type, value.data(), value.size());
+        }
+        return Encode(element, element->fullTag);
+    }
+
+    CHIP_ERROR EncodeBoundary(const DecodedTLVView & element)
+    {
+        uint64_t choice = mMutator.mRandom();
+        if (element.IsContainer())
+        {
+            chip::TLV::TLVType outer;
+            ReturnErrorOnFailure(mWriter.StartContainer(element->fullTag, element->type, outer));
+            return mWriter.EndContainer(outer);
+        }
+        if (IsInteger(element->type))
+        {
+            return PutInteger(mWriter, element->fullTag, element->type, element->length,
+                              GetBoundaryInteger(element->type, element->length, choice));
+        }
+        if (element->IsString())
+        {
+            // Around the limit of a 1-byte length field.
+            const size_t lengths[] = { 0, 1, kMaxBoundaryStringLength - 1, kMaxBoundaryStringLength };
+            return PutString(element->fullTag, element->type, reinterpret_cast<const char *>(mMutator.mBoundaryString),
+                             lengths[choice % std::size(lengths)]);
+        }
+        if (const auto * value = std::get_if<bool>(&element->value))
+        {
+            return mWriter.PutBoolean(element->fullTag, !*value);
+        }
+        if (std::holds_alternative<float>(element->value))
+        {
+            return mWriter.Put(element->fullTag, GetBoundaryFloatingPoint<float>(choice));
+        }
+        if (std::holds_alternative<double>(element->value))
+        {
+            return mWriter.Put(element->fullTag, GetBoundaryFloatingPoint<double>(choice));
+        }
+        return Encode(element, element->fullTag);
+    }
+
+    CHIP_ERROR SwitchNullable(const DecodedTLVView & element)
+    {
+        if (!std::holds_alternative<NullOptionalType>(element->value))
+        {
+            return mWriter.PutNull(element->fullTag);
+        }
+
+        // A null becomes a value, the boundaries of the integers are the most likely to be mistaken for nulls.
+        uint8_t width = static_cast<uint8_t>(1u << mMutator.Random(4));
+        auto type     = mMutator.Random(2) ? chip::TLV::kTLVType_SignedInteger : chip::TLV::kTLVType_UnsignedInteger;
+        return PutInteger(mWriter, element->fullTag, type, width, GetBoundaryInteger(type, width, mMutator.mRandom()));
+    }
+};
+
+gen::TLVMutator::TLVMutator(uint64_t seed) : mRandom(seed)
+{
+    memset(mBoundaryString, 'a', sizeof(mBoundaryString));
+}
+
+CHIP_ERROR gen::TLVMutator::Decode(chip::ByteSpan payload, std::shared_ptr<DecodedTLVTree> & root)
+{
+    chip::TLV::TLVReader reader;
+    reader.Init(payload);
+    root = DecodedTLVTree::Create();
+    return TLV::TLVDataPayloadHelper(&reader).Decode(*root);
+}
+
+CHIP_ERROR gen::TLVMutator::Mutate(const DecodedTLVTree & root, const DecodedTLVTree * donor, GeneratedCommand & testCase)
+{
+    // Every element but the root is a candidate, they are stored in document order.
+    VerifyOrReturnError(root.GetElementCount() > 1, CHIP_ERROR_INVALID_ARGUMENT);
+    DecodedTLVView target = FindElement(root, Random(root.GetElementCount() - 1), false);
+    VerifyOrReturnError(target.IsValid(), CHIP_ERROR_INTERNAL);
+
+    // The top-level element is never dropped nor duplicated, the payload must hold exactly one.
+    bool topLevel = false;
+    for (auto child = root.GetRoot().GetFirstChild(); child.IsValid() && !topLevel; child = child.GetNextSibling())
+    {
+        topLevel = child == target;
+    }
+    MutationKind kind = PickMutation(target, topLevel);
+
+    DecodedTLVView splice;
+    if (kind == MutationKind::kSplice)
+    {
+        splice = donor != nullptr ? PickContainer(*donor) : DecodedTLVView();
+        // The target is a container, so the payload itself has at least one to splice.
+        splice = splice.IsValid() ? splice : PickContainer(root);
+        VerifyOrReturnError(splice.IsValid(), CHIP_ERROR_INTERNAL);
+    }
+
+    chip::TLV::TLVWriter writer;
+    writer.Init(testCase.payload, sizeof(testCase.payload));
+    Encoder encoder(*this, writer, target, kind, splice);
+    ReturnErrorOnFailure(encoder.EncodeChildren(root.GetRoot()));
+    ReturnErrorOnFailure(writer.Finalize());
+
+    testCase.payloadLength = writer.GetLengthWritten();
+    mApplied[static_cast<size_t>(kind)]++;
+    return CHIP_NO_ERROR;
+}
+
+gen::MutationKind gen::TLVMutator::PickMutation(const DecodedTLVView & element, bool topLevel)
+{
+    MutationKind candidates[static_cast<size_t>(MutationKind::kCount)];
+    size_t count = 0;
+
+    if (!std::holds_alternative<NullOptionalType>(element->value))
+    {
+        candidates[count++] = MutationKind::kBoundaryValue;
+    }
+    if (IsInteger(element->type) || element->IsString() || element->type == chip::TLV::kTLVType_FloatingPointNumber)
+    {
+        candidates[count++] = MutationKind::kFlipWidth;
+    }
+    if (element.IsContainer())
+    {
+        candidates[count++] = MutationKind::kSplice;
+    }
+    if (!topLevel)
+    {
+        candidates[count++] = MutationKind::kDropElement;
+        candidates[count++] = MutationKind::kDuplicateElement;
+    }
+    candidates[count++] = MutationKind::kSwitchNullable;
+    return candidates[Random(count)];
+}
+
+chip::fuzzing::TLV::DecodedTLVView gen::TLVMutator::PickContainer(const DecodedTLVTree & tree)
+{
+    size_t count = CountContainers(tree);
+    VerifyOrReturnValue(count > 0, DecodedTLVView());
+    return FindElement(tree, Random(count), true);
+}
+
+const char * gen::TLVMutator::GetMutationName(MutationKind kind)
+{
+    switch (kind)
+    {
+    case MutationKind::kFlipWidth:
+        return "flip-width";
+    case MutationKind::kBoundaryValue:
+        return "boundary-value";
+    case MutationKind::kSplice:
+        return "splice";
+    case MutationKind::kDropElement:
+        return "drop-element";
+    case MutationKind::kDuplicateElement:
+        return "duplicate-element";
+    case MutationKind::kSwitchNullable:
+        return "switch-nullable";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "../tlv/DecodedTLVElement.h"
+#include "CommandGenerator.h"
+#include <array>
+#include <random>
+
+namespace chip {
+namespace fuzzing {
+namespace generation {
+
+enum class MutationKind : uint8_t
+{
+    // Encodes an integer with another (signedness, width) pair of the supportedTypes table, a float as a double and vice versa,
+    // a character string as an octet string and vice versa.
+    kFlipWidth,
+    // Replaces a value with a boundary of its type and width, e.g. the minimum, the maximum, or a string crossing the length of
+    // its length field. Containers are emptied.
+    kBoundaryValue,
+    // Replaces a container with a container taken from another test case, keeping the tag.
+    kSplice,
+    // Omits an element, e.g. leaves an optional command field out.
+    kDropElement,
+    // Encodes an element twice, e.g. repeats a context tag in a structure.
+    kDuplicateElement,
+    // Encodes a value as null, or a null as a value.
+    kSwitchNullable,
+    kCount,
+};
+
+/**
+ * @brief Structure-aware mutation engine for the TLV payloads of the test cases.
+ *
+ * Mutants are derived from the DecodedTLVTree of a seed, decoded once with Decode. Each mutant applies a single mutation to one
+ * element of the tree, picked at random, and is encoded straight into the payload of a GeneratedCommand while walking the tree:
+ * the tree is never modified nor copied, so that producing a mutant does not allocate.
+ */
+class TLVMutator
+{
+public:
+    TLVMutator(uint64_t seed = std::random_device{}());
+
+    /**
+     * @brief Decodes a payload into the tree its mutants are derived from.
+     *
+     * The root of the tree is an anonymous structure holding the top-level elements of the payload.
+     */
+    static CHIP_ERROR Decode(chip::ByteSpan payload, std::shared_ptr<TLV::DecodedTLVTree> & root);
+
+    /**
+     * @brief Writes a mutant of a decoded payload into the payload of the test case. The path of the test case is left as is.
+     *
+     * @param root Tree of the payload to mutate, as returned by Decode.
+     * @param donor Tree of another payload, which provides the containers spliced into the mutant. May be nullptr, in which case
+     *              the containers are taken from the payload itself.
+     */
+    CHIP_ERROR Mutate(const TLV::DecodedTLVTree & root, const TLV::DecodedTLVTree * donor, GeneratedCommand & testCase);
+
+    const std::array<uint64_t, static_cast<size_t>(MutationKind::kCount)> & GetStatistics() const { return mApplied; }
+    static const char * GetMutationName(MutationKind kind);
+
+private:
+    class Encoder;
+
+    // Longest boundary string, one more than what a 1-byte length field can express.
+    static constexpr size_t kMaxBoundaryStringLength = 256;
+
+    std::mt19937_64 mRandom;
+    std::array<uint64_t, static_cast<size_t>(MutationKind::kCount)> mApplied{};
+    uint8_t mBoundaryString[kMaxBoundaryStringLength];
+
+    uint64_t Random(uint64_t bound) { return bound ? mRandom() % bound : 0; }
+    MutationKind PickMutation(const TLV::DecodedTLVView & element, bool topLevel);
+    TLV::DecodedTLVView PickContainer(const TLV::DecodedTLVTree & tree);
+};
+
+} // namespace generation
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,77 @@
+#include "TestCaseFormat.h"
+#include <cstring>
+#include <lib/support/BytesToHex.h>
+#include <sstream>
+
+namespace gen = chip::fuzzing::generation;
+
+namespace {
+constexpr char kPayloadPrefix[] = "hex:";
+} // namespace
+
+CHIP_ERROR gen::FormatTestCase(chip::NodeId node, const GeneratedCommand & testCase, std::string & out)
+{
+    char payloadHex[2 * GeneratedCommand::kMaxPayloadLength + 1];
+    ReturnErrorOnFailure(
+        chip::Encoding::BytesToUppercaseHexString(testCase.payload, testCase.payloadLength, payloadHex, sizeof(payloadHex)));
+
+    std::ostringstream command;
+    switch (testCase.kind)
+    {
+    case RequestKind::kInvoke:
+        command << "tlv-invoke " << node << " " << testCase.path.endpoint << " " << testCase.path.cluster << " "
+                << testCase.path.command << " " << kPayloadPrefix << payloadHex;
+        break;
+    case RequestKind::kRead:
+        command << "tlv-read " << node << " " << testCase.attributePath.endpoint << " " << testCase.attributePath.cluster << " "
+                << testCase.attributePath.attribute;
+        break;
+    case RequestKind::kWrite:
+        command << "tlv-write " << node << " " << testCase.attributePath.endpoint << " " << testCase.attributePath.cluster << " "
+                << testCase.attributePath.attribute << " " << kPayloadPrefix << payloadHex;
+        break;
+    }
+    out = command.str();
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR gen::ParseTestCase(const std::string & line, chip::NodeId & node, GeneratedCommand & testCase)
+{
+    std::istringstream stream(line);
+    std::string kind;
+    uint64_t endpoint, cluster, id;
+    VerifyOrReturnError(stream >> kind >> node >> endpoint >> cluster >> id, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(endpoint <= UINT16_MAX && cluster <= UINT32_MAX && id <= UINT32_MAX, CHIP_ERROR_INVALID_ARGUMENT);
+
+    if (kind == "tlv-invoke")
+    {
+        testCase.kind = RequestKind::kInvoke;
+        testCase.path = CommandPath{ static_cast<chip::EndpointId>(endpoint), static_cast<chip::ClusterId>(cluster),
+                                     static_cast<chip::CommandId>(id) };
+    }
+    else if (kind == "tlv-read" || kind == "tlv-write")
+    {
+        testCase.kind          = kind == "tlv-read" ? RequestKind::kRead : RequestKind::kWrite;
+        testCase.attributePath = AttributePath{ static_cast<chip::EndpointId>(endpoint), static_cast<chip::ClusterId>(cluster),
+                                                static_cast<chip::AttributeId>(id) };
+    }
+    else
+    {
+        return CHIP_ERROR_INVALID_ARGUMENT;
+    }
+
+    testCase.payloadLength = 0;
+    VerifyOrReturnError(testCase.kind != RequestKind::kRead, CHIP_NO_ERROR);
+
+    std::string payload;
+    VerifyOrReturnError(stream >> payload, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(payload.rfind(kPayloadPrefix, 0) == 0, CHIP_ERROR_INVALID_ARGUMENT);
+
+    size_t hexLength = payload.size() - strlen(kPayloadPrefix);
+    VerifyOrReturnError(hexLength > 0 && hexLength <= 2 * GeneratedCommand::kMaxPayloadLength, CHIP_ERROR_INVALID_ARGUMENT);
+    size_t length = chip::Encoding::HexToBytes(payload.c_str() + strlen(kPayloadPrefix), hexLength, testCase.payload,
+                                               sizeof(testCase.payload));
+    VerifyOrReturnError(length > 0, CHIP_ERROR_INVALID_ARGUMENT);
+    testCase.payloadLength = static_cast<uint32_t>(length);
+    return CHIP_NO_ERROR;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include "CommandGenerator.h"
+
+namespace chip {
+namespace fuzzing {
+namespace generation {
+
+/**
+ * @brief Renders a test case as a line of the command history, which is also the format of the TLV seeds.
+ *
+ * The line reads "tlv-invoke|tlv-read|tlv-write NODE ENDPOINT CLUSTER ID [hex:PAYLOAD]". The payload is kept as hex-encoded
+ * TLV, as it may not be representable in the chip-tool notation.
+ */
+CHIP_ERROR FormatTestCase(chip::NodeId node, const GeneratedCommand & testCase, std::string & out);
+
+/**
+ * @brief Parses a line rendered by FormatTestCase.
+ */
+CHIP_ERROR ParseTestCase(const std::string & line, chip::NodeId & node, GeneratedCommand & testCase);
+
+} // namespace generation
+} // namespace fuzzing
+} // namespace chip
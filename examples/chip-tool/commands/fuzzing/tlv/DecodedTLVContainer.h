@@ -0,0 +1,63 @@
+#pragma once
+#include "../ForwardDeclarations.h"
+#include <iterator>
+#include <memory>
+
+namespace chip {
+namespace fuzzing {
+namespace TLV {
+
+// Index of a missing element of a DecodedTLVTree, e.g. the next sibling of the last child of a container.
+constexpr uint32_t kNoElement = UINT32_MAX;
+
+/**
+ * @brief A structure, array or list of a DecodedTLVTree, as held by AnyType.
+ *
+ * The container shares the ownership of its tree: storing it, e.g. in the device state, neither copies nor re-decodes the
+ * elements. The elements are iterated as DecodedTLVView, which are only valid as long as the container is.
+ */
+class DecodedTLVContainer
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = DecodedTLVView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = DecodedTLVView;
+
+        Iterator(const DecodedTLVTree * tree, uint32_t index) : mTree(tree), mIndex(index) {}
+
+        DecodedTLVView operator*() const;
+        Iterator & operator++();
+        bool operator==(const Iterator & other) const { return mIndex == other.mIndex; }
+        bool operator!=(const Iterator & other) const { return mIndex != other.mIndex; }
+
+    private:
+        const DecodedTLVTree * mTree;
+        uint32_t mIndex;
+    };
+
+    DecodedTLVContainer() = default;
+    DecodedTLVContainer(std::shared_ptr<const DecodedTLVTree> tree, uint32_t index) : mTree(std::move(tree)), mIndex(index) {}
+
+    Iterator begin() const;
+    Iterator end() const { return Iterator(mTree.get(), kNoElement); }
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    // Walks the children up to the requested one, the containers of the device state are short enough for it not to matter.
+    DecodedTLVView operator[](size_t index) const;
+
+    DecodedTLVView GetView() const;
+    const std::shared_ptr<const DecodedTLVTree> & GetTree() const { return mTree; }
+
+private:
+    std::shared_ptr<const DecodedTLVTree> mTree;
+    uint32_t mIndex = kNoElement;
+};
+
+} // namespace TLV
+} // namespace fuzzing
+} // namespace chip
@@ -0,0 +1,216 @@
+#include "DecodedTLVElement.h"
+#include <cstring>
+
+namespace fuzz = chip::fuzzing;
+
+void fuzz::TLV::DecodedTLVTree::Clear()
+{
+    mElements.clear();
+    mStrings.clear();
+    Reserve(mElements, 1);
+    mElements.emplace_back(TLVType::kTLVType_Structure);
+}
+
+CHIP_ERROR fuzz::TLV::DecodedTLVTree::Append(uint32_t parent, const DecodedTLVElement & element, uint32_t & index)
+{
+    VerifyOrReturnError(parent < mElements.size() && mElements[parent].IsContainer(), CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(mElements.size() < kNoElement, CHIP_ERROR_NO_MEMORY);
+
+    index = static_cast<uint32_t>(mElements.size());
+    Reserve(mElements, mElements.size() + 1);
+    DecodedTLVElement & appended = mElements.emplace_back(element);
+    appended.next                = kNoElement;
+    if (appended.IsContainer())
+    {
+        appended.offset = kNoElement;
+        appended.size   = 0;
+        appended.last   = kNoElement;
+    }
+
+    DecodedTLVElement & container = mElements[parent];
+    if (container.last == kNoElement)
+    {
+        container.offset = index;
+    }
+    else
+    {
+        mElements[container.last].next = index;
+    }
+    container.last = index;
+    container.size++;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR fuzz::TLV::DecodedTLVTree::AppendString(uint32_t parent, const DecodedTLVElement & element, const char * data,
+                                                   size_t length, uint32_t & index)
+{
+    VerifyOrReturnError(element.IsString(), CHIP_ERROR_WRONG_TLV_TYPE);
+    VerifyOrReturnError(mStrings.size() + length < UINT32_MAX, CHIP_ERROR_NO_MEMORY);
+    ReturnErrorOnFailure(Append(parent, element, index));
+
+    mElements[index].offset = static_cast<uint32_t>(mStrings.size());
+    mElements[index].size   = static_cast<uint32_t>(length);
+    Reserve(mStrings, mStrings.size() + length);
+    mStrings.insert(mStrings.end(), data, data + length);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR fuzz::TLV::DecodedTLVTree::AppendValue(uint32_t parent, const AnyType & value, uint32_t & index)
+{
+    return std::visit(
+        [&](auto && arg) -> CHIP_ERROR {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                return AppendString(parent, DecodedTLVElement(TLVType::kTLVType_UTF8String, 1), arg.data(), arg.size(), index);
+            }
+            else if constexpr (std::is_same_v<T, char *>)
+            {
+                return AppendString(parent, DecodedTLVElement(TLVType::kTLVType_ByteString, 1), arg,
+                                    arg != nullptr ? strlen(arg) : 0, index);
+            }
+            else if constexpr (std::is_same_v<T, ContainerType>)
+            {
+                return AppendCopy(parent, arg.GetView(), index);
+            }
+            else if constexpr (std::is_same_v<T, std::monostate>)
+            {
+                return CHIP_ERROR_WRONG_TLV_TYPE;
+            }
+            else
+            {
+                DecodedTLVElement element;
+                if constexpr (std::is_same_v<T, bool>)
+                    element.type = TLVType::kTLVType_Boolean;
+                else if constexpr (std::is_same_v<T, NullOptionalType>)
+                    element.type = TLVType::kTLVType_Null;
+                else if constexpr (std::is_floating_point_v<T>)
+                    element.type = TLVType::kTLVType_FloatingPointNumber;
+                else if constexpr (std::is_signed_v<T>)
+                    element.type = TLVType::kTLVType_SignedInteger;
+                else
+                    element.type = TLVType::kTLVType_UnsignedInteger;
+                if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+                    element.length = sizeof(T);
+                element.value = arg;
+                return Append(parent, element, index);
+            }
+        },
+        value);
+}
+
+CHIP_ERROR fuzz::TLV::DecodedTLVTree::AppendCopy(uint32_t parent, const DecodedTLVView & source, uint32_t & index)
+{
+    VerifyOrReturnError(source.IsValid(), CHIP_ERROR_INVALID_ARGUMENT);
+    if (source->IsString())
+    {
+        std::string_view data = source.GetString();
+        return AppendString(parent, *source, data.data(), data.size(), index);
+    }
+    ReturnErrorOnFailure(Append(parent, *source, index));
+    for (auto child = source.GetFirstChild(); child.IsValid(); child = child.GetNextSibling())
+    {
+        uint32_t childIndex;
+        ReturnErrorOnFailure(AppendCopy(index, child, childIndex));
+    }
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR fuzz::TLV::DecodedTLVTree::Assign(const DecodedTLVElement * elements, size_t count, const char * strings,
+                                             size_t length)
+{
+    VerifyOrReturnError(count > 0 && count < kNoElement && length < UINT32_MAX, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(elements[kRoot].IsContainer(), CHIP_ERROR_INVALID_ARGUMENT);
+
+    // Links only point forward, so that a corrupted snapshot can neither loop nor read out of the buffers.
+    auto isForward = [count](uint32_t from, uint32_t to) { return to == kNoElement || (to > from && to < count); };
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const DecodedTLVElement & element = elements[i];
+        VerifyOrReturnError(isForward(i, element.next), CHIP_ERROR_INVALID_ARGUMENT);
+        if (element.IsContainer())
+        {
+            VerifyOrReturnError(isForward(i, element.offset) && isForward(i, element.last), CHIP_ERROR_INVALID_ARGUMENT);
+        }
+        else if (element.IsString())
+        {
+            VerifyOrReturnError(element.size == 0 || static_cast<size_t>(element.offset) + element.size <= length,
+                                CHIP_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    Reserve(mElements, count);
+    Reserve(mStrings, length);
+    mElements.assign(elements, elements + count);
+    mStrings.assign(strings, strings + length);
+    return CHIP_NO_ERROR;
+}
+
+std::string_view fuzz::TLV::DecodedTLVTree::GetString(uint32_t index) const
+{
+    const DecodedTLVElement & element = mElements[index];
+    VerifyOrReturnValue(element.IsString() && element.size > 0, std::string_view());
+    return std::string_view(&mStrings[element.offset], element.size);
+}
+
+fuzz::TLV::DecodedTLVView fuzz::TLV::DecodedTLVTree::GetRoot() const
+{
+    return DecodedTLVView(this, kRoot);
+}
+
+fuzz::TLV::DecodedTLVContainer fuzz::TLV::DecodedTLVTree::GetContainer(uint32_t index) const
+{
+    VerifyOrDie(mElements[index].IsContainer());
+    return DecodedTLVContainer(shared_from_this(), index);
+}
+
+fuzz::AnyType fuzz::TLV::DecodedTLVView::GetContent() const
+{
+    VerifyOrReturnValue(IsValid(), AnyType{});
+    const DecodedTLVElement & element = **this;
+    if (element.IsContainer())
+    {
+        return mTree->GetContainer(mIndex);
+    }
+    if (element.IsString())
+    {
+        return std::string(GetString());
+    }
+    return std::visit([](auto && arg) -> AnyType { return arg; }, element.value);
+}
+
+fuzz::TLV::DecodedTLVView fuzz::TLV::DecodedTLVContainer::Iterator::operator*() const
+{
+    return DecodedTLVView(mTree, mIndex);
+}
+
+fuzz::TLV::DecodedTLVContainer::Iterator & fuzz::TLV::DecodedTLVContainer::Iterator::operator++()
+{
+    mIndex = mTree->Get(mIndex).next;
+    return *this;
+}
+
+fuzz::TLV::DecodedTLVContainer::Iterator fuzz::TLV::DecodedTLVContainer::begin() const
+{
+    return Iterator(mTree.get(), GetView().GetFirstChild().GetIndex());
+}
+
+size_t fuzz::TLV::DecodedTLVContainer::size() const
+{
+    return GetView().GetChildCount();
+}
+
+fuzz::TLV::DecodedTLVView fuzz::TLV::DecodedTLVContainer::operator[](size_t index) const
+{
+    DecodedTLVView element = GetView().GetFirstChild();
+    while (index-- > 0 && element.IsValid())
+    {
+        element = element.GetNextSibling();
+    }
+    return element;
+}
+
+fuzz::TLV::DecodedTLVView fuzz::TLV::DecodedTLVContainer::GetView() const
+{
+    return DecodedTLVView(mTree.get(), mTree != nullptr ? mIndex : kNoElement);
+}
@@ -3,14 +3,23 @@
 #include "../ForwardDeclarations.h"
 #include "../Utils.h"
 #include "../Visitors.h"
+#include <algorithm>
 #include <iostream>
+#include <string_view>
 namespace fuzz = chip::fuzzing;
 namespace chip {
 namespace fuzzing {
 namespace TLV {
+// Value of a primitive element of a DecodedTLVTree. Strings are kept aside, in the string buffer of the tree.
+using DecodedScalarType = std::variant<std::monostate, bool, float, double, NullOptionalType, int8_t, int16_t, int32_t, int64_t,
+                                       uint8_t, uint16_t, uint32_t, uint64_t>;
+
 /**
  * @brief Encodes a TLV element with a specific type, length and tag using the C++ standard types.
  *
+ * Elements are stored contiguously in a DecodedTLVTree and refer to each other by index, in document order: the children of a
+ * container follow it and are chained through next.
+ *
  * @param aType The TLV type of the element.
  * @param aBytes The byte size of the underlying C++ primitive type or the number of bytes used to represent the length (in
  * case of a string element). 0 must be used when the type has a fixed size or is a container type.
@@ -20,57 +29,185 @@ class DecodedTLVElement
 {
 public:
     DecodedTLVElement() {};
-    DecodedTLVElement(const DecodedTLVElement & other)                 = default;
-    DecodedTLVElement(DecodedTLVElement && other) noexcept             = default;
-    DecodedTLVElement & operator=(const DecodedTLVElement & other)     = default;
-    DecodedTLVElement & operator=(DecodedTLVElement && other) noexcept = default;
-
-    DecodedTLVElement(TLVType aType, uint8_t aBytes = 0, TLVTag aTag = TLVTag::Anonymous) :
-        type(aType), length(aBytes), tag(aTag) {};
     DecodedTLVElement(TLVType aType, uint8_t aBytes = 0, TLVTag aTag = TLVTag::Anonymous,
                       fuzz::AttributeQualityEnum aQuality = fuzz::AttributeQualityEnum::kMandatory) :
         type(aType), length(aBytes), tag(aTag), quality(aQuality) {};
 
-    TLVType type    = TLVType::kTLVType_NotSpecified;
-    AnyType content = {};
-    uint8_t length;
-    TLVTag tag;
-    fuzz::AttributeQualityEnum quality;
+    TLVType type            = TLVType::kTLVType_NotSpecified;
+    DecodedScalarType value = {};
+    uint8_t length          = 0;
+    TLVTag tag              = TLVTag::Anonymous;
+    // The complete tag of the element, tag only holds its control bits. Needed to encode the element again.
+    chip::TLV::Tag fullTag             = chip::TLV::AnonymousTag();
+    fuzz::AttributeQualityEnum quality = fuzz::AttributeQualityEnum::kMandatory;
+    // Containers: index of the first child. Strings: offset of the string in the string buffer of the tree.
+    uint32_t offset = kNoElement;
+    // Containers: number of children. Strings: length of the string.
+    uint32_t size = 0;
+    // Index of the next sibling.
+    uint32_t next = kNoElement;
+    // Index of the last child of a container, where the next child is chained while decoding.
+    uint32_t last = kNoElement;
+
+    bool IsContainer() const
+    {
+        return type == TLVType::kTLVType_Structure || type == TLVType::kTLVType_Array || type == TLVType::kTLVType_List;
+    }
+    bool IsString() const { return type == TLVType::kTLVType_UTF8String || type == TLVType::kTLVType_ByteString; }
 
-    bool IsContainer() { return std::holds_alternative<ContainerType>(content); };
-    static std::shared_ptr<DecodedTLVElement> Create(TLVType type, uint8_t length = 0, TLVTag tag = TLVTag::Anonymous,
-                                                     fuzz::AttributeQualityEnum quality = fuzz::AttributeQualityEnum::kMandatory)
+    static bool IsSupported(TLVType type, uint8_t length)
     {
         auto key = std::make_pair(type, length);
         for (const auto & supportedType : supportedTypes)
         {
             if (supportedType == key)
             {
-                return std::make_shared<DecodedTLVElement>(type, length, tag, quality);
+                return true;
             }
         }
-        return nullptr; // Default factory logic
+        return false;
     };
 };
 
+/**
+ * @brief Flat representation of a decoded TLV payload: one array of elements and one buffer of strings.
+ *
+ * Decoding a payload into a tree that was cleared reuses its buffers, so that it does not allocate once they are large enough.
+ * Elements are accessed through DecodedTLVView. Trees are always owned by a shared_ptr, as the containers they hand out as
+ * AnyType share their ownership.
+ */
+class DecodedTLVTree : public std::enable_shared_from_this<DecodedTLVTree>
+{
+public:
+    // The root is an anonymous structure holding the top-level elements of the payload.
+    static constexpr uint32_t kRoot = 0;
+
+    /**
+     * @param elements, strings Initial capacity of the buffers, e.g. the size of the previous response of the same kind.
+     */
+    static std::shared_ptr<DecodedTLVTree> Create(size_t elements = 1, size_t strings = 0)
+    {
+        return std::make_shared<DecodedTLVTree>(elements, strings);
+    }
+
+    DecodedTLVTree(size_t elements = 1, size_t strings = 0)
+    {
+        Reserve(mElements, elements);
+        Reserve(mStrings, strings);
+        Clear();
+    }
+
+    /**
+     * @brief Removes every element but the root. The capacity of the buffers is kept.
+     */
+    void Clear();
+
+    /**
+     * @brief Appends an element as the last child of a container.
+     *
+     * @param index Set to the index of the new element.
+     */
+    CHIP_ERROR Append(uint32_t parent, const DecodedTLVElement & element, uint32_t & index);
+    CHIP_ERROR AppendString(uint32_t parent, const DecodedTLVElement & element, const char * data, size_t length,
+                            uint32_t & index);
+    /**
+     * @brief Appends a value of the device state, e.g. when loading or taking a device state snapshot. The TLV type of primitives
+     * is derived from the C++ type, containers are copied with AppendCopy.
+     */
+    CHIP_ERROR AppendValue(uint32_t parent, const AnyType & value, uint32_t & index);
+    /**
+     * @brief Appends a copy of an element of another tree, with its children.
+     */
+    CHIP_ERROR AppendCopy(uint32_t parent, const DecodedTLVView & source, uint32_t & index);
+
+    /**
+     * @brief Replaces the content of the tree with buffers written by a previous tree, e.g. a memory-mapped device state
+     * snapshot. The buffers are copied as they are, the links between the elements are only checked to be in bounds and in
+     * document order.
+     */
+    CHIP_ERROR Assign(const DecodedTLVElement * elements, size_t count, const char * strings, size_t length);
+
+    const DecodedTLVElement & Get(uint32_t index) const { return mElements[index]; }
+    std::string_view GetString(uint32_t index) const;
+    DecodedTLVView GetRoot() const;
+    DecodedTLVContainer GetContainer(uint32_t index) const;
+
+    size_t GetElementCount() const { return mElements.size(); }
+    size_t GetStringsLength() const { return mStrings.size(); }
+    const DecodedTLVElement * GetElements() const { return mElements.data(); }
+    const char * GetStrings() const { return mStrings.data(); }
+    // Number of times the buffers of the tree were allocated or grown since its creation.
+    uint64_t GetAllocationCount() const { return mAllocations; }
+
+private:
+    std::vector<DecodedTLVElement> mElements;
+    std::vector<char> mStrings;
+    uint64_t mAllocations = 0;
+
+    template <typename T>
+    void Reserve(std::vector<T> & buffer, size_t size)
+    {
+        if (size > buffer.capacity())
+        {
+            buffer.reserve(std::max(size, 2 * buffer.capacity()));
+            mAllocations++;
+        }
+    }
+};
+
+/**
+ * @brief Non-owning handle to an element of a DecodedTLVTree.
+ */
+class DecodedTLVView
+{
+public:
+    DecodedTLVView() = default;
+    DecodedTLVView(const DecodedTLVTree * tree, uint32_t index) : mTree(tree), mIndex(index) {}
+
+    bool IsValid() const { return mTree != nullptr && mIndex != kNoElement; }
+    bool IsContainer() const { return IsValid() && mTree->Get(mIndex).IsContainer(); }
+    const DecodedTLVElement & operator*() const { return mTree->Get(mIndex); }
+    const DecodedTLVElement * operator->() const { return &mTree->Get(mIndex); }
+    bool operator==(const DecodedTLVView & other) const { return mTree == other.mTree && mIndex == other.mIndex; }
+    bool operator!=(const DecodedTLVView & other) const { return !(*this == other); }
+
+    // Invalid if the element is not a container or is empty.
+    DecodedTLVView GetFirstChild() const { return DecodedTLVView(mTree, IsContainer() ? (*this)->offset : kNoElement); }
+    DecodedTLVView GetNextSibling() const { return DecodedTLVView(mTree, IsValid() ? (*this)->next : kNoElement); }
+    size_t GetChildCount() const { return IsContainer() ? (*this)->size : 0; }
+    std::string_view GetString() const { return mTree->GetString(mIndex); }
+
+    /**
+     * @brief Returns the value of the element as stored in the device state. Containers share the ownership of the tree.
+     */
+    AnyType GetContent() const;
+
+    const DecodedTLVTree * GetTree() const { return mTree; }
+    uint32_t GetIndex() const { return mIndex; }
+
+private:
+    const DecodedTLVTree * mTree = nullptr;
+    uint32_t mIndex              = kNoElement;
+};
+
 class DecodedTLVElementPrettyPrinter
 {
 public:
-    DecodedTLVElementPrettyPrinter(std::shared_ptr<DecodedTLVElement> element) : mRootElement(element) {}
+    DecodedTLVElementPrettyPrinter(DecodedTLVView element) : mRootElement(element) {}
 
     void Print()
     {
-        VerifyOrDie(mRootElement != nullptr);
+        VerifyOrDie(mRootElement.IsValid());
         Visitors::TLV::PrintDecodedElement(this, mRootElement, 0);
     }
 
 private:
-    std::shared_ptr<DecodedTLVElement> mRootElement;
+    DecodedTLVView mRootElement;
 
-    friend void fuzz::Visitors::TLV::PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer,
-                                                         std::shared_ptr<DecodedTLVElement> element, size_t indent);
+    friend void fuzz::Visitors::TLV::PrintDecodedElement(DecodedTLVElementPrettyPrinter * printer, const DecodedTLVView & element,
+                                                         size_t indent);
     friend void fuzz::Visitors::TLV::FinalizePrintDecodedElementMetadata(DecodedTLVElementPrettyPrinter * printer,
-                                                                         std::shared_ptr<DecodedTLVElement> element, size_t indent);
+                                                                         const DecodedTLVView & element, size_t indent);
     template <typename T>
     void PrintDecodedPrimitiveElement(T value, size_t indent)
     {
@@ -101,13 +238,13 @@ private:
         }
     }
 
-    void PrintDecodedContainerElement(ContainerType & container, size_t indent)
+    void PrintDecodedContainerElement(const DecodedTLVView & container, size_t indent)
     {
-        for (const auto & element : container)
+        for (auto element = container.GetFirstChild(); element.IsValid(); element = element.GetNextSibling())
         {
             Visitors::TLV::PrintDecodedElement(this, element, indent);
         }
-        if (container.size() == 0)
+        if (container.GetChildCount() == 0)
         {
             std::cout << "}";
         }
@@ -118,9 +255,9 @@ private:
         }
     }
 
-    void PrintDecodedElementMetadata(std::shared_ptr<DecodedTLVElement> element, size_t indent = 0)
+    void PrintDecodedElementMetadata(const DecodedTLVView & element, size_t indent = 0)
     {
-        VerifyOrDie(element != nullptr);
+        VerifyOrDie(element.IsValid());
         Indent(indent);
         std::cout << "[Type: 0x" << std::hex << static_cast<int16_t>(element->type) << std::dec
                   << ", Byte size: " << static_cast<uint16_t>(element->length) << ", Tag: 0x" << std::hex
@@ -3,20 +3,19 @@
 
 namespace fuzz = chip::fuzzing;
 
-CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uint8_t dstBytes,
-                                                            std::shared_ptr<DecodedTLVElement> output)
+CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uint8_t dstBytes, DecodedTLVElement & output)
 {
-    VerifyOrReturnError(!output->IsContainer(), CHIP_ERROR_WRONG_TLV_TYPE);
+    VerifyOrReturnError(!output.IsContainer(), CHIP_ERROR_WRONG_TLV_TYPE);
     switch (dstType)
     {
     case TLVType::kTLVType_Boolean: {
         bool v;
         mPayloadReader.Get(v);
-        output->content = v;
+        output.value = v;
         break;
     }
     case TLVType::kTLVType_Null: {
-        output->content = NullOptional;
+        output.value = NullOptional;
         break;
     }
     case TLVType::kTLVType_SignedInteger: {
@@ -25,25 +24,25 @@ CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uin
         case 1: {
             int8_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 2: {
             int16_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 4: {
             int32_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 8: {
             int64_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         default:
@@ -57,25 +56,25 @@ CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uin
         case 1: {
             uint8_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 2: {
             uint16_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 4: {
             uint32_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 8: {
             uint64_t v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         default:
@@ -89,13 +88,13 @@ CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uin
         case 4: {
             float v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         case 8: {
             double v;
             mPayloadReader.Get(v);
-            output->content = v;
+            output.value = v;
             break;
         }
         default:
@@ -103,20 +102,13 @@ CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::DecodePrimitive(TLVType dstType, uin
         }
         break;
     }
-    case TLVType::kTLVType_UTF8String:
-    case TLVType::kTLVType_ByteString: {
-        std::vector<char> buffer(mPayloadReader.GetLength() + 1);
-        mPayloadReader.GetString(buffer.data(), buffer.size());
-        output->content = std::string(buffer.data(), strlen(buffer.data()));
-        break;
-    }
     default:
         return CHIP_ERROR_WRONG_TLV_TYPE;
     }
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::Decode(std::shared_ptr<DecodedTLVElement> output)
+CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::Decode(DecodedTLVTree & output, uint32_t parent)
 {
     CHIP_ERROR err = CHIP_NO_ERROR;
     if (mPayloadReader.GetType() == TLVType::kTLVType_NotSpecified)
@@ -133,60 +125,59 @@ CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::Decode(std::shared_ptr<DecodedTLVEle
         uint8_t bytes  = ExtractSizeFromControlByte(type, cbyte);
         AttributeQualityEnum quality =
             type == TLVType::kTLVType_Null ? AttributeQualityEnum::kOptional : AttributeQualityEnum::kMandatory;
+        VerifyOrReturnError(DecodedTLVElement::IsSupported(type, bytes), CHIP_ERROR_INVALID_TLV_ELEMENT);
 
-        auto newElement = DecodedTLVElement::Create(type, bytes, tag, quality);
-        VerifyOrReturnError(newElement != nullptr, CHIP_ERROR_INVALID_TLV_ELEMENT);
+        DecodedTLVElement newElement(type, bytes, tag, quality);
+        newElement.fullTag = mPayloadReader.GetTag();
+        uint32_t index;
 
-        if (type == TLVType::kTLVType_Structure || type == TLVType::kTLVType_Array || type == TLVType::kTLVType_List)
+        if (newElement.IsContainer())
         {
+            ReturnErrorOnFailure(output.Append(parent, newElement, index));
             TLVType outerContainer;
             mPayloadReader.EnterContainer(outerContainer);
-            newElement->content = ContainerType();
-            ReturnErrorOnFailure(Decode(newElement));
+            ReturnErrorOnFailure(Decode(output, index));
             mPayloadReader.ExitContainer(outerContainer);
         }
+        else if (newElement.IsString())
+        {
+            // The string is copied straight into the string buffer of the tree. Octet strings may hold NUL bytes, the whole
+            // length is kept so that the element can be encoded again.
+            const uint8_t * data;
+            ReturnErrorOnFailure(mPayloadReader.GetDataPtr(data));
+            ReturnErrorOnFailure(
+                output.AppendString(parent, newElement, reinterpret_cast<const char *>(data), mPayloadReader.GetLength(), index));
+        }
         else
         {
             // Base case of recursion
             ReturnErrorOnFailure(DecodePrimitive(type, bytes, newElement));
+            ReturnErrorOnFailure(output.Append(parent, newElement, index));
         }
-        ReturnErrorOnFailure(PushToContainer(std::move(newElement), output));
         err = mPayloadReader.Next();
     }
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::Encode(std::shared_ptr<DecodedTLVElement> src)
+CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::WriteToDeviceState(const DecodedTLVTree & src, AttributeState & attributeState)
 {
-    return CHIP_NO_ERROR;
-}
-
-CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::WriteToDeviceState(std::shared_ptr<DecodedTLVElement> && src,
-                                                               AttributeState & attributeState)
-{
-    // src is ALWAYS a structure element. The first element of the structure is the actual value
-    VerifyOrReturnError(std::holds_alternative<ContainerType>(src->content), CHIP_ERROR_INTERNAL);
-    auto container = std::move(src);
-    auto element   = std::get<ContainerType>(container->content).at(0);
-    VerifyOrReturnError(element != nullptr, CHIP_ERROR_INTERNAL);
+    // The root of src is ALWAYS a structure element. Its first element is the actual value, which is handed to the device state
+    // as is: containers share the tree instead of being copied.
+    DecodedTLVView container = src.GetRoot();
+    DecodedTLVView element   = container.GetFirstChild();
+    VerifyOrReturnError(element.IsValid(), CHIP_ERROR_INTERNAL);
     if (std::holds_alternative<std::monostate>(attributeState.ReadCurrent()))
     {
         ReturnErrorOnFailure(
-            attributeState.LazyInitialize(container->type, container->length, container->quality, std::move(element->content)));
+            attributeState.LazyInitialize(container->type, container->length, container->quality, element.GetContent()));
     }
     else
     {
-        ReturnErrorOnFailure(attributeState.Write(std::move(element->content)));
+        ReturnErrorOnFailure(attributeState.Write(element.GetContent()));
     }
     return CHIP_NO_ERROR;
 }
 
-CHIP_ERROR fuzz::TLV::TLVDataPayloadHelper::PushToContainer(std::shared_ptr<DecodedTLVElement> && element,
-                                                            std::shared_ptr<DecodedTLVElement> dst)
-{
-    return Visitors::TLV::PushToContainer(std::move(element), dst);
-}
-
 void fuzz::TLV::TLVDataPayloadHelper::PrettyPrint()
 {
     chip::TLV::TLVReader printBuffer;
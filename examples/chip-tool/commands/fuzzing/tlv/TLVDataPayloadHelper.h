@@ -39,10 +39,11 @@ class TLVDataPayloadHelper
 public:
     TLVDataPayloadHelper(chip::TLV::TLVReader * data) { mPayloadReader.Init(*data); }
 
-    CHIP_ERROR Decode(std::shared_ptr<DecodedTLVElement> output);
-    CHIP_ERROR Encode(std::shared_ptr<DecodedTLVElement> src);
-    CHIP_ERROR WriteToDeviceState(std::shared_ptr<DecodedTLVElement> && src, AttributeState & attributeState);
-    CHIP_ERROR PushToContainer(std::shared_ptr<DecodedTLVElement> && element, std::shared_ptr<DecodedTLVElement> dst);
+    /**
+     * @brief Decodes the payload into a tree, appending the elements to the given container of the tree.
+     */
+    CHIP_ERROR Decode(DecodedTLVTree & output, uint32_t parent = DecodedTLVTree::kRoot);
+    CHIP_ERROR WriteToDeviceState(const DecodedTLVTree & src, AttributeState & attributeState);
 
     void Print() { PrettyPrint(); }
 
@@ -67,7 +68,7 @@ private:
     chip::TLV::TLVReader mPayloadReader;
     chip::TLV::TLVWriter mPayloadWriter;
     chip::Protocols::InteractionModel::MsgType mMessageType;
-    CHIP_ERROR DecodePrimitive(TLVType dstType, uint8_t dstBytes, std::shared_ptr<DecodedTLVElement> output);
+    CHIP_ERROR DecodePrimitive(TLVType dstType, uint8_t dstBytes, DecodedTLVElement & output);
     void PrettyPrint();
 };
 
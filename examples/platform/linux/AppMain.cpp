@@ -96,12 +96,16 @@
 #if CHIP_DEVICE_CONFIG_ENABLE_DEVICE_ENERGY_MANAGEMENT_TRIGGER
 #include <app/clusters/device-energy-management-server/DeviceEnergyManagementTestEventTriggerHandler.h>
 #endif
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+#include <app/server/ServerSnapshotTestEventTriggerHandler.h>
+#endif
 #include <app/TestEventTriggerDelegate.h>
 
 #include <signal.h>
 
 #include "AppMain.h"
 #include "CommissionableInit.h"
+#include "ForkServer.h"
 
 #if CHIP_DEVICE_LAYER_TARGET_DARWIN
 #include <platform/Darwin/NetworkCommissioningDriver.h>
@@ -584,6 +588,11 @@ void ChipLinuxAppMainLoop(AppMainLoopImplementation * impl)
     static DeviceEnergyManagementTestEventTriggerHandler sDeviceEnergyManagementTestEventTriggerHandler;
     sTestEventTriggerDelegate.AddHandler(&sDeviceEnergyManagementTestEventTriggerHandler);
 #endif
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    // Lets black-box fuzzers reset the device between two test cases.
+    static ServerSnapshotTestEventTriggerHandler sServerSnapshotTestEventTriggerHandler;
+    sTestEventTriggerDelegate.AddHandler(&sServerSnapshotTestEventTriggerHandler);
+#endif
 
     initParams.testEventTriggerDelegate = &sTestEventTriggerDelegate;
 
@@ -640,13 +649,17 @@ void ChipLinuxAppMainLoop(AppMainLoopImplementation * impl)
     // NOLINTEND(bugprone-signal-handler)
 #endif // !defined(ENABLE_CHIP_SHELL)
 
-    if (impl != nullptr)
-    {
-        impl->RunMainLoop();
-    }
-    else
+    // In fork server mode, the main loop only runs in the forked children.
+    if (chip::examples::RunForkServer(LinuxDeviceOptions::GetInstance().forkServerPoint))
     {
-        DeviceLayer::PlatformMgr().RunEventLoop();
+        if (impl != nullptr)
+        {
+            impl->RunMainLoop();
+        }
+        else
+        {
+            DeviceLayer::PlatformMgr().RunEventLoop();
+        }
     }
     gMainLoopImplementation = nullptr;
 
@@ -0,0 +1,153 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "ForkServer.h"
+
+#include <app/server/Server.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <platform/CHIPDeviceLayer.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace chip::DeviceLayer;
+
+namespace chip {
+namespace examples {
+
+namespace {
+
+// File descriptors of the AFL fork server protocol.
+constexpr int kControlFd = 198;
+constexpr int kStatusFd  = kControlFd + 1;
+
+bool ReadWord(int fd, uint32_t & value)
+{
+    return read(fd, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value));
+}
+
+bool WriteWord(int fd, uint32_t value)
+{
+    return write(fd, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value));
+}
+
+bool IsCommissioned()
+{
+    return Server::GetInstance().GetFabricTable().FabricCount() > 0;
+}
+
+void StopOnCommissioningComplete(const ChipDeviceEvent * event, intptr_t)
+{
+    if (event->Type == DeviceEventType::kCommissioningComplete)
+    {
+        PlatformMgr().StopEventLoopTask();
+    }
+}
+
+/**
+ * Runs the app until it is commissioned.
+ *
+ * @return false if the app was stopped before being commissioned.
+ */
+bool WaitForCommissioning()
+{
+    VerifyOrReturnValue(!IsCommissioned(), true);
+
+    ChipLogProgress(AppServer, "Fork server: waiting for the commissioning to complete");
+    VerifyOrReturnValue(PlatformMgr().AddEventHandler(StopOnCommissioningComplete) == CHIP_NO_ERROR, false);
+    PlatformMgr().RunEventLoop();
+    PlatformMgr().RemoveEventHandler(StopOnCommissioningComplete);
+
+    return IsCommissioned();
+}
+
+/**
+ * Waits for the child running the test case, and reports its wait status to
+ * the fuzzer, which kills it when the test case times out.
+ */
+bool ReportChild(pid_t child)
+{
+    int status = 0;
+
+    if (!WriteWord(kStatusFd, static_cast<uint32_t>(child)))
+    {
+        kill(child, SIGKILL);
+        waitpid(child, &status, 0);
+        return false;
+    }
+
+    VerifyOrReturnValue(waitpid(child, &status, 0) == child, false);
+    return WriteWord(kStatusFd, static_cast<uint32_t>(status));
+}
+
+} // namespace
+
+bool RunForkServer(ForkServerPoint point)
+{
+    VerifyOrReturnValue(point != ForkServerPoint::kDisabled, true);
+
+    if (point == ForkServerPoint::kCommissioned)
+    {
+        VerifyOrReturnValue(WaitForCommissioning(), false);
+    }
+
+    // The hello message tells the fuzzer that the fork server is up.
+    if (!WriteWord(kStatusFd, 0))
+    {
+        ChipLogError(AppServer, "Fork server: no fuzzer on fd %d, running without forking", kStatusFd);
+        return true;
+    }
+
+    ChipLogProgress(AppServer, "Fork server: ready");
+
+    uint32_t request;
+    while (ReadWord(kControlFd, request))
+    {
+        // The buffered output would be written again by every child.
+        fflush(nullptr);
+
+        pid_t child = fork();
+        if (child == 0)
+        {
+            close(kControlFd);
+            close(kStatusFd);
+            return true;
+        }
+
+        if (child < 0)
+        {
+            ChipLogError(AppServer, "Fork server: fork failed: %s", strerror(errno));
+            break;
+        }
+
+        VerifyOrReturnValue(ReportChild(child), false);
+    }
+
+    // The fuzzer closed the pipes, or the app was stopped by a signal.
+    ChipLogProgress(AppServer, "Fork server: stopped");
+    return false;
+}
+
+} // namespace examples
+} // namespace chip
@@ -0,0 +1,63 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace chip {
+namespace examples {
+
+/**
+ * Point of the startup of the app from which the fork server forks the test
+ * cases.
+ */
+enum class ForkServerPoint : uint8_t
+{
+    kDisabled,     ///< No fork server: the app runs as usual.
+    kInit,         ///< Once the app is initialized, before it handles any message.
+    kCommissioned, ///< Once the app is commissioned, the sessions opened by the commissioning being kept.
+};
+
+/**
+ * @brief Runs the app as the fork server of an out-of-process fuzzer.
+ *
+ * The app, initialized up to @a point, forks a child per test case on the
+ * request of the fuzzer and waits for it, so that every test case starts from
+ * the same warm state without paying for the startup of the stack. The
+ * protocol is the one of the AFL fork server: the requests are read from the
+ * file descriptor 198, the pid and then the wait status of every child are
+ * written to the file descriptor 199.
+ *
+ * Only the thread calling this function runs in the children: the helper
+ * threads of the app (shell, named pipes, GLib main loop) are not forked.
+ *
+ * Every child restarts from the same session state, with kCommissioned the
+ * outgoing message counters of the CASE session of the commissioning among
+ * others: the messages of a child reuse the counters of the previous ones, and
+ * a peer which kept that session drops them as duplicates. The fuzzer has to
+ * establish a new session, or reset the one it has, for every test case.
+ *
+ * @param point - point from which to fork, returns right away if kDisabled
+ * @return true when the caller should go on running the app: in the forked children, and when no fuzzer
+ *         listens on the file descriptors. false when the fork server stopped and the app should shut down.
+ */
+bool RunForkServer(ForkServerPoint point);
+
+} // namespace examples
+} // namespace chip
@@ -93,6 +93,7 @@ enum
     kDeviceOption_TestEventTriggerEnableKey,
     kTraceTo,
     kOptionSimulateNoInternalTime,
+    kDeviceOption_ForkServer,
 #if defined(PW_RPC_ENABLED)
     kOptionRpcServerPort,
 #endif
@@ -167,6 +168,7 @@ OptionDef sDeviceOptionDefs[] = {
     { "trace-to", kArgumentRequired, kTraceTo },
 #endif
     { "simulate-no-internal-time", kNoArgument, kOptionSimulateNoInternalTime },
+    { "fork-server", kArgumentRequired, kDeviceOption_ForkServer },
 #if defined(PW_RPC_ENABLED)
     { "rpc-server-port", kArgumentRequired, kOptionRpcServerPort },
 #endif
@@ -304,6 +306,9 @@ const char * sDeviceOptionHelp =
 #endif
     "  --simulate-no-internal-time\n"
     "       Time cluster does not use internal platform time\n"
+    "  --fork-server <init|commissioned>\n"
+    "       Fork a child per test case of an out-of-process fuzzer, using the AFL fork server protocol on\n"
+    "       fds 198 and 199, once the app is initialized or once it is commissioned.\n"
 #if defined(PW_RPC_ENABLED)
     "  --rpc-server-port\n"
     "       Start RPC server on specified port\n"
@@ -574,6 +579,21 @@ bool HandleOption(const char * aProgram, OptionSet * aOptions, int aIdentifier,
     case kOptionSimulateNoInternalTime:
         LinuxDeviceOptions::GetInstance().mSimulateNoInternalTime = true;
         break;
+    case kDeviceOption_ForkServer:
+        if (strcmp(aValue, "init") == 0)
+        {
+            LinuxDeviceOptions::GetInstance().forkServerPoint = chip::examples::ForkServerPoint::kInit;
+        }
+        else if (strcmp(aValue, "commissioned") == 0)
+        {
+            LinuxDeviceOptions::GetInstance().forkServerPoint = chip::examples::ForkServerPoint::kCommissioned;
+        }
+        else
+        {
+            PrintArgError("%s: Invalid fork server point: %s\n", aProgram, aValue);
+            retval = false;
+        }
+        break;
 #if defined(PW_RPC_ENABLED)
     case kOptionRpcServerPort:
         LinuxDeviceOptions::GetInstance().rpcServerPort = static_cast<uint16_t>(atoi(aValue));
@@ -35,6 +35,8 @@
 #include <platform/CHIPDeviceConfig.h>
 #include <setup_payload/SetupPayload.h>
 
+#include "ForkServer.h"
+
 #include <credentials/DeviceAttestationCredsProvider.h>
 #include <testing/CustomCSRResponse.h>
 
@@ -75,6 +77,7 @@ struct LinuxDeviceOptions
     uint8_t testEventTriggerEnableKey[16] = { 0 };
     std::vector<std::string> traceTo;
     bool mSimulateNoInternalTime = false;
+    chip::examples::ForkServerPoint forkServerPoint = chip::examples::ForkServerPoint::kDisabled;
 #if defined(PW_RPC_ENABLED)
     uint16_t rpcServerPort = 33000;
 #endif
@@ -382,6 +382,29 @@ public:
      */
     bool IsValid(void) { return EventManagementStates::Shutdown != mState; };
 
+    /**
+     * @brief
+     *   Bookkeeping of the logged events kept outside of the event buffers.
+     *
+     *   Saved along with the content of the event buffers and of the event number counter, it allows bringing the event
+     *   logging back to an earlier state, e.g. between two fuzzing inputs.
+     */
+    struct LoggingState
+    {
+        uint32_t mBytesWritten       = 0;
+        EventNumber mLastEventNumber = 0;
+        Timestamp mLastEventTimestamp;
+    };
+
+    LoggingState GetLoggingState() const { return LoggingState{ mBytesWritten, mLastEventNumber, mLastEventTimestamp }; }
+
+    void RestoreLoggingState(const LoggingState & aState)
+    {
+        mBytesWritten       = aState.mBytesWritten;
+        mLastEventNumber    = aState.mLastEventNumber;
+        mLastEventTimestamp = aState.mLastEventTimestamp;
+    }
+
     /**
      *  Logger would save last logged event number and initial written event bytes number into schedule event number array
      */
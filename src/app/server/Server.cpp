@@ -37,6 +37,7 @@
 #include <lib/support/CodeUtils.h>
 #include <lib/support/DefaultStorageKeyAllocator.h>
 #include <lib/support/PersistedCounter.h>
+#include <lib/support/ScopedBuffer.h>
 #include <lib/support/TestGroupData.h>
 #include <lib/support/logging/CHIPLogging.h>
 #include <messaging/ExchangeMgr.h>
@@ -64,6 +65,11 @@
 #include <lib/support/PersistentStorageAudit.h>
 #endif // defined(CHIP_SUPPORT_ENABLE_STORAGE_API_AUDIT) || defined(CHIP_SUPPORT_ENABLE_STORAGE_LOAD_TEST_AUDIT)
 
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+#include <algorithm>
+#include <iterator>
+#endif // CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+
 using namespace chip::DeviceLayer;
 
 using chip::kMinValidFabricIndex;
@@ -105,6 +111,28 @@ static ::chip::PersistedCounter<chip::EventNumber> sGlobalEventIdCounter;
 static ::chip::app::CircularEventBuffer sLoggingBuffer[CHIP_NUM_EVENT_LOGGING_BUFFERS];
 #endif // CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
 
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+namespace {
+
+// State of the server outside of the persistent storage, saved by Server::CaptureSnapshot().
+struct ServerSnapshot
+{
+    Platform::ScopedMemoryBuffer<uint8_t> attributeData;
+#if CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+    uint8_t infoEventBuffer[CHIP_DEVICE_CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE];
+    uint8_t debugEventBuffer[CHIP_DEVICE_CONFIG_EVENT_LOGGING_DEBUG_BUFFER_SIZE];
+    uint8_t critEventBuffer[CHIP_DEVICE_CONFIG_EVENT_LOGGING_CRIT_BUFFER_SIZE];
+    ::chip::PersistedCounter<chip::EventNumber> globalEventIdCounter;
+    ::chip::app::CircularEventBuffer loggingBuffer[CHIP_NUM_EVENT_LOGGING_BUFFERS];
+    ::chip::app::EventManagement::LoggingState loggingState;
+#endif // CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+};
+
+ServerSnapshot sServerSnapshot;
+
+} // namespace
+#endif // CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+
 CHIP_ERROR Server::Init(const ServerInitParams & initParams)
 {
     ChipLogProgress(AppServer, "Server initializing...");
@@ -140,6 +168,10 @@ CHIP_ERROR Server::Init(const ServerInitParams & initParams)
     mOperationalKeystore           = initParams.operationalKeystore;
     mOpCertStore                   = initParams.opCertStore;
     mSessionKeystore               = initParams.sessionKeystore;
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    mSnapshotStorage = initParams.snapshotStorage;
+    VerifyOrExit(mSnapshotStorage == nullptr || mSnapshotStorage == mDeviceStorage, err = CHIP_ERROR_INVALID_ARGUMENT);
+#endif
 
     if (initParams.certificateValidityPolicy)
     {
@@ -589,6 +621,80 @@ void Server::ScheduleFactoryReset()
     });
 }
 
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+CHIP_ERROR Server::CaptureSnapshot()
+{
+    assertChipStackLockedByCurrentThread();
+    VerifyOrReturnError(mSnapshotStorage != nullptr, CHIP_ERROR_INCORRECT_STATE);
+
+    MutableByteSpan attributeStorage = GetDataModelAttributeStorage();
+    if (!attributeStorage.empty())
+    {
+        VerifyOrReturnError(sServerSnapshot.attributeData.Alloc(attributeStorage.size()), CHIP_ERROR_NO_MEMORY);
+        memcpy(sServerSnapshot.attributeData.Get(), attributeStorage.data(), attributeStorage.size());
+    }
+
+#if CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+    // The buffer objects point to the event buffers and to each other, which
+    // stay where they are: copying them back restores the queues as they were.
+    memcpy(sServerSnapshot.infoEventBuffer, sInfoEventBuffer, sizeof(sInfoEventBuffer));
+    memcpy(sServerSnapshot.debugEventBuffer, sDebugEventBuffer, sizeof(sDebugEventBuffer));
+    memcpy(sServerSnapshot.critEventBuffer, sCritEventBuffer, sizeof(sCritEventBuffer));
+    std::copy(std::begin(sLoggingBuffer), std::end(sLoggingBuffer), std::begin(sServerSnapshot.loggingBuffer));
+    sServerSnapshot.globalEventIdCounter = sGlobalEventIdCounter;
+    sServerSnapshot.loggingState         = chip::app::EventManagement::GetInstance().GetLoggingState();
+#endif // CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+
+    mSnapshotStorage->Capture();
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR Server::RestoreSnapshot()
+{
+    assertChipStackLockedByCurrentThread();
+    VerifyOrReturnError(mSnapshotStorage != nullptr && mSnapshotStorage->HasSnapshot(), CHIP_ERROR_INCORRECT_STATE);
+
+    // The access control entries are dropped before the storage is restored,
+    // which undoes the deletions their listener makes, then reloaded from it.
+    for (const auto & fabricInfo : mFabrics)
+    {
+        ReturnErrorOnFailure(mAccessControl.DeleteAllEntriesForFabric(fabricInfo.GetFabricIndex()));
+    }
+
+    ReturnErrorOnFailure(mSnapshotStorage->Restore());
+
+    MutableByteSpan attributeStorage = GetDataModelAttributeStorage();
+    if (!attributeStorage.empty())
+    {
+        memcpy(attributeStorage.data(), sServerSnapshot.attributeData.Get(), attributeStorage.size());
+    }
+
+#if CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+    memcpy(sInfoEventBuffer, sServerSnapshot.infoEventBuffer, sizeof(sInfoEventBuffer));
+    memcpy(sDebugEventBuffer, sServerSnapshot.debugEventBuffer, sizeof(sDebugEventBuffer));
+    memcpy(sCritEventBuffer, sServerSnapshot.critEventBuffer, sizeof(sCritEventBuffer));
+    std::copy(std::begin(sServerSnapshot.loggingBuffer), std::end(sServerSnapshot.loggingBuffer), std::begin(sLoggingBuffer));
+    sGlobalEventIdCounter = sServerSnapshot.globalEventIdCounter;
+    chip::app::EventManagement::GetInstance().RestoreLoggingState(sServerSnapshot.loggingState);
+#endif // CHIP_CONFIG_ENABLE_SERVER_IM_EVENT
+
+    // Reloading the fabric table from the restored storage drops the fabrics
+    // added or removed since the capture. Its delegates are kept.
+    mFabrics.RevertPendingFabricData();
+    mOperationalKeystore->RevertPendingKeypair();
+    {
+        FabricTable::InitParams fabricTableInitParams;
+        fabricTableInitParams.storage             = mDeviceStorage;
+        fabricTableInitParams.operationalKeystore = mOperationalKeystore;
+        fabricTableInitParams.opCertStore         = mOpCertStore;
+
+        ReturnErrorOnFailure(mFabrics.Init(fabricTableInitParams));
+    }
+
+    return mAclStorage->Init(*mDeviceStorage, mFabrics.begin(), mFabrics.end());
+}
+#endif // CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+
 void Server::Shutdown()
 {
     assertChipStackLockedByCurrentThread();
@@ -771,6 +877,9 @@ void Server::ResumeSubscriptions()
 Credentials::IgnoreCertificateValidityPeriodPolicy Server::sDefaultCertValidityPolicy;
 
 KvsPersistentStorageDelegate CommonCaseDeviceServerInitParams::sKvsPersistenStorageDelegate;
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+SnapshotPersistentStorageDelegate CommonCaseDeviceServerInitParams::sSnapshotStorage;
+#endif
 PersistentStorageOperationalKeystore CommonCaseDeviceServerInitParams::sPersistentStorageOperationalKeystore;
 Credentials::PersistentStorageOpCertStore CommonCaseDeviceServerInitParams::sPersistentStorageOpCertStore;
 Credentials::GroupDataProviderImpl CommonCaseDeviceServerInitParams::sGroupDataProvider;
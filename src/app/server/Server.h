@@ -45,6 +45,9 @@
 #include <inet/InetConfig.h>
 #include <lib/core/CHIPConfig.h>
 #include <lib/support/SafeInt.h>
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+#include <lib/support/SnapshotPersistentStorageDelegate.h>
+#endif
 #include <messaging/ExchangeMgr.h>
 #include <platform/DeviceInstanceInfoProvider.h>
 #include <platform/KeyValueStoreManager.h>
@@ -179,6 +182,12 @@ struct ServerInitParams
     // Optional. Support for the ICD Check-In BackOff strategy. Must be initialized before being provided.
     // If the ICD Check-In protocol use-case is supported and no strategy is provided, server will use the default strategy.
     app::ICDCheckInBackOffStrategy * icdCheckInBackOffStrategy = nullptr;
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    // Optional. Support Server::CaptureSnapshot() and Server::RestoreSnapshot() when provided. Must be
+    // the persistentStorageDelegate, so that all the writes to the storage can be undone, and be
+    // initialized before being provided.
+    SnapshotPersistentStorageDelegate * snapshotStorage = nullptr;
+#endif
 };
 
 /**
@@ -236,6 +245,17 @@ struct CommonCaseDeviceServerInitParams : public ServerInitParams
             this->persistentStorageDelegate = &sKvsPersistenStorageDelegate;
         }
 
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+        // Wrap the storage before it is handed to the resources below, so that
+        // their writes are undone as well when the snapshot is restored.
+        if (this->snapshotStorage == nullptr)
+        {
+            sSnapshotStorage.Init(this->persistentStorageDelegate);
+            this->persistentStorageDelegate = &sSnapshotStorage;
+            this->snapshotStorage           = &sSnapshotStorage;
+        }
+#endif
+
         // PersistentStorageDelegate "software-based" operational key access injection
         if (this->operationalKeystore == nullptr)
         {
@@ -305,6 +325,9 @@ struct CommonCaseDeviceServerInitParams : public ServerInitParams
 
 private:
     static KvsPersistentStorageDelegate sKvsPersistenStorageDelegate;
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    static SnapshotPersistentStorageDelegate sSnapshotStorage;
+#endif
     static PersistentStorageOperationalKeystore sPersistentStorageOperationalKeystore;
     static Credentials::PersistentStorageOpCertStore sPersistentStorageOpCertStore;
     static Credentials::GroupDataProviderImpl sGroupDataProvider;
@@ -428,6 +451,28 @@ public:
 
     void ScheduleFactoryReset();
 
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    /**
+     * Captures the state of the server which RestoreSnapshot() brings it back
+     * to: the persistent storage, the attribute store, the event buffers, and
+     * the fabric table and access control entries loaded from the storage. The
+     * group keys and the scene tables live in the persistent storage.
+     *
+     * Requires ServerInitParams::snapshotStorage to have been provided.
+     */
+    CHIP_ERROR CaptureSnapshot();
+
+    /**
+     * Brings the server back to the state captured by CaptureSnapshot(). The
+     * snapshot is kept, so that it can be restored again.
+     *
+     * The sessions, exchanges and subscriptions are not part of the snapshot,
+     * and the state the clusters keep outside of the attribute store and of
+     * the persistent storage is not restored.
+     */
+    CHIP_ERROR RestoreSnapshot();
+#endif // CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+
     System::Clock::Microseconds64 TimeSinceInit() const
     {
         return System::SystemClock().GetMonotonicMicroseconds64() - mInitTimestamp;
@@ -693,6 +738,9 @@ private:
 #if CHIP_CONFIG_ENABLE_ICD_SERVER
     app::ICDManager mICDManager;
 #endif // CHIP_CONFIG_ENABLE_ICD_SERVER
+#if CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+    SnapshotPersistentStorageDelegate * mSnapshotStorage = nullptr;
+#endif // CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
 };
 
 } // namespace chip
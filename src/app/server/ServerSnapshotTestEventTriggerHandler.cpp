@@ -0,0 +1,53 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <app/server/ServerSnapshotTestEventTriggerHandler.h>
+
+#include <app/server/Server.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <platform/CHIPDeviceLayer.h>
+
+namespace chip {
+
+namespace {
+
+void RestoreSnapshot(System::Layer *, void *)
+{
+    CHIP_ERROR err = Server::GetInstance().RestoreSnapshot();
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(AppServer, "Failed to restore the server snapshot: %" CHIP_ERROR_FORMAT, err.Format());
+    }
+}
+
+} // namespace
+
+CHIP_ERROR ServerSnapshotTestEventTriggerHandler::HandleEventTrigger(uint64_t eventTrigger)
+{
+    switch (eventTrigger)
+    {
+    case kCaptureSnapshotTrigger:
+        return Server::GetInstance().CaptureSnapshot();
+    case kRestoreSnapshotTrigger:
+        return DeviceLayer::SystemLayer().ScheduleWork(RestoreSnapshot, nullptr);
+    default:
+        return CHIP_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+} // namespace chip
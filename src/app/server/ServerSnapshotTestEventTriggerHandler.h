@@ -0,0 +1,46 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <app/TestEventTriggerDelegate.h>
+
+namespace chip {
+
+/**
+ * Test event triggers capturing and restoring the snapshot of the server
+ * state, so that a black-box fuzzer driving the device over the network can
+ * bring it back to a known state between two test cases, e.g. with
+ * `chip-tool generaldiagnostics test-event-trigger`.
+ *
+ * The restore happens once the command carrying the trigger is handled,
+ * since it reloads the fabric table and the access control entries.
+ */
+class ServerSnapshotTestEventTriggerHandler : public TestEventTriggerHandler
+{
+public:
+    // In the range reserved for non-standard usages, FFFF_FFFF_<VID_HEX>_xxxx, with the test vendor ID 0xFFF2.
+    static constexpr uint64_t kCaptureSnapshotTrigger = 0xFFFF'FFFF'FFF2'0000;
+    static constexpr uint64_t kRestoreSnapshotTrigger = 0xFFFF'FFFF'FFF2'0001;
+
+    ServerSnapshotTestEventTriggerHandler() {}
+
+    CHIP_ERROR HandleEventTrigger(uint64_t eventTrigger) override;
+};
+
+} // namespace chip
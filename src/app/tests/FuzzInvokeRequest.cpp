@@ -0,0 +1,73 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#include <cstddef>
+#include <cstdint>
+
+#include <app/MessageDef/InvokeRequestMessage.h>
+#include <lib/core/TLVReader.h>
+#include <lib/support/CodeUtils.h>
+
+#include "MessageDefFuzzing.h"
+
+namespace {
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::app::Fuzzing;
+
+CHIP_ERROR BuildInvokeRequest(TLV::TLVWriter & writer, Random & random)
+{
+    InvokeRequestMessage::Builder builder;
+    ReturnErrorOnFailure(builder.Init(&writer));
+    builder.SuppressResponse(PickBool(random)).TimedRequest(PickBool(random));
+    BuildCommandData(builder.CreateInvokeRequests(), random);
+    return builder.EndOfInvokeRequestMessage();
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t len)
+{
+    TLV::TLVReader reader;
+    reader.Init(data, len);
+
+    InvokeRequestMessage::Parser parser;
+    VerifyOrReturnValue(parser.Init(reader) == CHIP_NO_ERROR, 0);
+#if CHIP_CONFIG_IM_PRETTY_PRINT
+    parser.PrettyPrint();
+#endif
+
+    bool suppressResponse;
+    bool timedRequest;
+    (void) parser.GetSuppressResponse(&suppressResponse);
+    (void) parser.GetTimedRequest(&timedRequest);
+
+    InvokeRequests::Parser invokeRequests;
+    if (parser.GetInvokeRequests(&invokeRequests) == CHIP_NO_ERROR)
+    {
+        WalkCommandData(invokeRequests);
+    }
+    (void) parser.ExitContainer();
+
+    return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t * data, size_t size, size_t maxSize, unsigned int seed)
+{
+    return MutateMessage(data, size, maxSize, seed, BuildInvokeRequest);
+}
@@ -0,0 +1,91 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#include <cstddef>
+#include <cstdint>
+
+#include <app/MessageDef/ReportDataMessage.h>
+#include <lib/core/TLVReader.h>
+#include <lib/support/CodeUtils.h>
+
+#include "MessageDefFuzzing.h"
+
+namespace {
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::app::Fuzzing;
+
+CHIP_ERROR BuildReportData(TLV::TLVWriter & writer, Random & random)
+{
+    ReportDataMessage::Builder builder;
+    ReturnErrorOnFailure(builder.Init(&writer));
+    if (PickBool(random))
+    {
+        builder.SubscriptionId(PickId(random));
+    }
+    if (PickBool(random))
+    {
+        BuildAttributeReports(builder.CreateAttributeReportIBs(), random);
+    }
+    if (PickBool(random))
+    {
+        BuildEventReports(builder.CreateEventReports(), random);
+    }
+    builder.MoreChunkedMessages(PickBool(random)).SuppressResponse(PickBool(random));
+    return builder.EndOfReportDataMessage();
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t len)
+{
+    TLV::TLVReader reader;
+    reader.Init(data, len);
+
+    ReportDataMessage::Parser parser;
+    VerifyOrReturnValue(parser.Init(reader) == CHIP_NO_ERROR, 0);
+#if CHIP_CONFIG_IM_PRETTY_PRINT
+    parser.PrettyPrint();
+#endif
+
+    bool suppressResponse;
+    SubscriptionId subscriptionId;
+    bool moreChunkedMessages;
+    (void) parser.GetSuppressResponse(&suppressResponse);
+    (void) parser.GetSubscriptionId(&subscriptionId);
+    (void) parser.GetMoreChunkedMessages(&moreChunkedMessages);
+
+    AttributeReportIBs::Parser attributeReports;
+    if (parser.GetAttributeReportIBs(&attributeReports) == CHIP_NO_ERROR)
+    {
+        WalkAttributeReports(attributeReports);
+    }
+    EventReportIBs::Parser eventReports;
+    if (parser.GetEventReports(&eventReports) == CHIP_NO_ERROR)
+    {
+        WalkEventReports(eventReports);
+    }
+    (void) parser.ExitContainer();
+
+    return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t * data, size_t size, size_t maxSize, unsigned int seed)
+{
+    return MutateMessage(data, size, maxSize, seed, BuildReportData);
+}
@@ -0,0 +1,110 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+#include <cstddef>
+#include <cstdint>
+
+#include <app/MessageDef/SubscribeRequestMessage.h>
+#include <lib/core/TLVReader.h>
+#include <lib/support/CodeUtils.h>
+
+#include "MessageDefFuzzing.h"
+
+namespace {
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::app::Fuzzing;
+
+CHIP_ERROR BuildSubscribeRequest(TLV::TLVWriter & writer, Random & random)
+{
+    SubscribeRequestMessage::Builder builder;
+    ReturnErrorOnFailure(builder.Init(&writer));
+    builder.KeepSubscriptions(PickBool(random))
+        .MinIntervalFloorSeconds(static_cast<uint16_t>(PickNumber(random)))
+        .MaxIntervalCeilingSeconds(static_cast<uint16_t>(PickNumber(random)));
+    if (PickBool(random))
+    {
+        BuildAttributePaths(builder.CreateAttributeRequests(), random);
+    }
+    if (PickBool(random))
+    {
+        BuildEventPaths(builder.CreateEventRequests(), random);
+        if (PickBool(random))
+        {
+            BuildEventFilters(builder.CreateEventFilters(), random);
+        }
+    }
+    builder.IsFabricFiltered(PickBool(random));
+    if (PickBool(random))
+    {
+        BuildDataVersionFilters(builder.CreateDataVersionFilters(), random);
+    }
+    return builder.EndOfSubscribeRequestMessage();
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t len)
+{
+    TLV::TLVReader reader;
+    reader.Init(data, len);
+
+    SubscribeRequestMessage::Parser parser;
+    VerifyOrReturnValue(parser.Init(reader) == CHIP_NO_ERROR, 0);
+#if CHIP_CONFIG_IM_PRETTY_PRINT
+    parser.PrettyPrint();
+#endif
+
+    bool keepSubscriptions;
+    uint16_t minIntervalFloor;
+    uint16_t maxIntervalCeiling;
+    (void) parser.GetKeepSubscriptions(&keepSubscriptions);
+    (void) parser.GetMinIntervalFloorSeconds(&minIntervalFloor);
+    (void) parser.GetMaxIntervalCeilingSeconds(&maxIntervalCeiling);
+
+    AttributePathIBs::Parser attributePaths;
+    if (parser.GetAttributeRequests(&attributePaths) == CHIP_NO_ERROR)
+    {
+        WalkAttributePaths(attributePaths);
+    }
+    EventPathIBs::Parser eventPaths;
+    if (parser.GetEventRequests(&eventPaths) == CHIP_NO_ERROR)
+    {
+        WalkEventPaths(eventPaths);
+    }
+    EventFilterIBs::Parser eventFilters;
+    if (parser.GetEventFilters(&eventFilters) == CHIP_NO_ERROR)
+    {
+        WalkEventFilters(eventFilters);
+    }
+    DataVersionFilterIBs::Parser dataVersionFilters;
+    if (parser.GetDataVersionFilters(&dataVersionFilters) == CHIP_NO_ERROR)
+    {
+        WalkDataVersionFilters(dataVersionFilters);
+    }
+    bool isFabricFiltered;
+    (void) parser.GetIsFabricFiltered(&isFabricFiltered);
+    (void) parser.ExitContainer();
+
+    return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t * data, size_t size, size_t maxSize, unsigned int seed)
+{
+    return MutateMessage(data, size, maxSize, seed, BuildSubscribeRequest);
+}
@@ -0,0 +1,840 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "MessageDefFuzzing.h"
+
+#include <app/AttributePathParams.h>
+#include <app/EventHeader.h>
+#include <app/EventPathParams.h>
+#include <app/MessageDef/StatusIB.h>
+#include <lib/core/TLVReader.h>
+#include <lib/support/CodeUtils.h>
+
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Provided by libFuzzer: mutates the bytes of the strings with its own strategies and dictionaries.
+extern "C" size_t LLVMFuzzerMutate(uint8_t * data, size_t size, size_t maxSize);
+
+namespace chip {
+namespace app {
+namespace Fuzzing {
+namespace {
+
+constexpr size_t kMaxDepth         = 16;
+constexpr size_t kMaxElements      = 512;
+constexpr size_t kMaxStringGrowth  = 16;
+constexpr uint32_t kMaxMutations   = 4;
+constexpr uint32_t kMaxListEntries = 4;
+// One input out of kFreshSeedOdds is replaced by a new seed message, so that the corpus never loses the valid messages.
+constexpr uint32_t kFreshSeedOdds = 32;
+
+constexpr uint32_t kInterestingIds[] = {
+    0x0000'0000, 0x0000'0001, 0x0000'0002, 0x0000'001D, 0x0000'0028, 0x0000'FFF8, 0x0000'FFF9, 0x0000'FFFA, 0x0000'FFFB,
+    0x0000'FFFC, 0x0000'FFFD, 0x0000'FFFE, 0x0000'FFFF, 0x0001'0000, 0xFFF1'0000, 0xFFF1'FC00, 0xFFFF'FFFE, 0xFFFF'FFFF,
+};
+
+constexpr uint64_t kInterestingNumbers[] = {
+    0, 1, 0x7F, 0x80, 0xFF, 0x100, 0x7FFF, 0x8000, 0xFFFF, 0x1'0000, 0x7FFF'FFFF, 0x8000'0000, 0xFFFF'FFFF, 0x1'0000'0000,
+    0x7FFF'FFFF'FFFF'FFFF, 0x8000'0000'0000'0000, 0xFFFF'FFFF'FFFF'FFFE, 0xFFFF'FFFF'FFFF'FFFF,
+};
+
+/**
+ * A decoded TLV element. Scalars keep their value, containers their members.
+ */
+struct Element
+{
+    TLV::Tag tag       = TLV::AnonymousTag();
+    TLV::TLVType type  = TLV::kTLVType_NotSpecified;
+    uint64_t value     = 0;
+    double floatValue  = 0;
+    std::vector<uint8_t> bytes;
+    std::vector<Element> members;
+
+    bool IsContainer() const { return TLV::TLVTypeIsContainer(type); }
+};
+
+// An element of the tree, reachable from its container.
+struct Location
+{
+    Element * container;
+    size_t index;
+
+    Element & Get() const { return container->members[index]; }
+};
+
+enum class Mutation : uint8_t
+{
+    kValue,
+    kType,
+    kTag,
+    kDrop,
+    kDuplicate,
+    kSwap,
+    kGraft,
+    kCount,
+};
+
+uint32_t Below(Random & random, size_t bound)
+{
+    return static_cast<uint32_t>(random() % bound);
+}
+
+CHIP_ERROR Decode(TLV::TLVReader & reader, Element & element, size_t depth, size_t & count)
+{
+    VerifyOrReturnError(++count <= kMaxElements && depth <= kMaxDepth, CHIP_ERROR_BUFFER_TOO_SMALL);
+    element.tag  = reader.GetTag();
+    element.type = reader.GetType();
+    switch (element.type)
+    {
+    case TLV::kTLVType_SignedInteger: {
+        int64_t value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.value = static_cast<uint64_t>(value);
+        return CHIP_NO_ERROR;
+    }
+    case TLV::kTLVType_UnsignedInteger:
+        return reader.Get(element.value);
+    case TLV::kTLVType_Boolean: {
+        bool value;
+        ReturnErrorOnFailure(reader.Get(value));
+        element.value = value ? 1 : 0;
+        return CHIP_NO_ERROR;
+    }
+    case TLV::kTLVType_FloatingPointNumber:
+        return reader.Get(element.floatValue);
+    case TLV::kTLVType_UTF8String:
+    case TLV::kTLVType_ByteString:
+        element.bytes.resize(reader.GetLength());
+        return element.bytes.empty() ? CHIP_NO_ERROR : reader.GetBytes(element.bytes.data(), element.bytes.size());
+    case TLV::kTLVType_Null:
+        return CHIP_NO_ERROR;
+    case TLV::kTLVType_Structure:
+    case TLV::kTLVType_Array:
+    case TLV::kTLVType_List: {
+        TLV::TLVType outer;
+        ReturnErrorOnFailure(reader.EnterContainer(outer));
+        CHIP_ERROR err;
+        while ((err = reader.Next()) == CHIP_NO_ERROR)
+        {
+            element.members.emplace_back();
+            ReturnErrorOnFailure(Decode(reader, element.members.back(), depth + 1, count));
+        }
+        VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+        return reader.ExitContainer(outer);
+    }
+    default:
+        return CHIP_ERROR_INVALID_TLV_ELEMENT;
+    }
+}
+
+CHIP_ERROR Encode(TLV::TLVWriter & writer, const Element & element)
+{
+    switch (element.type)
+    {
+    case TLV::kTLVType_SignedInteger:
+        return writer.Put(element.tag, static_cast<int64_t>(element.value));
+    case TLV::kTLVType_UnsignedInteger:
+        return writer.Put(element.tag, element.value);
+    case TLV::kTLVType_Boolean:
+        return writer.PutBoolean(element.tag, element.value != 0);
+    case TLV::kTLVType_FloatingPointNumber:
+        return writer.Put(element.tag, element.floatValue);
+    case TLV::kTLVType_UTF8String:
+        return writer.PutString(element.tag, reinterpret_cast<const char *>(element.bytes.data()),
+                                static_cast<uint32_t>(element.bytes.size()));
+    case TLV::kTLVType_ByteString:
+        return writer.PutBytes(element.tag, element.bytes.data(), static_cast<uint32_t>(element.bytes.size()));
+    case TLV::kTLVType_Null:
+        return writer.PutNull(element.tag);
+    default: {
+        TLV::TLVType outer;
+        ReturnErrorOnFailure(writer.StartContainer(element.tag, element.type, outer));
+        for (const Element & member : element.members)
+        {
+            ReturnErrorOnFailure(Encode(writer, member));
+        }
+        return writer.EndContainer(outer);
+    }
+    }
+}
+
+CHIP_ERROR DecodeMessage(const uint8_t * data, size_t size, Element & root)
+{
+    TLV::TLVReader reader;
+    reader.Init(data, size);
+    ReturnErrorOnFailure(reader.Next());
+    size_t count = 0;
+    return Decode(reader, root, 0, count);
+}
+
+size_t EncodeMessage(const Element & root, uint8_t * data, size_t maxSize)
+{
+    TLV::TLVWriter writer;
+    writer.Init(data, maxSize);
+    VerifyOrReturnValue(Encode(writer, root) == CHIP_NO_ERROR && writer.Finalize() == CHIP_NO_ERROR, 0);
+    return writer.GetLengthWritten();
+}
+
+size_t BuildSeedMessage(SeedBuilder buildSeed, Random & random, uint8_t * data, size_t maxSize)
+{
+    TLV::TLVWriter writer;
+    writer.Init(data, maxSize);
+    VerifyOrReturnValue(buildSeed(writer, random) == CHIP_NO_ERROR && writer.Finalize() == CHIP_NO_ERROR, 0);
+    return writer.GetLengthWritten();
+}
+
+void CollectLocations(Element & container, std::vector<Location> & locations)
+{
+    for (size_t index = 0; index < container.members.size(); index++)
+    {
+        locations.push_back({ &container, index });
+        if (container.members[index].IsContainer())
+        {
+            CollectLocations(container.members[index], locations);
+        }
+    }
+}
+
+void CollectContainers(Element & element, std::vector<Element *> & containers)
+{
+    containers.push_back(&element);
+    for (Element & member : element.members)
+    {
+        if (member.IsContainer())
+        {
+            CollectContainers(member, containers);
+        }
+    }
+}
+
+void MutateValue(Element & element, Random & random)
+{
+    switch (element.type)
+    {
+    case TLV::kTLVType_SignedInteger:
+    case TLV::kTLVType_UnsignedInteger:
+        switch (Below(random, 4))
+        {
+        case 0:
+            element.value = kInterestingNumbers[Below(random, ArraySize(kInterestingNumbers))];
+            break;
+        case 1:
+            element.value += (random() & 1) ? 1 : static_cast<uint64_t>(-1);
+            break;
+        case 2:
+            element.value ^= static_cast<uint64_t>(1) << Below(random, 64);
+            break;
+        default:
+            element.value = PickId(random);
+            break;
+        }
+        break;
+    case TLV::kTLVType_Boolean:
+        element.value = element.value ? 0 : 1;
+        break;
+    case TLV::kTLVType_FloatingPointNumber: {
+        const double values[] = { 0.0, -0.0, 1.0, -1.0, std::numeric_limits<double>::quiet_NaN(),
+                                  std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min() };
+        element.floatValue = values[Below(random, ArraySize(values))];
+        break;
+    }
+    case TLV::kTLVType_UTF8String:
+    case TLV::kTLVType_ByteString: {
+        size_t size = element.bytes.size();
+        element.bytes.resize(size + kMaxStringGrowth);
+        element.bytes.resize(LLVMFuzzerMutate(element.bytes.data(), size, element.bytes.size()));
+        break;
+    }
+    case TLV::kTLVType_Null:
+        element.type  = TLV::kTLVType_UnsignedInteger;
+        element.value = 0;
+        break;
+    default:
+        // Containers get emptied, which the parsers of the mandatory lists reject.
+        element.members.clear();
+        break;
+    }
+}
+
+void MutateType(Element & element, Random & random)
+{
+    constexpr TLV::TLVType kTypes[] = { TLV::kTLVType_SignedInteger, TLV::kTLVType_UnsignedInteger, TLV::kTLVType_Boolean,
+                                        TLV::kTLVType_FloatingPointNumber, TLV::kTLVType_UTF8String, TLV::kTLVType_ByteString,
+                                        TLV::kTLVType_Null, TLV::kTLVType_Structure, TLV::kTLVType_Array, TLV::kTLVType_List };
+    TLV::TLVType type = kTypes[Below(random, ArraySize(kTypes))];
+    if (!TLV::TLVTypeIsContainer(type))
+    {
+        element.members.clear();
+    }
+    // Array members are anonymous, the other containers keep the tags of theirs.
+    if (type == TLV::kTLVType_Array)
+    {
+        for (Element & member : element.members)
+        {
+            member.tag = TLV::AnonymousTag();
+        }
+    }
+    element.type = type;
+}
+
+void MutateTag(Element & element, Random & random)
+{
+    switch (Below(random, 3))
+    {
+    case 0:
+        element.tag = TLV::AnonymousTag();
+        break;
+    case 1:
+        // Neighbouring tags are the ones of the other fields of the same information block.
+        element.tag = TLV::ContextTag(static_cast<uint8_t>(Below(random, 8)));
+        break;
+    default:
+        element.tag = TLV::ContextTag(static_cast<uint8_t>(random()));
+        break;
+    }
+}
+
+void GraftSeed(Element & container, SeedBuilder buildSeed, Random & random)
+{
+    uint8_t buffer[512];
+    Element seed;
+    size_t size = BuildSeedMessage(buildSeed, random, buffer, sizeof(buffer));
+    VerifyOrReturn(size > 0 && DecodeMessage(buffer, size, seed) == CHIP_NO_ERROR);
+
+    std::vector<Location> locations;
+    CollectLocations(seed, locations);
+    VerifyOrReturn(!locations.empty());
+    Element graft = locations[Below(random, locations.size())].Get();
+    container.members.insert(container.members.begin() + Below(random, container.members.size() + 1), std::move(graft));
+}
+
+void Mutate(Element & root, SeedBuilder buildSeed, Random & random)
+{
+    std::vector<Location> locations;
+    CollectLocations(root, locations);
+    std::vector<Element *> containers;
+    CollectContainers(root, containers);
+
+    auto mutation = static_cast<Mutation>(Below(random, to_underlying(Mutation::kCount)));
+    if (mutation == Mutation::kGraft || locations.empty())
+    {
+        GraftSeed(*containers[Below(random, containers.size())], buildSeed, random);
+        return;
+    }
+
+    const Location & location = locations[Below(random, locations.size())];
+    Element & container       = *location.container;
+    switch (mutation)
+    {
+    case Mutation::kValue:
+        MutateValue(location.Get(), random);
+        break;
+    case Mutation::kType:
+        MutateType(location.Get(), random);
+        break;
+    case Mutation::kTag:
+        MutateTag(location.Get(), random);
+        break;
+    case Mutation::kDrop:
+        container.members.erase(container.members.begin() + static_cast<std::ptrdiff_t>(location.index));
+        break;
+    case Mutation::kDuplicate: {
+        Element copy = location.Get();
+        container.members.insert(container.members.begin() + static_cast<std::ptrdiff_t>(location.index), std::move(copy));
+        break;
+    }
+    case Mutation::kSwap:
+        std::swap(location.Get(), container.members[Below(random, container.members.size())]);
+        break;
+    default:
+        break;
+    }
+}
+
+void WalkAttributePath(AttributePathIB::Parser & parser)
+{
+    AttributePathParams params;
+    bool enableTagCompression;
+    NodeId node;
+    DataModel::Nullable<ListIndex> listIndex;
+    (void) parser.ParsePath(params);
+    (void) parser.GetEnableTagCompression(&enableTagCompression);
+    (void) parser.GetNode(&node);
+    (void) parser.GetListIndex(&listIndex);
+}
+
+void WalkEventPath(EventPathIB::Parser & parser)
+{
+    EventPathParams params;
+    ConcreteEventPath path;
+    NodeId node;
+    (void) parser.ParsePath(params);
+    (void) parser.GetEventPath(&path);
+    (void) parser.GetNode(&node);
+}
+
+void WalkClusterPath(ClusterPathIB::Parser & parser)
+{
+    NodeId node;
+    EndpointId endpoint;
+    ClusterId cluster;
+    (void) parser.GetNode(&node);
+    (void) parser.GetEndpoint(&endpoint);
+    (void) parser.GetCluster(&cluster);
+}
+
+void WalkStatus(StatusIB::Parser & parser)
+{
+    StatusIB status;
+    (void) parser.DecodeStatusIB(status);
+}
+
+void WalkData(const TLV::TLVReader & data)
+{
+    // The data are decoded by the clusters, the parsers only have to skip them.
+    TLV::TLVReader reader;
+    reader.Init(data);
+    (void) reader.Skip();
+}
+
+void WalkAttributeDataIB(AttributeDataIB::Parser & parser)
+{
+    DataVersion version;
+    AttributePathIB::Parser path;
+    TLV::TLVReader data;
+    (void) parser.GetDataVersion(&version);
+    if (parser.GetPath(&path) == CHIP_NO_ERROR)
+    {
+        WalkAttributePath(path);
+    }
+    if (parser.GetData(&data) == CHIP_NO_ERROR)
+    {
+        WalkData(data);
+    }
+}
+
+void WalkEventDataIB(EventDataIB::Parser & parser)
+{
+    EventHeader header;
+    EventPathIB::Parser path;
+    TLV::TLVReader data;
+    (void) parser.DecodeEventHeader(header);
+    if (parser.GetPath(&path) == CHIP_NO_ERROR)
+    {
+        WalkEventPath(path);
+    }
+    if (parser.GetData(&data) == CHIP_NO_ERROR)
+    {
+        WalkData(data);
+    }
+}
+
+/**
+ * Calls @p walk with the parser of every element of the list parsed by
+ * @p parser, as the Interaction Model engine iterates over them.
+ */
+template <typename ElementParser, typename ListParser, typename Walk>
+void WalkList(ListParser & parser, Walk walk)
+{
+    TLV::TLVReader reader;
+    parser.GetReader(&reader);
+    while (reader.Next() == CHIP_NO_ERROR)
+    {
+        ElementParser element;
+        if (element.Init(reader) == CHIP_NO_ERROR)
+        {
+            walk(element);
+        }
+    }
+}
+
+void BuildAttributePath(AttributePathIB::Builder & builder, Random & random)
+{
+    // Every field of a path is optional: the omitted ones are wildcards.
+    if (PickBool(random))
+    {
+        builder.Endpoint(static_cast<EndpointId>(PickId(random)));
+    }
+    if (PickBool(random))
+    {
+        builder.Cluster(PickId(random));
+    }
+    if (PickBool(random))
+    {
+        builder.Attribute(PickId(random));
+    }
+    if (Below(random, 4) == 0)
+    {
+        builder.ListIndex(DataModel::Nullable<ListIndex>());
+    }
+    builder.EndOfAttributePathIB();
+}
+
+void BuildEventPath(EventPathIB::Builder & builder, Random & random)
+{
+    if (PickBool(random))
+    {
+        builder.Endpoint(static_cast<EndpointId>(PickId(random)));
+    }
+    if (PickBool(random))
+    {
+        builder.Cluster(PickId(random));
+    }
+    if (PickBool(random))
+    {
+        builder.Event(PickId(random));
+    }
+    if (PickBool(random))
+    {
+        builder.IsUrgent(PickBool(random));
+    }
+    builder.EndOfEventPathIB();
+}
+
+void BuildStatus(StatusIB::Builder & builder, Random & random)
+{
+    builder.EncodeStatusIB(StatusIB(static_cast<Protocols::InteractionModel::Status>(random())));
+}
+
+uint32_t PickEntryCount(Random & random)
+{
+    return 1 + Below(random, kMaxListEntries);
+}
+
+} // namespace
+
+uint32_t PickId(Random & random)
+{
+    return (random() & 3) ? kInterestingIds[Below(random, ArraySize(kInterestingIds))] : static_cast<uint32_t>(random());
+}
+
+uint64_t PickNumber(Random & random)
+{
+    return (random() & 3) ? kInterestingNumbers[Below(random, ArraySize(kInterestingNumbers))]
+                          : (static_cast<uint64_t>(random()) << 32 | random());
+}
+
+bool PickBool(Random & random)
+{
+    return (random() & 1) != 0;
+}
+
+CHIP_ERROR WriteData(TLV::TLVWriter & writer, TLV::Tag tag, Random & random)
+{
+    switch (Below(random, 6))
+    {
+    case 0:
+        return writer.Put(tag, PickNumber(random));
+    case 1:
+        return writer.Put(tag, static_cast<int64_t>(PickNumber(random)));
+    case 2:
+        return writer.PutBoolean(tag, PickBool(random));
+    case 3:
+        return writer.PutString(tag, "fuzz");
+    case 4:
+        return writer.PutNull(tag);
+    default: {
+        TLV::TLVType outer;
+        ReturnErrorOnFailure(writer.StartContainer(tag, TLV::kTLVType_Structure, outer));
+        ReturnErrorOnFailure(writer.Put(TLV::ContextTag(0), PickNumber(random)));
+        ReturnErrorOnFailure(writer.PutBoolean(TLV::ContextTag(1), PickBool(random)));
+        return writer.EndContainer(outer);
+    }
+    }
+}
+
+void BuildAttributePaths(AttributePathIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        BuildAttributePath(builder.CreatePath(), random);
+    }
+    builder.EndOfAttributePathIBs();
+}
+
+void BuildEventPaths(EventPathIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        BuildEventPath(builder.CreatePath(), random);
+    }
+    builder.EndOfEventPaths();
+}
+
+void BuildEventFilters(EventFilterIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        EventFilterIB::Builder & filter = builder.CreateEventFilter();
+        if (PickBool(random))
+        {
+            filter.Node(PickNumber(random));
+        }
+        filter.EventMin(PickNumber(random)).EndOfEventFilterIB();
+    }
+    builder.EndOfEventFilters();
+}
+
+void BuildDataVersionFilters(DataVersionFilterIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        DataVersionFilterIB::Builder & filter = builder.CreateDataVersionFilter();
+        filter.CreatePath()
+            .Endpoint(static_cast<EndpointId>(PickId(random)))
+            .Cluster(PickId(random))
+            .EndOfClusterPathIB();
+        filter.DataVersion(PickId(random)).EndOfDataVersionFilterIB();
+    }
+    builder.EndOfDataVersionFilterIBs();
+}
+
+void BuildAttributeData(AttributeDataIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        AttributeDataIB::Builder & data = builder.CreateAttributeDataIBBuilder();
+        if (PickBool(random))
+        {
+            data.DataVersion(PickId(random));
+        }
+        BuildAttributePath(data.CreatePath(), random);
+        VerifyOrReturn(data.GetError() == CHIP_NO_ERROR);
+        VerifyOrReturn(WriteData(*data.GetWriter(), TLV::ContextTag(AttributeDataIB::Tag::kData), random) == CHIP_NO_ERROR);
+        data.EndOfAttributeDataIB();
+    }
+    builder.EndOfAttributeDataIBs();
+}
+
+void BuildCommandData(InvokeRequests::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        CommandDataIB::Builder & command = builder.CreateCommandData();
+        command.CreatePath()
+            .EndpointId(static_cast<EndpointId>(PickId(random)))
+            .ClusterId(PickId(random))
+            .CommandId(PickId(random))
+            .EndOfCommandPathIB();
+        VerifyOrReturn(command.GetError() == CHIP_NO_ERROR);
+        VerifyOrReturn(WriteData(*command.GetWriter(), TLV::ContextTag(CommandDataIB::Tag::kFields), random) == CHIP_NO_ERROR);
+        command.EndOfCommandDataIB();
+    }
+    builder.EndOfInvokeRequests();
+}
+
+void BuildAttributeReports(AttributeReportIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        AttributeReportIB::Builder & report = builder.CreateAttributeReport();
+        if (PickBool(random))
+        {
+            AttributeStatusIB::Builder & status = report.CreateAttributeStatus();
+            BuildAttributePath(status.CreatePath(), random);
+            BuildStatus(status.CreateErrorStatus(), random);
+            status.EndOfAttributeStatusIB();
+        }
+        else
+        {
+            AttributeDataIB::Builder & data = report.CreateAttributeData();
+            data.DataVersion(PickId(random));
+            BuildAttributePath(data.CreatePath(), random);
+            VerifyOrReturn(data.GetError() == CHIP_NO_ERROR);
+            VerifyOrReturn(WriteData(*data.GetWriter(), TLV::ContextTag(AttributeDataIB::Tag::kData), random) == CHIP_NO_ERROR);
+            data.EndOfAttributeDataIB();
+        }
+        report.EndOfAttributeReportIB();
+    }
+    builder.EndOfAttributeReportIBs();
+}
+
+void BuildEventReports(EventReportIBs::Builder & builder, Random & random)
+{
+    for (uint32_t count = PickEntryCount(random); count > 0; count--)
+    {
+        EventReportIB::Builder & report = builder.CreateEventReport();
+        if (PickBool(random))
+        {
+            EventStatusIB::Builder & status = report.CreateEventStatus();
+            BuildEventPath(status.CreatePath(), random);
+            BuildStatus(status.CreateErrorStatus(), random);
+            status.EndOfEventStatusIB();
+        }
+        else
+        {
+            EventDataIB::Builder & data = report.CreateEventData();
+            BuildEventPath(data.CreatePath(), random);
+            data.EventNumber(PickNumber(random)).Priority(static_cast<uint8_t>(random()));
+            if (PickBool(random))
+            {
+                data.EpochTimestamp(PickNumber(random));
+            }
+            else
+            {
+                data.SystemTimestamp(PickNumber(random));
+            }
+            VerifyOrReturn(data.GetError() == CHIP_NO_ERROR);
+            VerifyOrReturn(WriteData(*data.GetWriter(), TLV::ContextTag(EventDataIB::Tag::kData), random) == CHIP_NO_ERROR);
+            data.EndOfEventDataIB();
+        }
+        report.EndOfEventReportIB();
+    }
+    builder.EndOfEventReports();
+}
+
+void WalkAttributePaths(AttributePathIBs::Parser & parser)
+{
+    WalkList<AttributePathIB::Parser>(parser, WalkAttributePath);
+}
+
+void WalkEventPaths(EventPathIBs::Parser & parser)
+{
+    WalkList<EventPathIB::Parser>(parser, WalkEventPath);
+}
+
+void WalkEventFilters(EventFilterIBs::Parser & parser)
+{
+    WalkList<EventFilterIB::Parser>(parser, [](EventFilterIB::Parser & filter) {
+        NodeId node;
+        uint64_t eventMin;
+        (void) filter.GetNode(&node);
+        (void) filter.GetEventMin(&eventMin);
+    });
+}
+
+void WalkDataVersionFilters(DataVersionFilterIBs::Parser & parser)
+{
+    WalkList<DataVersionFilterIB::Parser>(parser, [](DataVersionFilterIB::Parser & filter) {
+        ClusterPathIB::Parser path;
+        DataVersion version;
+        if (filter.GetPath(&path) == CHIP_NO_ERROR)
+        {
+            WalkClusterPath(path);
+        }
+        (void) filter.GetDataVersion(&version);
+    });
+}
+
+void WalkAttributeData(AttributeDataIBs::Parser & parser)
+{
+    WalkList<AttributeDataIB::Parser>(parser, WalkAttributeDataIB);
+}
+
+void WalkCommandData(InvokeRequests::Parser & parser)
+{
+    WalkList<CommandDataIB::Parser>(parser, [](CommandDataIB::Parser & command) {
+        CommandPathIB::Parser path;
+        TLV::TLVReader fields;
+        uint16_t ref;
+        if (command.GetPath(&path) == CHIP_NO_ERROR)
+        {
+            ConcreteCommandPath concretePath(0, 0, 0);
+            ClusterId cluster;
+            CommandId commandId;
+            (void) path.GetConcreteCommandPath(concretePath);
+            (void) path.GetGroupCommandPath(&cluster, &commandId);
+        }
+        if (command.GetFields(&fields) == CHIP_NO_ERROR)
+        {
+            WalkData(fields);
+        }
+        (void) command.GetRef(&ref);
+    });
+}
+
+void WalkAttributeReports(AttributeReportIBs::Parser & parser)
+{
+    WalkList<AttributeReportIB::Parser>(parser, [](AttributeReportIB::Parser & report) {
+        AttributeStatusIB::Parser status;
+        AttributeDataIB::Parser data;
+        if (report.GetAttributeStatus(&status) == CHIP_NO_ERROR)
+        {
+            AttributePathIB::Parser path;
+            StatusIB::Parser errorStatus;
+            if (status.GetPath(&path) == CHIP_NO_ERROR)
+            {
+                WalkAttributePath(path);
+            }
+            if (status.GetErrorStatus(&errorStatus) == CHIP_NO_ERROR)
+            {
+                WalkStatus(errorStatus);
+            }
+        }
+        if (report.GetAttributeData(&data) == CHIP_NO_ERROR)
+        {
+            WalkAttributeDataIB(data);
+        }
+    });
+}
+
+void WalkEventReports(EventReportIBs::Parser & parser)
+{
+    WalkList<EventReportIB::Parser>(parser, [](EventReportIB::Parser & report) {
+        EventStatusIB::Parser status;
+        EventDataIB::Parser data;
+        if (report.GetEventStatus(&status) == CHIP_NO_ERROR)
+        {
+            EventPathIB::Parser path;
+            StatusIB::Parser errorStatus;
+            if (status.GetPath(&path) == CHIP_NO_ERROR)
+            {
+                WalkEventPath(path);
+            }
+            if (status.GetErrorStatus(&errorStatus) == CHIP_NO_ERROR)
+            {
+                WalkStatus(errorStatus);
+            }
+        }
+        if (report.GetEventData(&data) == CHIP_NO_ERROR)
+        {
+            WalkEventDataIB(data);
+        }
+    });
+}
+
+size_t MutateMessage(uint8_t * data, size_t size, size_t maxSize, unsigned int seed, SeedBuilder buildSeed)
+{
+    Random random(seed);
+    Element root;
+    if (Below(random, kFreshSeedOdds) == 0 || DecodeMessage(data, size, root) != CHIP_NO_ERROR || !root.IsContainer())
+    {
+        size_t seedSize = BuildSeedMessage(buildSeed, random, data, maxSize);
+        return seedSize > 0 ? seedSize : size;
+    }
+
+    for (uint32_t count = 1 + Below(random, kMaxMutations); count > 0; count--)
+    {
+        Mutate(root, buildSeed, random);
+    }
+
+    // The input is only overwritten once the mutated message is known to fit.
+    std::vector<uint8_t> buffer(maxSize);
+    size_t mutatedSize = EncodeMessage(root, buffer.data(), buffer.size());
+    VerifyOrReturnValue(mutatedSize > 0, size);
+    memcpy(data, buffer.data(), mutatedSize);
+    return mutatedSize;
+}
+
+} // namespace Fuzzing
+} // namespace app
+} // namespace chip
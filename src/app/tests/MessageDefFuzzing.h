@@ -0,0 +1,99 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Shared pieces of the structure-aware fuzz targets of the Interaction
+ *      Model messages: a TLV-aware mutator, which keeps the mutated inputs
+ *      well-formed TLV, and walkers which descend into every information
+ *      block of a message the way the Interaction Model engine does.
+ */
+
+#pragma once
+
+#include <app/MessageDef/AttributeDataIBs.h>
+#include <app/MessageDef/AttributePathIBs.h>
+#include <app/MessageDef/AttributeReportIBs.h>
+#include <app/MessageDef/DataVersionFilterIBs.h>
+#include <app/MessageDef/EventFilterIBs.h>
+#include <app/MessageDef/EventPathIBs.h>
+#include <app/MessageDef/EventReportIBs.h>
+#include <app/MessageDef/InvokeRequests.h>
+#include <lib/core/CHIPError.h>
+#include <lib/core/TLVWriter.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace chip {
+namespace app {
+namespace Fuzzing {
+
+using Random = std::minstd_rand;
+
+/**
+ * Writes a well-formed message with the MessageDef builders, the fields being
+ * drawn from @p random. Used when the input to mutate is not a TLV element.
+ */
+using SeedBuilder = CHIP_ERROR (*)(TLV::TLVWriter & writer, Random & random);
+
+/**
+ * Mutates the TLV encoded message in @p data, as an implementation of
+ * LLVMFuzzerCustomMutator.
+ *
+ * The message is decoded into a tree of elements, which gets a few mutations
+ * (values out of range, other types, unknown or duplicated tags, dropped,
+ * duplicated or reordered elements, or elements grafted from a new seed
+ * message), and is encoded again. The mutated message is always well-formed
+ * TLV, so that the parsers get past the TLV reader.
+ *
+ * @return the size of the mutated message, at most @p maxSize.
+ */
+size_t MutateMessage(uint8_t * data, size_t size, size_t maxSize, unsigned int seed, SeedBuilder buildSeed);
+
+// Identifiers biased towards the boundaries the parsers and the data model check.
+uint32_t PickId(Random & random);
+uint64_t PickNumber(Random & random);
+bool PickBool(Random & random);
+
+// Writes a random value of a random type under @p tag, for the data of the attributes, commands and events.
+CHIP_ERROR WriteData(TLV::TLVWriter & writer, TLV::Tag tag, Random & random);
+
+void BuildAttributePaths(AttributePathIBs::Builder & builder, Random & random);
+void BuildEventPaths(EventPathIBs::Builder & builder, Random & random);
+void BuildEventFilters(EventFilterIBs::Builder & builder, Random & random);
+void BuildDataVersionFilters(DataVersionFilterIBs::Builder & builder, Random & random);
+void BuildAttributeData(AttributeDataIBs::Builder & builder, Random & random);
+void BuildCommandData(InvokeRequests::Builder & builder, Random & random);
+void BuildAttributeReports(AttributeReportIBs::Builder & builder, Random & random);
+void BuildEventReports(EventReportIBs::Builder & builder, Random & random);
+
+// Every element of the list is parsed, down to the leaves of its information blocks.
+void WalkAttributePaths(AttributePathIBs::Parser & parser);
+void WalkEventPaths(EventPathIBs::Parser & parser);
+void WalkEventFilters(EventFilterIBs::Parser & parser);
+void WalkDataVersionFilters(DataVersionFilterIBs::Parser & parser);
+void WalkAttributeData(AttributeDataIBs::Parser & parser);
+void WalkCommandData(InvokeRequests::Parser & parser);
+void WalkAttributeReports(AttributeReportIBs::Parser & parser);
+void WalkEventReports(EventReportIBs::Parser & parser);
+
+} // namespace Fuzzing
+} // namespace app
+} // namespace chip
@@ -40,8 +40,12 @@ using chip::CommissioningWindowAdvertisement;
 using chip::CommissioningWindowManager;
 using chip::Server;
 
-// Mock function for linking
+// Mock functions for linking
 void InitDataModelHandler() {}
+chip::MutableByteSpan GetDataModelAttributeStorage()
+{
+    return chip::MutableByteSpan();
+}
 
 namespace {
 bool sAdminFabricIndexDirty = false;
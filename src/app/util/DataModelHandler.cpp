@@ -16,6 +16,7 @@
  */
 #include <app/util/DataModelHandler.h>
 
+#include <app/util/attribute-storage-detail.h>
 #include <app/util/attribute-storage.h>
 #include <app/util/util.h>
 #include <lib/support/logging/CHIPLogging.h>
@@ -28,3 +29,12 @@ void InitDataModelHandler()
     emberAfEndpointConfigure();
     emberAfInit();
 }
+
+MutableByteSpan GetDataModelAttributeStorage()
+{
+#if (ATTRIBUTE_MAX_SIZE == 0)
+    return MutableByteSpan();
+#else
+    return MutableByteSpan(attributeData, ATTRIBUTE_MAX_SIZE);
+#endif
+}
@@ -16,8 +16,16 @@
  */
 #pragma once
 
+#include <lib/support/Span.h>
+
 /**
  * Initialize the data model internal code to be ready to send and receive
  * data model messages.
  */
 void InitDataModelHandler();
+
+/**
+ * Returns the RAM storage of the attributes kept by the data model itself,
+ * e.g. to save and restore its content. Empty when no such attribute exists.
+ */
+chip::MutableByteSpan GetDataModelAttributeStorage();
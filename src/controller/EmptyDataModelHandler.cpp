@@ -25,3 +25,8 @@
 #include <app/util/DataModelHandler.h>
 
 void InitDataModelHandler() {}
+
+chip::MutableByteSpan GetDataModelAttributeStorage()
+{
+    return chip::MutableByteSpan();
+}
@@ -1245,6 +1245,17 @@ extern const char CHIP_NON_PRODUCTION_MARKER[];
 #define CHIP_CONFIG_ENABLE_SERVER_IM_EVENT 1
 #endif
 
+/**
+ * @def CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+ *
+ * @brief Enable Server::CaptureSnapshot() and Server::RestoreSnapshot(), which
+ *        bring the state of the server back to an earlier point, e.g. between
+ *        two fuzzing inputs. Only meant for test and fuzzing builds.
+ */
+#ifndef CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT
+#define CHIP_CONFIG_ENABLE_SERVER_SNAPSHOT 0
+#endif
+
 /**
  * Accepts receipt of invalid privacy flag usage that affected some early SVE2 test event implementations.
  * When SVE2 started, group messages would be sent with the privacy flag enabled, but without privacy encrypting the message header.
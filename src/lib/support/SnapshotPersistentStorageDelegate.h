@@ -0,0 +1,156 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+#include <lib/core/CHIPPersistentStorageDelegate.h>
+#include <lib/support/CodeUtils.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chip {
+
+/**
+ * PersistentStorageDelegate which can bring the storage it wraps back to the
+ * content it had when the snapshot was captured.
+ *
+ * Once a snapshot is captured, the first write or deletion of every key saves
+ * the value the key had, and restoring the snapshot puts these values back.
+ * Capturing and restoring cost nothing for the keys which were not modified,
+ * whatever the backend and the size of the storage.
+ */
+class SnapshotPersistentStorageDelegate : public PersistentStorageDelegate
+{
+public:
+    SnapshotPersistentStorageDelegate() = default;
+
+    void Init(PersistentStorageDelegate * storage) { mStorage = storage; }
+
+    /// Captures the current content of the storage, replacing the previous snapshot.
+    void Capture()
+    {
+        mUndoLog.clear();
+        mCaptured = true;
+    }
+
+    /// Brings the storage back to the content it had when the snapshot was captured. The snapshot is kept.
+    CHIP_ERROR Restore()
+    {
+        VerifyOrReturnError(mCaptured, CHIP_ERROR_INCORRECT_STATE);
+
+        CHIP_ERROR err = CHIP_NO_ERROR;
+        for (const auto & [key, value] : mUndoLog)
+        {
+            CHIP_ERROR keyErr = value.present ? mStorage->SyncSetKeyValue(key.c_str(), value.data.data(), value.Size())
+                                              : mStorage->SyncDeleteKeyValue(key.c_str());
+            if (keyErr == CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND)
+            {
+                keyErr = CHIP_NO_ERROR;
+            }
+            if (err == CHIP_NO_ERROR)
+            {
+                err = keyErr;
+            }
+        }
+        mUndoLog.clear();
+        return err;
+    }
+
+    bool HasSnapshot() const { return mCaptured; }
+
+    CHIP_ERROR SyncGetKeyValue(const char * key, void * buffer, uint16_t & size) override
+    {
+        VerifyOrReturnError(mStorage != nullptr, CHIP_ERROR_INCORRECT_STATE);
+        return mStorage->SyncGetKeyValue(key, buffer, size);
+    }
+
+    CHIP_ERROR SyncSetKeyValue(const char * key, const void * value, uint16_t size) override
+    {
+        VerifyOrReturnError(mStorage != nullptr, CHIP_ERROR_INCORRECT_STATE);
+        ReturnErrorOnFailure(SaveOriginalValue(key));
+        return mStorage->SyncSetKeyValue(key, value, size);
+    }
+
+    CHIP_ERROR SyncDeleteKeyValue(const char * key) override
+    {
+        VerifyOrReturnError(mStorage != nullptr, CHIP_ERROR_INCORRECT_STATE);
+        ReturnErrorOnFailure(SaveOriginalValue(key));
+        return mStorage->SyncDeleteKeyValue(key);
+    }
+
+private:
+    static constexpr size_t kInitialValueSize = 256;
+
+    struct OriginalValue
+    {
+        bool present = false;
+        std::vector<uint8_t> data;
+
+        uint16_t Size() const { return static_cast<uint16_t>(data.size()); }
+    };
+
+    CHIP_ERROR SaveOriginalValue(const char * key)
+    {
+        VerifyOrReturnError(mCaptured, CHIP_NO_ERROR);
+        VerifyOrReturnError(key != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+        auto [entry, inserted] = mUndoLog.try_emplace(key);
+        VerifyOrReturnError(inserted, CHIP_NO_ERROR);
+
+        // The value is read with a growing buffer, the delegate not reporting the size of the values.
+        OriginalValue & original = entry->second;
+        size_t capacity          = kInitialValueSize;
+        while (true)
+        {
+            original.data.resize(capacity);
+            uint16_t size  = static_cast<uint16_t>(capacity);
+            CHIP_ERROR err = mStorage->SyncGetKeyValue(key, original.data.data(), size);
+            if (err == CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND)
+            {
+                original.data.clear();
+                return CHIP_NO_ERROR;
+            }
+            if (err == CHIP_ERROR_BUFFER_TOO_SMALL && capacity < std::numeric_limits<uint16_t>::max())
+            {
+                capacity = std::min<size_t>(capacity * 2, std::numeric_limits<uint16_t>::max());
+                continue;
+            }
+            if (err != CHIP_NO_ERROR)
+            {
+                mUndoLog.erase(entry);
+                return err;
+            }
+            original.present = true;
+            original.data.resize(size);
+            return CHIP_NO_ERROR;
+        }
+    }
+
+    PersistentStorageDelegate * mStorage = nullptr;
+    bool mCaptured                       = false;
+    // Value of every key modified since the snapshot was captured, as it was when it was captured.
+    std::map<std::string, OriginalValue> mUndoLog;
+};
+
+} // namespace chip
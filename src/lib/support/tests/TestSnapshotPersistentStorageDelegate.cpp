@@ -0,0 +1,150 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <pw_unit_test/framework.h>
+
+#include <lib/core/CHIPError.h>
+#include <lib/core/StringBuilderAdapters.h>
+#include <lib/support/SnapshotPersistentStorageDelegate.h>
+#include <lib/support/TestPersistentStorageDelegate.h>
+
+using namespace chip;
+
+namespace {
+
+class TestSnapshotPersistentStorageDelegate : public ::testing::Test
+{
+protected:
+    void SetUp() override { mSnapshot.Init(&mStorage); }
+
+    CHIP_ERROR Set(const char * key, const char * value)
+    {
+        return mSnapshot.SyncSetKeyValue(key, value, static_cast<uint16_t>(strlen(value)));
+    }
+
+    bool Matches(const char * key, const char * value)
+    {
+        char buf[32];
+        uint16_t size = static_cast<uint16_t>(sizeof(buf));
+        VerifyOrReturnValue(mStorage.SyncGetKeyValue(key, buf, size) == CHIP_NO_ERROR, false);
+        return size == strlen(value) && memcmp(buf, value, size) == 0;
+    }
+
+    TestPersistentStorageDelegate mStorage;
+    SnapshotPersistentStorageDelegate mSnapshot;
+};
+
+TEST_F(TestSnapshotPersistentStorageDelegate, TestPassThroughWithoutSnapshot)
+{
+    EXPECT_FALSE(mSnapshot.HasSnapshot());
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_ERROR_INCORRECT_STATE);
+
+    EXPECT_EQ(Set("a", "1"), CHIP_NO_ERROR);
+    EXPECT_TRUE(Matches("a", "1"));
+
+    char buf[4];
+    uint16_t size = static_cast<uint16_t>(sizeof(buf));
+    EXPECT_EQ(mSnapshot.SyncGetKeyValue("a", buf, size), CHIP_NO_ERROR);
+    EXPECT_EQ(size, 1u);
+
+    EXPECT_EQ(mSnapshot.SyncDeleteKeyValue("a"), CHIP_NO_ERROR);
+    EXPECT_FALSE(mStorage.HasKey("a"));
+    EXPECT_EQ(mSnapshot.SyncDeleteKeyValue("a"), CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+}
+
+TEST_F(TestSnapshotPersistentStorageDelegate, TestRestoreModifiedKeys)
+{
+    EXPECT_EQ(Set("kept", "kept"), CHIP_NO_ERROR);
+    EXPECT_EQ(Set("changed", "before"), CHIP_NO_ERROR);
+    EXPECT_EQ(Set("deleted", "deleted"), CHIP_NO_ERROR);
+
+    mSnapshot.Capture();
+    EXPECT_TRUE(mSnapshot.HasSnapshot());
+
+    EXPECT_EQ(Set("changed", "after"), CHIP_NO_ERROR);
+    EXPECT_EQ(Set("changed", "after again"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.SyncDeleteKeyValue("deleted"), CHIP_NO_ERROR);
+    EXPECT_EQ(Set("added", "added"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.SyncDeleteKeyValue("missing"), CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND);
+    EXPECT_EQ(mStorage.GetNumKeys(), 3u);
+
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_NO_ERROR);
+    EXPECT_EQ(mStorage.GetNumKeys(), 3u);
+    EXPECT_TRUE(Matches("kept", "kept"));
+    EXPECT_TRUE(Matches("changed", "before"));
+    EXPECT_TRUE(Matches("deleted", "deleted"));
+    EXPECT_FALSE(mStorage.HasKey("added"));
+    EXPECT_FALSE(mStorage.HasKey("missing"));
+
+    // The snapshot is kept, to be restored again after the next changes.
+    EXPECT_EQ(Set("changed", "third"), CHIP_NO_ERROR);
+    EXPECT_EQ(Set("added", "added"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_NO_ERROR);
+    EXPECT_TRUE(Matches("changed", "before"));
+    EXPECT_FALSE(mStorage.HasKey("added"));
+}
+
+TEST_F(TestSnapshotPersistentStorageDelegate, TestCaptureReplacesSnapshot)
+{
+    mSnapshot.Capture();
+    EXPECT_EQ(Set("a", "1"), CHIP_NO_ERROR);
+
+    mSnapshot.Capture();
+    EXPECT_EQ(Set("a", "2"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_NO_ERROR);
+    EXPECT_TRUE(Matches("a", "1"));
+}
+
+TEST_F(TestSnapshotPersistentStorageDelegate, TestRestoreLargeValue)
+{
+    std::vector<uint8_t> large(1000);
+    for (size_t i = 0; i < large.size(); i++)
+    {
+        large[i] = static_cast<uint8_t>(i);
+    }
+    EXPECT_EQ(mSnapshot.SyncSetKeyValue("large", large.data(), static_cast<uint16_t>(large.size())), CHIP_NO_ERROR);
+
+    mSnapshot.Capture();
+    EXPECT_EQ(Set("large", "small"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_NO_ERROR);
+
+    std::vector<uint8_t> restored(2000);
+    uint16_t size = static_cast<uint16_t>(restored.size());
+    EXPECT_EQ(mStorage.SyncGetKeyValue("large", restored.data(), size), CHIP_NO_ERROR);
+    ASSERT_EQ(size, large.size());
+    EXPECT_EQ(memcmp(restored.data(), large.data(), size), 0);
+}
+
+TEST_F(TestSnapshotPersistentStorageDelegate, TestFailedReadIsNotLogged)
+{
+    EXPECT_EQ(Set("poisoned", "before"), CHIP_NO_ERROR);
+    mSnapshot.Capture();
+
+    mStorage.AddPoisonKey("poisoned");
+    EXPECT_EQ(Set("poisoned", "after"), CHIP_ERROR_PERSISTED_STORAGE_FAILED);
+    mStorage.ClearPoisonKeys();
+
+    EXPECT_EQ(Set("poisoned", "after"), CHIP_NO_ERROR);
+    EXPECT_EQ(mSnapshot.Restore(), CHIP_NO_ERROR);
+    EXPECT_TRUE(Matches("poisoned", "before"));
+}
+
+} // namespace
@@ -29,13 +29,13 @@ namespace Test {
 
 using namespace TestCerts;
 
-CHIP_ERROR MessagingContext::Init(TransportMgrBase * transport, IOContext * ioContext)
+CHIP_ERROR MessagingContext::Init(TransportMgrBase * transport, System::Layer * systemLayer)
 {
     VerifyOrReturnError(mpData->mInitialized == false, CHIP_ERROR_INTERNAL);
     mpData->mInitialized = true;
 
-    mpData->mIOContext = ioContext;
-    mpData->mTransport = transport;
+    mpData->mSystemLayer = systemLayer;
+    mpData->mTransport   = transport;
 
     ReturnErrorOnFailure(PlatformMemoryUser::Init());
 
@@ -96,7 +96,7 @@ void MessagingContext::Shutdown()
 
 CHIP_ERROR MessagingContext::InitFromExisting(const MessagingContext & existing)
 {
-    return Init(existing.mpData->mTransport, existing.mpData->mIOContext);
+    return Init(existing.mpData->mTransport, existing.mpData->mSystemLayer);
 }
 
 void MessagingContext::ShutdownAndRestoreExisting(MessagingContext & existing)
@@ -310,6 +310,8 @@ Messaging::ExchangeContext * MessagingContext::NewExchangeToBob(Messaging::Excha
 
 LoopbackTransportManager * LoopbackMessagingContext::spLoopbackTransportManager = nullptr;
 
+InMemoryTransportManager * VirtualTimeMessagingContext::spInMemoryTransportManager = nullptr;
+
 UDPTransportManager * UDPMessagingContext::spUDPTransportManager = nullptr;
 
 void MessageCapturer::OnMessageReceived(const PacketHeader & packetHeader, const PayloadHeader & payloadHeader,
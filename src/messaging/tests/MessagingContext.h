@@ -31,6 +31,7 @@
 #include <system/SystemClock.h>
 #include <transport/SessionManager.h>
 #include <transport/TransportMgr.h>
+#include <transport/tests/InMemoryTransportManager.h>
 #include <transport/tests/LoopbackTransportManager.h>
 #include <transport/tests/UDPTransportManager.h>
 
@@ -100,7 +101,8 @@ public:
     void ConfigInitializeNodes(bool initializeNodes) { mpData->mInitializeNodes = initializeNodes; }
 
     /// Initialize the underlying layers and test suite pointer
-    CHIP_ERROR Init(TransportMgrBase * transport, IOContext * io);
+    CHIP_ERROR Init(TransportMgrBase * transport, System::Layer * systemLayer);
+    CHIP_ERROR Init(TransportMgrBase * transport, IOContext * io) { return Init(transport, &io->GetSystemLayer()); }
 
     // Shutdown all layers, finalize operations
     void Shutdown();
@@ -171,7 +173,7 @@ public:
     Messaging::ExchangeContext * NewExchangeToAlice(Messaging::ExchangeDelegate * delegate, bool isInitiator = true);
     Messaging::ExchangeContext * NewExchangeToBob(Messaging::ExchangeDelegate * delegate, bool isInitiator = true);
 
-    System::Layer & GetSystemLayer() { return mpData->mIOContext->GetSystemLayer(); }
+    System::Layer & GetSystemLayer() { return *mpData->mSystemLayer; }
 
 private:
     // These members are encapsulated in a struct which is allocated upon construction of MessagingContext and freed upon
@@ -191,7 +193,7 @@ private:
         SessionManager mSessionManager;
         Messaging::ExchangeManager mExchangeManager;
         secure_channel::MessageCounterManager mMessageCounterManager;
-        IOContext * mIOContext        = nullptr;
+        System::Layer * mSystemLayer  = nullptr;
         TransportMgrBase * mTransport = nullptr;      // Only needed for InitFromExisting.
         chip::TestPersistentStorageDelegate mStorage; // for SessionManagerInit
         chip::PersistentStorageOperationalKeystore mOpKeyStore;
@@ -269,6 +271,69 @@ public:
     static LoopbackTransportManager * spLoopbackTransportManager;
 };
 
+// VirtualTimeMessagingContext enriches MessagingContext with a loopback transport running in memory on a virtual clock: the
+// retransmissions and timeouts fire as soon as nothing else is left to run, see InMemoryTransportManager.
+class VirtualTimeMessagingContext : public ::testing::Test, public MessagingContext
+{
+public:
+    virtual ~VirtualTimeMessagingContext() {}
+
+    // These functions wrap spInMemoryTransportManager methods
+    static auto & GetSystemLayer() { return spInMemoryTransportManager->GetSystemLayer(); }
+    static auto & GetLoopback() { return spInMemoryTransportManager->GetLoopback(); }
+    static auto & GetTransportMgr() { return spInMemoryTransportManager->GetTransportMgr(); }
+
+    template <typename... Ts>
+    static void DrainAndServiceIO(Ts... args)
+    {
+        return spInMemoryTransportManager->DrainAndServiceIO(args...);
+    }
+
+    static void AdvanceClock(System::Clock::Timeout delay) { spInMemoryTransportManager->AdvanceClock(delay); }
+
+    template <typename... Ts>
+    static bool RunUntilIdle(Ts... args)
+    {
+        return spInMemoryTransportManager->RunUntilIdle(args...);
+    }
+
+    // Performs shared setup for all tests in the test suite
+    static void SetUpTestSuite()
+    {
+        // Initialize memory.
+        ASSERT_EQ(chip::Platform::MemoryInit(), CHIP_NO_ERROR);
+        // Instantiate the InMemoryTransportManager.
+        ASSERT_EQ(spInMemoryTransportManager, nullptr);
+        spInMemoryTransportManager = new InMemoryTransportManager();
+        ASSERT_NE(spInMemoryTransportManager, nullptr);
+        // Initialize the InMemoryTransportManager.
+        ASSERT_EQ(spInMemoryTransportManager->Init(), CHIP_NO_ERROR);
+    }
+
+    // Performs shared teardown for all tests in the test suite
+    static void TearDownTestSuite()
+    {
+        // Shutdown the InMemoryTransportManager.
+        spInMemoryTransportManager->Shutdown();
+        // Destroy the InMemoryTransportManager.
+        if (spInMemoryTransportManager != nullptr)
+        {
+            delete spInMemoryTransportManager;
+            spInMemoryTransportManager = nullptr;
+        }
+        // Shutdown memory.
+        chip::Platform::MemoryShutdown();
+    }
+
+    // Performs setup for each individual test in the test suite
+    virtual void SetUp() { ASSERT_EQ(MessagingContext::Init(&GetTransportMgr(), &GetSystemLayer()), CHIP_NO_ERROR); }
+
+    // Performs teardown for each individual test in the test suite
+    virtual void TearDown() { MessagingContext::Shutdown(); }
+
+    static InMemoryTransportManager * spInMemoryTransportManager;
+};
+
 // UDPMessagingContext enriches MessagingContext with an UDP transport
 class UDPMessagingContext : public ::testing::Test, public MessagingContext
 {
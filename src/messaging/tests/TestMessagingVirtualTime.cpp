@@ -0,0 +1,166 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements unit tests of the exchanges running on the
+ *      virtual clock of VirtualTimeMessagingContext.
+ */
+
+#include <pw_unit_test/framework.h>
+
+#include <lib/core/CHIPCore.h>
+#include <lib/core/StringBuilderAdapters.h>
+#include <lib/support/CodeUtils.h>
+#include <messaging/ExchangeContext.h>
+#include <messaging/ExchangeMgr.h>
+#include <messaging/ReliableMessageMgr.h>
+#include <messaging/tests/MessagingContext.h>
+#include <protocols/echo/Echo.h>
+
+namespace {
+
+using namespace chip;
+using namespace chip::Messaging;
+using namespace chip::Protocols;
+using namespace chip::System::Clock::Literals;
+
+const char PAYLOAD[] = "Hello!";
+
+constexpr uint32_t kMaxMRPTransmits = 5; // Counting the initial message.
+
+using TestMessagingVirtualTime = chip::Test::VirtualTimeMessagingContext;
+
+class MockAppDelegate : public UnsolicitedMessageHandler, public ExchangeDelegate
+{
+public:
+    CHIP_ERROR OnUnsolicitedMessageReceived(const PayloadHeader & payloadHeader, ExchangeDelegate *& newDelegate) override
+    {
+        newDelegate = this;
+        return CHIP_NO_ERROR;
+    }
+
+    CHIP_ERROR OnMessageReceived(ExchangeContext * ec, const PayloadHeader & payloadHeader,
+                                 System::PacketBufferHandle && buffer) override
+    {
+        mReceivedCount++;
+        return CHIP_NO_ERROR;
+    }
+
+    void OnResponseTimeout(ExchangeContext * ec) override
+    {
+        mResponseTimedOut  = true;
+        mResponseTimeoutAt = System::SystemClock().GetMonotonicTimestamp();
+    }
+
+    int mReceivedCount                          = 0;
+    bool mResponseTimedOut                      = false;
+    System::Clock::Timestamp mResponseTimeoutAt = System::Clock::kZero;
+};
+
+TEST_F(TestMessagingVirtualTime, CheckMessageDelivery)
+{
+    MockAppDelegate mockReceiver;
+    EXPECT_EQ(GetExchangeManager().RegisterUnsolicitedMessageHandlerForType(Echo::MsgType::EchoRequest, &mockReceiver),
+              CHIP_NO_ERROR);
+
+    MockAppDelegate mockSender;
+    ExchangeContext * exchange = NewExchangeToAlice(&mockSender);
+    ASSERT_NE(exchange, nullptr);
+
+    const System::Clock::Timestamp startTime = System::SystemClock().GetMonotonicTimestamp();
+    EXPECT_EQ(exchange->SendMessage(Echo::MsgType::EchoRequest, MessagePacketBuffer::NewWithData(PAYLOAD, sizeof(PAYLOAD))),
+              CHIP_NO_ERROR);
+    DrainAndServiceIO();
+
+    // The message and its acknowledgement were delivered without the clock moving.
+    EXPECT_EQ(mockReceiver.mReceivedCount, 1);
+    EXPECT_EQ(GetExchangeManager().GetReliableMessageMgr()->TestGetCountRetransTable(), 0);
+    EXPECT_EQ(System::SystemClock().GetMonotonicTimestamp(), startTime);
+
+    EXPECT_EQ(GetExchangeManager().UnregisterUnsolicitedMessageHandlerForType(Echo::MsgType::EchoRequest), CHIP_NO_ERROR);
+    EXPECT_TRUE(RunUntilIdle());
+}
+
+TEST_F(TestMessagingVirtualTime, CheckRetransmissionsAndResponseTimeout)
+{
+    MockAppDelegate mockSender;
+    ExchangeContext * exchange = NewExchangeToAlice(&mockSender);
+    ASSERT_NE(exchange, nullptr);
+
+    ReliableMessageMgr * rm = GetExchangeManager().GetReliableMessageMgr();
+    ASSERT_NE(rm, nullptr);
+
+    // Nothing gets through: every transmission is dropped.
+    auto & loopback               = GetLoopback();
+    loopback.mSentMessageCount    = 0;
+    loopback.mNumMessagesToDrop   = kMaxMRPTransmits;
+    loopback.mDroppedMessageCount = 0;
+
+    const System::Clock::Timestamp startTime = System::SystemClock().GetMonotonicTimestamp();
+    exchange->SetResponseTimeout(60_s16);
+    EXPECT_EQ(exchange->SendMessage(Echo::MsgType::EchoRequest, MessagePacketBuffer::NewWithData(PAYLOAD, sizeof(PAYLOAD)),
+                                    SendMessageFlags::kExpectResponse),
+              CHIP_NO_ERROR);
+    DrainAndServiceIO();
+
+    EXPECT_EQ(loopback.mDroppedMessageCount, 1u);
+    EXPECT_EQ(rm->TestGetCountRetransTable(), 1);
+
+    // The retransmissions and the response timeout fire one after the other,
+    // without waiting for the minute they take on a real clock.
+    EXPECT_TRUE(RunUntilIdle());
+
+    EXPECT_EQ(loopback.mSentMessageCount, kMaxMRPTransmits);
+    EXPECT_EQ(loopback.mDroppedMessageCount, kMaxMRPTransmits);
+    EXPECT_EQ(rm->TestGetCountRetransTable(), 0);
+    EXPECT_TRUE(mockSender.mResponseTimedOut);
+    EXPECT_EQ(mockSender.mReceivedCount, 0);
+    EXPECT_EQ(mockSender.mResponseTimeoutAt - startTime, System::Clock::Timestamp(60000));
+}
+
+TEST_F(TestMessagingVirtualTime, CheckAdvanceClockStopsAtTarget)
+{
+    MockAppDelegate mockSender;
+    ExchangeContext * exchange = NewExchangeToAlice(&mockSender);
+    ASSERT_NE(exchange, nullptr);
+
+    auto & loopback               = GetLoopback();
+    loopback.mSentMessageCount    = 0;
+    loopback.mNumMessagesToDrop   = kMaxMRPTransmits;
+    loopback.mDroppedMessageCount = 0;
+
+    exchange->SetResponseTimeout(60_s16);
+    EXPECT_EQ(exchange->SendMessage(Echo::MsgType::EchoRequest, MessagePacketBuffer::NewWithData(PAYLOAD, sizeof(PAYLOAD)),
+                                    SendMessageFlags::kExpectResponse),
+              CHIP_NO_ERROR);
+    DrainAndServiceIO();
+
+    AdvanceClock(59_s16);
+    EXPECT_EQ(loopback.mDroppedMessageCount, kMaxMRPTransmits);
+    EXPECT_FALSE(mockSender.mResponseTimedOut);
+
+    // A bound shorter than the next timer leaves it pending.
+    EXPECT_FALSE(RunUntilIdle(500_ms32));
+    EXPECT_FALSE(mockSender.mResponseTimedOut);
+
+    EXPECT_TRUE(RunUntilIdle());
+    EXPECT_TRUE(mockSender.mResponseTimedOut);
+}
+
+} // namespace
@@ -0,0 +1,184 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements Layer on a virtual monotonic clock.
+ */
+
+#include <lib/support/CodeUtils.h>
+#include <system/SystemLayerImplVirtualTime.h>
+
+namespace chip {
+namespace System {
+
+CHIP_ERROR LayerImplVirtualTime::Init()
+{
+    VerifyOrReturnError(mLayerState.SetInitializing(), CHIP_ERROR_INCORRECT_STATE);
+
+    mRealClock = &SystemClock();
+    Clock::Internal::SetSystemClockForTesting(&mClock);
+
+    VerifyOrReturnError(mLayerState.SetInitialized(), CHIP_ERROR_INCORRECT_STATE);
+    return CHIP_NO_ERROR;
+}
+
+void LayerImplVirtualTime::Shutdown()
+{
+    VerifyOrReturn(mLayerState.SetShuttingDown());
+
+    mTimerList.Clear();
+    mExpiredTimers.Clear();
+    mTimerPool.ReleaseAll();
+
+    Clock::Internal::SetSystemClockForTesting(mRealClock);
+    mRealClock = nullptr;
+
+    mLayerState.ResetFromShuttingDown(); // Return to uninitialized state to permit re-initialization.
+}
+
+CHIP_ERROR LayerImplVirtualTime::StartTimer(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState)
+{
+    VerifyOrReturnError(mLayerState.IsInitialized(), CHIP_ERROR_INCORRECT_STATE);
+
+    CancelTimer(onComplete, appState);
+
+    TimerList::Node * timer = mTimerPool.Create(*this, mClock.GetMonotonicTimestamp() + delay, onComplete, appState);
+    VerifyOrReturnError(timer != nullptr, CHIP_ERROR_NO_MEMORY);
+    (void) mTimerList.Add(timer);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplVirtualTime::ExtendTimerTo(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState)
+{
+    VerifyOrReturnError(delay.count() > 0, CHIP_ERROR_INVALID_ARGUMENT);
+
+    Clock::Timeout remainingTime = mTimerList.GetRemainingTime(onComplete, appState);
+    if (remainingTime.count() < delay.count())
+    {
+        if (remainingTime == Clock::kZero)
+        {
+            // If remaining time is Clock::kZero, it might possible that our timer is in
+            // the mExpiredTimers list and about to be fired. Remove it from that list, since we are extending it.
+            mExpiredTimers.Remove(onComplete, appState);
+        }
+        return StartTimer(delay, onComplete, appState);
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+bool LayerImplVirtualTime::IsTimerActive(TimerCompleteCallback onComplete, void * appState)
+{
+    bool timerIsActive = (mTimerList.GetRemainingTime(onComplete, appState) > Clock::kZero);
+
+    if (!timerIsActive)
+    {
+        // check if the timer is in the mExpiredTimers list about to be fired.
+        for (TimerList::Node * timer = mExpiredTimers.Earliest(); timer != nullptr; timer = timer->mNextTimer)
+        {
+            if (timer->GetCallback().GetOnComplete() == onComplete && timer->GetCallback().GetAppState() == appState)
+            {
+                return true;
+            }
+        }
+    }
+
+    return timerIsActive;
+}
+
+Clock::Timeout LayerImplVirtualTime::GetRemainingTime(TimerCompleteCallback onComplete, void * appState)
+{
+    return mTimerList.GetRemainingTime(onComplete, appState);
+}
+
+void LayerImplVirtualTime::CancelTimer(TimerCompleteCallback onComplete, void * appState)
+{
+    VerifyOrReturn(mLayerState.IsInitialized());
+
+    TimerList::Node * timer = mTimerList.Remove(onComplete, appState);
+    if (timer == nullptr)
+    {
+        // The timer was not in our "will fire in the future" list, but it might
+        // be in the "we're about to fire these" chunk we already grabbed from
+        // that list.  Check for it there too, and if found there we still want
+        // to cancel it.
+        timer = mExpiredTimers.Remove(onComplete, appState);
+    }
+    VerifyOrReturn(timer != nullptr);
+
+    mTimerPool.Release(timer);
+}
+
+CHIP_ERROR LayerImplVirtualTime::ScheduleWork(TimerCompleteCallback onComplete, void * appState)
+{
+    VerifyOrReturnError(mLayerState.IsInitialized(), CHIP_ERROR_INCORRECT_STATE);
+
+    // As in the other implementations, scheduled work is a timer expiring now,
+    // which does not cancel the work already scheduled with the same callback.
+    TimerList::Node * timer = mTimerPool.Create(*this, mClock.GetMonotonicTimestamp(), onComplete, appState);
+    VerifyOrReturnError(timer != nullptr, CHIP_ERROR_NO_MEMORY);
+    (void) mTimerList.Add(timer);
+    return CHIP_NO_ERROR;
+}
+
+bool LayerImplVirtualTime::HandleExpiredTimers()
+{
+    VerifyOrDieWithMsg(mExpiredTimers.Empty(), DeviceLayer, "Re-entry into HandleExpiredTimers from a timer callback?");
+    mExpiredTimers = mTimerList.ExtractEarlier(Clock::Timeout(1) + mClock.GetMonotonicTimestamp());
+
+    bool fired              = false;
+    TimerList::Node * timer = nullptr;
+    while ((timer = mExpiredTimers.PopEarliest()) != nullptr)
+    {
+        mTimerPool.Invoke(timer);
+        fired = true;
+    }
+    return fired;
+}
+
+void LayerImplVirtualTime::AdvanceClock(Clock::Timeout delay)
+{
+    const Clock::Timestamp target = mClock.GetMonotonicTimestamp() + delay;
+    (void) RunTimersUntil(target);
+    mClock.SetMonotonic(target);
+}
+
+bool LayerImplVirtualTime::RunUntilIdle(Clock::Timeout maxAdvance)
+{
+    return RunTimersUntil(mClock.GetMonotonicTimestamp() + maxAdvance);
+}
+
+bool LayerImplVirtualTime::RunTimersUntil(Clock::Timestamp limit)
+{
+    while (true)
+    {
+        // The work the timers schedule runs before the clock moves again.
+        while (HandleExpiredTimers())
+        {
+        }
+
+        TimerList::Node * next = mTimerList.Earliest();
+        VerifyOrReturnValue(next != nullptr, true);
+        VerifyOrReturnValue(next->AwakenTime() <= limit, false);
+        mClock.SetMonotonic(next->AwakenTime());
+    }
+}
+
+} // namespace System
+} // namespace chip
@@ -0,0 +1,111 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file declares an implementation of System::Layer whose timers run
+ *      on a virtual monotonic clock, for tests and fuzzing harnesses.
+ */
+
+#pragma once
+
+#include <lib/support/ObjectLifeCycle.h>
+#include <system/SystemClock.h>
+#include <system/SystemLayer.h>
+#include <system/SystemTimer.h>
+
+namespace chip {
+namespace System {
+
+/**
+ * System::Layer without sockets nor threads, whose time only moves when its
+ * owner advances it.
+ *
+ * The layer installs its mock clock as the system clock while it is
+ * initialized, so that every timestamp taken by the stack is virtual. Timers
+ * and scheduled work only fire from HandleExpiredTimers(), AdvanceClock() and
+ * RunUntilIdle(): there is no event loop to run, and no system call is made.
+ *
+ * Since the clock can jump from one expiry to the next, the retransmissions,
+ * timeouts and reporting intervals which take minutes of wall-clock time run
+ * as fast as their callbacks do, in the same order on every run.
+ */
+class LayerImplVirtualTime : public Layer
+{
+public:
+    LayerImplVirtualTime() = default;
+    ~LayerImplVirtualTime() override { VerifyOrDie(mLayerState.Destroy()); }
+
+    // Layer overrides.
+    CHIP_ERROR Init() override;
+    void Shutdown() override;
+    bool IsInitialized() const override { return mLayerState.IsInitialized(); }
+    CHIP_ERROR StartTimer(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState) override;
+    CHIP_ERROR ExtendTimerTo(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState) override;
+    bool IsTimerActive(TimerCompleteCallback onComplete, void * appState) override;
+    Clock::Timeout GetRemainingTime(TimerCompleteCallback onComplete, void * appState) override;
+    void CancelTimer(TimerCompleteCallback onComplete, void * appState) override;
+    CHIP_ERROR ScheduleWork(TimerCompleteCallback onComplete, void * appState) override;
+
+    /**
+     * Fires the timers which expired at the current virtual time. The timers
+     * started by their callbacks, including the scheduled work, are left for
+     * the next call.
+     *
+     * @return true if at least one timer fired.
+     */
+    bool HandleExpiredTimers();
+
+    /**
+     * Moves the virtual clock forward by @a delay. The timers expiring on the
+     * way fire in order, each one with the clock set to its expiry time.
+     */
+    void AdvanceClock(Clock::Timeout delay);
+
+    /**
+     * Runs the timers until none is left, jumping the virtual clock straight
+     * to the next expiry whenever nothing is due at the current time. The
+     * clock is not moved past @a maxAdvance from its current value, which
+     * bounds the periodic timers that never let the layer go idle.
+     *
+     * @return true if the layer went idle, false if a timer is still pending
+     *         beyond @a maxAdvance.
+     */
+    bool RunUntilIdle(Clock::Timeout maxAdvance);
+
+    Clock::Timestamp GetMonotonicTimestamp() { return mClock.GetMonotonicTimestamp(); }
+    Clock::Internal::MockClock & GetClock() { return mClock; }
+
+private:
+    // Fires the timers expiring until @a limit in order, returns true if no timer is left.
+    bool RunTimersUntil(Clock::Timestamp limit);
+
+    TimerPool<TimerList::Node> mTimerPool;
+    TimerList mTimerList;
+    // List of expired timers being processed right now. Stored in a member so
+    // we can cancel them.
+    TimerList mExpiredTimers;
+
+    Clock::Internal::MockClock mClock;
+    Clock::ClockBase * mRealClock = nullptr;
+
+    ObjectLifeCycle mLayerState;
+};
+
+} // namespace System
+} // namespace chip
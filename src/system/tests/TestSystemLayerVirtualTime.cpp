@@ -0,0 +1,169 @@
+/*
+ *    Copyright (c) 2024 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <pw_unit_test/framework.h>
+
+#include <lib/core/StringBuilderAdapters.h>
+#include <lib/support/CHIPMem.h>
+#include <system/SystemLayerImplVirtualTime.h>
+
+#include <vector>
+
+using namespace chip;
+using namespace chip::System;
+using namespace chip::System::Clock::Literals;
+
+namespace {
+
+class TestSystemLayerVirtualTime : public ::testing::Test
+{
+public:
+    static void SetUpTestSuite() { ASSERT_EQ(chip::Platform::MemoryInit(), CHIP_NO_ERROR); }
+    static void TearDownTestSuite() { chip::Platform::MemoryShutdown(); }
+
+protected:
+    void SetUp() override { ASSERT_EQ(mLayer.Init(), CHIP_NO_ERROR); }
+    void TearDown() override { mLayer.Shutdown(); }
+
+    LayerImplVirtualTime mLayer;
+};
+
+// Records the virtual time at which it fired.
+struct FiredAt
+{
+    std::vector<Clock::Timestamp> times;
+
+    static void Record(Layer *, void * state)
+    {
+        static_cast<FiredAt *>(state)->times.push_back(SystemClock().GetMonotonicTimestamp());
+    }
+};
+
+void IncrementIntCounter(Layer *, void * state)
+{
+    ++(*static_cast<int *>(state));
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckClockIsInstalled)
+{
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::kZero);
+    mLayer.AdvanceClock(1500_ms);
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::Timestamp(1500));
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckScheduleWork)
+{
+    int callCount = 0;
+    EXPECT_EQ(mLayer.ScheduleWork(IncrementIntCounter, &callCount), CHIP_NO_ERROR);
+    EXPECT_EQ(mLayer.ScheduleWork(IncrementIntCounter, &callCount), CHIP_NO_ERROR);
+    EXPECT_EQ(callCount, 0);
+
+    EXPECT_TRUE(mLayer.HandleExpiredTimers());
+    EXPECT_EQ(callCount, 2);
+    EXPECT_FALSE(mLayer.HandleExpiredTimers());
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::kZero);
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckTimersFireAtTheirExpiry)
+{
+    FiredAt first;
+    FiredAt second;
+    EXPECT_EQ(mLayer.StartTimer(300_ms, FiredAt::Record, &second), CHIP_NO_ERROR);
+    EXPECT_EQ(mLayer.StartTimer(100_ms, FiredAt::Record, &first), CHIP_NO_ERROR);
+
+    EXPECT_FALSE(mLayer.HandleExpiredTimers());
+    EXPECT_EQ(mLayer.GetRemainingTime(FiredAt::Record, &second), 300_ms);
+
+    mLayer.AdvanceClock(200_ms);
+    ASSERT_EQ(first.times.size(), 1u);
+    EXPECT_EQ(first.times[0], Clock::Timestamp(100));
+    EXPECT_TRUE(second.times.empty());
+    EXPECT_TRUE(mLayer.IsTimerActive(FiredAt::Record, &second));
+
+    mLayer.AdvanceClock(1000_ms);
+    ASSERT_EQ(second.times.size(), 1u);
+    EXPECT_EQ(second.times[0], Clock::Timestamp(300));
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::Timestamp(1200));
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckCancelAndExtendTimer)
+{
+    int callCount = 0;
+    EXPECT_EQ(mLayer.StartTimer(100_ms, IncrementIntCounter, &callCount), CHIP_NO_ERROR);
+    mLayer.CancelTimer(IncrementIntCounter, &callCount);
+    mLayer.AdvanceClock(200_ms);
+    EXPECT_EQ(callCount, 0);
+
+    EXPECT_EQ(mLayer.StartTimer(100_ms, IncrementIntCounter, &callCount), CHIP_NO_ERROR);
+    EXPECT_EQ(mLayer.ExtendTimerTo(500_ms, IncrementIntCounter, &callCount), CHIP_NO_ERROR);
+    mLayer.AdvanceClock(499_ms);
+    EXPECT_EQ(callCount, 0);
+    mLayer.AdvanceClock(1_ms);
+    EXPECT_EQ(callCount, 1);
+}
+
+// Restarts itself until it has fired the given number of times.
+struct Periodic
+{
+    int remaining;
+
+    static void Fire(Layer * layer, void * state)
+    {
+        auto * self = static_cast<Periodic *>(state);
+        if (--self->remaining > 0)
+        {
+            EXPECT_EQ(layer->StartTimer(3600_s, Fire, self), CHIP_NO_ERROR);
+        }
+    }
+};
+
+TEST_F(TestSystemLayerVirtualTime, CheckRunUntilIdleJumpsToNextTimer)
+{
+    FiredAt fired;
+    EXPECT_EQ(mLayer.StartTimer(2000_ms, FiredAt::Record, &fired), CHIP_NO_ERROR);
+
+    // A day of timers runs without waiting, the clock stopping at the last expiry.
+    Periodic periodic{ 24 };
+    EXPECT_EQ(mLayer.StartTimer(3600_s, Periodic::Fire, &periodic), CHIP_NO_ERROR);
+
+    EXPECT_TRUE(mLayer.RunUntilIdle(48 * 3600_s));
+    EXPECT_EQ(periodic.remaining, 0);
+    ASSERT_EQ(fired.times.size(), 1u);
+    EXPECT_EQ(fired.times[0], Clock::Timestamp(2000));
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::Timestamp(24 * 3600 * 1000));
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckRunUntilIdleIsBounded)
+{
+    Periodic periodic{ 1000 };
+    EXPECT_EQ(mLayer.StartTimer(3600_s, Periodic::Fire, &periodic), CHIP_NO_ERROR);
+
+    EXPECT_FALSE(mLayer.RunUntilIdle(10 * 3600_s + 1_ms));
+    EXPECT_EQ(periodic.remaining, 990);
+    EXPECT_EQ(SystemClock().GetMonotonicTimestamp(), Clock::Timestamp(10 * 3600 * 1000));
+    EXPECT_TRUE(mLayer.IsTimerActive(Periodic::Fire, &periodic));
+}
+
+TEST_F(TestSystemLayerVirtualTime, CheckShutdownRestoresClock)
+{
+    Clock::ClockBase * virtualClock = &SystemClock();
+    mLayer.Shutdown();
+    EXPECT_NE(&SystemClock(), virtualClock);
+    ASSERT_EQ(mLayer.Init(), CHIP_NO_ERROR);
+    EXPECT_EQ(&SystemClock(), virtualClock);
+}
+
+} // namespace
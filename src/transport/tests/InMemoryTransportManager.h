@@ -0,0 +1,121 @@
+/*
+ *
+ *    Copyright (c) 2024 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <lib/core/CHIPError.h>
+#include <lib/support/CHIPMem.h>
+#include <lib/support/CodeUtils.h>
+#include <system/SystemLayerImplVirtualTime.h>
+#include <transport/TransportMgr.h>
+#include <transport/raw/tests/NetworkTestHelpers.h>
+
+namespace chip {
+namespace Test {
+
+/**
+ * Loopback transport manager which runs entirely in memory: the messages sent
+ * are queued by the loopback transport and delivered to the session manager by
+ * scheduled work of a System::LayerImplVirtualTime. No socket, Inet layer nor
+ * event loop is set up, and the time only moves through AdvanceClock() and
+ * RunUntilIdle(), so the timing of the exchanges is deterministic.
+ *
+ * Drop-in replacement of LoopbackTransportManager for the tests and the
+ * fuzzing harnesses which do not need the IOContext.
+ */
+class InMemoryTransportManager
+{
+public:
+    /// Initialize the underlying layers.
+    CHIP_ERROR Init()
+    {
+        ReturnErrorOnFailure(Platform::MemoryInit());
+        ReturnErrorOnFailure(mSystemLayer.Init());
+        GetLoopback().InitLoopbackTransport(&mSystemLayer);
+        ReturnErrorOnFailure(mTransportManager.Init("LOOPBACK"));
+        return CHIP_NO_ERROR;
+    }
+
+    // Shutdown all layers, finalize operations
+    void Shutdown()
+    {
+        mTransportManager.Close();
+        GetLoopback().ShutdownLoopbackTransport();
+        mSystemLayer.Shutdown();
+        Platform::MemoryShutdown();
+    }
+
+    System::LayerImplVirtualTime & GetSystemLayer() { return mSystemLayer; }
+    LoopbackTransport & GetLoopback() { return mTransportManager.GetTransport().template GetImplAtIndex<0>(); }
+    TransportMgrBase & GetTransportMgr() { return mTransportManager; }
+
+    /*
+     * Delivers the pending messages and runs the work they schedule, until
+     * nothing is left to run at the current virtual time. The clock does not
+     * move: the messages sent in reply are delivered, but the retransmissions
+     * and the other timers are not fired.
+     *
+     * An indefinite ping-pong of messages is cut after maxRounds passes, so
+     * that a misbehaving test or input does not stall.
+     */
+    void DrainAndServiceIO(size_t maxRounds = kDefaultMaxRounds)
+    {
+        for (size_t round = 0; round < maxRounds; round++)
+        {
+            if (!mSystemLayer.HandleExpiredTimers() && !GetLoopback().HasPendingMessages())
+            {
+                break;
+            }
+        }
+    }
+
+    /*
+     * Moves the virtual clock forward by @a delay, firing the timers expiring
+     * on the way (MRP retransmissions, response timeouts, ...), then delivers
+     * the messages they sent.
+     */
+    void AdvanceClock(System::Clock::Timeout delay)
+    {
+        mSystemLayer.AdvanceClock(delay);
+        DrainAndServiceIO();
+    }
+
+    /*
+     * Runs the exchanges to completion: the pending messages are delivered and
+     * the virtual clock jumps to the next timer whenever nothing else is left
+     * to run, until no timer is pending or the clock moved by @a maxAdvance.
+     *
+     * @return true if nothing is left to run.
+     */
+    bool RunUntilIdle(System::Clock::Timeout maxAdvance = kDefaultMaxAdvance)
+    {
+        bool idle = mSystemLayer.RunUntilIdle(maxAdvance);
+        DrainAndServiceIO();
+        return idle && !GetLoopback().HasPendingMessages();
+    }
+
+private:
+    static constexpr size_t kDefaultMaxRounds                  = 1000;
+    static constexpr System::Clock::Timeout kDefaultMaxAdvance = System::Clock::Seconds32(24 * 60 * 60);
+
+    System::LayerImplVirtualTime mSystemLayer;
+    TransportMgr<LoopbackTransport> mTransportManager;
+};
+
+} // namespace Test
+} // namespace chip